@@ -418,7 +418,9 @@ CScriptArray::CScriptArray(asITypeInfo *ti, void *buf)
 	asIScriptEngine *engine = ti->GetEngine();
 
 	// Determine element size
-	if( subTypeId & asTYPEID_MASK_OBJECT )
+	if( elementsInline )
+		elementSize = (ti->GetSubType()->GetSize() + 3) & ~3;
+	else if( subTypeId & asTYPEID_MASK_OBJECT )
 		elementSize = sizeof(asPWORD);
 	else
 		elementSize = engine->GetSizeOfPrimitiveType(subTypeId);
@@ -471,6 +473,15 @@ CScriptArray::CScriptArray(asITypeInfo *ti, void *buf)
 		// implicitly stored as handles.
 		memset((((asUINT*)buf)+1), 0, length * elementSize);
 	}
+	else if( elementsInline )
+	{
+		CreateBuffer(&buffer, length);
+
+		// Script structs only hold plain data so the values are copied byte for byte
+		asUINT size = ti->GetSubType()->GetSize();
+		for( asUINT n = 0; n < length; n++ )
+			memcpy(At(n), ((asBYTE*)buf) + 4 + n*size, size);
+	}
 	else
 	{
 		// TODO: Optimize by calling the copy constructor of the object instead of
@@ -509,7 +520,9 @@ CScriptArray::CScriptArray(asUINT length, asITypeInfo *ti)
 	Precache();
 
 	// Determine element size
-	if( subTypeId & asTYPEID_MASK_OBJECT )
+	if( elementsInline )
+		elementSize = (ti->GetSubType()->GetSize() + 3) & ~3;
+	else if( subTypeId & asTYPEID_MASK_OBJECT )
 		elementSize = sizeof(asPWORD);
 	else
 		elementSize = objType->GetEngine()->GetSizeOfPrimitiveType(subTypeId);
@@ -563,7 +576,9 @@ CScriptArray::CScriptArray(asUINT length, void *defVal, asITypeInfo *ti)
 	Precache();
 
 	// Determine element size
-	if( subTypeId & asTYPEID_MASK_OBJECT )
+	if( elementsInline )
+		elementSize = (ti->GetSubType()->GetSize() + 3) & ~3;
+	else if( subTypeId & asTYPEID_MASK_OBJECT )
 		elementSize = sizeof(asPWORD);
 	else
 		elementSize = objType->GetEngine()->GetSizeOfPrimitiveType(subTypeId);
@@ -695,7 +710,8 @@ void CScriptArray::Reserve(asUINT maxElements)
 	}
 
 	// As objects in arrays of objects are not stored inline, it is safe to use memcpy here
-	// since we're just copying the pointers to objects and not the actual objects.
+	// since we're just copying the pointers to objects and not the actual objects. Script
+	// structs are stored inline, but they are plain data that can be moved byte for byte.
 	memcpy(newBuffer->data, buffer->data, buffer->numElements*elementSize);
 
 	// Release the old buffer
@@ -735,7 +751,8 @@ void CScriptArray::RemoveRange(asUINT start, asUINT count)
 
 	// Compact the elements
 	// As objects in arrays of objects are not stored inline, it is safe to use memmove here
-	// since we're just copying the pointers to objects and not the actual objects.
+	// since we're just copying the pointers to objects and not the actual objects. Script
+	// structs are stored inline, but they are plain data that can be moved byte for byte.
 	memmove(buffer->data + start*elementSize, buffer->data + (start + count)*elementSize, (buffer->numElements - start - count)*elementSize);
 	buffer->numElements -= count;
 }
@@ -781,7 +798,8 @@ void CScriptArray::Resize(int delta, asUINT at)
 		}
 
 		// As objects in arrays of objects are not stored inline, it is safe to use memcpy here
-		// since we're just copying the pointers to objects and not the actual objects.
+		// since we're just copying the pointers to objects and not the actual objects. Script
+		// structs are stored inline, but they are plain data that can be moved byte for byte.
 		memcpy(newBuffer->data, buffer->data, at*elementSize);
 		if( at < buffer->numElements )
 			memcpy(newBuffer->data + (at+delta)*elementSize, buffer->data + at*elementSize, (buffer->numElements-at)*elementSize);
@@ -798,14 +816,16 @@ void CScriptArray::Resize(int delta, asUINT at)
 	{
 		Destruct(buffer, at, at-delta);
 		// As objects in arrays of objects are not stored inline, it is safe to use memmove here
-		// since we're just copying the pointers to objects and not the actual objects.
+		// since we're just copying the pointers to objects and not the actual objects. Script
+		// structs are stored inline, but they are plain data that can be moved byte for byte.
 		memmove(buffer->data + at*elementSize, buffer->data + (at-delta)*elementSize, (buffer->numElements - (at-delta))*elementSize);
 		buffer->numElements += delta;
 	}
 	else
 	{
 		// As objects in arrays of objects are not stored inline, it is safe to use memmove here
-		// since we're just copying the pointers to objects and not the actual objects.
+		// since we're just copying the pointers to objects and not the actual objects. Script
+		// structs are stored inline, but they are plain data that can be moved byte for byte.
 		memmove(buffer->data + (at+delta)*elementSize, buffer->data + at*elementSize, (buffer->numElements - at)*elementSize);
 		Construct(buffer, at, at+delta);
 		buffer->numElements += delta;
@@ -960,7 +980,7 @@ const void *CScriptArray::At(asUINT index) const
 		return 0;
 	}
 
-	if( (subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) )
+	if( (subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) && !elementsInline )
 		return *(void**)(buffer->data + elementSize*index);
 	else
 		return buffer->data + elementSize*index;
@@ -1008,7 +1028,7 @@ void CScriptArray::DeleteBuffer(SArrayBuffer *buf)
 // internal
 void CScriptArray::Construct(SArrayBuffer *buf, asUINT start, asUINT end)
 {
-	if( (subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) )
+	if( (subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) && !elementsInline )
 	{
 		// Create an object using the default constructor/factory for each element
 		void **max = (void**)(buf->data + end * sizeof(void*));
@@ -1034,7 +1054,7 @@ void CScriptArray::Construct(SArrayBuffer *buf, asUINT start, asUINT end)
 	}
 	else
 	{
-		// Set all elements to zero whether they are handles or primitives
+		// Set all elements to zero whether they are handles, primitives, or script structs
 		void *d = (void*)(buf->data + start * elementSize);
 		memset(d, 0, (end-start)*elementSize);
 	}
@@ -1043,7 +1063,8 @@ void CScriptArray::Construct(SArrayBuffer *buf, asUINT start, asUINT end)
 // internal
 void CScriptArray::Destruct(SArrayBuffer *buf, asUINT start, asUINT end)
 {
-	if( subTypeId & asTYPEID_MASK_OBJECT )
+	// Script structs stored inline don't need to be destroyed
+	if( (subTypeId & asTYPEID_MASK_OBJECT) && !elementsInline )
 	{
 		asIScriptEngine *engine = objType->GetEngine();
 
@@ -1101,14 +1122,8 @@ void CScriptArray::Reverse()
 
 	if( size >= 2 )
 	{
-		asBYTE TEMP[16];
-
 		for( asUINT i = 0; i < size / 2; i++ )
-		{
-			Copy(TEMP, GetArrayItemPointer(i));
-			Copy(GetArrayItemPointer(i), GetArrayItemPointer(size - i - 1));
-			Copy(GetArrayItemPointer(size - i - 1), TEMP);
-		}
+			Swap(GetArrayItemPointer(i), GetArrayItemPointer(size - i - 1));
 	}
 }
 
@@ -1388,7 +1403,7 @@ int CScriptArray::Find(asUINT startAt, const void *value) const
 
 // internal
 // Copy object handle or primitive value
-// Even in arrays of objects the objects are allocated on
+// Except for script structs the objects are allocated on
 // the heap and the array stores the pointers to the objects
 void CScriptArray::Copy(void *dst, void *src)
 {
@@ -1398,14 +1413,19 @@ void CScriptArray::Copy(void *dst, void *src)
 
 // internal
 // Swap two elements
-// Even in arrays of objects the objects are allocated on 
-// the heap and the array stores the pointers to the objects.
+// Except for script structs the objects are allocated on the heap and the
+// array stores the pointers to the objects. The structs only hold plain
+// data, but may be larger than the temporary buffer so they are swapped in parts
 void CScriptArray::Swap(void* a, void* b)
 {
 	asBYTE tmp[16];
-	Copy(tmp, a);
-	Copy(a, b);
-	Copy(b, tmp);
+	for( int n = 0; n < elementSize; n += sizeof(tmp) )
+	{
+		int size = elementSize - n < (int)sizeof(tmp) ? elementSize - n : (int)sizeof(tmp);
+		memcpy(tmp, (asBYTE*)a + n, size);
+		memcpy((asBYTE*)a + n, (asBYTE*)b + n, size);
+		memcpy((asBYTE*)b + n, tmp, size);
+	}
 }
 
 
@@ -1420,7 +1440,7 @@ void *CScriptArray::GetArrayItemPointer(int index)
 // Return pointer to data in buffer (object or primitive)
 void *CScriptArray::GetDataPointer(void *buf)
 {
-	if ((subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) )
+	if ((subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) && !elementsInline )
 	{
 		// Real address of object
 		return reinterpret_cast<void*>(*(size_t*)buf);
@@ -1574,7 +1594,15 @@ void CScriptArray::Sort(asUINT startAt, asUINT count, bool asc)
 				return false;
 			}
 		} customLess = {asc, cmpContext, cache ? cache->cmpFunc : 0};
-		std::sort((void**)GetArrayItemPointer(start), (void**)GetArrayItemPointer(end), customLess);
+		if( elementsInline )
+		{
+			// Script structs are stored inline so the elements themselves must be moved
+			for( int i = start + 1; i < end; i++ )
+				for( int j = i; j > start && customLess(GetArrayItemPointer(j), GetArrayItemPointer(j - 1)); j-- )
+					Swap(GetArrayItemPointer(j), GetArrayItemPointer(j - 1));
+		}
+		else
+			std::sort((void**)GetArrayItemPointer(start), (void**)GetArrayItemPointer(end), customLess);
 
 		// Clean up
 		if( cmpContext )
@@ -1725,7 +1753,7 @@ void CScriptArray::CopyBuffer(SArrayBuffer *dst, SArrayBuffer *src)
 		if( dst->numElements > 0 && src->numElements > 0 )
 		{
 			int count = dst->numElements > src->numElements ? src->numElements : dst->numElements;
-			if( subTypeId & asTYPEID_MASK_OBJECT )
+			if( (subTypeId & asTYPEID_MASK_OBJECT) && !elementsInline )
 			{
 				// Call the assignment operator on all of the objects
 				void **max = (void**)(dst->data + count * sizeof(void*));
@@ -1767,7 +1795,7 @@ void CScriptArray::CopyBuffer(SArrayBuffer *dst, SArrayBuffer *src)
 			}
 			else
 			{
-				// Primitives are copied byte for byte
+				// Primitives and script structs are copied byte for byte
 				memcpy(dst->data, src->data, count*elementSize);
 			}
 		}
@@ -1780,6 +1808,10 @@ void CScriptArray::Precache()
 {
 	subTypeId = objType->GetSubTypeId();
 
+	// Script structs are plain data without references, so they can be stored directly in the buffer
+	elementsInline = (subTypeId & asTYPEID_MASK_OBJECT) && !(subTypeId & asTYPEID_OBJHANDLE) &&
+	                 (objType->GetSubType()->GetFlags() & asOBJ_SCRIPT_STRUCT);
+
 	// Check if it is an array of objects. Only for these do we need to cache anything
 	// Type ids for primitives and enums only has the sequence number part
 	if( !(subTypeId & ~asTYPEID_MASK_SEQNBR) )
@@ -1908,7 +1940,7 @@ void CScriptArray::EnumReferences(asIScriptEngine *engine)
 	//       protected so that it doesn't get lost during the iteration if the array is modified
 
 	// If the array is holding handles, then we need to notify the GC of them
-	if( subTypeId & asTYPEID_MASK_OBJECT )
+	if( (subTypeId & asTYPEID_MASK_OBJECT) && !elementsInline )
 	{
 		void **d = (void**)buffer->data;
 
@@ -112,6 +112,7 @@ protected:
 	SArrayBuffer   *buffer;
 	int             elementSize;
 	int             subTypeId;
+	bool            elementsInline;
 
 	// Constructors
 	CScriptArray(asITypeInfo *ot, void *initBuf); // Called from script when initialized with list
@@ -1,5 +1,6 @@
 #include "scriptbuilder.h"
 #include <vector>
+#include <sstream>
 #include <assert.h>
 #ifdef _WIN32
 #include <windows.h> // MultiByteToWideChar()
@@ -23,6 +24,45 @@ BEGIN_AS_NAMESPACE
 // Helper functions
 static string GetCurrentDir();
 static string GetAbsolutePath(const string &path);
+static FILE  *OpenFile(const string &filename, const char *mode);
+
+// Binary stream used for reading and writing the bytecode cache files
+class CByteCodeCacheStream : public asIBinaryStream
+{
+public:
+	CByteCodeCacheStream(FILE *file) : f(file) {}
+	int Write(const void *ptr, asUINT size)
+	{
+		if( size == 0 ) return 0;
+		return fwrite(ptr, size, 1, f) == 1 ? 0 : -1;
+	}
+	int Read(void *ptr, asUINT size)
+	{
+		if( size == 0 ) return 0;
+		return fread(ptr, size, 1, f) == 1 ? 0 : -1;
+	}
+
+protected:
+	FILE *f;
+};
+
+// 64bit FNV-1a hash used for the cache keys
+static asQWORD HashData(asQWORD hash, const void *data, size_t length)
+{
+	const asBYTE *bytes = (const asBYTE*)data;
+	for( size_t n = 0; n < length; n++ )
+	{
+		hash ^= bytes[n];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static asQWORD HashString(asQWORD hash, const string &str)
+{
+	// Include the terminating null so concatenated strings don't give the same hash
+	return HashData(hash, str.c_str(), str.length() + 1);
+}
 
 
 CScriptBuilder::CScriptBuilder()
@@ -35,6 +75,33 @@ CScriptBuilder::CScriptBuilder()
 
 	pragmaCallback = 0;
 	pragmaParam = 0;
+
+	loadedFromCache = false;
+
+	// Same as the default for new modules
+	accessMask = 1;
+}
+
+void CScriptBuilder::SetByteCodeCacheDir(const char *dir)
+{
+	byteCodeCacheDir = dir ? dir : "";
+}
+
+void CScriptBuilder::SetAccessMask(asDWORD mask)
+{
+	accessMask = mask;
+	if( module )
+		module->SetAccessMask(mask);
+}
+
+bool CScriptBuilder::WasLoadedFromCache() const
+{
+	return loadedFromCache;
+}
+
+string CScriptBuilder::GetByteCodeCacheFile() const
+{
+	return byteCodeCacheFile;
 }
 
 void CScriptBuilder::SetIncludeCallback(INCLUDECALLBACK_t callback, void *userParam)
@@ -158,6 +225,11 @@ void CScriptBuilder::ClearAll()
 	varMetadataMap.clear();
 	classMetadataMap.clear();
 #endif
+
+	pendingSections.clear();
+	byteCodeCacheFile = "";
+	loadedFromCache = false;
+	accessMask = 1;
 }
 
 bool CScriptBuilder::IncludeIfNotAlreadyIncluded(const char *filename)
@@ -179,23 +251,7 @@ int CScriptBuilder::LoadScriptSection(const char* filename)
 {
 	// Open the script file
 	string scriptFile = filename;
-#if _MSC_VER >= 1500 && !defined(__S3E__)
-  #ifdef _WIN32
-	// Convert the filename from UTF8 to UTF16
-	wchar_t bufUTF16_name[10000] = {0};
-	wchar_t bufUTF16_mode[10] = {0};
-	MultiByteToWideChar(CP_UTF8, 0, filename, -1, bufUTF16_name, 10000);
-	MultiByteToWideChar(CP_UTF8, 0, "rb", -1, bufUTF16_mode, 10);
-
-	FILE *f = 0;
-	_wfopen_s(&f, bufUTF16_name, bufUTF16_mode);
-  #else
-	FILE* f = 0;
-	fopen_s(&f, scriptFile.c_str(), "rb");
-  #endif
-#else
-	FILE *f = fopen(scriptFile.c_str(), "rb");
-#endif
+	FILE *f = OpenFile(scriptFile, "rb");
 	if( f == 0 )
 	{
 		// Write a message to the engine's message callback
@@ -565,7 +621,10 @@ int CScriptBuilder::ProcessScriptSection(const char *script, unsigned int length
 
 	// Build the actual script
 	engine->SetEngineProperty(asEP_COPY_SCRIPT_SECTIONS, true);
-	module->AddScriptSection(sectionname, modifiedScript.c_str(), modifiedScript.size(), lineOffset);
+	if( byteCodeCacheDir.empty() )
+		module->AddScriptSection(sectionname, modifiedScript.c_str(), modifiedScript.size(), lineOffset);
+	else
+		pendingSections.push_back(SSection(sectionname, modifiedScript, lineOffset));
 
 	if( includes.size() > 0 )
 	{
@@ -614,7 +673,7 @@ int CScriptBuilder::ProcessScriptSection(const char *script, unsigned int length
 
 int CScriptBuilder::Build()
 {
-	int r = module->Build();
+	int r = byteCodeCacheDir.empty() ? module->Build() : BuildWithCache();
 	if( r < 0 )
 		return r;
 
@@ -1067,7 +1126,7 @@ int CScriptBuilder::ExtractDeclaration(int pos, string &name, string &declaratio
 				}
 
 				// Skip trailing decorators
-				if( !hasParenthesis || nestedParenthesis > 0 || t != asTC_IDENTIFIER || (token != "final" && token != "override" && token != "delete" && token != "property"))
+				if( !hasParenthesis || nestedParenthesis > 0 || t != asTC_IDENTIFIER || (token != "final" && token != "override" && token != "delete" && token != "property" && token != "constexpr" && token != "inline" && token != "noinline"))
 					declaration += token;
 
 				pos += len;
@@ -1174,6 +1233,188 @@ string GetAbsolutePath(const string &file)
 	return str;
 }
 
+int CScriptBuilder::BuildWithCache()
+{
+	// The cache key is formed from the engine configuration and the pre-processed
+	// script sections, so any change in either will give a different cache file
+	asQWORD hash = 0xCBF29CE484222325ULL;
+	hash = HashString(hash, GetEngineFingerprint());
+
+	// The module's access mask decides which of the registered entities the script can
+	// see. The default namespace is included too so a cache entry is never shared by
+	// modules configured differently
+	hash = HashData(hash, &accessMask, sizeof(asDWORD));
+	hash = HashString(hash, module->GetDefaultNamespace());
+
+	for( size_t n = 0; n < pendingSections.size(); n++ )
+	{
+		hash = HashString(hash, pendingSections[n].name);
+		hash = HashData(hash, &pendingSections[n].lineOffset, sizeof(int));
+		hash = HashString(hash, pendingSections[n].code);
+	}
+
+	char key[17];
+	for( int n = 0; n < 16; n++ )
+		key[n] = "0123456789abcdef"[(hash >> (60 - n*4)) & 0xF];
+	key[16] = 0;
+
+	byteCodeCacheFile = byteCodeCacheDir;
+	char last = byteCodeCacheFile[byteCodeCacheFile.length()-1];
+	if( last != '/' && last != '\\' )
+		byteCodeCacheFile += "/";
+	byteCodeCacheFile += string(key) + ".asbc";
+
+	FILE *f = OpenFile(byteCodeCacheFile, "rb");
+	if( f )
+	{
+		// A stale or damaged cache file is not an error, the script is just compiled
+		// again, so don't let the engine report the failed load to the application
+		asSFuncPtr msgCallback;
+		void      *msgObj = 0;
+		asDWORD    msgCallConv = 0;
+		bool hasCallback = engine->GetMessageCallback(&msgCallback, &msgObj, &msgCallConv) >= 0;
+		engine->ClearMessageCallback();
+
+		CByteCodeCacheStream stream(f);
+		int r = module->LoadByteCode(&stream);
+		fclose(f);
+
+		if( hasCallback )
+			engine->SetMessageCallback(msgCallback, msgObj, msgCallConv);
+
+		if( r >= 0 )
+		{
+			loadedFromCache = true;
+			return r;
+		}
+	}
+
+	for( size_t n = 0; n < pendingSections.size(); n++ )
+	{
+		const SSection &section = pendingSections[n];
+		module->AddScriptSection(section.name.c_str(), section.code.c_str(), section.code.size(), section.lineOffset);
+	}
+
+	int r = module->Build();
+	if( r < 0 )
+		return r;
+
+	// Write to a temporary file first so an interrupted save doesn't leave a partial cache file
+	string tmpFile = byteCodeCacheFile + ".tmp";
+	f = OpenFile(tmpFile, "wb");
+	if( f )
+	{
+		CByteCodeCacheStream stream(f);
+		bool ok = module->SaveByteCode(&stream) >= 0;
+		ok = (fclose(f) == 0) && ok;
+		if( ok )
+		{
+			remove(byteCodeCacheFile.c_str());
+			ok = rename(tmpFile.c_str(), byteCodeCacheFile.c_str()) == 0;
+		}
+		if( !ok )
+			remove(tmpFile.c_str());
+	}
+
+	// Failing to update the cache doesn't affect the build
+	return r;
+}
+
+string CScriptBuilder::GetEngineFingerprint() const
+{
+	// Collect everything that the saved bytecode depends on, including the access
+	// masks that decide what each module can see. The addresses of registered
+	// properties and functions are not included since they are resolved again
+	// when the bytecode is loaded
+	stringstream strm;
+	strm << ANGELSCRIPT_VERSION_STRING << " " << sizeof(void*) << "\n";
+
+	for( int n = 1; n < asEP_LAST_PROPERTY; n++ )
+		strm << "ep " << n << " " << (asQWORD)engine->GetEngineProperty(asEEngineProp(n)) << "\n";
+
+	asDWORD flags = 0;
+	int typeId = engine->GetStringFactory(&flags);
+	strm << "strfactory " << flags << " " << (typeId > 0 ? engine->GetTypeDeclaration(typeId, true) : "") << "\n";
+	typeId = engine->GetDefaultArrayTypeId();
+	strm << "defarray " << (typeId > 0 ? engine->GetTypeDeclaration(typeId, true) : "") << "\n";
+
+	asUINT n, m;
+	for( n = 0; n < engine->GetEnumCount(); n++ )
+	{
+		asITypeInfo *type = engine->GetEnumByIndex(n);
+		strm << "enum " << type->GetNamespace() << "::" << type->GetName() << " " << type->GetAccessMask() << "\n";
+		for( m = 0; m < type->GetEnumValueCount(); m++ )
+		{
+			int value = 0;
+			const char *name = type->GetEnumValueByIndex(m, &value);
+			strm << " " << name << " " << value << "\n";
+		}
+	}
+
+	for( n = 0; n < engine->GetObjectTypeCount(); n++ )
+	{
+		asITypeInfo *type = engine->GetObjectTypeByIndex(n);
+		strm << "type " << type->GetNamespace() << "::" << type->GetName() << " " << type->GetFlags() << " " << type->GetSize() << " " << type->GetAccessMask() << "\n";
+		for( m = 0; m < type->GetFactoryCount(); m++ )
+			strm << " " << type->GetFactoryByIndex(m)->GetDeclaration(true, true, true) << " " << type->GetFactoryByIndex(m)->GetAccessMask() << "\n";
+		for( m = 0; m < type->GetBehaviourCount(); m++ )
+		{
+			asEBehaviours beh;
+			asIScriptFunction *func = type->GetBehaviourByIndex(m, &beh);
+			strm << " beh " << beh << " " << func->GetDeclaration(true, true, true) << " " << func->GetAccessMask() << "\n";
+		}
+		for( m = 0; m < type->GetMethodCount(); m++ )
+			strm << " " << type->GetMethodByIndex(m)->GetDeclaration(true, true, true) << " " << type->GetMethodByIndex(m)->GetAccessMask() << "\n";
+		for( m = 0; m < type->GetPropertyCount(); m++ )
+			strm << " " << type->GetPropertyDeclaration(m, true) << "\n";
+	}
+
+	for( n = 0; n < engine->GetFuncdefCount(); n++ )
+		strm << "funcdef " << engine->GetFuncdefByIndex(n)->GetFuncdefSignature()->GetDeclaration(true, true, true) << " " << engine->GetFuncdefByIndex(n)->GetAccessMask() << "\n";
+
+	for( n = 0; n < engine->GetTypedefCount(); n++ )
+	{
+		asITypeInfo *type = engine->GetTypedefByIndex(n);
+		strm << "typedef " << type->GetNamespace() << "::" << type->GetName() << " " << engine->GetTypeDeclaration(type->GetTypedefTypeId(), true) << " " << type->GetAccessMask() << "\n";
+	}
+
+	for( n = 0; n < engine->GetGlobalPropertyCount(); n++ )
+	{
+		const char *name, *nameSpace;
+		bool isConst;
+		asDWORD accessMask;
+		engine->GetGlobalPropertyByIndex(n, &name, &nameSpace, &typeId, &isConst, 0, 0, &accessMask);
+		strm << "prop " << (isConst ? "const " : "") << engine->GetTypeDeclaration(typeId, true) << " " << nameSpace << "::" << name << " " << accessMask << "\n";
+	}
+
+	for( n = 0; n < engine->GetGlobalFunctionCount(); n++ )
+		strm << "func " << engine->GetGlobalFunctionByIndex(n)->GetDeclaration(true, true, true) << " " << engine->GetGlobalFunctionByIndex(n)->GetAccessMask() << "\n";
+
+	return strm.str();
+}
+
+FILE *OpenFile(const string &filename, const char *mode)
+{
+#if _MSC_VER >= 1500 && !defined(__S3E__)
+  #ifdef _WIN32
+	// Convert the filename from UTF8 to UTF16
+	wchar_t bufUTF16_name[10000] = {0};
+	wchar_t bufUTF16_mode[10] = {0};
+	MultiByteToWideChar(CP_UTF8, 0, filename.c_str(), -1, bufUTF16_name, 10000);
+	MultiByteToWideChar(CP_UTF8, 0, mode, -1, bufUTF16_mode, 10);
+
+	FILE *f = 0;
+	_wfopen_s(&f, bufUTF16_name, bufUTF16_mode);
+  #else
+	FILE* f = 0;
+	fopen_s(&f, filename.c_str(), mode);
+  #endif
+#else
+	FILE *f = fopen(filename.c_str(), mode);
+#endif
+	return f;
+}
+
 string GetCurrentDir()
 {
 	char buffer[1024];
@@ -95,6 +95,24 @@ public:
 	// Add a pre-processor define for conditional compilation
 	void DefineWord(const char *word);
 
+	// Enable a cache of the compiled bytecode in the given directory. When set the
+	// BuildModule will look for bytecode compiled from the same pre-processed script
+	// sections with the same engine configuration and load that instead of compiling.
+	// On a miss the compiled bytecode is saved to the cache for the next time.
+	// Must be set before adding the script sections. Pass an empty string to disable.
+	void        SetByteCodeCacheDir(const char *dir);
+
+	// Set the access mask of the current module. When the bytecode cache is used
+	// the mask must be set through the builder, rather than directly on the module,
+	// so it becomes part of the cache key. Must be called after StartNewModule.
+	void        SetAccessMask(asDWORD mask);
+
+	// Returns true if the last BuildModule loaded the module from the cache
+	bool        WasLoadedFromCache() const;
+
+	// Returns the name of the cache file used by the last BuildModule
+	std::string GetByteCodeCacheFile() const;
+
 	// Enumerate included script sections
 	unsigned int GetSectionCount() const;
 	std::string  GetSectionName(unsigned int idx) const;
@@ -128,6 +146,9 @@ protected:
 	int  ExcludeCode(int start);
 	void OverwriteCode(int start, int len);
 
+	int         BuildWithCache();
+	std::string GetEngineFingerprint() const;
+
 	asIScriptEngine           *engine;
 	asIScriptModule           *module;
 	std::string                modifiedScript;
@@ -138,6 +159,20 @@ protected:
 	PRAGMACALLBACK_t  pragmaCallback;
 	void             *pragmaParam;
 
+	// The pre-processed sections are held back until the build when the cache is used
+	struct SSection
+	{
+		SSection(const std::string &n, const std::string &c, int l) : name(n), code(c), lineOffset(l) {}
+		std::string name;
+		std::string code;
+		int         lineOffset;
+	};
+	std::vector<SSection> pendingSections;
+	std::string           byteCodeCacheDir;
+	std::string           byteCodeCacheFile;
+	asDWORD               accessMask;
+	bool                  loadedFromCache;
+
 #if AS_PROCESS_METADATA == 1
 	int  ExtractMetadata(int pos, std::vector<std::string> &outMetadata);
 	int  ExtractDeclaration(int pos, std::string &outName, std::string &outDeclaration, int &outType);
@@ -191,6 +191,9 @@ enum asEEngineProp
 	asEP_MEMBER_INIT_MODE                   = 38,
 	asEP_BOOL_CONVERSION_MODE               = 39,
 	asEP_FOREACH_SUPPORT                    = 40,
+	asEP_DEFER_FUNCTION_COMPILATION         = 41,
+	asEP_BYTECODE_FORMAT                    = 42,
+	asEP_SKIP_DEBUG_INFO_ON_LOAD            = 43,
 
 	asEP_LAST_PROPERTY
 };
@@ -261,7 +264,8 @@ enum asEObjTypeFlags : asQWORD
 	asOBJ_TEMPLATE_SUBTYPE            = (1<<27),
 	asOBJ_TYPEDEF                     = (1<<28),
 	asOBJ_ABSTRACT                    = (1<<29),
-	asOBJ_APP_ALIGN16                 = (1<<30)
+	asOBJ_APP_ALIGN16                 = (1<<30),
+	asOBJ_SCRIPT_STRUCT               = (asQWORD(1)<<33)
 };
 
 // Behaviours
@@ -532,6 +536,24 @@ struct asSMessageInfo
 	const char *message;
 };
 
+struct asSBuildStatistics
+{
+	double parseTime;
+	double typeCompileTime;
+	double globalVarCompileTime;
+	double functionCompileTime;
+	double finalizeTime;
+	double loadTime;
+	double totalTime;
+	asUINT numFunctionsCompiled;
+	asUINT numFunctions;
+	asUINT numTypes;
+	asUINT totalByteCodeSize;
+	asUINT largestByteCodeSize;
+	asUINT numScriptNodeAllocs;
+	asUINT numByteInstructionAllocs;
+};
+
 
 // API functions
 
@@ -837,6 +859,9 @@ public:
 	// Compilation
 	virtual int         AddScriptSection(const char *name, const char *code, size_t codeLength = 0, int lineOffset = 0) = 0;
 	virtual int         Build() = 0;
+	virtual int         BuildIncremental() = 0;
+	virtual int         CompileAll() = 0;
+	virtual int         GetBuildStatistics(asSBuildStatistics *stats) const = 0;
 	virtual int         CompileFunction(const char *sectionName, const char *code, int lineOffset, asDWORD compileFlags, asIScriptFunction **outFunc) = 0;
 	virtual int         CompileGlobalVar(const char *sectionName, const char *code, int lineOffset) = 0;
 	virtual asDWORD     SetAccessMask(asDWORD accessMask) = 0;
@@ -888,6 +913,7 @@ public:
 	// Byte code saving and loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped = 0) = 0;
+	virtual int LoadByteCode(const void *data, size_t size, bool *wasDebugInfoStripped = 0) = 0;
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type = 0) = 0;
@@ -1652,7 +1678,17 @@ enum asEBCInstr
 	asBC_POWi64			= 198,
 	asBC_POWu64			= 199,
 	asBC_Thiscall1		= 200,
-	asBC_MAXBYTECODE	= 201,
+	asBC_StrHash		= 201,
+	asBC_ADDIi64		= 202,
+	asBC_SUBIi64		= 203,
+	asBC_MULIi64		= 204,
+	asBC_CMPIi64		= 205,
+	asBC_CMPIu64		= 206,
+	asBC_ADDId			= 207,
+	asBC_SUBId			= 208,
+	asBC_MULId			= 209,
+	asBC_CMPId			= 210,
+	asBC_MAXBYTECODE	= 211,
 
 	// Temporary tokens. Can't be output to the final program
 	asBC_TryBlock		= 250,
@@ -1686,11 +1722,12 @@ enum asEBCType
 	asBCTYPE_rW_QW_ARG    = 17,
 	asBCTYPE_W_DW_ARG     = 18,
 	asBCTYPE_rW_W_DW_ARG  = 19,
-	asBCTYPE_rW_DW_DW_ARG = 20
+	asBCTYPE_rW_DW_DW_ARG = 20,
+	asBCTYPE_wW_rW_QW_ARG = 21
 };
 
 // Instruction type sizes
-const int asBCTypeSize[21] =
+const int asBCTypeSize[22] =
 {
 	0, // asBCTYPE_INFO
 	1, // asBCTYPE_NO_ARG
@@ -1712,7 +1749,8 @@ const int asBCTypeSize[21] =
 	3, // asBCTYPE_rW_QW_ARG
 	2, // asBCTYPE_W_DW_ARG
 	3, // asBCTYPE_rW_W_DW_ARG
-	3  // asBCTYPE_rW_DW_DW_ARG
+	3, // asBCTYPE_rW_DW_DW_ARG
+	4  // asBCTYPE_wW_rW_QW_ARG
 };
 
 // Instruction info
@@ -1948,17 +1986,17 @@ const asSBCInfo asBCInfo[256] =
 	asBCINFO(POWi64,	wW_rW_rW_ARG,	0),
 	asBCINFO(POWu64,	wW_rW_rW_ARG,	0),
 	asBCINFO(Thiscall1, DW_ARG,			-AS_PTR_SIZE-1),
+	asBCINFO(StrHash,	wW_ARG,			-AS_PTR_SIZE),
+	asBCINFO(ADDIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(SUBIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(MULIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(CMPIi64,	rW_QW_ARG,		0),
+	asBCINFO(CMPIu64,	rW_QW_ARG,		0),
+	asBCINFO(ADDId,		wW_rW_QW_ARG,	0),
+	asBCINFO(SUBId,		wW_rW_QW_ARG,	0),
+	asBCINFO(MULId,		wW_rW_QW_ARG,	0),
+	asBCINFO(CMPId,		rW_QW_ARG,		0),
 
-	asBCINFO_DUMMY(201),
-	asBCINFO_DUMMY(202),
-	asBCINFO_DUMMY(203),
-	asBCINFO_DUMMY(204),
-	asBCINFO_DUMMY(205),
-	asBCINFO_DUMMY(206),
-	asBCINFO_DUMMY(207),
-	asBCINFO_DUMMY(208),
-	asBCINFO_DUMMY(209),
-	asBCINFO_DUMMY(210),
 	asBCINFO_DUMMY(211),
 	asBCINFO_DUMMY(212),
 	asBCINFO_DUMMY(213),
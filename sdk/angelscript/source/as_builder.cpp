@@ -46,6 +46,7 @@
 #include "as_texts.h"
 #include "as_scriptobject.h"
 #include "as_debug.h"
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -80,7 +81,7 @@ private:
 
 #endif
 
-asCBuilder::asCBuilder(asCScriptEngine *_engine, asCModule *_module)
+asCBuilder::asCBuilder(asCScriptEngine *_engine, asCModule *_module) : nodeArena(_engine)
 {
 	this->engine = _engine;
 	this->module = _module;
@@ -142,6 +143,18 @@ asCBuilder::~asCBuilder()
 		}
 	}
 
+	for( n = 0; n < structDeclarations.GetLength(); n++ )
+	{
+		if( structDeclarations[n] )
+		{
+			if( structDeclarations[n]->node )
+				structDeclarations[n]->node->Destroy(engine);
+
+			asDELETE(structDeclarations[n],sClassDeclaration);
+			structDeclarations[n] = 0;
+		}
+	}
+
 	for( n = 0; n < interfaceDeclarations.GetLength(); n++ )
 	{
 		if( interfaceDeclarations[n] )
@@ -203,6 +216,7 @@ void asCBuilder::Reset()
 	// Clear the cache of known types
 	hasCachedKnownTypes = false;
 	knownTypes.EraseAll();
+	isCompilingGlobalVars = false;
 #endif
 }
 
@@ -251,10 +265,11 @@ asCScriptCode *asCBuilder::FindOrAddCode(const char *name, const char *code, siz
 
 void asCBuilder::EvaluateTemplateInstances(asUINT startIdx, bool keepSilent)
 {
-	// Backup the original message stream
-	bool                       msgCallback     = engine->msgCallback;
-	asSSystemFunctionInterface msgCallbackFunc = engine->msgCallbackFunc;
-	void                      *msgCallbackObj  = engine->msgCallbackObj;
+	// Backup the original message stream as the application registered it
+	asSFuncPtr msgCallbackPtr(0);
+	void      *msgCallbackObj = 0;
+	asDWORD    msgCallConv    = 0;
+	bool       msgCallback    = engine->GetMessageCallback(&msgCallbackPtr, &msgCallbackObj, &msgCallConv) >= 0;
 
 	// Set the new temporary message stream
 	asCOutputBuffer outBuffer;
@@ -290,11 +305,17 @@ void asCBuilder::EvaluateTemplateInstances(asUINT startIdx, bool keepSilent)
 
 	// Restore message callback
 	if( keepSilent )
-	{
-		engine->msgCallback     = msgCallback;
-		engine->msgCallbackFunc = msgCallbackFunc;
-		engine->msgCallbackObj  = msgCallbackObj;
-	}
+		RestoreMessageCallback(msgCallback, msgCallbackPtr, msgCallbackObj, msgCallConv);
+}
+
+void asCBuilder::RestoreMessageCallback(bool hadCallback, const asSFuncPtr &callback, void *obj, asDWORD callConv)
+{
+	// Go through the public interface so the engine reports the same callback
+	// that the application registered, rather than the temporary output buffer
+	if( hadCallback )
+		engine->SetMessageCallback(callback, obj, callConv);
+	else
+		engine->ClearMessageCallback();
 }
 
 int asCBuilder::Build()
@@ -310,27 +331,40 @@ int asCBuilder::Build()
 	engine->deferValidationOfTemplateTypes = true;
 	asUINT numTempl = (asUINT)engine->templateInstanceTypes.GetLength();
 
+	asSBuildStatistics &stats = module->m_buildStats;
+	double time = asGetSystemTime();
+
 	ParseScripts();
+	stats.parseTime = asGetSystemTime() - time;
 	if (numErrors > 0)
 		return asERROR;
 
 	// Compile the types first
+	time = asGetSystemTime();
 	CompileInterfaces();
+	CompileStructs();
 	CompileClasses(numTempl);
 
 	// Evaluate the template instances one last time, this time with error messages, as we know
 	// all classes have been fully built and it is known which ones will need garbage collection.
 	EvaluateTemplateInstances(numTempl, false);
 	engine->deferValidationOfTemplateTypes = false;
+	stats.typeCompileTime = asGetSystemTime() - time;
 	if (numErrors > 0)
 		return asERROR;
 
 	// Then the global variables. Here the variables declared with auto
 	// will be resolved, so they can be accessed properly in the functions
+	time = asGetSystemTime();
 	CompileGlobalVariables();
+	stats.globalVarCompileTime = asGetSystemTime() - time;
 
-	// Finally the global functions and class methods
-	CompileFunctions();
+	// Finally the global functions and class methods. The constexpr functions
+	// are compiled first so the other functions can evaluate the calls to them
+	time = asGetSystemTime();
+	CompileFunctions(true);
+	CompileFunctions(false);
+	stats.functionCompileTime = asGetSystemTime() - time;
 
 	// TODO: Attempt to reorder the initialization of global variables so that
 	//       they do not access other uninitialized global variables out-of-order
@@ -350,9 +384,204 @@ int asCBuilder::Build()
 		return asERROR;
 	}
 
+	// Keep the information needed to later rebuild only the modified functions
+	StoreSectionInfos();
+
+	return StoreDeferredFunctions();
+}
+
+// Restores the information from the full build that the compiler needs to compile function bodies at a later time
+int asCBuilder::RestoreBuildState()
+{
+	// The namespace visibility determined in the full build is needed to resolve symbols in the functions
+	namespaceVisibility = module->m_namespaceVisibility;
+
+	// Tell the compiler about the global constants so they are substituted with their values as in the full build
+	asSMapNode<asCGlobalProperty*, asQWORD> *cursor = 0;
+	module->m_pureConstants.MoveFirst(&cursor);
+	while( cursor )
+	{
+		asCGlobalProperty *prop = module->m_pureConstants.GetKey(cursor);
+
+		sGlobalVariableDescription *gvar = asNEW(sGlobalVariableDescription);
+		if( gvar == 0 )
+			return asOUT_OF_MEMORY;
+
+		gvar->script             = 0;
+		gvar->declaredAtNode     = 0;
+		gvar->initializationNode = 0;
+		gvar->name               = prop->name;
+		gvar->property           = prop;
+		gvar->datatype           = prop->type;
+		gvar->ns                 = prop->nameSpace;
+		gvar->index              = prop->id;
+		gvar->isCompiled         = true;
+		gvar->isPureConstant     = true;
+		gvar->isEnumValue        = false;
+		gvar->constantValue      = module->m_pureConstants.GetValue(cursor);
+		globVariables.Put(gvar);
+
+		module->m_pureConstants.MoveNext(&cursor, cursor);
+	}
+
+	return asSUCCESS;
+}
+
+int asCBuilder::BuildIncremental()
+{
+	Reset();
+
+	int r = RestoreBuildState();
+	if( r < 0 )
+		return r;
+
+	// Determine which function bodies have been modified in the script sections
+	asCArray<asCScriptFunction*> funcs;
+	asCArray<asCScriptCode*>     funcScripts;
+	asCArray<sBodyRange>         funcBodies;
+	asCArray<int>                rowOffsets;
+	asCArray<sFunctionBodyInfo*> modifiedBodies;
+	asCArray<asQWORD>            newHashes;
+	asCArray<int>                newRows;
+	asUINT n;
+	for( n = 0; n < scripts.GetLength(); n++ )
+	{
+		asCScriptCode *script = scripts[n];
+
+		// Find the information stored for the section in the last build. The name must be unique
+		sScriptSectionInfo *info = 0;
+		bool isUnique = true;
+		for( asUINT i = 0; i < module->m_sectionInfos.GetLength(); i++ )
+		{
+			if( module->m_sectionInfos[i]->name == script->name )
+			{
+				if( info ) isUnique = false;
+				info = module->m_sectionInfos[i];
+			}
+		}
+
+		if( info == 0 || !isUnique )
+		{
+			WriteInfo(script->name, TXT_SECTION_NOT_IN_PREVIOUS_BUILD, 0, 0, false);
+			return asNOT_SUPPORTED;
+		}
+
+		// Locate the function bodies and make sure nothing else has changed
+		asCArray<sBodyRange> bodies;
+		bodies.SetLength(info->bodies.GetLength());
+		for( asUINT b = 0; b < bodies.GetLength(); b++ )
+		{
+			bodies[b].pos      = 0;
+			bodies[b].length   = 0;
+			bodies[b].tokenIdx = info->bodies[b].tokenIdx;
+		}
+
+		asQWORD declarationHash;
+		if( !HashDeclarations(script, bodies, true, declarationHash) || declarationHash != info->declarationHash )
+		{
+			WriteInfo(script->name, TXT_SECTION_DECLARATIONS_CHANGED, 0, 0, false);
+			return asNOT_SUPPORTED;
+		}
+
+		for( asUINT b = 0; b < bodies.GetLength(); b++ )
+		{
+			sFunctionBodyInfo *body = &info->bodies[b];
+
+			int row;
+			script->ConvertPosToRowCol(bodies[b].pos, &row, 0);
+			asQWORD hash = asStringHash(&script->code[bodies[b].pos], bodies[b].length);
+			if( hash == body->hash && row == body->row )
+				continue;
+
+			for( asUINT f = 0; f < body->funcIds.GetLength(); f++ )
+			{
+				// Shared functions may be in use by other modules, constructors need the
+				// member initializations from the class declaration, and the calls to constexpr
+				// functions and inlined functions may have been replaced in the callers,
+				// so they cannot be recompiled without a full build
+				asCScriptFunction *func = engine->scriptFunctions[body->funcIds[f]];
+				if( func == 0 || func->module != module || func->scriptData == 0 || func->IsShared() || func->IsConstExpr() ||
+					module->m_inlinedFunctions.IndexOf(func->id) >= 0 ||
+					(func->objectType && func->name == func->objectType->name) )
+				{
+					int r, c;
+					script->ConvertPosToRowCol(bodies[b].pos, &r, &c);
+					asCString str;
+					str.Format(TXT_FUNCTION_s_REQUIRES_FULL_BUILD, func ? func->GetDeclaration() : "");
+					WriteInfo(script->name, str, r, c, false);
+					return asNOT_SUPPORTED;
+				}
+
+				funcs.PushLast(func);
+				funcScripts.PushLast(script);
+				funcBodies.PushLast(bodies[b]);
+				rowOffsets.PushLast(row - body->row);
+			}
+
+			modifiedBodies.PushLast(body);
+			newHashes.PushLast(hash);
+			newRows.PushLast(row);
+		}
+	}
+
+	if( funcs.GetLength() == 0 )
+		return asSUCCESS;
+
+	double time = asGetSystemTime();
+	r = RecompileFunctionBodies(funcs, funcScripts, funcBodies, rowOffsets);
+	module->m_buildStats.functionCompileTime += asGetSystemTime() - time;
+	if( r < 0 )
+		return r;
+
+	// Remember the new bodies for the next incremental build
+	for( n = 0; n < modifiedBodies.GetLength(); n++ )
+	{
+		modifiedBodies[n]->hash = newHashes[n];
+		modifiedBodies[n]->row  = newRows[n];
+	}
+
 	return asSUCCESS;
 }
 
+int asCBuilder::CompileDeferredFunctions(asCArray<asCScriptFunction*> &funcs)
+{
+	Reset();
+
+	// Look up where the bodies of the functions are. Functions that are no longer in
+	// the list have already been compiled since the caller checked it
+	asCArray<asCScriptFunction*> pending;
+	asCArray<asCScriptCode*>     funcScripts;
+	asCArray<sBodyRange>         funcBodies;
+	asCArray<int>                rowOffsets;
+	for( asUINT n = 0; n < funcs.GetLength(); n++ )
+	{
+		asSMapNode<int, sDeferredFunction> *cursor = 0;
+		if( !module->m_deferredFunctions.MoveTo(&cursor, funcs[n]->id) )
+			continue;
+
+		const sDeferredFunction &deferred = module->m_deferredFunctions.GetValue(cursor);
+		sBodyRange body = {deferred.pos, deferred.length, 0};
+		pending.PushLast(funcs[n]);
+		funcScripts.PushLast(deferred.script);
+		funcBodies.PushLast(body);
+		rowOffsets.PushLast(0);
+	}
+
+	if( pending.GetLength() == 0 )
+		return asSUCCESS;
+
+	int r = RestoreBuildState();
+	if( r < 0 )
+		return r;
+
+	// Deferred compilations are added to the statistics of the last build
+	double time = asGetSystemTime();
+	r = RecompileFunctionBodies(pending, funcScripts, funcBodies, rowOffsets);
+	module->m_buildStats.functionCompileTime += asGetSystemTime() - time;
+
+	return r;
+}
+
 int asCBuilder::CompileGlobalVar(const char *sectionName, const char *code, int lineOffset)
 {
 	Reset();
@@ -414,6 +643,7 @@ int asCBuilder::CompileGlobalVar(const char *sectionName, const char *code, int
 			{
 				module->m_globalFunctions.Erase(module->m_globalFunctions.GetIndex(func));
 				module->m_scriptFunctions.RemoveValue(func);
+				engine->RemoveEntityOwner(func, module);
 				func->ReleaseInternal();
 			}
 		}
@@ -626,6 +856,7 @@ int asCBuilder::CompileFunction(const char *sectionName, const char *code, int l
 			{
 				module->m_globalFunctions.Erase(module->m_globalFunctions.GetIndex(f));
 				module->m_scriptFunctions.RemoveValue(f);
+				engine->RemoveEntityOwner(f, module);
 				f->ReleaseInternal();
 			}
 		}
@@ -725,6 +956,36 @@ void asCBuilder::ParseScripts()
 			}
 		}
 
+		// Register script methods found in the structs. Structs have no default
+		// behaviours, as they are created and copied without calling any functions
+		for( n = 0; n < structDeclarations.GetLength(); n++ )
+		{
+			sClassDeclaration *decl = structDeclarations[n];
+
+			asCScriptNode *node = decl->node->firstChild->next;
+
+			// Skip the inheritance list, it has already been reported as an error
+			while( node && node->nodeType == snIdentifier )
+				node = node->next;
+
+			while( node )
+			{
+				asCScriptNode *next = node->next;
+				if( node->nodeType == snFunction )
+				{
+					node->DisconnectParent();
+					RegisterScriptFunctionFromNode(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, false, false, decl);
+				}
+				else if( node->nodeType == snVirtualProperty )
+				{
+					node->DisconnectParent();
+					RegisterVirtualProperty(node, decl->script, CastToObjectType(decl->typeInfo), false, false, 0, false);
+				}
+
+				node = next;
+			}
+		}
+
 		// Register script methods found in the classes
 		for( n = 0; n < classDeclarations.GetLength(); n++ )
 		{
@@ -847,7 +1108,12 @@ void asCBuilder::RegisterTypesFromScript(asCScriptNode *node, asCScriptCode *scr
 			if( node->nodeType == snClass )
 			{
 				node->DisconnectParent();
-				RegisterClass(node, script, ns);
+
+				// Structs are declared with the contextual keyword 'struct' instead of 'class'
+				if( node->tokenType == ttIdentifier )
+					RegisterStruct(node, script, ns);
+				else
+					RegisterClass(node, script, ns);
 			}
 			else if( node->nodeType == snInterface )
 			{
@@ -999,96 +1265,505 @@ void asCBuilder::RegisterNonTypesFromScript(asCScriptNode *node, asCScriptCode *
 	}
 }
 
-void asCBuilder::CompileFunctions()
+// Returns true if the function may be inlined in the callers, in which case it should be compiled
+// before them. The size of the bytecode isn't known yet, so the length of the body is used instead
+bool asCBuilder::IsInlineCandidate(sFunctionDescription *desc)
 {
-	// Compile each function
-	for( asUINT n = 0; n < functions.GetLength(); n++ )
-	{
-		sFunctionDescription *current = functions[n];
-		if( current == 0 ) continue;
+	if( desc == 0 || desc->node == 0 || engine->ep.optimizeByteCode == 0 )
+		return false;
 
-		// Don't compile the function again if it was an existing shared function
-		if( current->isExistingShared ) continue;
+	asCScriptFunction *func = engine->scriptFunctions[desc->funcId];
+	if( func == 0 || func->IsNoInline() )
+		return false;
 
-		// Don't compile if there is no statement block
-		if (current->node && !(current->node->nodeType == snStatementBlock || current->node->lastChild->nodeType == snStatementBlock))
-			continue;
+	asCScriptNode *block = desc->node->nodeType == snStatementBlock ? desc->node : desc->node->lastChild;
+	if( block == 0 || block->nodeType != snStatementBlock )
+		return false;
 
-		asCCompiler compiler(engine);
-		asCScriptFunction *func = engine->scriptFunctions[current->funcId];
+	// Functions that call other functions cannot be inlined, and must instead be compiled
+	// after the functions they call, in case those are inlined. The statement block isn't
+	// parsed until the function is compiled, so look for an identifier followed by '('
+	eTokenType prev = ttUnrecognizedToken;
+	size_t pos = block->tokenPos;
+	size_t end = block->tokenPos + block->tokenLength;
+	while( pos < end )
+	{
+		size_t len = 0;
+		eTokenType t = engine->tok.GetToken(&desc->script->code[pos], end - pos, &len);
+		if( t != ttWhiteSpace && t != ttOnelineComment && t != ttMultilineComment )
+		{
+			if( t == ttOpenParenthesis && prev == ttIdentifier )
+				return false;
+			prev = t;
+		}
+		pos += len;
+	}
+
+	return func->IsInline() || (engine->ep.optimizeByteCode >= 2 && block->tokenLength <= 160);
+}
 
-		// Find the class declaration for constructors
-		sClassDeclaration *classDecl = 0;
-		if( current->objType && current->name == current->objType->name )
+void asCBuilder::CompileFunctions(bool constExpr)
+{
+	// Compile each function. The functions that may be inlined are compiled in the first
+	// pass, so their bytecode is available when the callers are compiled in the second pass.
+	// The functions added while compiling, e.g. anonymous functions, are compiled in the pass
+	// that finds them
+	asUINT numFirstPass = 0;
+	for( asUINT pass = 0; pass < 2; pass++ )
+	{
+		for( asUINT n = 0; n < functions.GetLength(); n++ )
 		{
-			for( asUINT c = 0; c < classDeclarations.GetLength(); c++ )
+			sFunctionDescription *current = functions[n];
+			if( current == 0 ) continue;
+			if( pass == 0 ? !IsInlineCandidate(current) : (n < numFirstPass && IsInlineCandidate(current)) ) continue;
+
+			// Don't compile the function again if it was an existing shared function
+			if( current->isExistingShared ) continue;
+
+			// Don't compile if there is no statement block
+			if (current->node && !(current->node->nodeType == snStatementBlock || current->node->lastChild->nodeType == snStatementBlock))
+				continue;
+
+			asCCompiler compiler(engine);
+			asCScriptFunction *func = engine->scriptFunctions[current->funcId];
+
+			// The constexpr functions are compiled separately, and may
+			// already have been compiled together with the global variables
+			if( func->IsConstExpr() != constExpr || (constExpr && func->scriptData->byteCode.GetLength()) )
+				continue;
+
+			// Find the class declaration for constructors
+			sClassDeclaration *classDecl = 0;
+			if( current->objType && current->name == current->objType->name )
 			{
-				if( classDeclarations[c]->typeInfo == current->objType )
+				for( asUINT c = 0; c < classDeclarations.GetLength(); c++ )
 				{
-					classDecl = classDeclarations[c];
-					break;
+					if( classDeclarations[c]->typeInfo == current->objType )
+					{
+						classDecl = classDeclarations[c];
+						break;
+					}
 				}
+
+				asASSERT( classDecl );
+			}
+
+			// Defer the compilation of the body until the function is first used. Constructors need the
+			// class declaration for the member initializations, shared functions may be used by other
+			// modules, and constexpr functions may be evaluated by the compiler, so they are always
+			// compiled immediately
+			if( engine->ep.deferFunctionCompilation && current->node && classDecl == 0 && !func->IsShared() && !func->IsConstExpr() )
+			{
+				deferredFunctions.PushLast(current);
+				continue;
 			}
 
-			asASSERT( classDecl );
+			if( current->node )
+			{
+				int r, c;
+				current->script->ConvertPosToRowCol(current->node->tokenPos, &r, &c);
+
+				asCString str = func->GetDeclarationStr();
+				str.Format(TXT_COMPILING_s, str.AddressOf());
+				WriteInfo(current->script->name, str, r, c, true);
+
+				// When compiling a constructor need to pass the class declaration for member initializations
+				compiler.CompileFunction(this, current->script, current->paramNames, current->node, func, classDecl);
+
+				engine->preMessage.isSet = false;
+			}
+			else if( current->objType && current->name == current->objType->name )
+			{
+				asCScriptNode *node = classDecl ? classDecl->node : 0;
+
+				if (func->parameterTypes.GetLength() == 0)
+				{
+					int r = 0, c = 0;
+					if (node)
+						current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+
+					asCString str = func->GetDeclarationStr();
+					str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
+					WriteInfo(current->script->name, str, r, c, true);
+
+					// This is the default constructor that is generated
+					// automatically if not implemented by the user.
+					r = compiler.CompileDefaultConstructor(this, current->script, node, func, classDecl);
+				}
+				else
+				{
+					asASSERT(func->parameterTypes.GetLength() == 1 && func->parameterTypes[0].GetTypeInfo() == current->objType);
+
+					int r = 0, c = 0;
+					if (node)
+						current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+
+					asCString str = func->GetDeclarationStr();
+					str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
+					WriteInfo(current->script->name, str, r, c, true);
+
+					// This is the default copy constructor that is generated
+					// automatically if not implemented by the user.
+					r = compiler.CompileDefaultCopyConstructor(this, current->script, node, func, classDecl);
+				}
+
+				engine->preMessage.isSet = false;
+			}
+			else
+			{
+				asASSERT( false );
+			}
 		}
 
-		if( current->node )
+		numFirstPass = functions.GetLength();
+	}
+}
+
+// Stores information on the function bodies in each script section so that a later
+// call to BuildIncremental can determine which functions must be recompiled
+void asCBuilder::StoreSectionInfos()
+{
+	for( asUINT s = 0; s < scripts.GetLength(); s++ )
+	{
+		asCScriptCode *script = scripts[s];
+
+		// Gather the bodies of the functions declared in this section sorted by their position. Lambdas
+		// are skipped as they are declared inside the body of another function or a global variable
+		asCArray<sBodyRange>        bodies;
+		asCArray<sFunctionBodyInfo> infos;
+		for( asUINT n = 0; n < functions.GetLength(); n++ )
 		{
-			int r, c;
-			current->script->ConvertPosToRowCol(current->node->tokenPos, &r, &c);
+			sFunctionDescription *desc = functions[n];
+			if( desc == 0 || desc->node == 0 || desc->script != script ) continue;
+			if( desc->name.GetLength() && desc->name[0] == '$' ) continue;
 
-			asCString str = func->GetDeclarationStr();
-			str.Format(TXT_COMPILING_s, str.AddressOf());
-			WriteInfo(current->script->name, str, r, c, true);
+			asCScriptNode *block = desc->node->nodeType == snStatementBlock ? desc->node : desc->node->lastChild;
+			if( block == 0 || block->nodeType != snStatementBlock ) continue;
 
-			// When compiling a constructor need to pass the class declaration for member initializations
-			compiler.CompileFunction(this, current->script, current->paramNames, current->node, func, classDecl);
+			// Methods from mixin classes share the same body in multiple classes
+			asUINT b;
+			for( b = 0; b < bodies.GetLength(); b++ )
+				if( bodies[b].pos == block->tokenPos )
+					break;
 
-			engine->preMessage.isSet = false;
+			if( b == bodies.GetLength() )
+			{
+				sBodyRange range = {block->tokenPos, block->tokenLength, 0};
+				bodies.PushLast(range);
+				infos.PushLast(sFunctionBodyInfo());
+
+				for( ; b > 0 && bodies[b-1].pos > bodies[b].pos; b-- )
+				{
+					range = bodies[b]; bodies[b] = bodies[b-1]; bodies[b-1] = range;
+					infos[b].funcIds.SwapWith(infos[b-1].funcIds);
+				}
+			}
+
+			infos[b].funcIds.PushLast(desc->funcId);
 		}
-		else if( current->objType && current->name == current->objType->name )
+
+		asQWORD declarationHash;
+		if( !HashDeclarations(script, bodies, false, declarationHash) )
+			continue;
+
+		sScriptSectionInfo *info = asNEW(sScriptSectionInfo);
+		if( info == 0 )
+			return;
+
+		info->name            = script->name;
+		info->declarationHash = declarationHash;
+		info->bodies          = infos;
+		for( asUINT b = 0; b < bodies.GetLength(); b++ )
 		{
-			asCScriptNode *node = classDecl ? classDecl->node : 0;
+			info->bodies[b].tokenIdx = bodies[b].tokenIdx;
+			info->bodies[b].hash     = asStringHash(&script->code[bodies[b].pos], bodies[b].length);
+			script->ConvertPosToRowCol(bodies[b].pos, &info->bodies[b].row, 0);
+		}
 
-			if (func->parameterTypes.GetLength() == 0)
-			{
-				int r = 0, c = 0;
-				if (node)
-					current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+		module->m_sectionInfos.PushLast(info);
+	}
 
-				asCString str = func->GetDeclarationStr();
-				str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
-				WriteInfo(current->script->name, str, r, c, true);
+	module->m_namespaceVisibility = namespaceVisibility;
+
+	// Remember the global constants that the compiler substitutes with their values
+	asCSymbolTable<sGlobalVariableDescription>::iterator it = globVariables.List();
+	while( it )
+	{
+		if( (*it)->isPureConstant && !(*it)->isEnumValue && (*it)->property )
+			module->m_pureConstants.Insert((*it)->property, (*it)->constantValue);
+		it++;
+	}
+}
 
-				// This is the default constructor that is generated
-				// automatically if not implemented by the user.
-				r = compiler.CompileDefaultConstructor(this, current->script, node, func, classDecl);
+// Hands over the location of the function bodies whose compilation was deferred to the module
+// together with the script sections, so the functions can be compiled when they are first used
+int asCBuilder::StoreDeferredFunctions()
+{
+	// The scripts that are handed over to the module are removed from the builder's array
+	asCArray<asCScriptCode*> builderScripts = scripts;
+	asCArray<asCScriptCode*> moduleScripts;
+	moduleScripts.SetLength(scripts.GetLength());
+	for( asUINT s = 0; s < moduleScripts.GetLength(); s++ )
+		moduleScripts[s] = 0;
+
+	for( asUINT n = 0; n < deferredFunctions.GetLength(); n++ )
+	{
+		sFunctionDescription *desc = deferredFunctions[n];
+		int s = builderScripts.IndexOf(desc->script);
+		if( s < 0 )
+			continue;
+
+		if( moduleScripts[s] == 0 )
+		{
+			asCScriptCode *script = builderScripts[s];
+			if( script->sharedCode )
+			{
+				// The application owns the code so the module needs its own copy
+				asCScriptCode *copy = asNEW(asCScriptCode);
+				if( copy == 0 || copy->SetCode(script->name.AddressOf(), script->code, script->codeLength, true) < 0 )
+				{
+					if( copy ) asDELETE(copy, asCScriptCode);
+					return asOUT_OF_MEMORY;
+				}
+				copy->lineOffset = script->lineOffset;
+				copy->idx        = script->idx;
+				moduleScripts[s] = copy;
 			}
 			else
 			{
-				asASSERT(func->parameterTypes.GetLength() == 1 && func->parameterTypes[0].GetTypeInfo() == current->objType);
+				moduleScripts[s] = script;
+				scripts[s] = 0;
+			}
 
-				int r = 0, c = 0;
-				if (node)
-					current->script->ConvertPosToRowCol(node->tokenPos, &r, &c);
+			module->m_deferredScripts.PushLast(moduleScripts[s]);
+		}
 
-				asCString str = func->GetDeclarationStr();
-				str.Format(TXT_COMPILING_AUTO_s, str.AddressOf());
-				WriteInfo(current->script->name, str, r, c, true);
+		asCScriptNode *block = desc->node->nodeType == snStatementBlock ? desc->node : desc->node->lastChild;
+		sDeferredFunction deferred = {moduleScripts[s], block->tokenPos, block->tokenLength};
+		module->m_deferredFunctions.Insert(desc->funcId, deferred);
+	}
+
+	return asSUCCESS;
+}
+
+// Computes a hash of all the tokens in the script section except those in the function bodies.
+// Whitespace and comments are ignored so formatting changes don't require a full build. If
+// locateBodies is false the position of each body is known and the number of declaration
+// tokens preceding it is stored. If locateBodies is true it is the other way around.
+bool asCBuilder::HashDeclarations(asCScriptCode *script, asCArray<sBodyRange> &bodies, bool locateBodies, asQWORD &outHash)
+{
+	asQWORD hash = asSTRING_HASH_SEED;
+	asUINT  tokenIdx = 0;
+	asUINT  nextBody = 0;
+	size_t  pos = 0;
+	while( pos < script->codeLength )
+	{
+		size_t len;
+		asETokenClass tc;
+		eTokenType t = engine->tok.GetToken(&script->code[pos], script->codeLength - pos, &len, &tc);
+		if( tc == asTC_WHITESPACE || tc == asTC_COMMENT )
+		{
+			pos += len;
+			continue;
+		}
+
+		if( nextBody < bodies.GetLength() &&
+			(locateBodies ? bodies[nextBody].tokenIdx == tokenIdx : bodies[nextBody].pos == pos) )
+		{
+			sBodyRange &body = bodies[nextBody++];
+			if( locateBodies )
+			{
+				// Find the end of the statement block by matching the braces
+				if( t != ttStartStatementBlock )
+					return false;
+
+				size_t end = pos;
+				int level = 0;
+				for(;;)
+				{
+					if( t == ttStartStatementBlock )
+						level++;
+					else if( t == ttEndStatementBlock )
+						level--;
+					end += len;
+
+					if( level == 0 )
+						break;
+					if( end >= script->codeLength || t == ttNonTerminatedStringConstant )
+						return false;
+
+					t = engine->tok.GetToken(&script->code[end], script->codeLength - end, &len);
+				}
 
-				// This is the default copy constructor that is generated
-				// automatically if not implemented by the user.
-				r = compiler.CompileDefaultCopyConstructor(this, current->script, node, func, classDecl);
+				body.pos    = pos;
+				body.length = end - pos;
 			}
+			else
+				body.tokenIdx = tokenIdx;
 
-			engine->preMessage.isSet = false;
+			// Mark the location of the body in the declarations
+			hash = asStringHash("{}", 2, hash);
+			pos = body.pos + body.length;
+			continue;
 		}
-		else
+
+		// Separate the tokens so that for example 'a b' and 'ab' don't give the same hash
+		hash = asStringHash(&script->code[pos], len, hash);
+		hash = asStringHash(" ", 1, hash);
+		tokenIdx++;
+		pos += len;
+	}
+
+	if( nextBody != bodies.GetLength() )
+		return false;
+
+	outHash = hash;
+	return true;
+}
+
+// Compiles the new bodies of the functions. The functions keep their ids so nothing that
+// refers to them needs to be updated. If any error occurs the functions are left untouched
+int asCBuilder::RecompileFunctionBodies(asCArray<asCScriptFunction*> &funcs, asCArray<asCScriptCode*> &funcScripts, asCArray<sBodyRange> &funcBodies, asCArray<int> &rowOffsets)
+{
+	asUINT n;
+
+	// Find the lambdas declared in the old bodies as they will be replaced by the new ones
+	asCArray<asCScriptFunction*> oldLambdas;
+	asCArray<asCScriptFunction*> declaredIn;
+	for( n = 0; n < funcs.GetLength(); n++ )
+		if( funcs[n]->scriptData->byteCode.GetLength() )
+			declaredIn.PushLast(funcs[n]);
+	for( n = 0; n < declaredIn.GetLength(); n++ )
+	{
+		asCString prefix;
+		prefix.Format("$%s$", declaredIn[n]->GetDeclaration());
+		for( asUINT f = 0; f < module->m_globalFunctions.GetSize(); f++ )
+		{
+			asCScriptFunction *func = module->m_globalFunctions.Get(f);
+			if( func == 0 || func->nameSpace != declaredIn[n]->nameSpace || oldLambdas.Exists(func) )
+				continue;
+			if( func->name.SubString(0, prefix.GetLength()) != prefix )
+				continue;
+
+			// Lambdas may in turn declare other lambdas
+			oldLambdas.PushLast(func);
+			declaredIn.PushLast(func);
+		}
+	}
+
+	// Give each function new script data so the old bytecode is kept in case the compilation fails
+	asCArray<asCScriptFunction::ScriptFunctionData*> oldData;
+	for( n = 0; n < funcs.GetLength(); n++ )
+	{
+		asCScriptFunction *func = funcs[n];
+		oldData.PushLast(func->scriptData);
+		func->scriptData = 0;
+		func->AllocateScriptFunctionData();
+
+		int row = (oldData[n]->declaredAt & 0xFFFFF) + rowOffsets[n];
+		func->scriptData->scriptSectionIdx = oldData[n]->scriptSectionIdx;
+		func->scriptData->declaredAt       = (row & 0xFFFFF)|(oldData[n]->declaredAt & ~0xFFFFF);
+
+		// The compiler parses the statement block from the position of the node
+		asCScriptNode *node = nodeArena.CreateNode(snStatementBlock);
+		sFunctionDescription *desc = asNEW(sFunctionDescription);
+		if( node == 0 || desc == 0 )
+		{
+			if( node ) node->Destroy(engine);
+			if( desc ) asDELETE(desc, sFunctionDescription);
+			numErrors++;
+			break;
+		}
+
+		node->UpdateSourcePos(funcBodies[n].pos, funcBodies[n].length);
+
+		desc->script           = funcScripts[n];
+		desc->node             = node;
+		desc->name             = func->name;
+		desc->objType          = func->objectType;
+		desc->paramNames       = func->parameterNames;
+		desc->funcId           = func->id;
+		desc->isExistingShared = false;
+		functions.PushLast(desc);
+	}
+
+	// This must be done in a loop, as additional functions get declared as lambdas in the code
+	for( n = 0; numErrors == 0 && n < functions.GetLength(); n++ )
+	{
+		sFunctionDescription *current = functions[n];
+		asCScriptFunction *func = engine->scriptFunctions[current->funcId];
+
+		int r, c;
+		current->script->ConvertPosToRowCol(current->node->tokenPos, &r, &c);
+
+		asCString str = func->GetDeclarationStr();
+		str.Format(TXT_COMPILING_s, str.AddressOf());
+		WriteInfo(current->script->name, str, r, c, true);
+
+		asCCompiler compiler(engine);
+		compiler.CompileFunction(this, current->script, current->paramNames, current->node, func, 0);
+
+		engine->preMessage.isSet = false;
+	}
+
+	if( numWarnings > 0 && engine->ep.compilerWarnings == 2 )
+		WriteError(TXT_WARNINGS_TREATED_AS_ERROR, 0, 0);
+
+	if( numErrors > 0 )
+	{
+		// Restore the old bytecode
+		for( n = 0; n < oldData.GetLength(); n++ )
 		{
-			asASSERT( false );
+			funcs[n]->ReleaseReferences();
+			funcs[n]->DeallocateScriptFunctionData();
+			funcs[n]->scriptData = oldData[n];
 		}
+
+		// Remove the lambdas that were declared in the new bodies
+		for( n = funcs.GetLength(); n < functions.GetLength(); n++ )
+		{
+			asCScriptFunction *func = engine->scriptFunctions[functions[n]->funcId];
+			if( module->m_globalFunctions.GetIndex(func) >= 0 )
+			{
+				module->m_globalFunctions.Erase(module->m_globalFunctions.GetIndex(func));
+				module->m_scriptFunctions.RemoveValue(func);
+				engine->RemoveEntityOwner(func, module);
+				func->ReleaseInternal();
+			}
+		}
+
+		return asERROR;
 	}
+
+	// Release the old bytecode
+	for( n = 0; n < funcs.GetLength(); n++ )
+	{
+		asCScriptFunction::ScriptFunctionData *newData = funcs[n]->scriptData;
+		funcs[n]->scriptData = oldData[n];
+		funcs[n]->ReleaseReferences();
+		funcs[n]->DeallocateScriptFunctionData();
+		funcs[n]->scriptData = newData;
+
+		// The function is no longer waiting to be compiled
+		asSMapNode<int, sDeferredFunction> *cursor = 0;
+		if( module->m_deferredFunctions.MoveTo(&cursor, funcs[n]->id) )
+			module->m_deferredFunctions.Erase(cursor);
+	}
+
+	// The lambdas from the old bodies are no longer used
+	for( n = 0; n < oldLambdas.GetLength(); n++ )
+	{
+		asCScriptFunction *func = oldLambdas[n];
+		module->m_globalFunctions.Erase(module->m_globalFunctions.GetIndex(func));
+		module->m_scriptFunctions.RemoveValue(func);
+		engine->RemoveEntityOwner(func, module);
+		func->ReleaseInternal();
+	}
+
+	for( n = 0; n < functions.GetLength(); n++ )
+		engine->scriptFunctions[functions[n]->funcId]->JITCompile();
+
+	return asSUCCESS;
 }
 #endif
 
@@ -1804,6 +2479,27 @@ int asCBuilder::CheckNameConflict(const char *name, asCScriptNode *node, asCScri
 		}
 	}
 
+	// Check against structs
+	for( n = 0; n < structDeclarations.GetLength(); n++ )
+	{
+		if( structDeclarations[n]->name == name &&
+			structDeclarations[n]->typeInfo->nameSpace == ns )
+		{
+			if( code )
+			{
+				asCString str;
+				if (ns->name != "")
+					str = ns->name + "::" + name;
+				else
+					str = name;
+				str.Format(TXT_NAME_CONFLICT_s_STRUCT, str.AddressOf());
+				WriteError(str, code, node);
+			}
+
+			return -1;
+		}
+	}
+
 	// Check against named types
 	for( n = 0; n < namedTypeDeclarations.GetLength(); n++ )
 	{
@@ -2579,6 +3275,74 @@ int asCBuilder::RegisterClass(asCScriptNode *node, asCScriptCode *file, asSNameS
 	return 0;
 }
 
+int asCBuilder::RegisterStruct(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns)
+{
+	asCScriptNode *n = node->firstChild;
+
+	// None of the class modifiers apply to structs
+	while( n->tokenType == ttIdentifier &&
+		   (file->TokenEquals(n->tokenPos, n->tokenLength, FINAL_TOKEN) ||
+			file->TokenEquals(n->tokenPos, n->tokenLength, SHARED_TOKEN) ||
+			file->TokenEquals(n->tokenPos, n->tokenLength, EXTERNAL_TOKEN) ||
+			file->TokenEquals(n->tokenPos, n->tokenLength, ABSTRACT_TOKEN)) )
+	{
+		asCString msg;
+		msg.Format(TXT_STRUCT_CANNOT_BE_DECLARED_AS_s, asCString(&file->code[n->tokenPos], n->tokenLength).AddressOf());
+		WriteError(msg, file, n);
+
+		n = n->next;
+	}
+
+	asCString name(&file->code[n->tokenPos], n->tokenLength);
+
+	CheckNameConflict(name.AddressOf(), n, file, ns, true, false, false);
+
+	sClassDeclaration *decl = asNEW(sClassDeclaration);
+	if( decl == 0 )
+	{
+		node->Destroy(engine);
+		return asOUT_OF_MEMORY;
+	}
+
+	structDeclarations.PushLast(decl);
+	decl->name             = name;
+	decl->script           = file;
+	decl->node             = node;
+
+	asCObjectType *st = asNEW(asCObjectType)(engine);
+	if( st == 0 )
+		return asOUT_OF_MEMORY;
+
+	// A struct is a value type without any behaviours. It is stored inline in variables and other
+	// objects, and copied byte by byte. The size is determined when the members are laid out
+	st->flags     = asOBJ_VALUE | asOBJ_POD | asOBJ_SCRIPT_STRUCT;
+	st->size      = 0;
+	st->name      = name;
+	st->nameSpace = ns;
+	st->module    = module;
+	module->AddClassType(st);
+	decl->typeInfo = st;
+
+	// Structs cannot inherit from other types
+	n = n->next;
+	if( n && n->nodeType == snIdentifier )
+		WriteError(TXT_STRUCT_CANNOT_INHERIT, file, n);
+
+	// Register possible child types
+	while( n )
+	{
+		asCScriptNode *next = n->next;
+		if( n->nodeType == snFuncDef )
+		{
+			n->DisconnectParent();
+			RegisterFuncDef(n, file, 0, st);
+		}
+		n = next;
+	}
+
+	return 0;
+}
+
 int asCBuilder::RegisterInterface(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns)
 {
 	asCScriptNode *n = node->firstChild;
@@ -2707,10 +3471,12 @@ void asCBuilder::CompileGlobalVariables()
 	int currNumErrors   = numErrors;
 	int currNumWarnings = numWarnings;
 
-	// Backup the original message stream
-	bool                       msgCallback     = engine->msgCallback;
+	// Backup the original message stream as the application registered it
+	asSFuncPtr                 msgCallbackPtr(0);
+	void                      *msgCallbackObj  = 0;
+	asDWORD                    msgCallConv     = 0;
+	bool                       msgCallback     = engine->GetMessageCallback(&msgCallbackPtr, &msgCallbackObj, &msgCallConv) >= 0;
 	asSSystemFunctionInterface msgCallbackFunc = engine->msgCallbackFunc;
-	void                      *msgCallbackObj  = engine->msgCallbackObj;
 
 	// Set the new temporary message stream
 	asCOutputBuffer outBuffer;
@@ -2721,6 +3487,8 @@ void asCBuilder::CompileGlobalVariables()
 
 	asCSymbolTable<asCGlobalProperty> initOrder;
 
+	isCompilingGlobalVars = true;
+
 	// We first try to compile all the primitive global variables, and only after that
 	// compile the non-primitive global variables. This permits the constructors
 	// for the complex types to use the already initialized variables of primitive
@@ -2739,6 +3507,54 @@ void asCBuilder::CompileGlobalVariables()
 
 		// Restore state of compilation
 		finalOutput.Clear();
+
+		// The constexpr functions are compiled together with the primitive variables, as the
+		// variables may be initialized by calls to them, and the functions may use constants.
+		// A function that fails is compiled again in the next pass, and if it still fails when
+		// no more progress is made the errors are reported when the functions are compiled
+		for( asUINT f = 0; compilingPrimitives && f < functions.GetLength(); f++ )
+		{
+			sFunctionDescription *current = functions[f];
+			if( current == 0 || current->isExistingShared || current->node == 0 ) continue;
+
+			asCScriptFunction *func = engine->scriptFunctions[current->funcId];
+			if( !func->IsConstExpr() || func->scriptData->byteCode.GetLength() )
+				continue;
+
+			numWarnings = 0;
+			numErrors = 0;
+			outBuffer.Clear();
+
+			int sectionIdx = func->scriptData->scriptSectionIdx;
+			int declaredAt = func->scriptData->declaredAt;
+
+			asCCompiler comp(engine);
+			int r = comp.CompileFunction(this, current->script, current->paramNames, current->node, func, 0);
+			if( r >= 0 )
+			{
+				compileSucceeded = true;
+
+				// Add warnings for this function to the total build
+				if( numWarnings )
+				{
+					currNumWarnings += numWarnings;
+					if( msgCallback )
+						outBuffer.SendToCallback(engine, &msgCallbackFunc, msgCallbackObj);
+				}
+			}
+			else
+			{
+				// Discard the partially compiled function so it can be compiled again
+				func->ReleaseReferences();
+				func->DeallocateScriptFunctionData();
+				func->AllocateScriptFunctionData();
+				func->scriptData->scriptSectionIdx = sectionIdx;
+				func->scriptData->declaredAt       = declaredAt;
+			}
+
+			engine->preMessage.isSet = false;
+		}
+
 		asCSymbolTable<sGlobalVariableDescription>::iterator it = globVariables.List();
 		for( ; it; it++ )
 		{
@@ -2954,10 +3770,10 @@ void asCBuilder::CompileGlobalVariables()
 		}
 	}
 
+	isCompilingGlobalVars = false;
+
 	// Restore states
-	engine->msgCallback     = msgCallback;
-	engine->msgCallbackFunc = msgCallbackFunc;
-	engine->msgCallbackObj  = msgCallbackObj;
+	RestoreMessageCallback(msgCallback, msgCallbackPtr, msgCallbackObj, msgCallConv);
 
 	numWarnings = currNumWarnings;
 	numErrors   = currNumErrors;
@@ -3438,6 +4254,120 @@ void asCBuilder::DetermineTypeRelations()
 	}
 }
 
+void asCBuilder::CompileStructs()
+{
+	// The members of a struct are stored inline, so the structs that are used as members must be
+	// laid out before the structs that contain them. The structs are also placed in this order first
+	// in the module, so that the saved bytecode is loaded with the sizes of the members already known
+	asCArray<asCObjectType*> order;
+	for( asUINT n = 0; n < structDeclarations.GetLength(); n++ )
+		LayoutStruct(structDeclarations[n], order);
+
+	if( order.GetLength() == 0 )
+		return;
+
+	for( asUINT n = 0; n < module->m_classTypes.GetLength(); n++ )
+		if( !(module->m_classTypes[n]->flags & asOBJ_SCRIPT_STRUCT) )
+			order.PushLast(module->m_classTypes[n]);
+
+	module->m_classTypes = order;
+}
+
+void asCBuilder::LayoutStruct(sClassDeclaration *decl, asCArray<asCObjectType*> &order)
+{
+	// validState is 1 when the struct has been laid out, and 2 while the members are being added
+	if( decl->validState == 1 )
+		return;
+
+	asCObjectType *ot = CastToObjectType(decl->typeInfo);
+	asCScriptCode *file = decl->script;
+	if( decl->validState == 2 )
+	{
+		asCString str;
+		str.Format(TXT_STRUCT_s_CANNOT_CONTAIN_ITSELF, ot->GetName());
+		WriteError(str, file, decl->node);
+		return;
+	}
+	decl->validState = 2;
+
+	// Enumerate each of the declared properties
+	asCScriptNode *node = decl->node->firstChild->next;
+
+	// Skip the inheritance list
+	while( node && node->nodeType == snIdentifier )
+		node = node->next;
+
+	while( node && node->nodeType == snDeclaration )
+	{
+		asCScriptNode *nd = node->firstChild;
+
+		// Is the property declared as private or protected?
+		bool isPrivate = false, isProtected = false;
+		if( nd && nd->tokenType == ttPrivate )
+		{
+			isPrivate = true;
+			nd = nd->next;
+		}
+		else if( nd && nd->tokenType == ttProtected )
+		{
+			isProtected = true;
+			nd = nd->next;
+		}
+
+		// Only types that can be stored inline without initialization are allowed
+		asCDataType dt = CreateDataTypeFromNode(nd, file, ot->nameSpace, false, ot);
+		bool isStruct = dt.GetTypeInfo() && (dt.GetTypeInfo()->flags & asOBJ_SCRIPT_STRUCT) && !dt.IsObjectHandle();
+		bool isValid = isStruct || (dt.IsPrimitive() && dt.CanBeInstantiated());
+		if( dt.IsReadOnly() )
+			WriteError(TXT_PROPERTY_CANT_BE_CONST, file, node);
+		else if( !isValid )
+		{
+			asCString str;
+			str.Format(TXT_STRUCT_MEMBER_CANNOT_BE_s, dt.Format(ot->nameSpace).AddressOf());
+			WriteError(str, file, node);
+		}
+		else if( isStruct )
+		{
+			for( asUINT n = 0; n < structDeclarations.GetLength(); n++ )
+			{
+				if( structDeclarations[n]->typeInfo == dt.GetTypeInfo() )
+				{
+					LayoutStruct(structDeclarations[n], order);
+					break;
+				}
+			}
+		}
+
+		// Multiple properties can be declared separated by ,
+		nd = nd->next;
+		while( nd )
+		{
+			asCString name(&file->code[nd->tokenPos], nd->tokenLength);
+
+			CheckNameConflictMember(ot, name.AddressOf(), nd, file, true, false);
+			if( isValid )
+				ot->AddPropertyToClass(name, dt, isPrivate, isProtected, false);
+
+			// The members are always initialized to zero
+			if( nd->next && nd->next->nodeType != snIdentifier )
+			{
+				WriteError(TXT_STRUCT_MEMBER_CANNOT_HAVE_INIT, file, nd->next);
+				nd = nd->next;
+			}
+
+			nd = nd->next;
+		}
+
+		node = node->next;
+	}
+
+	// The size is rounded up to whole dwords, as that is how the value is copied
+	ot->size = ot->size ? (ot->size + 3) & ~3 : 4;
+
+	decl->validState = 1;
+	order.PushLast(ot);
+}
+
 // numTempl is the number of template instances that existed in the engine before the build begun
 void asCBuilder::CompileClasses(asUINT numTempl)
 {
@@ -3992,6 +4922,7 @@ void asCBuilder::CompileClasses(asUINT numTempl)
 				functions.RemoveIndex(funcDesc);
 
 				module->m_scriptFunctions.RemoveValue(func);
+				engine->RemoveEntityOwner(func, module);
 				func->module = 0;
 				func->ReleaseInternal();
 				ot->beh.constructors.RemoveValue(ot->beh.copyconstruct);
@@ -4008,6 +4939,7 @@ void asCBuilder::CompileClasses(asUINT numTempl)
 					}
 				func = engine->scriptFunctions[ot->beh.copyfactory];
 				module->m_scriptFunctions.RemoveValue(func);
+				engine->RemoveEntityOwner(func, module);
 				func->module = 0;
 				func->ReleaseInternal();
 				ot->beh.factories.RemoveValue(ot->beh.copyfactory);
@@ -4452,6 +5384,7 @@ int asCBuilder::CreateVirtualFunction(asCScriptFunction *func, int idx)
 	vf->returnType       = func->returnType;
 	vf->parameterTypes   = func->parameterTypes;
 	vf->inOutFlags       = func->inOutFlags;
+	vf->argumentsSize    = func->GetSpaceNeededForArguments();
 	vf->id               = engine->GetNextScriptFunctionId();
 	vf->objectType       = func->objectType;
 	vf->objectType->AddRefInternal();
@@ -5011,6 +5944,9 @@ void asCBuilder::GetParsedFunctionDetails(asCScriptNode *node, asCScriptCode *fi
 	funcTraits.SetTrait(asTRAIT_OVERRIDE, false);
 	funcTraits.SetTrait(asTRAIT_EXPLICIT, false);
 	funcTraits.SetTrait(asTRAIT_PROPERTY, false);
+	funcTraits.SetTrait(asTRAIT_CONSTEXPR, false);
+	funcTraits.SetTrait(asTRAIT_INLINE, false);
+	funcTraits.SetTrait(asTRAIT_NOINLINE, false);
 
 	if( n->next->next )
 	{
@@ -5035,6 +5971,12 @@ void asCBuilder::GetParsedFunctionDetails(asCScriptNode *node, asCScriptCode *fi
 				funcTraits.SetTrait(asTRAIT_PROPERTY, true);
 			else if (file->TokenEquals(decorator->tokenPos, decorator->tokenLength, DELETE_TOKEN))
 				funcTraits.SetTrait(asTRAIT_DELETED, true);
+			else if (objType == 0 && file->TokenEquals(decorator->tokenPos, decorator->tokenLength, CONSTEXPR_TOKEN))
+				funcTraits.SetTrait(asTRAIT_CONSTEXPR, true);
+			else if (file->TokenEquals(decorator->tokenPos, decorator->tokenLength, INLINE_TOKEN))
+				funcTraits.SetTrait(asTRAIT_INLINE, true);
+			else if (file->TokenEquals(decorator->tokenPos, decorator->tokenLength, NOINLINE_TOKEN))
+				funcTraits.SetTrait(asTRAIT_NOINLINE, true);
 			else
 			{
 				asCString msg(&file->code[decorator->tokenPos], decorator->tokenLength);
@@ -5112,6 +6054,21 @@ void asCBuilder::GetParsedFunctionDetails(asCScriptNode *node, asCScriptCode *fi
 		else
 			defaultArgs.PushLast(0);
 	}
+
+	// A constexpr function is evaluated by the compiler, so it can only work on primitive values
+	if( funcTraits.GetTrait(asTRAIT_CONSTEXPR) )
+	{
+		bool isValid = returnType.IsPrimitive() && !returnType.IsReference() && returnType.GetTokenType() != ttVoid;
+		for( asUINT p = 0; isValid && p < parameterTypes.GetLength(); p++ )
+			if( !parameterTypes[p].IsPrimitive() || parameterTypes[p].IsReference() || parameterTypes[p].GetTokenType() == ttQuestion )
+				isValid = false;
+
+		if( !isValid )
+		{
+			WriteError(TXT_CONSTEXPR_MUST_BE_PRIMITIVE, file, node);
+			funcTraits.SetTrait(asTRAIT_CONSTEXPR, false);
+		}
+	}
 }
 #endif
 
@@ -5263,6 +6220,21 @@ int asCBuilder::RegisterScriptFunction(asCScriptNode *node, asCScriptCode *file,
 		return 0;
 	}
 
+	// Structs are always created without calling a constructor and are copied byte by byte
+	if( objType && (objType->flags & asOBJ_SCRIPT_STRUCT) &&
+		(funcTraits.GetTrait(asTRAIT_CONSTRUCTOR) || funcTraits.GetTrait(asTRAIT_DESTRUCTOR) || name == "opAssign") )
+	{
+		WriteError(TXT_STRUCT_CANNOT_HAVE_CONSTRUCTOR, file, node);
+
+		// Free the default args
+		for( asUINT n = 0; n < defaultArgs.GetLength(); n++ )
+			if( defaultArgs[n] )
+				asDELETE(defaultArgs[n], asCString);
+
+		node->Destroy(engine);
+		return 0;
+	}
+
 	// Check for name conflicts
 	if( !funcTraits.GetTrait(asTRAIT_CONSTRUCTOR) && !funcTraits.GetTrait(asTRAIT_DESTRUCTOR) )
 	{
@@ -5756,6 +6728,10 @@ int asCBuilder::RegisterVirtualProperty(asCScriptNode *node, asCScriptCode *file
 					funcTraits.SetTrait(asTRAIT_FINAL, true);
 				else if (funcNode->tokenType == ttIdentifier && file->TokenEquals(funcNode->tokenPos, funcNode->tokenLength, OVERRIDE_TOKEN))
 					funcTraits.SetTrait(asTRAIT_OVERRIDE, true);
+				else if (funcNode->tokenType == ttIdentifier && file->TokenEquals(funcNode->tokenPos, funcNode->tokenLength, INLINE_TOKEN))
+					funcTraits.SetTrait(asTRAIT_INLINE, true);
+				else if (funcNode->tokenType == ttIdentifier && file->TokenEquals(funcNode->tokenPos, funcNode->tokenLength, NOINLINE_TOKEN))
+					funcTraits.SetTrait(asTRAIT_NOINLINE, true);
 				else
 				{
 					asCString msg(&file->code[funcNode->tokenPos], funcNode->tokenLength);;
@@ -5866,6 +6842,11 @@ int asCBuilder::RegisterImportedFunction(int importID, asCScriptNode *node, asCS
 	// Check for invalid function traits
 	if (funcTraits.GetTrait(asTRAIT_DELETED))
 		WriteError(TXT_CANNOT_DELETE_NON_AUTO_FUNC, file, node);
+	if (funcTraits.GetTrait(asTRAIT_CONSTEXPR))
+	{
+		WriteError(TXT_CANNOT_IMPORT_CONSTEXPR, file, node);
+		funcTraits.SetTrait(asTRAIT_CONSTEXPR, false);
+	}
 
 	// Read the module name as well
 	asCScriptNode *nd = node->lastChild;
@@ -116,6 +116,13 @@ struct sClassDeclaration
 	asCArray<sPropertyInitializer> propInits;
 };
 
+struct sBodyRange
+{
+	size_t pos;
+	size_t length;
+	asUINT tokenIdx;
+};
+
 struct sFuncDef
 {
 	asCScriptCode *script;
@@ -156,6 +163,8 @@ public:
 	int AddCode(const char *name, const char *code, int codeLength, int lineOffset, int sectionIdx, bool makeCopy);
 	asCScriptCode *FindOrAddCode(const char *name, const char *code, size_t length);
 	int Build();
+	int BuildIncremental();
+	int CompileDeferredFunctions(asCArray<asCScriptFunction*> &funcs);
 
 	int CompileFunction(const char *sectionName, const char *code, int lineOffset, asDWORD compileFlags, asCScriptFunction **outFunc);
 	int CompileGlobalVar(const char *sectionName, const char *code, int lineOffset);
@@ -205,6 +214,10 @@ protected:
 	asCModule       *module;
 	asCMap<asSNameSpace*, asCArray<asSNameSpace*>>    namespaceVisibility;
 
+	// All script nodes created by the parsers and compilers for this builder
+	// are allocated from this arena, and released together with the builder
+	asCScriptNodeArena nodeArena;
+
 #ifndef AS_NO_COMPILER
 protected:
 	friend class asCCompiler;
@@ -225,6 +238,7 @@ protected:
 	int                RegisterGlobalVar(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
 	int                RegisterUsingNamespace(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
 	int                RegisterClass(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
+	int                RegisterStruct(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
 	int                RegisterInterface(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
 	int                RegisterEnum(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
 	int                RegisterTypedef(asCScriptNode *node, asCScriptCode *file, asSNameSpace *ns);
@@ -232,6 +246,8 @@ protected:
 	asCScriptFunction *RegisterLambda(asCScriptNode *node, asCScriptCode *file, asCScriptFunction *funcDef, const asCString &name, asSNameSpace *ns, bool isShared);
 	void               CompleteFuncDef(sFuncDef *funcDef);
 	void               CompileInterfaces();
+	void               CompileStructs();
+	void               LayoutStruct(sClassDeclaration *decl, asCArray<asCObjectType*> &order);
 	void               CompileClasses(asUINT originalNumTempl);
 	void               DetermineTypeRelations();
 	void               GetParsedFunctionDetails(asCScriptNode *node, asCScriptCode *file, asCObjectType *objType, asCString &name, asCDataType &returnType, asCArray<asCString> &parameterNames, asCArray<asCDataType> &parameterTypes, asCArray<asETypeModifiers> &inOutFlags, asCArray<asCString *> &defaultArgs, asSFunctionTraits &traits, asSNameSpace *implicitNamespace);
@@ -244,8 +260,14 @@ protected:
 	void               RegisterTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
 	void               RegisterNamespaceVisibility(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
 	void               RegisterNonTypesFromScript(asCScriptNode *node, asCScriptCode *script, asSNameSpace *ns);
-	void               CompileFunctions();
+	void               CompileFunctions(bool constExpr);
+	bool               IsInlineCandidate(sFunctionDescription *desc);
 	void               CompileGlobalVariables();
+	void               StoreSectionInfos();
+	int                StoreDeferredFunctions();
+	int                RestoreBuildState();
+	bool               HashDeclarations(asCScriptCode *script, asCArray<sBodyRange> &bodies, bool locateBodies, asQWORD &outHash);
+	int                RecompileFunctionBodies(asCArray<asCScriptFunction*> &funcs, asCArray<asCScriptCode*> &funcScripts, asCArray<sBodyRange> &funcBodies, asCArray<int> &rowOffsets);
 	int                GetEnumValueFromType(asCEnumType *type, const char *name, asCDataType &outDt, asDWORD &outValue);
 	int                GetEnumValue(const char *name, asCDataType &outDt, asDWORD &outValue, asSNameSpace *ns);
 	bool               DoesTypeExist(const asCString &type);
@@ -254,16 +276,23 @@ protected:
 	void               GetFunctionDescriptions(const char *name, asCArray<int> &funcs, asSNameSpace *ns);
 	void               GetObjectMethodDescriptions(const char *name, asCObjectType *objectType, asCArray<int> &methods, bool objIsConst, const asCString &scope = "", asCScriptNode *errNode = 0, asCScriptCode *script = 0);
 	void               EvaluateTemplateInstances(asUINT startIdx, bool keepSilent);
+	void               RestoreMessageCallback(bool hadCallback, const asSFuncPtr &callback, void *obj, asDWORD callConv);
 	void               CleanupEnumValues();
 
 	asCArray<asCScriptCode *>                         scripts;
 	asCArray<sFunctionDescription *>                  functions;
 	asCSymbolTable<sGlobalVariableDescription>        globVariables;
 	asCArray<sClassDeclaration *>                     classDeclarations;
+	asCArray<sClassDeclaration *>                     structDeclarations;
 	asCArray<sClassDeclaration *>                     interfaceDeclarations;
 	asCArray<sClassDeclaration *>                     namedTypeDeclarations;
 	asCArray<sFuncDef *>                              funcDefs;
 	asCArray<sMixinClass *>                           mixinClasses;
+	asCArray<sFunctionDescription *>                  deferredFunctions;
+
+	// Set while the global variables are compiled, so calls to constexpr
+	// functions that are not yet compiled can be retried in the next pass
+	bool                    isCompilingGlobalVars;
 
 	// For use with the DoesTypeExists() method
 	bool                    hasCachedKnownTypes;
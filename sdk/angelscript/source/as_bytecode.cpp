@@ -74,6 +74,16 @@ void asCByteCode::Finalize(const asCArray<int> &tempVariableOffsets)
 
 	// Optimize the code
 	Optimize();
+	if( engine->ep.optimizeByteCode >= 2 )
+	{
+		OptimizeDataFlow();
+
+		// Remove what became redundant, e.g. consecutive SUSPEND instructions
+		Optimize();
+
+		// Let the variables that are never alive at the same time share the stack position
+		CompactVariables();
+	}
 
 	// Resolve jumps
 	ResolveJumpAddresses();
@@ -97,6 +107,7 @@ void asCByteCode::ClearAll()
 	last = 0;
 
 	lineNumbers.SetLength(0);
+	movedVariables.SetLength(0);
 
 	largestStackUsed = -1;
 }
@@ -126,6 +137,7 @@ void asCByteCode::GetVarsUsed(asCArray<int> &vars)
 			     asBCInfo[curr->op].type == asBCTYPE_rW_DW_ARG ||
 			     asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG ||
 			     asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_QW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_W_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_DW_DW_ARG )
 		{
@@ -133,7 +145,8 @@ void asCByteCode::GetVarsUsed(asCArray<int> &vars)
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG )
 		{
 			InsertIfNotExists(vars, curr->wArg[0]);
 			InsertIfNotExists(vars, curr->wArg[1]);
@@ -166,6 +179,7 @@ bool asCByteCode::IsVarUsed(int offset)
 				 asBCInfo[curr->op].type == asBCTYPE_rW_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_QW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_W_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_DW_DW_ARG )
 		{
@@ -174,7 +188,8 @@ bool asCByteCode::IsVarUsed(int offset)
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG )
 		{
 			if( curr->wArg[0] == offset || curr->wArg[1] == offset )
 				return true;
@@ -214,6 +229,7 @@ void asCByteCode::ExchangeVar(int oldOffset, int newOffset)
 				 asBCInfo[curr->op].type == asBCTYPE_rW_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_rW_QW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_W_DW_ARG ||
 				 asBCInfo[curr->op].type == asBCTYPE_rW_DW_DW_ARG )
 		{
@@ -221,7 +237,9 @@ void asCByteCode::ExchangeVar(int oldOffset, int newOffset)
 				curr->wArg[0] = (short)newOffset;
 		}
 		else if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
-				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG )
+				 asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+				 asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG )
 		{
 			if( curr->wArg[0] == oldOffset )
 				curr->wArg[0] = (short)newOffset;
@@ -400,8 +418,6 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 	if( next == 0 )
 		next = &dummy;
 
-	// TODO: runtime optimize: Should work for 64bit types as well
-
 	// TODO: runtime optimize: Need a asBCTYPE_rwW_ARG to cover the instructions that read
 	//                         and write to the same variable. Currently they are considered
 	//                         as readers only, so they are not optimized away. This includes
@@ -412,6 +428,7 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 		(asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG    ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+		 asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_ARG       ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG    ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG) &&
@@ -436,6 +453,7 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 		     curr->next->op == asBC_CMPf ||
 		     curr->next->op == asBC_CMPu) &&
 		    curr->wArg[0] == curr->next->wArg[1] &&
+		    curr->wArg[0] != curr->next->wArg[0] &&             // The variable isn't also the other operand
 		    IsTemporary(curr->wArg[0]) &&                       // The variable is temporary and never used again
 		    !IsTempVarRead(curr->next, curr->wArg[0]) )
 		{
@@ -456,6 +474,7 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 			 curr->next->op == asBC_SUBf ||
 			 curr->next->op == asBC_MULf) &&
 			curr->wArg[0] == curr->next->wArg[2] &&
+			curr->wArg[0] != curr->next->wArg[1] &&         // The variable isn't also the other operand
 			(curr->next->wArg[0] == curr->wArg[0] ||        // The variable is overwritten
 			 (IsTemporary(curr->wArg[0]) &&                 // The variable is temporary and never used again
 			  !IsTempVarRead(curr->next, curr->wArg[0]))) )
@@ -477,6 +496,7 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 			 curr->next->op == asBC_ADDf ||
 			 curr->next->op == asBC_MULf) &&
 			curr->wArg[0] == curr->next->wArg[1] &&
+			curr->wArg[0] != curr->next->wArg[2] &&         // The variable isn't also the other operand
 			(curr->next->wArg[0] == curr->wArg[0] ||        // The variable is overwritten
 			 (IsTemporary(curr->wArg[0]) &&                 // The variable is temporary and never used again
 			  !IsTempVarRead(curr->next, curr->wArg[0]))) )
@@ -533,6 +553,76 @@ bool asCByteCode::RemoveUnusedValue(asCByteInstruction *curr, asCByteInstruction
 		}
 	}
 
+	if( curr->op == asBC_SetV8 && curr->next )
+	{
+		// The value is immediately used and then never again
+		if( (curr->next->op == asBC_CMPi64 ||
+		     curr->next->op == asBC_CMPu64 ||
+		     curr->next->op == asBC_CMPd) &&
+		    curr->wArg[0] == curr->next->wArg[1] &&
+		    curr->wArg[0] != curr->next->wArg[0] &&             // The variable isn't also the other operand
+		    IsTemporary(curr->wArg[0]) &&                       // The variable is temporary and never used again
+		    !IsTempVarRead(curr->next, curr->wArg[0]) )
+		{
+			if(      curr->next->op == asBC_CMPi64 ) curr->next->op = asBC_CMPIi64;
+			else if( curr->next->op == asBC_CMPu64 ) curr->next->op = asBC_CMPIu64;
+			else if( curr->next->op == asBC_CMPd   ) curr->next->op = asBC_CMPId;
+			curr->next->size = asBCTypeSize[asBCInfo[asBC_CMPIi64].type];
+			curr->next->arg = curr->arg;
+			*next = GoForward(DeleteInstruction(curr));
+			return true;
+		}
+
+		// The value is immediately used and then never again
+		if(	(curr->next->op == asBC_ADDi64 ||
+			 curr->next->op == asBC_SUBi64 ||
+			 curr->next->op == asBC_MULi64 ||
+			 curr->next->op == asBC_ADDd ||
+			 curr->next->op == asBC_SUBd ||
+			 curr->next->op == asBC_MULd) &&
+			curr->wArg[0] == curr->next->wArg[2] &&
+			curr->wArg[0] != curr->next->wArg[1] &&         // The variable isn't also the other operand
+			(curr->next->wArg[0] == curr->wArg[0] ||        // The variable is overwritten
+			 (IsTemporary(curr->wArg[0]) &&                 // The variable is temporary and never used again
+			  !IsTempVarRead(curr->next, curr->wArg[0]))) )
+		{
+			if(      curr->next->op == asBC_ADDi64 ) curr->next->op = asBC_ADDIi64;
+			else if( curr->next->op == asBC_SUBi64 ) curr->next->op = asBC_SUBIi64;
+			else if( curr->next->op == asBC_MULi64 ) curr->next->op = asBC_MULIi64;
+			else if( curr->next->op == asBC_ADDd   ) curr->next->op = asBC_ADDId;
+			else if( curr->next->op == asBC_SUBd   ) curr->next->op = asBC_SUBId;
+			else if( curr->next->op == asBC_MULd   ) curr->next->op = asBC_MULId;
+			curr->next->size = asBCTypeSize[asBCInfo[asBC_ADDIi64].type];
+			curr->next->arg = curr->arg;
+			*next = GoForward(DeleteInstruction(curr));
+			return true;
+		}
+
+		if(	(curr->next->op == asBC_ADDi64 ||
+			 curr->next->op == asBC_MULi64 ||
+			 curr->next->op == asBC_ADDd ||
+			 curr->next->op == asBC_MULd) &&
+			curr->wArg[0] == curr->next->wArg[1] &&
+			curr->wArg[0] != curr->next->wArg[2] &&         // The variable isn't also the other operand
+			(curr->next->wArg[0] == curr->wArg[0] ||        // The variable is overwritten
+			 (IsTemporary(curr->wArg[0]) &&                 // The variable is temporary and never used again
+			  !IsTempVarRead(curr->next, curr->wArg[0]))) )
+		{
+			if(      curr->next->op == asBC_ADDi64 ) curr->next->op = asBC_ADDIi64;
+			else if( curr->next->op == asBC_MULi64 ) curr->next->op = asBC_MULIi64;
+			else if( curr->next->op == asBC_ADDd   ) curr->next->op = asBC_ADDId;
+			else if( curr->next->op == asBC_MULd   ) curr->next->op = asBC_MULId;
+			curr->next->size = asBCTypeSize[asBCInfo[asBC_ADDIi64].type];
+			curr->next->arg = curr->arg;
+
+			// The order of the operands are changed
+			curr->next->wArg[1] = curr->next->wArg[2];
+
+			*next = GoForward(DeleteInstruction(curr));
+			return true;
+		}
+	}
+
 	// The value is immediately moved to another variable and then not used again
 	if( (asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG ||
 		 asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG) &&
@@ -1190,191 +1280,2174 @@ void asCByteCode::Optimize()
 	}
 }
 
-bool asCByteCode::IsTempVarReadByInstr(asCByteInstruction *curr, int offset)
-{
-	// Which instructions read from variables?
-	if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG &&
-		(int(curr->wArg[1]) == offset || int(curr->wArg[2]) == offset) )
-		return true;
-	else if( (asBCInfo[curr->op].type == asBCTYPE_rW_ARG    ||
-			  asBCInfo[curr->op].type == asBCTYPE_rW_DW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_rW_QW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_rW_W_DW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_rW_DW_DW_ARG ||
-			  curr->op == asBC_FREE) &&  // FREE both read and write to the variable
-			  int(curr->wArg[0]) == offset )
-		return true;
-	else if( (asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG) &&
-			 int(curr->wArg[1]) == offset )
-		return true;
-	else if( asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG &&
-			 (int(curr->wArg[0]) == offset || int(curr->wArg[1]) == offset) )
-		return true;
-	else if( curr->op == asBC_LoadThisR && offset == 0 )
-		return true;
+// The following structures and functions are used by OptimizeDataFlow
 
-	return false;
+// Describes how an instruction accesses the variables
+struct asSVarAccess
+{
+	short  write;        // Offset of the variable that is written
+	short  read[2];      // Offsets of the variables that are read
+	asBYTE readArg[2];   // Index in wArg of each variable that is read
+	asBYTE writeSize;    // Size in dwords of the written value, or 0 if no variable is written
+	asBYTE readSize[2];  // Size in dwords of the read values, or 0 if the operand is not used
+	bool   isInPlace;    // The instruction reads and writes the same variable
+	bool   isPure;       // Writing to the variable is the only effect of the instruction
+};
+
+// Returns the offsets of all the variables that an instruction refers to
+static asUINT GetVarOperands(const asCByteInstruction *instr, short *vars)
+{
+	switch( asBCInfo[instr->op].type )
+	{
+	case asBCTYPE_wW_rW_rW_ARG:
+		vars[0] = instr->wArg[0];
+		vars[1] = instr->wArg[1];
+		vars[2] = instr->wArg[2];
+		return 3;
+
+	case asBCTYPE_wW_rW_ARG:
+	case asBCTYPE_rW_rW_ARG:
+	case asBCTYPE_wW_rW_DW_ARG:
+	case asBCTYPE_wW_rW_QW_ARG:
+		vars[0] = instr->wArg[0];
+		vars[1] = instr->wArg[1];
+		return 2;
+
+	case asBCTYPE_rW_ARG:
+	case asBCTYPE_wW_ARG:
+	case asBCTYPE_wW_W_ARG:
+	case asBCTYPE_rW_DW_ARG:
+	case asBCTYPE_wW_DW_ARG:
+	case asBCTYPE_wW_QW_ARG:
+	case asBCTYPE_rW_QW_ARG:
+	case asBCTYPE_rW_W_DW_ARG:
+	case asBCTYPE_rW_DW_DW_ARG:
+		vars[0] = instr->wArg[0];
+		return 1;
+
+	default:
+		return 0;
+	}
 }
 
-bool asCByteCode::IsInstrJmpOrLabel(asCByteInstruction *curr)
+// Returns false if the instruction refers to variables in a way that is not
+// understood by the data-flow optimizations, e.g. by taking their address
+static bool GetVarAccess(const asCByteInstruction *instr, asSVarAccess &a)
 {
-	if( curr->op == asBC_JS      ||
-		curr->op == asBC_JNS     ||
-		curr->op == asBC_JP      ||
-		curr->op == asBC_JNP     ||
-		curr->op == asBC_JMPP    ||
-		curr->op == asBC_JMP     ||
-		curr->op == asBC_JZ      ||
-		curr->op == asBC_JNZ     ||
-		curr->op == asBC_JLowZ   ||
-		curr->op == asBC_JLowNZ  ||
-		curr->op == asBC_LABEL   )
-		return true;
+	a.writeSize   = 0;
+	a.readSize[0] = 0;
+	a.readSize[1] = 0;
+	a.isInPlace   = false;
+	a.isPure      = true;
 
-	return false;
+	// Size in dwords of the written value and the read values
+	asBYTE w = 0, r0 = 0, r1 = 0;
+
+	switch( instr->op )
+	{
+	// The value is written from a constant, the register, or a global variable
+	case asBC_SetV1:
+	case asBC_SetV2:
+	case asBC_SetV4:
+	case asBC_CpyRtoV4:
+	case asBC_CpyGtoV4:
+	case asBC_RDR1:
+	case asBC_RDR2:
+	case asBC_RDR4:
+		w = 1; break;
+	case asBC_SetV8:
+	case asBC_CpyRtoV8:
+	case asBC_RDR8:
+		w = 2; break;
+
+	// The value is computed from other variables
+	case asBC_DIVi: case asBC_MODi: case asBC_DIVu: case asBC_MODu:
+	case asBC_DIVf: case asBC_MODf:
+	case asBC_POWi: case asBC_POWu: case asBC_POWf:
+		a.isPure = false; // May raise a script exception
+		w = 1; r0 = 1; r1 = 1; break;
+	case asBC_ADDi: case asBC_SUBi: case asBC_MULi:
+	case asBC_ADDf: case asBC_SUBf: case asBC_MULf:
+	case asBC_BAND: case asBC_BOR: case asBC_BXOR:
+	case asBC_BSLL: case asBC_BSRL: case asBC_BSRA:
+		w = 1; r0 = 1; r1 = 1; break;
+	case asBC_DIVd: case asBC_MODd:
+	case asBC_DIVi64: case asBC_MODi64: case asBC_DIVu64: case asBC_MODu64:
+	case asBC_POWd: case asBC_POWi64: case asBC_POWu64:
+		a.isPure = false; // May raise a script exception
+		w = 2; r0 = 2; r1 = 2; break;
+	case asBC_ADDd: case asBC_SUBd: case asBC_MULd:
+	case asBC_ADDi64: case asBC_SUBi64: case asBC_MULi64:
+	case asBC_BAND64: case asBC_BOR64: case asBC_BXOR64:
+		w = 2; r0 = 2; r1 = 2; break;
+	case asBC_POWdi:
+		a.isPure = false; // May raise a script exception
+		w = 2; r0 = 2; r1 = 1; break;
+	case asBC_BSLL64: case asBC_BSRL64: case asBC_BSRA64:
+		w = 2; r0 = 2; r1 = 1; break;
+	case asBC_CpyVtoV4:
+	case asBC_ADDIi: case asBC_SUBIi: case asBC_MULIi:
+	case asBC_ADDIf: case asBC_SUBIf: case asBC_MULIf:
+		w = 1; r0 = 1; break;
+	case asBC_CpyVtoV8:
+	case asBC_ADDIi64: case asBC_SUBIi64: case asBC_MULIi64:
+	case asBC_ADDId: case asBC_SUBId: case asBC_MULId:
+		w = 2; r0 = 2; break;
+	case asBC_dTOi: case asBC_dTOu: case asBC_dTOf:
+	case asBC_i64TOi: case asBC_i64TOf: case asBC_u64TOf:
+		w = 1; r0 = 2; break;
+	case asBC_iTOd: case asBC_uTOd: case asBC_fTOd:
+	case asBC_iTOi64: case asBC_uTOi64: case asBC_fTOi64: case asBC_fTOu64:
+		w = 2; r0 = 1; break;
+
+	// The value is modified in place
+	case asBC_NOT: case asBC_BNOT: case asBC_NEGi: case asBC_NEGf:
+	case asBC_IncVi: case asBC_DecVi:
+	case asBC_iTOf: case asBC_fTOi: case asBC_uTOf: case asBC_fTOu:
+	case asBC_sbTOi: case asBC_swTOi: case asBC_ubTOi: case asBC_uwTOi:
+	case asBC_iTOb: case asBC_iTOw:
+		a.isInPlace = true;
+		w = 1; break;
+	case asBC_NEGd: case asBC_NEGi64: case asBC_BNOT64:
+	case asBC_dTOi64: case asBC_dTOu64: case asBC_i64TOd: case asBC_u64TOd:
+		a.isInPlace = true;
+		w = 2; break;
+
+	// The value is only read
+	case asBC_PshV4:
+	case asBC_CpyVtoR4:
+	case asBC_CpyVtoG4:
+	case asBC_WRTV1: case asBC_WRTV2: case asBC_WRTV4:
+	case asBC_CMPIi: case asBC_CMPIf: case asBC_CMPIu:
+	case asBC_JMPP:
+		r0 = 1; break;
+	case asBC_PshV8:
+	case asBC_CpyVtoR8:
+	case asBC_WRTV8:
+	case asBC_CMPIi64: case asBC_CMPIu64: case asBC_CMPId:
+		r0 = 2; break;
+	case asBC_CMPi: case asBC_CMPu: case asBC_CMPf:
+		r0 = 1; r1 = 1; break;
+	case asBC_CMPd: case asBC_CMPi64: case asBC_CMPu64:
+		r0 = 2; r1 = 2; break;
+
+	default:
+		{
+			// Any other instruction that refers to a variable may access it through a pointer
+			short vars[3];
+			return GetVarOperands(instr, vars) == 0;
+		}
+	}
+
+	if( w )
+	{
+		a.write = instr->wArg[0];
+		a.writeSize = w;
+		if( a.isInPlace )
+		{
+			a.read[0] = instr->wArg[0];
+			a.readArg[0] = 0;
+			a.readSize[0] = w;
+		}
+	}
+
+	// The read operands follow the written operand, if any
+	asBYTE arg = w ? 1 : 0;
+	if( r0 )
+	{
+		a.read[0] = instr->wArg[arg];
+		a.readArg[0] = arg;
+		a.readSize[0] = r0;
+	}
+	if( r1 )
+	{
+		a.read[1] = instr->wArg[arg+1];
+		a.readArg[1] = asBYTE(arg+1);
+		a.readSize[1] = r1;
+	}
+
+	return true;
 }
 
-bool asCByteCode::IsTempVarOverwrittenByInstr(asCByteInstruction *curr, int offset)
+static void ChangeInstr(asCByteInstruction *instr, asEBCInstr op)
 {
-	// Which instructions overwrite the variable or discard it?
-	if( curr->op == asBC_RET     ||
-		curr->op == asBC_SUSPEND )
-		return true;
-	else if( (asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG    ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_ARG       ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_W_ARG     ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG    ||
-			  asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG) &&
-			 int(curr->wArg[0]) == offset )
-		return true;
+	instr->op       = op;
+	instr->size     = asBCTypeSize[asBCInfo[op].type];
+	instr->stackInc = asBCInfo[op].stackInc;
+}
 
-	return false;
+// The value of a variable as seen by the data-flow analysis. A variable may
+// at the same time hold a known constant and be a copy of another variable
+struct asSVarValue
+{
+	enum { UNKNOWN = -2, VARYING = -1 };
+
+	int     constState; // UNKNOWN, VARYING, or 0 if the value is known
+	int     copyOf;     // UNKNOWN, VARYING, or the index of the variable holding the same value
+	asQWORD value;
+};
+
+// The variables that are tracked by the data-flow optimizations
+struct asSDataFlowVars
+{
+	int           minOffset;
+	asCArray<int> index;    // Index of the tracked variable for each offset from minOffset, or -1
+	asCArray<int> offsets;  // Offset of each tracked variable
+	asCArray<asBYTE> sizes; // Size in dwords of each tracked variable
+
+	int Find(int offset) const
+	{
+		offset -= minOffset;
+		if( offset < 0 || offset >= (int)index.GetLength() )
+			return -1;
+		return index[offset];
+	}
+};
+
+struct asSBasicBlock
+{
+	asCByteInstruction *start;
+	asCByteInstruction *end;
+	asCArray<asUINT>    succ;
+	asCArray<asUINT>    pred;
+};
+
+// Returns true if the instruction ends a basic block
+static bool IsBlockEnd(const asCByteInstruction *instr)
+{
+	switch( instr->op )
+	{
+	case asBC_JMP:
+	case asBC_JZ:    case asBC_JNZ:
+	case asBC_JS:    case asBC_JNS:
+	case asBC_JP:    case asBC_JNP:
+	case asBC_JLowZ: case asBC_JLowNZ:
+	case asBC_JMPP:
+	case asBC_RET:
+		return true;
+	default:
+		return false;
+	}
 }
 
-bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
+void asCByteCode::OptimizeDataFlow()
 {
-	TimeIt("asCByteCode::IsTempVarRead");
+	// This function performs the optimizations that require knowledge of how the values flow
+	// through the function, i.e. constant propagation, copy propagation, and removal of dead
+	// stores. Unlike the peephole optimizations that search forward for each instruction, the
+	// control flow graph and the liveness of the variables are computed once for each pass.
 
-	asCArray<asCByteInstruction *> openPaths;
-	asCArray<asCByteInstruction *> closedPaths;
+	TimeIt("asCByteCode::OptimizeDataFlow");
 
-	// We're not interested in the first instruction, since it is the one that sets the variable
-	openPaths.PushLast(curr->next);
+	// The null checks of handles are analysed separately as the handle variables are not tracked
+	RemoveRedundantNullChecks();
 
-	while( openPaths.GetLength() )
+	// The handles that are copied only to be read or moved don't need to update the reference counter
+	RemoveRedundantRefCounting();
+
+	asSDataFlowVars vars;
+	if( !FindTrackedVariables(vars) )
+		return;
+
+	// Each pass may open up for new optimizations in the next, e.g. a propagated
+	// constant makes the original variable dead, which then makes another copy dead
+	for( int pass = 0; pass < 4; pass++ )
 	{
-		curr = openPaths.PopLast();
+		asCArray<asSBasicBlock> blocks;
+		if( !BuildBasicBlocks(blocks) )
+			return;
 
-		// Add the instruction to the closed paths so that we don't verify it again
-		closedPaths.PushLast(curr);
+		bool changed = PropagateValues(blocks, vars);
 
-		while( curr )
-		{
-			if( IsTempVarReadByInstr(curr, offset) )
-				return true;
+		// The blocks must be rebuilt since the instructions may have changed
+		blocks.SetLength(0);
+		if( !BuildBasicBlocks(blocks) )
+			return;
 
-			if( IsTempVarOverwrittenByInstr(curr, offset) ) break;
+		if( RemoveDeadStores(blocks, vars) )
+			changed = true;
 
-			// In case of jumps, we must follow the each of the paths
-			if( curr->op == asBC_JMP )
-			{
-				// Find the destination. If it cannot be found it is because we're doing a localized
-				// optimization and the label hasn't been added to the final bytecode yet
+		if( OptimizeLoops(vars) )
+			changed = true;
 
-				int label = *((int*)ARG_DW(curr->arg));
-				int r = FindLabel(label, curr, &curr, 0);
-				if( r >= 0 &&
-					!closedPaths.Exists(curr) &&
-					!openPaths.Exists(curr) )
-					openPaths.PushLast(curr);
+		if( !changed )
+			break;
+	}
+}
 
-				break;
-			}
-			else if( curr->op == asBC_JZ    || curr->op == asBC_JNZ    ||
-				     curr->op == asBC_JS    || curr->op == asBC_JNS    ||
-					 curr->op == asBC_JP    || curr->op == asBC_JNP    ||
-					 curr->op == asBC_JLowZ || curr->op == asBC_JLowNZ )
-			{
-				// Find the destination. If it cannot be found it is because we're doing a localized
-				// optimization and the label hasn't been added to the final bytecode yet
+bool asCByteCode::FindTrackedVariables(asSDataFlowVars &vars)
+{
+	if( first == 0 ) return false;
 
-				asCByteInstruction *dest = 0;
-				int label = *((int*)ARG_DW(curr->arg));
-				int r = FindLabel(label, curr, &dest, 0);
-				if( r >= 0 &&
-					!closedPaths.Exists(dest) &&
-					!openPaths.Exists(dest) )
-					openPaths.PushLast(dest);
-			}
-			else if( curr->op == asBC_JMPP )
-			{
-				// A JMPP instruction is always followed by a series of JMP instructions
-				// that give the real destination (like a look-up table). We need add all
-				// of these as open paths.
-				curr = curr->next;
-				while( curr->op == asBC_JMP )
-				{
-					// Find the destination. If it cannot be found it is because we're doing a localized
-					// optimization and the label hasn't been added to the final bytecode yet
+	// Find the range of offsets used by the instructions
+	int minOffset = 0, maxOffset = 0;
+	asCByteInstruction *instr;
+	for( instr = first; instr; instr = instr->next )
+	{
+		// The catch block can be reached from any instruction in the try block, which
+		// isn't represented in the control flow graph so such functions are skipped
+		if( instr->op == asBC_TryBlock )
+			return false;
 
-					asCByteInstruction *dest = 0;
-					int label = *((int*)ARG_DW(curr->arg));
-					int r = FindLabel(label, curr, &dest, 0);
-					if( r >= 0 &&
-						!closedPaths.Exists(dest) &&
-						!openPaths.Exists(dest) )
-						openPaths.PushLast(dest);
+		short vars[3];
+		asUINT count = GetVarOperands(instr, vars);
+		for( asUINT n = 0; n < count; n++ )
+		{
+			if( vars[n] > maxOffset ) maxOffset = vars[n];
+			if( vars[n] < minOffset ) minOffset = vars[n];
+		}
+	}
 
-					curr = curr->next;
-				}
+	// Only the variables that are exclusively accessed by instructions with known semantics
+	// are tracked. Any other variable may be accessed through a pointer, e.g. by a called
+	// function, so they are always considered to be alive and to be varying.
+	const asBYTE EXCLUDED = 0xFF;
+	asCArray<asBYTE> sizes;
+	sizes.SetLength(maxOffset-minOffset+1);
+	memset(sizes.AddressOf(), 0, sizes.GetLength());
+	for( instr = first; instr; instr = instr->next )
+	{
+		asSVarAccess a;
+		if( !GetVarAccess(instr, a) )
+		{
+			short vars[3];
+			asUINT count = GetVarOperands(instr, vars);
+			for( asUINT n = 0; n < count; n++ )
+				sizes[vars[n]-minOffset] = EXCLUDED;
+			continue;
+		}
 
-				// We should now be on a label which is the destination of the
-				// first JMP in the sequence and is already added in the open paths
-				asASSERT(curr->op == asBC_LABEL);
-				break;
-			}
+		// LoadThisR reads the object pointer at offset 0 without referring to it
+		if( instr->op == asBC_LoadThisR && minOffset <= 0 && maxOffset >= 0 )
+			sizes[-minOffset] = EXCLUDED;
 
-			curr = curr->next;
+		// The same variable must always be accessed with the same size
+		if( a.writeSize && sizes[a.write-minOffset] != a.writeSize )
+			sizes[a.write-minOffset] = sizes[a.write-minOffset] ? EXCLUDED : a.writeSize;
+		for( asUINT n = 0; n < 2; n++ )
+			if( a.readSize[n] && sizes[a.read[n]-minOffset] != a.readSize[n] )
+				sizes[a.read[n]-minOffset] = sizes[a.read[n]-minOffset] ? EXCLUDED : a.readSize[n];
+	}
+
+	vars.minOffset = minOffset;
+	vars.index.SetLength(sizes.GetLength());
+	for( asUINT n = 0; n < sizes.GetLength(); n++ )
+	{
+		vars.index[n] = -1;
+		if( sizes[n] != 0 && sizes[n] != EXCLUDED )
+		{
+			vars.index[n] = vars.offsets.GetLength();
+			vars.offsets.PushLast(int(n) + minOffset);
+			vars.sizes.PushLast(sizes[n]);
 		}
 	}
 
-	return false;
+	return vars.offsets.GetLength() > 0;
 }
 
-bool asCByteCode::IsTempRegUsed(asCByteInstruction *curr)
+bool asCByteCode::BuildBasicBlocks(asCArray<asSBasicBlock> &blocks)
 {
-	TimeIt("asCByteCode::IsTempRegUsed");
+	// A new block starts at each label and after each instruction that transfers control
+	asCArray<int> labelBlocks;
+	asCByteInstruction *instr;
+	for( instr = first; instr; instr = instr->next )
+	{
+		if( instr == first || instr->op == asBC_LABEL || IsBlockEnd(instr->prev) )
+		{
+			if( blocks.GetLength() )
+				blocks[blocks.GetLength()-1].end = instr->prev;
 
-	// We're not interested in the first instruction, since it is the one that sets the register
-	while( curr->next )
+			blocks.PushLast(asSBasicBlock());
+			blocks[blocks.GetLength()-1].start = instr;
+			blocks[blocks.GetLength()-1].end = 0;
+		}
+
+		if( instr->op == asBC_LABEL )
+		{
+			int label = instr->wArg[0];
+			if( label < 0 )
+				return false;
+			while( labelBlocks.GetLength() <= asUINT(label) )
+				labelBlocks.PushLast(-1);
+			labelBlocks[label] = blocks.GetLength()-1;
+		}
+	}
+	blocks[blocks.GetLength()-1].end = last;
+
+	// Connect the blocks
+	for( asUINT b = 0; b < blocks.GetLength(); b++ )
 	{
-		curr = curr->next;
+		asCByteInstruction *end = blocks[b].end;
+		bool fallThrough = !IsBlockEnd(end);
 
-		// Which instructions read from the register?
-		if( curr->op == asBC_INCi     ||
-			curr->op == asBC_INCi16   ||
-			curr->op == asBC_INCi8    ||
-			curr->op == asBC_INCf     ||
-			curr->op == asBC_INCd     ||
-			curr->op == asBC_DECi     ||
-			curr->op == asBC_DECi16   ||
-			curr->op == asBC_DECi8    ||
-			curr->op == asBC_DECf     ||
-			curr->op == asBC_DECd     ||
-			curr->op == asBC_WRTV1    ||
-			curr->op == asBC_WRTV2    ||
-			curr->op == asBC_WRTV4    ||
-			curr->op == asBC_WRTV8    ||
-			curr->op == asBC_RDR1     ||
-			curr->op == asBC_RDR2     ||
-			curr->op == asBC_RDR4     ||
-			curr->op == asBC_RDR8     ||
-			curr->op == asBC_PshRPtr  ||
-			curr->op == asBC_CpyRtoV4 ||
-			curr->op == asBC_CpyRtoV8 ||
+		if( end->op == asBC_JMPP )
+		{
+			// The JMPP instruction is followed by a table of JMP instructions, one for each possible value
+			asDWORD max = *ARG_DW(end->arg);
+			for( asDWORD n = 0; n <= max; n++ )
+			{
+				if( b+1+n >= blocks.GetLength() || blocks[b+1+n].start->op != asBC_JMP )
+					return false;
+				blocks[b].succ.PushLast(b+1+n);
+			}
+		}
+		else if( IsBlockEnd(end) && end->op != asBC_RET )
+		{
+			int label = *((int*)ARG_DW(end->arg));
+			if( label < 0 || asUINT(label) >= labelBlocks.GetLength() || labelBlocks[label] < 0 )
+				return false;
+			blocks[b].succ.PushLast(labelBlocks[label]);
+
+			// Conditional jumps may also continue with the next instruction
+			if( end->op != asBC_JMP )
+				fallThrough = true;
+		}
+
+		if( fallThrough && b+1 < blocks.GetLength() && !blocks[b].succ.Exists(b+1) )
+			blocks[b].succ.PushLast(b+1);
+
+		for( asUINT n = 0; n < blocks[b].succ.GetLength(); n++ )
+			blocks[blocks[b].succ[n]].pred.PushLast(b);
+	}
+
+	return true;
+}
+
+// Updates the values of the variables after the instruction is executed
+static void UpdateVarValues(const asCByteInstruction *instr, const asSDataFlowVars &vars, asSVarValue *values)
+{
+	asSVarAccess a;
+	if( !GetVarAccess(instr, a) || a.writeSize == 0 )
+		return;
+
+	int v = vars.Find(a.write);
+	if( v < 0 )
+		return;
+
+	// The operands of the instruction, if tracked
+	int src[2] = {-1, -1};
+	for( asUINT n = 0; n < 2; n++ )
+		if( a.readSize[n] )
+			src[n] = vars.Find(a.read[n]);
+
+	asSVarValue nv;
+	nv.constState = asSVarValue::VARYING;
+	nv.copyOf     = asSVarValue::VARYING;
+	nv.value      = 0;
+
+	switch( instr->op )
+	{
+	case asBC_SetV4:
+		nv.constState = 0;
+		nv.value = *ARG_DW(instr->arg);
+		break;
+	case asBC_SetV8:
+		nv.constState = 0;
+		nv.value = *ARG_QW(instr->arg);
+		break;
+	case asBC_CpyVtoV4:
+	case asBC_CpyVtoV8:
+		if( src[0] == v )
+			return; // The value doesn't change
+		if( src[0] >= 0 )
+		{
+			nv.constState = values[src[0]].constState;
+			nv.value      = values[src[0]].value;
+			nv.copyOf     = src[0];
+		}
+		break;
+	case asBC_ADDi: case asBC_SUBi: case asBC_MULi:
+	case asBC_BAND: case asBC_BOR: case asBC_BXOR:
+		if( src[0] >= 0 && src[1] >= 0 )
+		{
+			const asSVarValue &l = values[src[0]];
+			const asSVarValue &r = values[src[1]];
+			if( l.constState == asSVarValue::UNKNOWN || r.constState == asSVarValue::UNKNOWN )
+				nv.constState = asSVarValue::UNKNOWN;
+			else if( l.constState == 0 && r.constState == 0 )
+			{
+				asDWORD lv = asDWORD(l.value), rv = asDWORD(r.value);
+				nv.constState = 0;
+				switch( instr->op )
+				{
+				case asBC_ADDi: nv.value = asDWORD(lv + rv); break;
+				case asBC_SUBi: nv.value = asDWORD(lv - rv); break;
+				case asBC_MULi: nv.value = asDWORD(lv * rv); break;
+				case asBC_BAND: nv.value = lv & rv; break;
+				case asBC_BOR:  nv.value = lv | rv; break;
+				default:        nv.value = lv ^ rv; break;
+				}
+			}
+		}
+		break;
+	case asBC_ADDIi: case asBC_SUBIi: case asBC_MULIi:
+		if( src[0] >= 0 )
+		{
+			const asSVarValue &l = values[src[0]];
+			nv.constState = l.constState;
+			if( l.constState == 0 )
+			{
+				asDWORD lv = asDWORD(l.value), rv = *ARG_DW(instr->arg);
+				if(      instr->op == asBC_ADDIi ) nv.value = asDWORD(lv + rv);
+				else if( instr->op == asBC_SUBIi ) nv.value = asDWORD(lv - rv);
+				else                               nv.value = asDWORD(lv * rv);
+			}
+		}
+		break;
+	case asBC_ADDi64: case asBC_SUBi64: case asBC_MULi64:
+	case asBC_BAND64: case asBC_BOR64: case asBC_BXOR64:
+		if( src[0] >= 0 && src[1] >= 0 )
+		{
+			const asSVarValue &l = values[src[0]];
+			const asSVarValue &r = values[src[1]];
+			if( l.constState == asSVarValue::UNKNOWN || r.constState == asSVarValue::UNKNOWN )
+				nv.constState = asSVarValue::UNKNOWN;
+			else if( l.constState == 0 && r.constState == 0 )
+			{
+				nv.constState = 0;
+				switch( instr->op )
+				{
+				case asBC_ADDi64: nv.value = l.value + r.value; break;
+				case asBC_SUBi64: nv.value = l.value - r.value; break;
+				case asBC_MULi64: nv.value = l.value * r.value; break;
+				case asBC_BAND64: nv.value = l.value & r.value; break;
+				case asBC_BOR64:  nv.value = l.value | r.value; break;
+				default:          nv.value = l.value ^ r.value; break;
+				}
+			}
+		}
+		break;
+	case asBC_ADDIi64: case asBC_SUBIi64: case asBC_MULIi64:
+		if( src[0] >= 0 )
+		{
+			const asSVarValue &l = values[src[0]];
+			nv.constState = l.constState;
+			if( l.constState == 0 )
+			{
+				asQWORD rv = *ARG_QW(instr->arg);
+				if(      instr->op == asBC_ADDIi64 ) nv.value = l.value + rv;
+				else if( instr->op == asBC_SUBIi64 ) nv.value = l.value - rv;
+				else                                 nv.value = l.value * rv;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Any variable that was a copy of the overwritten variable no longer is
+	for( asUINT n = 0; n < vars.offsets.GetLength(); n++ )
+		if( values[n].copyOf == v )
+			values[n].copyOf = asSVarValue::VARYING;
+
+	values[v] = nv;
+}
+
+// Merges the value seen on one path into the value seen on other paths
+static bool MergeVarValue(asSVarValue &to, const asSVarValue &from)
+{
+	bool changed = false;
+
+	if( from.constState != asSVarValue::UNKNOWN && to.constState != asSVarValue::VARYING )
+	{
+		if( to.constState == asSVarValue::UNKNOWN )
+		{
+			to.constState = from.constState;
+			to.value = from.value;
+			changed = true;
+		}
+		else if( from.constState == asSVarValue::VARYING || from.value != to.value )
+		{
+			to.constState = asSVarValue::VARYING;
+			changed = true;
+		}
+	}
+
+	if( from.copyOf != asSVarValue::UNKNOWN && to.copyOf != asSVarValue::VARYING && to.copyOf != from.copyOf )
+	{
+		to.copyOf = to.copyOf == asSVarValue::UNKNOWN ? from.copyOf : int(asSVarValue::VARYING);
+		changed = true;
+	}
+
+	return changed;
+}
+
+bool asCByteCode::PropagateValues(asCArray<asSBasicBlock> &blocks, const asSDataFlowVars &vars)
+{
+	TimeIt("asCByteCode::PropagateValues");
+
+	asUINT numVars = vars.offsets.GetLength();
+	asUINT numBlocks = blocks.GetLength();
+
+	// Avoid excessive memory use for very large functions
+	if( asQWORD(numVars) * numBlocks > 250000 )
+		return false;
+
+	// Compute the values of the variables at the entry of each block. The values are unknown
+	// until a path reaches them, except at the entry of the function where all are varying
+	asCArray<asSVarValue> blockIn;
+	blockIn.SetLength(numVars * numBlocks);
+	for( asUINT n = 0; n < blockIn.GetLength(); n++ )
+	{
+		asSVarValue &val = blockIn[n];
+		val.constState = n < numVars ? asSVarValue::VARYING : asSVarValue::UNKNOWN;
+		val.copyOf     = n < numVars ? asSVarValue::VARYING : asSVarValue::UNKNOWN;
+		val.value      = 0;
+	}
+
+	asCArray<asSVarValue> values;
+	values.SetLength(numVars);
+	asCArray<asUINT> workList;
+	asCArray<bool> inWorkList;
+	inWorkList.SetLength(numBlocks);
+	for( asUINT b = 0; b < numBlocks; b++ )
+		inWorkList[b] = false;
+	workList.PushLast(0);
+	inWorkList[0] = true;
+
+	while( workList.GetLength() )
+	{
+		asUINT b = workList.PopLast();
+		inWorkList[b] = false;
+
+		memcpy(values.AddressOf(), &blockIn[b*numVars], numVars*sizeof(asSVarValue));
+		for( asCByteInstruction *instr = blocks[b].start; ; instr = instr->next )
+		{
+			UpdateVarValues(instr, vars, values.AddressOf());
+			if( instr == blocks[b].end ) break;
+		}
+
+		for( asUINT s = 0; s < blocks[b].succ.GetLength(); s++ )
+		{
+			asUINT succ = blocks[b].succ[s];
+			bool changed = false;
+			for( asUINT v = 0; v < numVars; v++ )
+				if( MergeVarValue(blockIn[succ*numVars+v], values[v]) )
+					changed = true;
+
+			if( changed && !inWorkList[succ] )
+			{
+				workList.PushLast(succ);
+				inWorkList[succ] = true;
+			}
+		}
+	}
+
+	// Rewrite the instructions to use the known values
+	bool changed = false;
+	for( asUINT b = 0; b < numBlocks; b++ )
+	{
+		memcpy(values.AddressOf(), &blockIn[b*numVars], numVars*sizeof(asSVarValue));
+		for( asCByteInstruction *instr = blocks[b].start; ; instr = instr->next )
+		{
+			asSVarAccess a;
+			if( GetVarAccess(instr, a) && !a.isInPlace )
+			{
+				// Read from the original variable rather than the copy, so the copy can be removed
+				int src[2] = {-1, -1};
+				for( asUINT n = 0; n < 2; n++ )
+				{
+					if( a.readSize[n] == 0 )
+						continue;
+
+					src[n] = vars.Find(a.read[n]);
+					if( src[n] >= 0 && values[src[n]].copyOf >= 0 )
+					{
+						src[n] = values[src[n]].copyOf;
+						instr->wArg[a.readArg[n]] = short(vars.offsets[src[n]]);
+						changed = true;
+					}
+				}
+
+				if( RewriteWithConstants(instr, src, values.AddressOf()) )
+					changed = true;
+			}
+
+			UpdateVarValues(instr, vars, values.AddressOf());
+			if( instr == blocks[b].end ) break;
+		}
+	}
+
+	return changed;
+}
+
+// Replaces a 64bit integer operation on known constants with the assignment of the result
+static bool FoldConstant64(asCByteInstruction *instr, asQWORD l, asQWORD r)
+{
+	asQWORD result;
+	switch( instr->op )
+	{
+	case asBC_ADDi64: case asBC_ADDIi64: result = l + r; break;
+	case asBC_SUBi64: case asBC_SUBIi64: result = l - r; break;
+	case asBC_MULi64: case asBC_MULIi64: result = l * r; break;
+	case asBC_BAND64: result = l & r; break;
+	case asBC_BOR64:  result = l | r; break;
+	default:          result = l ^ r; break;
+	}
+
+	ChangeInstr(instr, asBC_SetV8);
+	*ARG_QW(instr->arg) = result;
+	return true;
+}
+
+bool asCByteCode::RewriteWithConstants(asCByteInstruction *instr, const int *src, const asSVarValue *values)
+{
+	bool isConst0 = src[0] >= 0 && values[src[0]].constState == 0;
+	bool isConst1 = src[1] >= 0 && values[src[1]].constState == 0;
+	if( !isConst0 && !isConst1 )
+		return false;
+
+	asQWORD c0 = isConst0 ? values[src[0]].value : 0;
+	asQWORD c1 = isConst1 ? values[src[1]].value : 0;
+
+	switch( instr->op )
+	{
+	case asBC_CpyVtoV4:
+		// CpyVtoV4 a, b where b is constant -> SetV4 a, c
+		ChangeInstr(instr, asBC_SetV4);
+		*ARG_DW(instr->arg) = asDWORD(c0);
+		return true;
+	case asBC_CpyVtoV8:
+		ChangeInstr(instr, asBC_SetV8);
+		*ARG_QW(instr->arg) = c0;
+		return true;
+	case asBC_PshV4:
+		ChangeInstr(instr, asBC_PshC4);
+		*ARG_DW(instr->arg) = asDWORD(c0);
+		return true;
+	case asBC_PshV8:
+		ChangeInstr(instr, asBC_PshC8);
+		*ARG_QW(instr->arg) = c0;
+		return true;
+
+	case asBC_CMPi:
+	case asBC_CMPu:
+	case asBC_CMPf:
+		// The comparison isn't symmetric so only the right operand can be replaced
+		if( !isConst1 ) return false;
+		if(      instr->op == asBC_CMPi ) ChangeInstr(instr, asBC_CMPIi);
+		else if( instr->op == asBC_CMPu ) ChangeInstr(instr, asBC_CMPIu);
+		else                              ChangeInstr(instr, asBC_CMPIf);
+		*ARG_DW(instr->arg) = asDWORD(c1);
+		return true;
+
+	case asBC_ADDi: case asBC_SUBi: case asBC_MULi:
+	case asBC_ADDf: case asBC_SUBf: case asBC_MULf:
+		// Integer operations with constant operands are already
+		// resolved, so these can be replaced with a simple assignment
+		if( isConst0 && isConst1 && (instr->op == asBC_ADDi || instr->op == asBC_SUBi || instr->op == asBC_MULi) )
+			break;
+		if( !isConst1 )
+		{
+			// Only the commutative operations can swap the operands
+			if( instr->op == asBC_SUBi || instr->op == asBC_SUBf )
+				return false;
+			instr->wArg[1] = instr->wArg[2];
+			c1 = c0;
+		}
+		switch( instr->op )
+		{
+		case asBC_ADDi: ChangeInstr(instr, asBC_ADDIi); break;
+		case asBC_SUBi: ChangeInstr(instr, asBC_SUBIi); break;
+		case asBC_MULi: ChangeInstr(instr, asBC_MULIi); break;
+		case asBC_ADDf: ChangeInstr(instr, asBC_ADDIf); break;
+		case asBC_SUBf: ChangeInstr(instr, asBC_SUBIf); break;
+		default:        ChangeInstr(instr, asBC_MULIf); break;
+		}
+		*ARG_DW(instr->arg) = asDWORD(c1);
+		return true;
+
+	case asBC_CMPi64:
+	case asBC_CMPu64:
+	case asBC_CMPd:
+		if( !isConst1 ) return false;
+		if(      instr->op == asBC_CMPi64 ) ChangeInstr(instr, asBC_CMPIi64);
+		else if( instr->op == asBC_CMPu64 ) ChangeInstr(instr, asBC_CMPIu64);
+		else                                ChangeInstr(instr, asBC_CMPId);
+		*ARG_QW(instr->arg) = c1;
+		return true;
+
+	case asBC_ADDi64: case asBC_SUBi64: case asBC_MULi64:
+	case asBC_ADDd: case asBC_SUBd: case asBC_MULd:
+		if( isConst0 && isConst1 && (instr->op == asBC_ADDi64 || instr->op == asBC_SUBi64 || instr->op == asBC_MULi64) )
+			return FoldConstant64(instr, c0, c1);
+		if( !isConst1 )
+		{
+			if( instr->op == asBC_SUBi64 || instr->op == asBC_SUBd )
+				return false;
+			instr->wArg[1] = instr->wArg[2];
+			c1 = c0;
+		}
+		switch( instr->op )
+		{
+		case asBC_ADDi64: ChangeInstr(instr, asBC_ADDIi64); break;
+		case asBC_SUBi64: ChangeInstr(instr, asBC_SUBIi64); break;
+		case asBC_MULi64: ChangeInstr(instr, asBC_MULIi64); break;
+		case asBC_ADDd:   ChangeInstr(instr, asBC_ADDId); break;
+		case asBC_SUBd:   ChangeInstr(instr, asBC_SUBId); break;
+		default:          ChangeInstr(instr, asBC_MULId); break;
+		}
+		*ARG_QW(instr->arg) = c1;
+		return true;
+
+	case asBC_BAND64: case asBC_BOR64: case asBC_BXOR64:
+		if( isConst0 && isConst1 )
+			return FoldConstant64(instr, c0, c1);
+		return false;
+
+	case asBC_ADDIi64: case asBC_SUBIi64: case asBC_MULIi64:
+		if( isConst0 )
+			return FoldConstant64(instr, c0, *ARG_QW(instr->arg));
+		return false;
+
+	case asBC_BAND: case asBC_BOR: case asBC_BXOR:
+		if( isConst0 && isConst1 )
+			break;
+		return false;
+
+	case asBC_ADDIi: case asBC_SUBIi: case asBC_MULIi:
+		if( isConst0 )
+			break;
+		return false;
+
+	default:
+		return false;
+	}
+
+	// The result is a known constant
+	asDWORD l = asDWORD(c0), r = asDWORD(c1), result;
+	switch( instr->op )
+	{
+	case asBC_ADDi:  result = l + r; break;
+	case asBC_SUBi:  result = l - r; break;
+	case asBC_MULi:  result = l * r; break;
+	case asBC_BAND:  result = l & r; break;
+	case asBC_BOR:   result = l | r; break;
+	case asBC_BXOR:  result = l ^ r; break;
+	case asBC_ADDIi: result = l + *ARG_DW(instr->arg); break;
+	case asBC_SUBIi: result = l - *ARG_DW(instr->arg); break;
+	default:         result = l * *ARG_DW(instr->arg); break;
+	}
+
+	ChangeInstr(instr, asBC_SetV4);
+	*ARG_DW(instr->arg) = result;
+	return true;
+}
+
+// Computes the tracked variables that are alive at the entry and at the exit of each block
+static void ComputeLiveness(const asCArray<asSBasicBlock> &blocks, const asSDataFlowVars &vars, asCArray<asDWORD> &liveIn, asCArray<asDWORD> &liveOut)
+{
+	asUINT numVars = vars.offsets.GetLength();
+	asUINT numBlocks = blocks.GetLength();
+	asUINT words = (numVars + 31) / 32;
+
+	// Compute the variables read before being written (gen), and the variables written (kill) in each block
+	asCArray<asDWORD> gen, kill;
+	gen.SetLength(numBlocks * words);
+	kill.SetLength(numBlocks * words);
+	liveIn.SetLength(numBlocks * words);
+	liveOut.SetLength(numBlocks * words);
+	memset(gen.AddressOf(), 0, gen.GetLength()*sizeof(asDWORD));
+	memset(kill.AddressOf(), 0, kill.GetLength()*sizeof(asDWORD));
+	memset(liveIn.AddressOf(), 0, liveIn.GetLength()*sizeof(asDWORD));
+	memset(liveOut.AddressOf(), 0, liveOut.GetLength()*sizeof(asDWORD));
+
+	asUINT b;
+	for( b = 0; b < numBlocks; b++ )
+	{
+		asDWORD *g = &gen[b*words], *k = &kill[b*words];
+		for( asCByteInstruction *instr = blocks[b].end; ; instr = instr->prev )
+		{
+			asSVarAccess a;
+			if( GetVarAccess(instr, a) )
+			{
+				int v = a.writeSize ? vars.Find(a.write) : -1;
+				if( v >= 0 )
+				{
+					g[v/32] &= ~(1u << (v%32));
+					k[v/32] |= 1u << (v%32);
+				}
+				for( asUINT n = 0; n < 2; n++ )
+				{
+					int r = a.readSize[n] ? vars.Find(a.read[n]) : -1;
+					if( r >= 0 )
+						g[r/32] |= 1u << (r%32);
+				}
+			}
+			if( instr == blocks[b].start ) break;
+		}
+	}
+
+	// Solve the liveness equations, in = gen | (out & ~kill), visiting the blocks backwards to converge faster
+	bool changed = true;
+	while( changed )
+	{
+		changed = false;
+		for( b = numBlocks; b-- > 0; )
+		{
+			asDWORD *out = &liveOut[b*words];
+			for( asUINT s = 0; s < blocks[b].succ.GetLength(); s++ )
+			{
+				const asDWORD *in = &liveIn[blocks[b].succ[s]*words];
+				for( asUINT w = 0; w < words; w++ )
+					out[w] |= in[w];
+			}
+
+			asDWORD *in = &liveIn[b*words];
+			for( asUINT w = 0; w < words; w++ )
+			{
+				asDWORD newIn = gen[b*words+w] | (out[w] & ~kill[b*words+w]);
+				if( newIn != in[w] )
+				{
+					in[w] = newIn;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+bool asCByteCode::RemoveDeadStores(asCArray<asSBasicBlock> &blocks, const asSDataFlowVars &vars)
+{
+	TimeIt("asCByteCode::RemoveDeadStores");
+
+	asUINT numVars = vars.offsets.GetLength();
+	asUINT numBlocks = blocks.GetLength();
+	asUINT words = (numVars + 31) / 32;
+
+	asCArray<asDWORD> liveIn, liveOut;
+	ComputeLiveness(blocks, vars, liveIn, liveOut);
+
+	// Remove the instructions whose only effect is to write a value that is never read
+	bool removed = false;
+	asCArray<asDWORD> live;
+	live.SetLength(words);
+	for( asUINT b = 0; b < numBlocks; b++ )
+	{
+		memcpy(live.AddressOf(), &liveOut[b*words], words*sizeof(asDWORD));
+		for( asCByteInstruction *instr = blocks[b].end; ; )
+		{
+			asCByteInstruction *prev = instr->prev;
+			bool isStart = instr == blocks[b].start;
+
+			asSVarAccess a;
+			if( GetVarAccess(instr, a) )
+			{
+				int v = a.writeSize ? vars.Find(a.write) : -1;
+
+				// For a copy, the variable copied from if it is not read afterwards
+				int src = -1;
+				if( instr->op == asBC_CpyVtoV4 || instr->op == asBC_CpyVtoV8 )
+				{
+					src = vars.Find(a.read[0]);
+					if( src >= 0 && (live[src/32] & (1u << (src%32))) )
+						src = -1;
+				}
+
+				asSVarAccess p;
+				if( v >= 0 && a.isPure && !(live[v/32] & (1u << (v%32))) )
+				{
+					DeleteInstruction(instr);
+					removed = true;
+				}
+				else if( (instr->op == asBC_CpyVtoV4 || instr->op == asBC_CpyVtoV8) && a.write == a.read[0] )
+				{
+					// The variable is copied to itself
+					DeleteInstruction(instr);
+					removed = true;
+				}
+				else if( src >= 0 && !isStart && GetVarAccess(prev, p) && !p.isInPlace &&
+						 p.writeSize == a.writeSize && p.write == a.read[0] )
+				{
+					// The value is computed in a variable only to be copied to
+					// another, so it is better to compute it in the other directly
+					prev->wArg[0] = instr->wArg[0];
+					DeleteInstruction(instr);
+					removed = true;
+				}
+				else
+				{
+					if( v >= 0 )
+						live[v/32] &= ~(1u << (v%32));
+					for( asUINT n = 0; n < 2; n++ )
+					{
+						int r = a.readSize[n] ? vars.Find(a.read[n]) : -1;
+						if( r >= 0 )
+							live[r/32] |= 1u << (r%32);
+					}
+				}
+			}
+
+			if( isStart ) break;
+			instr = prev;
+		}
+	}
+
+	return removed;
+}
+
+// Returns true if the instruction raises an exception unless the handle held by the variable
+// is non-null, so the variable is known to refer to an object once the instruction is done
+static bool IsNullCheckOfVar(asCScriptEngine *engine, const asCByteInstruction *instr, short &var)
+{
+	switch( instr->op )
+	{
+	case asBC_ChkNullV:
+	case asBC_LoadRObjR:
+		var = instr->wArg[0];
+		return true;
+
+	// These verify the object pointer on the top of the stack
+	case asBC_ChkNullS:
+	case asBC_ADDSi:
+	case asBC_CALLINTF:
+	case asBC_Thiscall1:
+	case asBC_CALL:
+		if( instr->prev == 0 || instr->prev->op != asBC_PshVPtr )
+			return false;
+		if( instr->op == asBC_ChkNullS && instr->wArg[0] != 0 )
+			return false;
+		if( instr->op == asBC_CALL )
+		{
+			// Only class methods have the object pointer on the top of the stack
+			asCScriptFunction *func = engine->scriptFunctions[*(int*)ARG_DW(instr->arg)];
+			if( func == 0 || func->objectType == 0 )
+				return false;
+		}
+		var = instr->prev->wArg[0];
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void asCByteCode::RemoveRedundantNullChecks()
+{
+	// A handle is known to be non-null after it has been verified by an instruction,
+	// until it is modified again. If that is true in all paths that reach a null check
+	// of the same handle, then the check is redundant and can be removed.
+
+	TimeIt("asCByteCode::RemoveRedundantNullChecks");
+
+	if( first == 0 ) return;
+
+	int minOffset = 0, maxOffset = 0;
+	asCByteInstruction *instr;
+	for( instr = first; instr; instr = instr->next )
+	{
+		// The catch block isn't represented in the control flow graph
+		if( instr->op == asBC_TryBlock )
+			return;
+
+		short vars[3];
+		asUINT count = GetVarOperands(instr, vars);
+		for( asUINT n = 0; n < count; n++ )
+		{
+			if( vars[n] > maxOffset ) maxOffset = vars[n];
+			if( vars[n] < minOffset ) minOffset = vars[n];
+		}
+	}
+
+	// Only handles that are accessed by the instructions below can be analysed. If the
+	// address of the variable is taken it may be modified by a called function.
+	const asBYTE READ = 1, WRITE = 2, EXCLUDED = 4;
+	asCArray<asBYTE> access;
+	access.SetLength(maxOffset-minOffset+1);
+	memset(access.AddressOf(), 0, access.GetLength());
+	for( instr = first; instr; instr = instr->next )
+	{
+		short vars[3];
+		asUINT count = GetVarOperands(instr, vars);
+		if( count == 0 )
+			continue;
+
+		switch( instr->op )
+		{
+		case asBC_PshVPtr:
+		case asBC_ChkNullV:
+		case asBC_LoadRObjR:
+			access[vars[0]-minOffset] |= READ;
+			break;
+		case asBC_RefCpyV:
+		case asBC_ClrVPtr:
+		case asBC_FREE:
+		case asBC_STOREOBJ:
+			access[vars[0]-minOffset] |= WRITE;
+			break;
+		default:
+			for( asUINT n = 0; n < count; n++ )
+				access[vars[n]-minOffset] |= EXCLUDED;
+		}
+	}
+
+	asCArray<int> index;
+	index.SetLength(access.GetLength());
+	asUINT numVars = 0;
+	for( asUINT n = 0; n < access.GetLength(); n++ )
+		index[n] = (access[n] & READ) && !(access[n] & EXCLUDED) ? int(numVars++) : -1;
+	if( numVars == 0 )
+		return;
+
+	asCArray<asSBasicBlock> blocks;
+	if( !BuildBasicBlocks(blocks) )
+		return;
+
+	asUINT numBlocks = blocks.GetLength();
+	asUINT words = (numVars + 31) / 32;
+
+	// Compute the handles verified (gen) and the handles modified (kill) in each block
+	asCArray<asDWORD> gen, kill, checkedIn, checkedOut;
+	gen.SetLength(numBlocks * words);
+	kill.SetLength(numBlocks * words);
+	checkedIn.SetLength(numBlocks * words);
+	checkedOut.SetLength(numBlocks * words);
+	memset(gen.AddressOf(), 0, gen.GetLength()*sizeof(asDWORD));
+	memset(kill.AddressOf(), 0, kill.GetLength()*sizeof(asDWORD));
+	memset(checkedIn.AddressOf(), 0, checkedIn.GetLength()*sizeof(asDWORD));
+	memset(checkedOut.AddressOf(), 0xFF, checkedOut.GetLength()*sizeof(asDWORD));
+
+	asUINT b;
+	for( b = 0; b < numBlocks; b++ )
+	{
+		asDWORD *g = &gen[b*words], *k = &kill[b*words];
+		for( instr = blocks[b].start; ; instr = instr->next )
+		{
+			short var;
+			int v;
+			if( IsNullCheckOfVar(engine, instr, var) && (v = index[var-minOffset]) >= 0 )
+				g[v/32] |= 1u << (v%32);
+			else if( (instr->op == asBC_RefCpyV || instr->op == asBC_ClrVPtr || instr->op == asBC_FREE || instr->op == asBC_STOREOBJ) &&
+					 (v = index[instr->wArg[0]-minOffset]) >= 0 )
+			{
+				g[v/32] &= ~(1u << (v%32));
+				k[v/32] |= 1u << (v%32);
+			}
+			if( instr == blocks[b].end ) break;
+		}
+	}
+
+	// Solve the equations, in = intersection of the predecessors' out, out = gen | (in & ~kill).
+	// The function entry, and any block without predecessors, starts with no verified handles
+	bool changed = true;
+	while( changed )
+	{
+		changed = false;
+		for( b = 0; b < numBlocks; b++ )
+		{
+			asDWORD *in = &checkedIn[b*words];
+			for( asUINT w = 0; w < words; w++ )
+			{
+				asDWORD meet = (b == 0 || blocks[b].pred.GetLength() == 0) ? 0 : 0xFFFFFFFF;
+				for( asUINT p = 0; p < blocks[b].pred.GetLength() && b != 0; p++ )
+					meet &= checkedOut[blocks[b].pred[p]*words+w];
+				in[w] = meet;
+
+				asDWORD newOut = gen[b*words+w] | (meet & ~kill[b*words+w]);
+				if( newOut != checkedOut[b*words+w] )
+				{
+					checkedOut[b*words+w] = newOut;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	// Remove the checks of handles that have already been verified
+	asCArray<asCByteInstruction*> remove;
+	asCArray<asDWORD> checked;
+	checked.SetLength(words);
+	for( b = 0; b < numBlocks; b++ )
+	{
+		memcpy(checked.AddressOf(), &checkedIn[b*words], words*sizeof(asDWORD));
+		for( instr = blocks[b].start; ; instr = instr->next )
+		{
+			short var;
+			int v;
+			if( IsNullCheckOfVar(engine, instr, var) && (v = index[var-minOffset]) >= 0 )
+			{
+				if( (checked[v/32] & (1u << (v%32))) && (instr->op == asBC_ChkNullV || instr->op == asBC_ChkNullS) )
+					remove.PushLast(instr);
+				checked[v/32] |= 1u << (v%32);
+			}
+			else if( (instr->op == asBC_RefCpyV || instr->op == asBC_ClrVPtr || instr->op == asBC_FREE || instr->op == asBC_STOREOBJ) &&
+					 (v = index[instr->wArg[0]-minOffset]) >= 0 )
+				checked[v/32] &= ~(1u << (v%32));
+			if( instr == blocks[b].end ) break;
+		}
+	}
+
+	for( asUINT n = 0; n < remove.GetLength(); n++ )
+		DeleteInstruction(remove[n]);
+}
+
+// Returns true if the instruction refers to the variable
+static bool RefersToVar(const asCByteInstruction *instr, short var)
+{
+	short vars[3];
+	asUINT count = GetVarOperands(instr, vars);
+	for( asUINT n = 0; n < count; n++ )
+		if( vars[n] == var )
+			return true;
+	return false;
+}
+
+// Returns true if the instruction only reads the handle held in the variable
+static bool IsReadOfHandle(const asCByteInstruction *instr)
+{
+	switch( instr->op )
+	{
+	case asBC_PshVPtr:
+	case asBC_ChkNullV:
+	case asBC_LoadRObjR:
+	case asBC_CmpPtr:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Returns true if the RefCpyV updates the reference counter of the object
+static bool IsCountedRefCopy(const asCByteInstruction *instr)
+{
+	if( instr == 0 || instr->op != asBC_RefCpyV )
+		return false;
+	asCObjectType *ot = reinterpret_cast<asCObjectType*>(*ARG_PTR(instr->arg));
+	return (ot->flags & asOBJ_REF) && !(ot->flags & asOBJ_NOCOUNT);
+}
+
+// Returns the FREE of the variable if that is the next instruction to refer to it in the
+// straight-line code following the given instruction, i.e. the value held in the variable
+// is not used anymore. Labels are allowed as long as the caller keeps the FREE instruction
+static asCByteInstruction *FindReleaseOfVar(asCByteInstruction *from, short var, bool &crossedLabel)
+{
+	crossedLabel = false;
+	for( asCByteInstruction *instr = from->next; instr; instr = instr->next )
+	{
+		if( RefersToVar(instr, var) )
+			return instr->op == asBC_FREE ? instr : 0;
+		if( IsBlockEnd(instr) )
+			return 0;
+		if( instr->op == asBC_LABEL )
+			crossedLabel = true;
+	}
+	return 0;
+}
+
+void asCByteCode::RemoveRedundantRefCounting()
+{
+	// When a handle is copied the object's reference counter is incremented, and when the copy
+	// is freed it is decremented again. When the original variable holds on to the object during
+	// the whole life time of the copy the copy can borrow the reference, and when the original
+	// variable is released right after the copy is made the reference can be moved instead.
+	// The life time of the objects must not change, so references are never moved to a function
+	// that is called while the variable is still in scope.
+
+	TimeIt("asCByteCode::RemoveRedundantRefCounting");
+
+	asCByteInstruction *instr;
+	for( instr = first; instr; instr = instr->next )
+	{
+		// The catch block isn't represented in the straight-line code
+		if( instr->op == asBC_TryBlock )
+			return;
+	}
+
+	for( instr = first; instr; )
+	{
+		asCByteInstruction *copy = instr->next;
+		if( instr->op != asBC_PshVPtr || !IsCountedRefCopy(copy) || copy->next == 0 )
+		{
+			instr = instr->next;
+			continue;
+		}
+
+		short src = instr->wArg[0];
+		short dst = copy->wArg[0];
+		asCByteInstruction *next = copy->next;
+		bool crossedLabel;
+
+		// PshVPtr t, RefCpyV d, FREE t, PopPtr -> FREE d, LOADOBJ t, STOREOBJ d
+		// The temporary handle is moved to the destination instead of being copied and freed
+		if( next->op == asBC_FREE && next->wArg[0] == src && src != dst &&
+			next->next && next->next->op == asBC_PopPtr )
+		{
+			ChangeInstr(copy, asBC_FREE);
+			ChangeInstr(next, asBC_LOADOBJ);
+			ChangeInstr(next->next, asBC_STOREOBJ);
+			next->next->wArg[0] = dst;
+			instr = DeleteInstruction(instr);
+			continue;
+		}
+
+		if( next->op != asBC_PopPtr || src == dst || !IsTemporary(dst) )
+		{
+			instr = instr->next;
+			continue;
+		}
+
+		asCByteInstruction *use = next->next;
+		while( use && !RefersToVar(use, dst) && !IsBlockEnd(use) && use->op != asBC_LABEL )
+		{
+			// The original handle may be read while the copy is alive, but not modified
+			if( RefersToVar(use, src) && !IsReadOfHandle(use) )
+				break;
+			use = use->next;
+		}
+		if( use == 0 || !RefersToVar(use, dst) )
+		{
+			instr = instr->next;
+			continue;
+		}
+
+		// PshVPtr a, RefCpyV t, PopPtr, LOADOBJ t, FREE a -> LOADOBJ a
+		// The handle in the variable is returned instead of a new reference to the same object
+		asCByteInstruction *release;
+		if( use->op == asBC_LOADOBJ && (release = FindReleaseOfVar(use, src, crossedLabel)) != 0 )
+		{
+			use->wArg[0] = src;
+			if( !crossedLabel )
+				DeleteInstruction(release);
+			DeleteInstruction(next);
+			DeleteInstruction(copy);
+			instr = DeleteInstruction(instr);
+			continue;
+		}
+
+		// PshVPtr a, RefCpyV t, PopPtr, {reads of t}, FREE t -> {reads of a}
+		// The copy is only read while the original handle keeps the object alive so it can borrow it
+		asCByteInstruction *end = use;
+		for( ; end && !IsBlockEnd(end) && end->op != asBC_LABEL; end = end->next )
+		{
+			bool usesDst = RefersToVar(end, dst), usesSrc = RefersToVar(end, src);
+			if( end->op == asBC_FREE && end->wArg[0] == dst )
+				break;
+			if( (usesDst || usesSrc) && !IsReadOfHandle(end) )
+			{
+				end = 0;
+				break;
+			}
+		}
+
+		if( end && end->op == asBC_FREE && end->wArg[0] == dst )
+		{
+			for( asCByteInstruction *i = use; i != end; i = i->next )
+			{
+				if( IsReadOfHandle(i) && i->wArg[0] == dst ) i->wArg[0] = src;
+				if( i->op == asBC_CmpPtr && i->wArg[1] == dst ) i->wArg[1] = src;
+			}
+			DeleteInstruction(end);
+			DeleteInstruction(next);
+			DeleteInstruction(copy);
+			instr = DeleteInstruction(instr);
+			continue;
+		}
+
+		instr = instr->next;
+	}
+}
+
+asCByteInstruction *asCByteCode::NewInstruction(asEBCInstr op, short a, short b, int c)
+{
+	void *ptr = engine->memoryMgr.AllocByteInstruction();
+	if( ptr == 0 )
+	{
+		// Out of memory
+		return 0;
+	}
+
+	asCByteInstruction *instr = new(ptr) asCByteInstruction();
+	ChangeInstr(instr, op);
+	instr->wArg[0] = a;
+	instr->wArg[1] = b;
+	*((int*)ARG_DW(instr->arg)) = c;
+
+	return instr;
+}
+
+// Returns the constant that the instruction adds to the variable, if
+// the instruction is a simple increment or decrement of the variable
+static bool GetIncrement(const asCByteInstruction *instr, short var, int &step)
+{
+	if( instr->wArg[0] != var )
+		return false;
+
+	switch( instr->op )
+	{
+	case asBC_IncVi:
+		step = 1;
+		return true;
+	case asBC_DecVi:
+		step = -1;
+		return true;
+	case asBC_ADDIi:
+		if( instr->wArg[1] != var ) return false;
+		step = *((int*)ARG_DW(instr->arg));
+		return true;
+	case asBC_SUBIi:
+		if( instr->wArg[1] != var ) return false;
+		step = int(0u - *ARG_DW(instr->arg));
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline bool IsBitSet(const asDWORD *bits, asUINT n)
+{
+	return (bits[n/32] & (1u << (n%32))) != 0;
+}
+
+// Returns true if the variable is read after the instruction, either in the rest of the
+// block or, if the variables alive at the exit of the block are given, after the block
+static bool IsTrackedVarReadAfter(const asCByteInstruction *instr, const asCByteInstruction *end, short var, const asSDataFlowVars &vars, const asDWORD *liveOut)
+{
+	while( instr != end )
+	{
+		instr = instr->next;
+
+		asSVarAccess a;
+		if( !GetVarAccess(instr, a) )
+			continue;
+		if( (a.readSize[0] && a.read[0] == var) || (a.readSize[1] && a.read[1] == var) )
+			return true;
+		if( a.writeSize && a.write == var )
+			return false;
+	}
+
+	if( liveOut == 0 )
+		return false;
+	int v = vars.Find(var);
+	return v < 0 || IsBitSet(liveOut, v);
+}
+
+// Returns the last instruction of the sequence starting with the given instruction, if the sequence
+// computes a value that is invariant in the loop and can be moved to before the loop. The operands of
+// the sequence must not be written in the loop, except by the sequence itself. The result must not
+// be written anywhere else in the loop, and the intermediate values must not be read outside the
+// sequence. As the sequence is also executed if the loop is never entered, it must not have any side
+// effect, and the previous values of the written variables must not be read in the loop.
+static asCByteInstruction *FindInvariantSequence(asCByteInstruction *first, asCByteInstruction *end, const asSDataFlowVars &vars, const int *defCount, const asDWORD *liveAtHeader, const asDWORD *liveOut)
+{
+	asCArray<short> written;
+	for( asCByteInstruction *instr = first; ; instr = instr->next )
+	{
+		asSVarAccess a;
+		if( !GetVarAccess(instr, a) || !a.isPure || a.isInPlace || a.writeSize == 0 )
+			return 0;
+
+		// Values from the register and global variables are not invariant
+		if( instr->op == asBC_RDR1 || instr->op == asBC_RDR2 || instr->op == asBC_RDR4 || instr->op == asBC_RDR8 ||
+			instr->op == asBC_CpyRtoV4 || instr->op == asBC_CpyRtoV8 || instr->op == asBC_CpyGtoV4 )
+			return 0;
+
+		int v = vars.Find(a.write);
+		if( v < 0 || IsBitSet(liveAtHeader, v) )
+			return 0;
+
+		for( asUINT r = 0; r < 2; r++ )
+		{
+			if( a.readSize[r] == 0 ) continue;
+			int src = vars.Find(a.read[r]);
+			if( src < 0 || (defCount[src] != 0 && !written.Exists(a.read[r])) )
+				return 0;
+		}
+		written.PushLast(a.write);
+
+		int writes = 0;
+		for( asUINT n = 0; n < written.GetLength(); n++ )
+			if( written[n] == a.write )
+				writes++;
+
+		if( defCount[v] == writes )
+		{
+			bool isUsedOutside = false;
+			for( asUINT n = 0; n < written.GetLength() && !isUsedOutside; n++ )
+				if( written[n] != a.write && IsTrackedVarReadAfter(instr, end, written[n], vars, liveOut) )
+					isUsedOutside = true;
+			if( !isUsedOutside )
+				return instr;
+		}
+
+		if( instr == end )
+			return 0;
+	}
+}
+
+bool asCByteCode::ReduceStrength(asCByteInstruction *mul, asCByteInstruction *end, asCByteInstruction *before, const asSDataFlowVars &vars, const int *defCount, asCByteInstruction **defInstr, const asDWORD *liveAtHeader, const asDWORD *liveOut)
+{
+	// The counter must be incremented by a constant once in the loop
+	short counter = mul->wArg[1];
+	int i = vars.Find(counter);
+	int step = 0;
+	if( i < 0 || defCount[i] != 1 || !GetIncrement(defInstr[i], counter, step) || defInstr[i]->next == 0 )
+		return false;
+
+	// Include the following additions of invariant values in the same variable. Each
+	// intermediate result must only be read by the next instruction in the sequence.
+	asCByteInstruction *last = mul;
+	while( last != end )
+	{
+		asCByteInstruction *next = last->next;
+		short curr = last->wArg[0];
+		if( next->wArg[0] == counter )
+			break;
+
+		if( next->op == asBC_ADDIi || next->op == asBC_SUBIi )
+		{
+			if( next->wArg[1] != curr )
+				break;
+		}
+		else if( next->op == asBC_ADDi || next->op == asBC_SUBi )
+		{
+			// Only the left operand of a subtraction can be the accumulated value
+			int other;
+			if( next->wArg[1] == curr && next->wArg[2] != curr )
+				other = 2;
+			else if( next->op == asBC_ADDi && next->wArg[2] == curr && next->wArg[1] != curr )
+				other = 1;
+			else
+				break;
+
+			int inv = vars.Find(next->wArg[other]);
+			if( inv < 0 || defCount[inv] != 0 )
+				break;
+		}
+		else
+			break;
+
+		if( next->wArg[0] != curr && IsTrackedVarReadAfter(next, end, curr, vars, liveOut) )
+			break;
+
+		last = next;
+	}
+
+	// The result must only be written by the sequence, and must only be read in the same block.
+	// The previous value of the variable must not be read in the loop.
+	short result = last->wArg[0];
+	int r = vars.Find(result);
+	if( r < 0 || r == i || IsBitSet(liveAtHeader, r) || IsBitSet(liveOut, r) )
+		return false;
+
+	int writes = 0;
+	asCByteInstruction *instr;
+	for( instr = mul; ; instr = instr->next )
+	{
+		if( instr->wArg[0] == result )
+			writes++;
+		if( instr == last ) break;
+	}
+	if( defCount[r] != writes )
+		return false;
+
+	// The result must not be read after the counter is incremented in the same block
+	for( instr = last; instr != end; instr = instr->next )
+	{
+		if( instr->next == defInstr[i] )
+		{
+			if( IsTrackedVarReadAfter(defInstr[i], end, result, vars, 0) )
+				return false;
+			break;
+		}
+	}
+
+	asCByteInstruction *inc = NewInstruction(asBC_ADDIi, result, result, int(*ARG_DW(mul->arg) * asDWORD(step)));
+	if( inc == 0 )
+		return false;
+	inc->stackSize = defInstr[i]->stackSize;
+	InsertBefore(defInstr[i]->next, inc);
+
+	// Move the sequence to before the loop to compute the initial value of the result
+	short prevVar = 0;
+	for( instr = mul; ; )
+	{
+		asCByteInstruction *next = instr->next;
+		if( instr != mul )
+		{
+			if( instr->wArg[1] == prevVar )
+				instr->wArg[1] = result;
+			else
+				instr->wArg[2] = result;
+		}
+		prevVar = instr->wArg[0];
+		instr->wArg[0] = result;
+
+		RemoveInstruction(instr);
+		instr->stackSize = before->stackSize;
+		InsertBefore(before, instr);
+
+		if( instr == last ) break;
+		instr = next;
+	}
+
+	return true;
+}
+
+bool asCByteCode::OptimizeLoops(const asSDataFlowVars &vars)
+{
+	// This function moves the computations that give the same result in every iteration of
+	// a loop to before the loop, and replaces multiplications of the loop counter with an
+	// addition that is done each time the counter is incremented (strength reduction).
+	// Only the tracked variables are considered since any other variable may be modified
+	// through a pointer, e.g. by a called function.
+
+	TimeIt("asCByteCode::OptimizeLoops");
+
+	asUINT numVars = vars.offsets.GetLength();
+	asUINT words = (numVars + 31) / 32;
+	bool changed = false;
+
+	// The loops that have been fully optimized are identified by the
+	// first instruction of the header, which is never moved or removed
+	asCArray<asCByteInstruction*> done;
+
+	// Each modification invalidates the blocks, so they are rebuilt until there is nothing more to do
+	for(;;)
+	{
+		asCArray<asSBasicBlock> blocks;
+		if( !BuildBasicBlocks(blocks) )
+			break;
+
+		asUINT numBlocks = blocks.GetLength();
+		asUINT bWords = (numBlocks + 31) / 32;
+
+		// Avoid excessive memory use for very large functions
+		if( asQWORD(numBlocks) * bWords > 250000 )
+			break;
+
+		// Find the blocks that can be reached from the entry
+		asCArray<asBYTE> reached;
+		reached.SetLength(numBlocks);
+		memset(reached.AddressOf(), 0, numBlocks);
+		asCArray<asUINT> workList;
+		workList.PushLast(0);
+		reached[0] = 1;
+		while( workList.GetLength() )
+		{
+			asUINT b = workList.PopLast();
+			for( asUINT s = 0; s < blocks[b].succ.GetLength(); s++ )
+				if( !reached[blocks[b].succ[s]] )
+				{
+					reached[blocks[b].succ[s]] = 1;
+					workList.PushLast(blocks[b].succ[s]);
+				}
+		}
+
+		// Compute the dominators of each block, i.e. the blocks that are executed on every path from the entry to the block
+		asCArray<asDWORD> dom;
+		dom.SetLength(numBlocks * bWords);
+		memset(dom.AddressOf(), 0xFF, dom.GetLength()*sizeof(asDWORD));
+		memset(dom.AddressOf(), 0, bWords*sizeof(asDWORD));
+		dom[0] = 1;
+		asCArray<asDWORD> newDom;
+		newDom.SetLength(bWords);
+		bool domChanged = true;
+		while( domChanged )
+		{
+			domChanged = false;
+			for( asUINT b = 1; b < numBlocks; b++ )
+			{
+				if( !reached[b] ) continue;
+
+				memset(newDom.AddressOf(), 0xFF, bWords*sizeof(asDWORD));
+				for( asUINT p = 0; p < blocks[b].pred.GetLength(); p++ )
+				{
+					asUINT pred = blocks[b].pred[p];
+					if( !reached[pred] ) continue;
+					for( asUINT w = 0; w < bWords; w++ )
+						newDom[w] &= dom[pred*bWords+w];
+				}
+				newDom[b/32] |= 1u << (b%32);
+
+				if( memcmp(newDom.AddressOf(), &dom[b*bWords], bWords*sizeof(asDWORD)) )
+				{
+					memcpy(&dom[b*bWords], newDom.AddressOf(), bWords*sizeof(asDWORD));
+					domChanged = true;
+				}
+			}
+		}
+
+		// A jump back to a block that dominates the source is the back edge of a loop, and the
+		// target is the header of the loop. The body of the loop is formed by the blocks that can
+		// reach the back edge without passing through the header. The innermost loops, i.e. the
+		// smallest ones, are optimized first so that their invariants can then move further out.
+		int header = -1;
+		asUINT headerSize = 0;
+		asCArray<asDWORD> body;
+		asCArray<asDWORD> loop;
+		loop.SetLength(bWords);
+		for( asUINT h = 0; h < numBlocks; h++ )
+		{
+			if( !reached[h] || done.Exists(blocks[h].start) )
+				continue;
+
+			memset(loop.AddressOf(), 0, bWords*sizeof(asDWORD));
+			loop[h/32] |= 1u << (h%32);
+			asUINT size = 1;
+			for( asUINT p = 0; p < blocks[h].pred.GetLength(); p++ )
+			{
+				asUINT latch = blocks[h].pred[p];
+				if( !reached[latch] || !IsBitSet(&dom[latch*bWords], h) )
+					continue;
+
+				if( !IsBitSet(loop.AddressOf(), latch) )
+				{
+					loop[latch/32] |= 1u << (latch%32);
+					size++;
+					workList.PushLast(latch);
+				}
+				while( workList.GetLength() )
+				{
+					asUINT b = workList.PopLast();
+					for( asUINT q = 0; q < blocks[b].pred.GetLength(); q++ )
+					{
+						asUINT pred = blocks[b].pred[q];
+						if( reached[pred] && !IsBitSet(loop.AddressOf(), pred) )
+						{
+							loop[pred/32] |= 1u << (pred%32);
+							size++;
+							workList.PushLast(pred);
+						}
+					}
+				}
+			}
+
+			if( size > 1 || blocks[h].succ.Exists(h) )
+			{
+				if( header < 0 || size < headerSize )
+				{
+					header = h;
+					headerSize = size;
+					body = loop;
+				}
+			}
+		}
+
+		if( header < 0 )
+			break;
+
+		asUINT h = header;
+		// The code that is moved out of the loop is placed at the end of the only block that leads into the loop
+		int preheader = -1;
+		for( asUINT p = 0; p < blocks[h].pred.GetLength(); p++ )
+		{
+			asUINT pred = blocks[h].pred[p];
+			if( !reached[pred] || IsBitSet(body.AddressOf(), pred) )
+				continue;
+			preheader = preheader < 0 ? int(pred) : -2;
+		}
+		if( preheader < 0 || blocks[preheader].succ.GetLength() != 1 )
+		{
+			done.PushLast(blocks[h].start);
+			continue;
+		}
+
+		// The entries in the jump table of a JMPP instruction cannot be extended
+		bool isJumpTable = false;
+		for( asUINT p = 0; p < blocks[preheader].pred.GetLength(); p++ )
+			if( blocks[blocks[preheader].pred[p]].end->op == asBC_JMPP )
+				isJumpTable = true;
+		if( isJumpTable )
+		{
+			done.PushLast(blocks[h].start);
+			continue;
+		}
+
+		asCByteInstruction *before = blocks[preheader].end->op == asBC_JMP ? blocks[preheader].end : blocks[h].start;
+
+		asCArray<asDWORD> liveIn, liveOut;
+		ComputeLiveness(blocks, vars, liveIn, liveOut);
+
+		// Count the number of times each variable is written in the loop
+		asCArray<int> defCount;
+		asCArray<asCByteInstruction*> defInstr;
+		defCount.SetLength(numVars);
+		defInstr.SetLength(numVars);
+		memset(defCount.AddressOf(), 0, numVars*sizeof(int));
+		memset(defInstr.AddressOf(), 0, numVars*sizeof(asCByteInstruction*));
+		asUINT b;
+		for( b = 0; b < numBlocks; b++ )
+		{
+			if( !IsBitSet(body.AddressOf(), b) ) continue;
+			for( asCByteInstruction *instr = blocks[b].start; ; instr = instr->next )
+			{
+				asSVarAccess a;
+				if( GetVarAccess(instr, a) && a.writeSize )
+				{
+					int v = vars.Find(a.write);
+					if( v >= 0 )
+					{
+						defCount[v]++;
+						defInstr[v] = instr;
+					}
+				}
+				if( instr == blocks[b].end ) break;
+			}
+		}
+
+		// Move the invariant computations out of the loop
+		bool modified = false;
+		for( b = 0; b < numBlocks && !modified; b++ )
+		{
+			if( !IsBitSet(body.AddressOf(), b) ) continue;
+			for( asCByteInstruction *instr = blocks[b].start; ; instr = instr->next )
+			{
+				asCByteInstruction *last = FindInvariantSequence(instr, blocks[b].end, vars, defCount.AddressOf(), &liveIn[h*words], &liveOut[b*words]);
+				if( last )
+				{
+					for(;;)
+					{
+						asCByteInstruction *next = instr->next;
+						RemoveInstruction(instr);
+						instr->stackSize = before->stackSize;
+						InsertBefore(before, instr);
+						if( instr == last ) break;
+						instr = next;
+					}
+					modified = true;
+					break;
+				}
+				if( instr == blocks[b].end ) break;
+			}
+		}
+
+		// Replace the multiplications of the loop counter with a variable that is incremented together with the counter.
+		// This is only done when the multiplication is executed in every iteration, i.e. when it dominates all back edges.
+		for( b = 0; b < numBlocks && !modified; b++ )
+		{
+			if( !IsBitSet(body.AddressOf(), b) ) continue;
+
+			bool isOnAllPaths = true;
+			for( asUINT p = 0; p < blocks[h].pred.GetLength(); p++ )
+			{
+				asUINT latch = blocks[h].pred[p];
+				if( IsBitSet(body.AddressOf(), latch) && !IsBitSet(&dom[latch*bWords], b) )
+					isOnAllPaths = false;
+			}
+			if( !isOnAllPaths ) continue;
+
+			for( asCByteInstruction *instr = blocks[b].start; ; instr = instr->next )
+			{
+				if( instr->op == asBC_MULIi &&
+					ReduceStrength(instr, blocks[b].end, before, vars, defCount.AddressOf(), defInstr.AddressOf(), &liveIn[h*words], &liveOut[b*words]) )
+				{
+					modified = true;
+					break;
+				}
+				if( instr == blocks[b].end ) break;
+			}
+		}
+
+		// The loop is analysed again after each modification since the blocks may have changed
+		if( modified )
+			changed = true;
+		else
+			done.PushLast(blocks[h].start);
+	}
+
+	return changed;
+}
+
+void asCByteCode::CompactVariables()
+{
+	// The variables are given new positions based on their live ranges, so that the variables that
+	// are never alive at the same time share the same position. Only the tracked variables with a
+	// positive offset are moved, and only to the positions of other tracked variables of the same
+	// size, so the layout of the stack frame and the positions of all other variables stay the same.
+	// The compiler will then release the positions at the top of the stack frame that are no longer
+	// used, and update the positions of the moved variables in the debug information.
+
+	TimeIt("asCByteCode::CompactVariables");
+
+	asSDataFlowVars vars;
+	if( !FindTrackedVariables(vars) )
+		return;
+
+	asUINT numVars = vars.offsets.GetLength();
+	asUINT words = (numVars + 31) / 32;
+
+	// Avoid excessive memory use for very large functions
+	if( asQWORD(numVars) * words > 250000 )
+		return;
+
+	asCArray<asSBasicBlock> blocks;
+	if( !BuildBasicBlocks(blocks) )
+		return;
+
+	asCArray<asDWORD> liveIn, liveOut;
+	ComputeLiveness(blocks, vars, liveIn, liveOut);
+
+	// Two variables interfere if one of them is written while the other is alive
+	asCArray<asDWORD> interference;
+	interference.SetLength(numVars * words);
+	memset(interference.AddressOf(), 0, interference.GetLength()*sizeof(asDWORD));
+	asCArray<asDWORD> live;
+	live.SetLength(words);
+	asUINT v, w;
+	for( asUINT b = 0; b < blocks.GetLength(); b++ )
+	{
+		memcpy(live.AddressOf(), &liveOut[b*words], words*sizeof(asDWORD));
+		for( asCByteInstruction *instr = blocks[b].end; ; instr = instr->prev )
+		{
+			asSVarAccess a;
+			if( GetVarAccess(instr, a) )
+			{
+				int d = a.writeSize ? vars.Find(a.write) : -1;
+				if( d >= 0 )
+				{
+					for( w = 0; w < words; w++ )
+						interference[d*words+w] |= live[w];
+					live[d/32] &= ~(1u << (d%32));
+				}
+				for( asUINT n = 0; n < 2; n++ )
+				{
+					int r = a.readSize[n] ? vars.Find(a.read[n]) : -1;
+					if( r >= 0 )
+						live[r/32] |= 1u << (r%32);
+				}
+			}
+			if( instr == blocks[b].start ) break;
+		}
+	}
+	for( v = 0; v < numVars; v++ )
+		for( w = 0; w < numVars; w++ )
+			if( IsBitSet(&interference[v*words], w) )
+				interference[w*words+v/32] |= 1u << (v%32);
+
+	// Give each variable the lowest position that isn't used by any interfering variable. As the variables
+	// are visited in the order of their original positions, a variable never moves to a higher position.
+	asCArray<int> newOffsets;
+	newOffsets.SetLength(numVars);
+	asCArray<asBYTE> isTaken;
+	isTaken.SetLength(numVars);
+	bool isMoved = false;
+	for( v = 0; v < numVars; v++ )
+	{
+		newOffsets[v] = vars.offsets[v];
+		if( vars.offsets[v] <= 0 )
+			continue;
+
+		memset(isTaken.AddressOf(), 0, numVars);
+		for( w = 0; w < v; w++ )
+			if( IsBitSet(&interference[v*words], w) )
+				isTaken[vars.Find(newOffsets[w])] = 1;
+
+		for( w = 0; w < v; w++ )
+		{
+			if( vars.offsets[w] > 0 && vars.sizes[w] == vars.sizes[v] && !isTaken[w] )
+			{
+				newOffsets[v] = vars.offsets[w];
+				movedVariables.PushLast(vars.offsets[v]);
+				movedVariables.PushLast(vars.offsets[w]);
+				isMoved = true;
+				break;
+			}
+		}
+	}
+
+	if( !isMoved )
+		return;
+
+	for( asCByteInstruction *instr = first; instr; instr = instr->next )
+	{
+		short operands[3];
+		asUINT count = GetVarOperands(instr, operands);
+		for( asUINT n = 0; n < count; n++ )
+		{
+			int t = vars.Find(operands[n]);
+			if( t >= 0 )
+				instr->wArg[n] = short(newOffsets[t]);
+		}
+	}
+}
+
+bool asCByteCode::IsTempVarReadByInstr(asCByteInstruction *curr, int offset)
+{
+	// Which instructions read from variables?
+	if( asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG &&
+		(int(curr->wArg[1]) == offset || int(curr->wArg[2]) == offset) )
+		return true;
+	else if( (asBCInfo[curr->op].type == asBCTYPE_rW_ARG    ||
+			  asBCInfo[curr->op].type == asBCTYPE_rW_DW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_rW_QW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_rW_W_DW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_rW_DW_DW_ARG ||
+			  curr->op == asBC_FREE) &&  // FREE both read and write to the variable
+			  int(curr->wArg[0]) == offset )
+		return true;
+	else if( (asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG) &&
+			 int(curr->wArg[1]) == offset )
+		return true;
+	else if( asBCInfo[curr->op].type == asBCTYPE_rW_rW_ARG &&
+			 (int(curr->wArg[0]) == offset || int(curr->wArg[1]) == offset) )
+		return true;
+	else if( curr->op == asBC_LoadThisR && offset == 0 )
+		return true;
+
+	return false;
+}
+
+bool asCByteCode::IsInstrJmpOrLabel(asCByteInstruction *curr)
+{
+	if( curr->op == asBC_JS      ||
+		curr->op == asBC_JNS     ||
+		curr->op == asBC_JP      ||
+		curr->op == asBC_JNP     ||
+		curr->op == asBC_JMPP    ||
+		curr->op == asBC_JMP     ||
+		curr->op == asBC_JZ      ||
+		curr->op == asBC_JNZ     ||
+		curr->op == asBC_JLowZ   ||
+		curr->op == asBC_JLowNZ  ||
+		curr->op == asBC_LABEL   )
+		return true;
+
+	return false;
+}
+
+bool asCByteCode::IsTempVarOverwrittenByInstr(asCByteInstruction *curr, int offset)
+{
+	// Which instructions overwrite the variable or discard it?
+	if( curr->op == asBC_RET     ||
+		curr->op == asBC_SUSPEND )
+		return true;
+	else if( (asBCInfo[curr->op].type == asBCTYPE_wW_rW_rW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_ARG    ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_DW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_rW_QW_ARG ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_ARG       ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_W_ARG     ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_DW_ARG    ||
+			  asBCInfo[curr->op].type == asBCTYPE_wW_QW_ARG) &&
+			 int(curr->wArg[0]) == offset )
+		return true;
+
+	return false;
+}
+
+bool asCByteCode::IsTempVarRead(asCByteInstruction *curr, int offset)
+{
+	TimeIt("asCByteCode::IsTempVarRead");
+
+	asCArray<asCByteInstruction *> openPaths;
+	asCArray<asCByteInstruction *> closedPaths;
+
+	// We're not interested in the first instruction, since it is the one that sets the variable
+	openPaths.PushLast(curr->next);
+
+	while( openPaths.GetLength() )
+	{
+		curr = openPaths.PopLast();
+
+		// Add the instruction to the closed paths so that we don't verify it again
+		closedPaths.PushLast(curr);
+
+		while( curr )
+		{
+			if( IsTempVarReadByInstr(curr, offset) )
+				return true;
+
+			if( IsTempVarOverwrittenByInstr(curr, offset) ) break;
+
+			// In case of jumps, we must follow the each of the paths
+			if( curr->op == asBC_JMP )
+			{
+				// Find the destination. If it cannot be found it is because we're doing a localized
+				// optimization and the label hasn't been added to the final bytecode yet
+
+				int label = *((int*)ARG_DW(curr->arg));
+				int r = FindLabel(label, curr, &curr, 0);
+				if( r >= 0 &&
+					!closedPaths.Exists(curr) &&
+					!openPaths.Exists(curr) )
+					openPaths.PushLast(curr);
+
+				break;
+			}
+			else if( curr->op == asBC_JZ    || curr->op == asBC_JNZ    ||
+				     curr->op == asBC_JS    || curr->op == asBC_JNS    ||
+					 curr->op == asBC_JP    || curr->op == asBC_JNP    ||
+					 curr->op == asBC_JLowZ || curr->op == asBC_JLowNZ )
+			{
+				// Find the destination. If it cannot be found it is because we're doing a localized
+				// optimization and the label hasn't been added to the final bytecode yet
+
+				asCByteInstruction *dest = 0;
+				int label = *((int*)ARG_DW(curr->arg));
+				int r = FindLabel(label, curr, &dest, 0);
+				if( r >= 0 &&
+					!closedPaths.Exists(dest) &&
+					!openPaths.Exists(dest) )
+					openPaths.PushLast(dest);
+			}
+			else if( curr->op == asBC_JMPP )
+			{
+				// A JMPP instruction is always followed by a series of JMP instructions
+				// that give the real destination (like a look-up table). We need add all
+				// of these as open paths.
+				curr = curr->next;
+				while( curr->op == asBC_JMP )
+				{
+					// Find the destination. If it cannot be found it is because we're doing a localized
+					// optimization and the label hasn't been added to the final bytecode yet
+
+					asCByteInstruction *dest = 0;
+					int label = *((int*)ARG_DW(curr->arg));
+					int r = FindLabel(label, curr, &dest, 0);
+					if( r >= 0 &&
+						!closedPaths.Exists(dest) &&
+						!openPaths.Exists(dest) )
+						openPaths.PushLast(dest);
+
+					curr = curr->next;
+				}
+
+				// We should now be on a label which is the destination of the
+				// first JMP in the sequence and is already added in the open paths
+				asASSERT(curr->op == asBC_LABEL);
+				break;
+			}
+
+			curr = curr->next;
+		}
+	}
+
+	return false;
+}
+
+bool asCByteCode::IsTempRegUsed(asCByteInstruction *curr)
+{
+	TimeIt("asCByteCode::IsTempRegUsed");
+
+	// We're not interested in the first instruction, since it is the one that sets the register
+	while( curr->next )
+	{
+		curr = curr->next;
+
+		// Which instructions read from the register?
+		if( curr->op == asBC_INCi     ||
+			curr->op == asBC_INCi16   ||
+			curr->op == asBC_INCi8    ||
+			curr->op == asBC_INCf     ||
+			curr->op == asBC_INCd     ||
+			curr->op == asBC_DECi     ||
+			curr->op == asBC_DECi16   ||
+			curr->op == asBC_DECi8    ||
+			curr->op == asBC_DECf     ||
+			curr->op == asBC_DECd     ||
+			curr->op == asBC_WRTV1    ||
+			curr->op == asBC_WRTV2    ||
+			curr->op == asBC_WRTV4    ||
+			curr->op == asBC_WRTV8    ||
+			curr->op == asBC_RDR1     ||
+			curr->op == asBC_RDR2     ||
+			curr->op == asBC_RDR4     ||
+			curr->op == asBC_RDR8     ||
+			curr->op == asBC_PshRPtr  ||
+			curr->op == asBC_CpyRtoV4 ||
+			curr->op == asBC_CpyRtoV8 ||
 			curr->op == asBC_TZ       ||
 			curr->op == asBC_TNZ      ||
 			curr->op == asBC_TS       ||
@@ -1418,6 +3491,9 @@ bool asCByteCode::IsTempRegUsed(asCByteInstruction *curr)
 			curr->op == asBC_CMPIi     ||
 			curr->op == asBC_CMPIu     ||
 			curr->op == asBC_CMPIf     ||
+			curr->op == asBC_CMPIi64   ||
+			curr->op == asBC_CMPIu64   ||
+			curr->op == asBC_CMPId     ||
 			curr->op == asBC_LoadThisR ||
 			curr->op == asBC_LoadRObjR ||
 			curr->op == asBC_LoadVObjR )
@@ -1746,6 +3822,140 @@ void asCByteCode::JmpP(int var, asDWORD max)
 	*ARG_DW(last->arg) = max;
 }
 
+// Appends a copy of the bytecode of a compiled script function so it is executed without a call.
+// The varMap holds pairs of the variable offset in the function and the offset of the caller's
+// variable that takes its place. The returns jump to the end of the copy with the value in the register.
+// The copy has no line information of its own, so it is reported as part of the caller's statement
+void asCByteCode::InlineFunction(asCScriptFunction *func, const asCArray<int> &varMap, int &nextLabel)
+{
+	asCArray<asDWORD> &bc = func->scriptData->byteCode;
+	asUINT length = bc.GetLength();
+
+	// Give a label to each destination of the jumps
+	asCArray<int> labels;
+	labels.SetLength(length+1);
+	asUINT n;
+	for( n = 0; n <= length; n++ )
+		labels[n] = -1;
+	for( n = 0; n < length; n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		asEBCInstr op = asEBCInstr(*(asBYTE*)&bc[n]);
+		if( (op >= asBC_JMP && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ )
+		{
+			int dest = int(n) + asBCTypeSize[asBCInfo[op].type] + asBC_INTARG(&bc[n]);
+			asASSERT( dest >= 0 && dest <= int(length) );
+			if( labels[dest] < 0 )
+				labels[dest] = nextLabel++;
+		}
+	}
+
+	int endLabel = -1;
+	for( n = 0; n < length; n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		asDWORD *instr = &bc[n];
+		asEBCInstr op = asEBCInstr(*(asBYTE*)instr);
+		int size = asBCTypeSize[asBCInfo[op].type];
+
+		if( labels[n] >= 0 )
+			Label(short(labels[n]));
+
+		// The suspend instructions are not copied, since the optimizations
+		// take them as the start of a new statement where no temporary
+		// variables are alive. The caller's statement continues here
+		if( op == asBC_SUSPEND || op == asBC_JitEntry )
+			continue;
+
+		if( op == asBC_RET )
+		{
+			// The last return simply continues with the code after the copy
+			if( n + size < length )
+			{
+				if( endLabel < 0 )
+					endLabel = nextLabel++;
+				InstrINT(asBC_JMP, endLabel);
+			}
+			continue;
+		}
+
+		if( (op >= asBC_JMP && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ )
+		{
+			InstrINT(op, labels[n + size + asBC_INTARG(instr)]);
+			continue;
+		}
+
+		if( AddInstruction() < 0 )
+			return;
+
+		last->op       = op;
+		last->size     = size;
+		last->stackInc = asBCInfo[op].stackInc;
+		last->wArg[0]  = asBC_SWORDARG0(instr);
+		last->wArg[1]  = asBC_SWORDARG1(instr);
+		last->wArg[2]  = asBC_SWORDARG2(instr);
+
+		// This is the reverse of Output()
+		switch( asBCInfo[op].type )
+		{
+		case asBCTYPE_wW_DW_ARG:
+		case asBCTYPE_rW_DW_ARG:
+		case asBCTYPE_W_DW_ARG:
+			*(asDWORD*)&last->arg = instr[1];
+			break;
+		case asBCTYPE_wW_rW_DW_ARG:
+		case asBCTYPE_rW_W_DW_ARG:
+			*(asDWORD*)&last->arg = instr[2];
+			break;
+		case asBCTYPE_wW_QW_ARG:
+		case asBCTYPE_rW_QW_ARG:
+			last->arg = *(asQWORD*)(instr+1);
+			break;
+		case asBCTYPE_wW_rW_QW_ARG:
+			last->arg = *(asQWORD*)(instr+2);
+			break;
+		case asBCTYPE_QW_DW_ARG:
+		case asBCTYPE_DW_DW_ARG:
+		case asBCTYPE_QW_ARG:
+		case asBCTYPE_DW_ARG:
+		case asBCTYPE_rW_DW_DW_ARG:
+			memcpy(&last->arg, instr+1, size*4-4);
+			break;
+		default:
+			break;
+		}
+
+		// The object pointer is no longer at offset 0, so it is loaded from the variable that holds it instead
+		if( op == asBC_LoadThisR )
+		{
+			last->op       = asBC_LoadRObjR;
+			last->size     = asBCTypeSize[asBCInfo[asBC_LoadRObjR].type];
+			last->stackInc = asBCInfo[asBC_LoadRObjR].stackInc;
+			last->wArg[1]  = last->wArg[0];
+			last->wArg[0]  = 0;
+		}
+
+		short vars[3];
+		asUINT count = GetVarOperands(last, vars);
+		for( asUINT v = 0; v < count; v++ )
+		{
+			asUINT m;
+			for( m = 0; m < varMap.GetLength(); m += 2 )
+			{
+				if( varMap[m] == vars[v] )
+				{
+					last->wArg[v] = short(varMap[m+1]);
+					break;
+				}
+			}
+
+			// The compiler verifies that all the variables are mapped before the function is inlined
+			asASSERT( m < varMap.GetLength() );
+		}
+	}
+
+	if( endLabel >= 0 )
+		Label(short(endLabel));
+}
+
 void asCByteCode::Label(short label)
 {
 	if( AddInstruction() < 0 )
@@ -1976,6 +4186,11 @@ void asCByteCode::Output(asDWORD *array)
 				*(((asWORD*)ap)+1) = instr->wArg[0];
 				*(asQWORD*)(ap+1) = asQWORD(instr->arg);
 				break;
+			case asBCTYPE_wW_rW_QW_ARG:
+				*(((asWORD*)ap)+1) = instr->wArg[0];
+				*(((asWORD*)ap)+2) = instr->wArg[1];
+				*(asQWORD*)(ap+2) = asQWORD(instr->arg);
+				break;
 			case asBCTYPE_W_ARG:
 			case asBCTYPE_rW_ARG:
 			case asBCTYPE_wW_ARG:
@@ -2246,6 +4461,28 @@ void asCByteCode::DebugOutput(const char *name, asCScriptFunction *func)
 			}
 			break;
 
+		case asBCTYPE_wW_rW_QW_ARG:
+			switch( instr->op )
+			{
+			case asBC_ADDId:
+			case asBC_SUBId:
+			case asBC_MULId:
+				fprintf(file, "   %-8s v%d, v%d, %f\n", asBCInfo[instr->op].name, instr->wArg[0], instr->wArg[1], *((double*) ARG_QW(instr->arg)));
+				break;
+			default:
+#ifdef __GNUC__
+#ifdef _LP64
+				fprintf(file, "   %-8s v%d, v%d, %ld\n", asBCInfo[instr->op].name, instr->wArg[0], instr->wArg[1], *((asINT64*) ARG_QW(instr->arg)));
+#else
+				fprintf(file, "   %-8s v%d, v%d, %lld\n", asBCInfo[instr->op].name, instr->wArg[0], instr->wArg[1], *((asINT64*) ARG_QW(instr->arg)));
+#endif
+#else
+				fprintf(file, "   %-8s v%d, v%d, %I64d\n", asBCInfo[instr->op].name, instr->wArg[0], instr->wArg[1], *((asINT64*) ARG_QW(instr->arg)));
+#endif
+				break;
+			}
+			break;
+
 		case asBCTYPE_DW_ARG:
 			switch( instr->op )
 			{
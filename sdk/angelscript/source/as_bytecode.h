@@ -55,6 +55,9 @@ BEGIN_AS_NAMESPACE
 class asCScriptEngine;
 class asCScriptFunction;
 class asCByteInstruction;
+struct asSBasicBlock;
+struct asSVarValue;
+struct asSDataFlowVars;
 
 class asCByteCode
 {
@@ -69,6 +72,8 @@ public:
 	void Finalize(const asCArray<int> &tempVariableOffsets);
 
 	void Optimize();
+	void OptimizeDataFlow();
+	void CompactVariables();
 	void OptimizeLocally(const asCArray<int> &tempVariableOffsets);
 	void ExtractLineNumbers();
 	void ExtractObjectVariableInfo(asCScriptFunction *outFunc);
@@ -110,6 +115,7 @@ public:
 	void Alloc(asEBCInstr bc, void *objID, int funcID, int pop);
 	void Ret(int pop);
 	void JmpP(int var, asDWORD max);
+	void InlineFunction(asCScriptFunction *func, const asCArray<int> &varMap, int &nextLabel);
 
 	int InsertFirstInstrDWORD(asEBCInstr bc, asDWORD param);
 	int InsertFirstInstrQWORD(asEBCInstr bc, asQWORD param);
@@ -140,6 +146,9 @@ public:
 	asCArray<int> sectionIdxs;
 	int largestStackUsed;
 
+	// Pairs of the original and the new offset of the variables that were moved by CompactVariables
+	asCArray<int> movedVariables;
+
 protected:
 	// Assignments are not allowed
 	void operator=(const asCByteCode &) {}
@@ -162,6 +171,18 @@ protected:
 	bool IsTempVarOverwrittenByInstr(asCByteInstruction *curr, int var);
 	bool IsInstrJmpOrLabel(asCByteInstruction *curr);
 
+	// Helpers for OptimizeDataFlow
+	bool FindTrackedVariables(asSDataFlowVars &vars);
+	bool BuildBasicBlocks(asCArray<asSBasicBlock> &blocks);
+	bool PropagateValues(asCArray<asSBasicBlock> &blocks, const asSDataFlowVars &vars);
+	bool RewriteWithConstants(asCByteInstruction *instr, const int *src, const asSVarValue *values);
+	bool RemoveDeadStores(asCArray<asSBasicBlock> &blocks, const asSDataFlowVars &vars);
+	bool OptimizeLoops(const asSDataFlowVars &vars);
+	void RemoveRedundantNullChecks();
+	void RemoveRedundantRefCounting();
+	bool ReduceStrength(asCByteInstruction *mul, asCByteInstruction *end, asCByteInstruction *before, const asSDataFlowVars &vars, const int *defCount, asCByteInstruction **defInstr, const asDWORD *liveAtHeader, const asDWORD *liveOut);
+	asCByteInstruction *NewInstruction(asEBCInstr op, short a, short b, int c);
+
 	int AddInstruction();
 	int AddInstructionFirst();
 
@@ -183,6 +183,7 @@ int PrepareSystemFunctionGeneric(asCScriptFunction *func, asSSystemFunctionInter
 
 	// Calculate the size needed for the parameters
 	internal->paramSize = func->GetSpaceNeededForArguments();
+	func->argumentsSize = internal->paramSize;
 
 	// Prepare the clean up instructions for the function arguments
 	internal->cleanArgs.SetLength(0);
@@ -451,6 +452,7 @@ int PrepareSystemFunction(asCScriptFunction *func, asSSystemFunctionInterface *i
 
 	// Calculate the size needed for the parameters
 	internal->paramSize = func->GetSpaceNeededForArguments();
+	func->argumentsSize = internal->paramSize;
 
 	// Verify if the function takes any objects by value
 	asUINT n;
@@ -55,6 +55,7 @@
 #include "as_parser.h"
 #include "as_debug.h"
 #include "as_context.h"  // as_powi()
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -441,7 +442,17 @@ void asCCompiler::FinalizeFunction()
 	}
 
 	// Finalize the bytecode
+	double time = asGetSystemTime();
 	byteCode.Finalize(tempVariableOffsets);
+	if( builder && builder->module )
+	{
+		builder->module->m_buildStats.finalizeTime += asGetSystemTime() - time;
+		builder->module->m_buildStats.numFunctionsCompiled++;
+	}
+
+	// The optimizations may have moved variables to share the stack position with other variables
+	if( byteCode.movedVariables.GetLength() )
+		ReleaseMovedVariables();
 
 	// extract the try/catch info before object variable info, as 
 	// some variable info is not needed if there are no try/catch blocks
@@ -958,6 +969,13 @@ int asCCompiler::CompileFunction(asCBuilder *in_builder, asCScriptCode *in_scrip
 
 	FinalizeFunction();
 
+	// A constexpr function is executed by the compiler, so it must not have any side effects
+	if( outFunc->IsConstExpr() && !IsConstExprByteCode(outFunc, 0) )
+	{
+		Error(TXT_CONSTEXPR_NOT_PURE, in_func);
+		return -1;
+	}
+
 #ifdef AS_DEBUG
 	// DEBUG: output byte code
 	if( outFunc->objectType )
@@ -1090,6 +1108,50 @@ int asCCompiler::CallCopyConstructor(asCDataType &type, int offset, bool isObjec
 	return -1;
 }
 
+// internal
+void asCCompiler::ClearStructMembers(asCObjectType *ot, int offset, bool derefDest, int zeroVar, asCArray<asCObjectProperty*> &path, asCByteCode *bc)
+{
+	// The path holds the members of nested structs that lead to the current struct
+	asCObjectType *curr = path.GetLength() ? CastToObjectType(path[path.GetLength()-1]->type.GetTypeInfo()) : ot;
+
+	// Each member is written through its address, the same way as when the script accesses the
+	// members, so the saved bytecode can still identify the properties on other platforms
+	for( asUINT n = 0; n < curr->properties.GetLength(); n++ )
+	{
+		asCObjectProperty *prop = curr->properties[n];
+		path.PushLast(prop);
+
+		if( prop->type.GetTypeInfo() && (prop->type.GetTypeInfo()->flags & asOBJ_SCRIPT_STRUCT) )
+			ClearStructMembers(ot, offset, derefDest, zeroVar, path, bc);
+		else
+		{
+			if( derefDest )
+				bc->InstrSHORT(asBC_PshVPtr, (short)offset);
+			else
+				bc->InstrSHORT(asBC_PSF, (short)offset);
+
+			asCObjectType *owner = ot;
+			for( asUINT p = 0; p < path.GetLength(); p++ )
+			{
+				bc->InstrSHORT_DW(asBC_ADDSi, (short)path[p]->byteOffset, engine->GetTypeIdFromDataType(asCDataType::CreateType(owner, false)));
+				owner = CastToObjectType(path[p]->type.GetTypeInfo());
+			}
+			bc->Instr(asBC_PopRPtr);
+
+			// The temporary variable holds 8 zero bytes so any part of it is zero
+			switch( prop->type.GetSizeInMemoryBytes() )
+			{
+			case 1: bc->InstrSHORT(asBC_WRTV1, (short)zeroVar); break;
+			case 2: bc->InstrSHORT(asBC_WRTV2, (short)zeroVar); break;
+			case 8: bc->InstrSHORT(asBC_WRTV8, (short)zeroVar); break;
+			default: bc->InstrSHORT(asBC_WRTV4, (short)zeroVar); break;
+			}
+		}
+
+		path.PopLast();
+	}
+}
+
 int asCCompiler::CallDefaultConstructor(const asCDataType &type, int offset, bool isObjectOnHeap, asCByteCode *bc, asCScriptNode *node, EVarGlobOrMem isVarGlobOrMem, bool derefDest)
 {
 	if( !type.IsObject() || type.IsObjectHandle() )
@@ -1264,6 +1326,15 @@ int asCCompiler::CallDefaultConstructor(const asCDataType &type, int offset, boo
 						PerformFunctionCall(func, &ctxCall, false, 0, CastToObjectType(type.GetTypeInfo()));
 						bc->AddCode(&ctxCall.bc);
 					}
+					else if( type.GetTypeInfo()->flags & asOBJ_SCRIPT_STRUCT )
+					{
+						// Structs have no constructor, instead the members are cleared
+						int zero = AllocateVariable(asCDataType::CreatePrimitive(ttInt64, false), true);
+						bc->InstrSHORT_QW(asBC_SetV8, (short)zero, 0);
+						asCArray<asCObjectProperty*> path;
+						ClearStructMembers(CastToObjectType(type.GetTypeInfo()), offset, derefDest, zero, path, bc);
+						ReleaseTemporaryVariable(zero, 0);
+					}
 
 					// TODO: value on stack: This probably needs to be done in PerformFunctionCall
 					// Mark the object as initialized
@@ -4432,8 +4503,12 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 	asCExprContext expr(engine);
 	CompileAssignment(snode->firstChild, &expr);
 
+	// Strings are dispatched on the hash of the value, and then compared with the cases that have the same hash
+	bool isStringSwitch = engine->stringFactory && expr.type.dataType.GetTypeInfo() &&
+	                      expr.type.dataType.GetTypeInfo() == engine->stringType.GetTypeInfo();
+
 	// Verify that the expression is a primitive type
-	if( !expr.type.dataType.IsIntegerType() && !expr.type.dataType.IsUnsignedType() )
+	if( !isStringSwitch && !expr.type.dataType.IsIntegerType() && !expr.type.dataType.IsUnsignedType() )
 	{
 		Error(TXT_SWITCH_MUST_BE_INTEGRAL, snode->firstChild);
 		return;
@@ -4445,21 +4520,61 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 	// TODO: Need to support 64bit integers
 	// Convert the expression to a 32bit variable
 	asCDataType to;
-	if( expr.type.dataType.IsIntegerType() )
+	if( expr.type.dataType.IsIntegerType() || isStringSwitch )
 		to.SetTokenType(ttInt);
 	else if( expr.type.dataType.IsUnsignedType() )
 		to.SetTokenType(ttUInt);
 
-	// Make sure the value is in a variable
-	if( expr.type.dataType.IsReference() )
-		ConvertToVariable(&expr);
+	int offset;
+	int strOffset = 0;
+	asCDataType strDt;
+	if( isStringSwitch )
+	{
+		// The string must stay available while it is compared with the cases,
+		// so unless it is already held by a local variable it is stored in a
+		// hidden variable that is destroyed at the end of the switch
+		if( expr.type.isVariable && !expr.type.isTemporary && !expr.type.dataType.IsObjectHandle() )
+		{
+			strOffset = expr.type.stackOffset;
+			strDt = expr.type.dataType;
+
+			// The address of the variable is already pushed on the stack
+			if( IsVariableOnHeap(strOffset) )
+				expr.bc.Instr(asBC_RDSPtr);
+		}
+		else
+		{
+			strDt = expr.type.dataType;
+			strDt.MakeHandle(false);
+			strDt.MakeReference(false);
+			strDt.MakeReadOnly(false);
+			strOffset = AllocateVariable(strDt, false);
+			if( DeclareVariable("", strDt, strOffset, &expr.bc, snode) < 0 )
+				return;
+
+			CompileInitializationWithAssignment(&expr.bc, strDt, snode->firstChild, strOffset, 0, asVGM_VARIABLE, snode->firstChild, &expr);
+			expr.bc.InstrSHORT(IsVariableOnHeap(strOffset) ? asBC_PshVPtr : asBC_PSF, (short)strOffset);
+		}
 
-	ImplicitConversion(&expr, to, snode->firstChild, asIC_IMPLICIT_CONV, true);
+		ProcessDeferredParams(&expr);
+
+		// Compute the hash of the string
+		offset = AllocateVariable(to, true);
+		expr.bc.InstrSHORT(asBC_StrHash, (short)offset);
+	}
+	else
+	{
+		// Make sure the value is in a variable
+		if( expr.type.dataType.IsReference() )
+			ConvertToVariable(&expr);
 
-	ConvertToVariable(&expr);
-	int offset = expr.type.stackOffset;
+		ImplicitConversion(&expr, to, snode->firstChild, asIC_IMPLICIT_CONV, true);
+
+		ConvertToVariable(&expr);
+		offset = expr.type.stackOffset;
 
-	ProcessDeferredParams(&expr);
+		ProcessDeferredParams(&expr);
+	}
 
 	//-------------------------------
 	// Determine case values and labels
@@ -4473,6 +4588,11 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 	asCArray<int> caseValues;
 	asCArray<int> caseLabels;
 
+	// For string switches the case values are the hashes of the strings, and the
+	// expressions are kept so the strings can be compared after the dispatch
+	asCArray<asCString> caseStrings;
+	asCArray<asCScriptNode*> caseNodes;
+
 	// Compile all case comparisons and make them jump to the right label
 	asCScriptNode *cnode = snode->firstChild->next;
 	while( cnode )
@@ -4484,6 +4604,40 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 			asCExprContext c(engine);
 			CompileExpression(cnode->firstChild, &c);
 
+			if( isStringSwitch )
+			{
+				// Only string literals are accepted. These are the only expressions that
+				// leave nothing but the pointer to the string constant in the bytecode
+				void *strPtr = 0;
+				asCByteInstruction *instr = c.bc.GetFirstInstr();
+				if( c.type.isConstant && c.type.dataType.IsEqualExceptRefAndConst(engine->stringType) &&
+					instr && instr->op == asBC_PGA && instr->next == 0 )
+					strPtr = (void*)*ARG_PTR(instr->arg);
+
+				if( strPtr == 0 )
+					Error(TXT_SWITCH_CASE_MUST_BE_STRING, cnode->firstChild);
+				else
+				{
+					// Has this case been declared already?
+					asCString str;
+					asUINT length = 0;
+					engine->stringFactory->GetRawStringData(strPtr, 0, &length);
+					str.SetLength(length);
+					engine->stringFactory->GetRawStringData(strPtr, str.AddressOf(), &length);
+					if( caseStrings.IndexOf(str) >= 0 )
+						Error(TXT_DUPLICATE_SWITCH_CASE, cnode->firstChild);
+
+					caseValues.PushLast(int(engine->HashStringObject(strPtr)));
+					caseStrings.PushLast(str);
+					caseNodes.PushLast(cnode->firstChild);
+
+					// Reserve label for this case
+					caseLabels.PushLast(nextLabel++);
+				}
+				cnode = cnode->next;
+				continue;
+			}
+
 			// Verify that the result is a literal constant
 			if (!c.type.isConstant)
 			{
@@ -4543,6 +4697,147 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 	// with jumps to the case code
 	//------------------------------------
 
+	if( isStringSwitch )
+	{
+		// Strings with the same hash share a label where they will be compared
+		asCArray<int> hashValues;
+		asCArray<int> hashLabels;
+		asCArray<int> caseHashLabels;
+		for( asUINT n = 0; n < caseValues.GetLength(); n++ )
+		{
+			int index = hashValues.IndexOf(caseValues[n]);
+			if( index < 0 )
+			{
+				index = (int)hashValues.GetLength();
+				hashValues.PushLast(caseValues[n]);
+				hashLabels.PushLast(nextLabel++);
+			}
+			caseHashLabels.PushLast(hashLabels[index]);
+		}
+
+		asCArray<int> sortedLabels = hashLabels;
+		CompileSwitchJumps(&expr.bc, offset, hashValues, sortedLabels, defaultLabel);
+		ReleaseTemporaryVariable(offset, &expr.bc);
+
+		// Compare the string with each case that has the same hash
+		for( asUINT h = 0; h < hashLabels.GetLength(); h++ )
+		{
+			expr.bc.Label((short)hashLabels[h]);
+			for( asUINT n = 0; n < caseNodes.GetLength(); n++ )
+			{
+				if( caseHashLabels[n] != hashLabels[h] )
+					continue;
+
+				asCExprContext lctx(engine), rctx(engine), cmp(engine);
+				lctx.bc.InstrSHORT(asBC_PSF, (short)strOffset);
+				lctx.type.SetVariable(strDt, strOffset, false);
+				if( IsVariableOnHeap(strOffset) ) lctx.type.dataType.MakeReference(true);
+				lctx.type.isRefSafe = true;
+				lctx.exprNode = snode->firstChild;
+				CompileExpression(caseNodes[n], &rctx);
+				if( CompileOperator(caseNodes[n], &lctx, &rctx, &cmp, ttEqual) < 0 )
+					continue;
+
+				ConvertToVariable(&cmp);
+				ProcessDeferredParams(&cmp);
+				cmp.bc.InstrSHORT(asBC_CpyVtoR4, (short)cmp.type.stackOffset);
+				cmp.bc.Instr(asBC_ClrHi);
+				cmp.bc.InstrDWORD(asBC_JNZ, caseLabels[n]);
+				ReleaseTemporaryVariable(cmp.type, &cmp.bc);
+				expr.bc.AddCode(&cmp.bc);
+			}
+
+			// It was a hash collision with a string that isn't one of the cases
+			expr.bc.InstrINT(asBC_JMP, defaultLabel);
+		}
+	}
+	else
+	{
+		CompileSwitchJumps(&expr.bc, offset, caseValues, caseLabels, defaultLabel);
+
+		// Release the temporary variable previously stored
+		ReleaseTemporaryVariable(expr.type, &expr.bc);
+	}
+
+	// TODO: optimize: Should optimize each piece individually
+	expr.bc.OptimizeLocally(tempVariableOffsets);
+
+	//----------------------------------
+    // Output case implementations
+	//----------------------------------
+
+	// Switch cases must be able to report if all paths have return too
+	// If the switch case has no default case, then it doesn't return
+	// If a case has a break without first return then the switch has no return
+	// If a case doesn't have a return, but falls through to a case that does return then the case can be said to have a return too
+	*hasReturn = true;
+
+	// Compile case implementations, each one with the label before it
+	cnode = snode->firstChild->next;
+	while( cnode )
+	{
+		// Each case should have a constant expression
+		if( cnode->firstChild && cnode->firstChild->nodeType == snExpression )
+		{
+			expr.bc.Label((short)firstCaseLabel++);
+
+			bool caseHasReturn, caseHasBreak;
+			CompileCase(cnode->firstChild->next, &expr.bc, &caseHasReturn, &caseHasBreak);
+
+			// If the case does not return and have a break, then we know the switch doesn't return in all paths
+			if (!caseHasReturn && caseHasBreak)
+				*hasReturn = false;
+		}
+		else
+		{
+			expr.bc.Label((short)defaultLabel);
+
+			// Is default the last case?
+			if( cnode->next )
+			{
+				// We've already reported this error
+				break;
+			}
+
+			bool caseHasReturn, caseHasBreak;
+			CompileCase(cnode->firstChild, &expr.bc, &caseHasReturn, &caseHasBreak);
+
+			// If the default case does not return then we know the switch doesn't return in all paths
+			if (!caseHasReturn)
+				*hasReturn = false;
+		}
+
+		cnode = cnode->next;
+	}
+
+	// If there is no default case, then the switch cannot be said to return in all paths
+	if (defaultLabel == breakLabel)
+		*hasReturn = false;
+
+	//--------------------------------
+
+	bc->AddCode(&expr.bc);
+
+	// Add break label
+	bc->Label((short)breakLabel);
+
+	// Destroy the hidden variable that held the string. Variables can't
+	// be declared directly in the cases so there are no other variables
+	for( int n = (int)variables->variables.GetLength() - 1; n >= 0; n-- )
+	{
+		sVariable *v = variables->variables[n];
+		CallDestructor(v->type, v->stackOffset, v->onHeap, bc);
+		DeallocateVariable(v->stackOffset);
+	}
+
+	breakLabels.PopLast();
+	RemoveVariableScope();
+}
+
+// Outputs the jumps to the case labels for the value in the variable. The
+// values are sorted and consecutive values are dispatched with jump tables
+void asCCompiler::CompileSwitchJumps(asCByteCode *bc, int offset, asCArray<int> &caseValues, asCArray<int> &caseLabels, int defaultLabel)
+{
 	// Sort the case values by increasing value. Do the sort together with the labels
 	// A simple bubble sort is sufficient since we don't expect a huge number of values
 	for( asUINT fwd = 1; fwd < caseValues.GetLength(); fwd++ )
@@ -4580,17 +4875,42 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 
 	// If the value is larger than the largest case value, jump to default
 	int tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
-	expr.bc.InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[caseValues.GetLength()-1]);
-	expr.bc.InstrW_W(asBC_CMPi, offset, tmpOffset);
-	expr.bc.InstrDWORD(asBC_JP, defaultLabel);
-	ReleaseTemporaryVariable(tmpOffset, &expr.bc);
+	bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[caseValues.GetLength()-1]);
+	bc->InstrW_W(asBC_CMPi, offset, tmpOffset);
+	bc->InstrDWORD(asBC_JP, defaultLabel);
+	ReleaseTemporaryVariable(tmpOffset, bc);
+
+	CompileSwitchRanges(bc, offset, caseValues, caseLabels, ranges, 0, (int)ranges.GetLength(), defaultLabel);
+}
 
-	// TODO: runtime optimize: We could possibly optimize this even more by doing a
-	//                         binary search instead of a linear search through the ranges
+// Outputs the comparisons for the ranges from first up to, but not including, last. With
+// many sparse values a binary search over the ranges is done, so the number of comparisons
+// grows with the logarithm of the number of ranges instead of linearly
+void asCCompiler::CompileSwitchRanges(asCByteCode *bc, int offset, const asCArray<int> &caseValues, const asCArray<int> &caseLabels, const asCArray<int> &ranges, int first, int last, int defaultLabel)
+{
+	// A few ranges are cheaper to test in sequence
+	const int MAX_SEQUENTIAL_RANGES = 4;
+	if( last - first > MAX_SEQUENTIAL_RANGES )
+	{
+		// If the value is smaller than the smallest case value in the middle range, search the lower half
+		int mid = (first + last) / 2;
+		int lowerLabel = nextLabel++;
+		int tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
+		bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[ranges[mid]]);
+		bc->InstrW_W(asBC_CMPi, offset, tmpOffset);
+		bc->InstrDWORD(asBC_JS, lowerLabel);
+		ReleaseTemporaryVariable(tmpOffset, bc);
+
+		CompileSwitchRanges(bc, offset, caseValues, caseLabels, ranges, mid, last, defaultLabel);
+
+		bc->Label((short)lowerLabel);
+		CompileSwitchRanges(bc, offset, caseValues, caseLabels, ranges, first, mid, defaultLabel);
+		return;
+	}
 
 	// For each range
 	int range;
-	for( range = 0; range < (int)ranges.GetLength(); range++ )
+	for( range = first; range < last; range++ )
 	{
 		// Find the largest value in this range
 		int maxRange = caseValues[ranges[range]];
@@ -4602,127 +4922,60 @@ void asCCompiler::CompileSwitchStatement(asCScriptNode *snode, bool *hasReturn,
 		if( index - ranges[range] > 2 )
 		{
 			// If the value is smaller than the smallest case value in the range, jump to default
-			tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
-			expr.bc.InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[ranges[range]]);
-			expr.bc.InstrW_W(asBC_CMPi, offset, tmpOffset);
-			expr.bc.InstrDWORD(asBC_JS, defaultLabel);
-			ReleaseTemporaryVariable(tmpOffset, &expr.bc);
+			int tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
+			bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[ranges[range]]);
+			bc->InstrW_W(asBC_CMPi, offset, tmpOffset);
+			bc->InstrDWORD(asBC_JS, defaultLabel);
+			ReleaseTemporaryVariable(tmpOffset, bc);
 
 			int nextRangeLabel = nextLabel++;
-			// If this is the last range we don't have to make this test
+			// If this is the last range we don't have to make this test, since the
+			// value has already been compared with the largest case value
 			if( range < (int)ranges.GetLength() - 1 )
 			{
 				// If the value is larger than the largest case value in the range, jump to the next range
 				tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
-				expr.bc.InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, maxRange);
-				expr.bc.InstrW_W(asBC_CMPi, offset, tmpOffset);
-				expr.bc.InstrDWORD(asBC_JP, nextRangeLabel);
-				ReleaseTemporaryVariable(tmpOffset, &expr.bc);
+				bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, maxRange);
+				bc->InstrW_W(asBC_CMPi, offset, tmpOffset);
+				bc->InstrDWORD(asBC_JP, range < last - 1 ? nextRangeLabel : defaultLabel);
+				ReleaseTemporaryVariable(tmpOffset, bc);
 			}
 
 			// Jump forward according to the value
 			tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
-			expr.bc.InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[ranges[range]]);
-			expr.bc.InstrW_W_W(asBC_SUBi, tmpOffset, offset, tmpOffset);
-			ReleaseTemporaryVariable(tmpOffset, &expr.bc);
-			expr.bc.JmpP(tmpOffset, maxRange - caseValues[ranges[range]]);
+			bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[ranges[range]]);
+			bc->InstrW_W_W(asBC_SUBi, tmpOffset, offset, tmpOffset);
+			ReleaseTemporaryVariable(tmpOffset, bc);
+			bc->JmpP(tmpOffset, maxRange - caseValues[ranges[range]]);
 
 			// Add the list of jumps to the correct labels (any holes, jump to default)
 			index = ranges[range];
 			for( int i = caseValues[index]; i <= maxRange; i++ )
 			{
 				if( caseValues[index] == i )
-					expr.bc.InstrINT(asBC_JMP, caseLabels[index++]);
+					bc->InstrINT(asBC_JMP, caseLabels[index++]);
 				else
-					expr.bc.InstrINT(asBC_JMP, defaultLabel);
+					bc->InstrINT(asBC_JMP, defaultLabel);
 			}
 
-			expr.bc.Label((short)nextRangeLabel);
+			bc->Label((short)nextRangeLabel);
 		}
 		else
 		{
 			// Simply make a comparison with each value
 			for( int i = ranges[range]; i < index; ++i )
 			{
-				tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
-				expr.bc.InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[i]);
-				expr.bc.InstrW_W(asBC_CMPi, offset, tmpOffset);
-				expr.bc.InstrDWORD(asBC_JZ, caseLabels[i]);
-				ReleaseTemporaryVariable(tmpOffset, &expr.bc);
+				int tmpOffset = AllocateVariable(asCDataType::CreatePrimitive(ttInt, false), true);
+				bc->InstrSHORT_DW(asBC_SetV4, (short)tmpOffset, caseValues[i]);
+				bc->InstrW_W(asBC_CMPi, offset, tmpOffset);
+				bc->InstrDWORD(asBC_JZ, caseLabels[i]);
+				ReleaseTemporaryVariable(tmpOffset, bc);
 			}
 		}
 	}
 
 	// Catch any value that falls trough
-	expr.bc.InstrINT(asBC_JMP, defaultLabel);
-
-	// Release the temporary variable previously stored
-	ReleaseTemporaryVariable(expr.type, &expr.bc);
-
-	// TODO: optimize: Should optimize each piece individually
-	expr.bc.OptimizeLocally(tempVariableOffsets);
-
-	//----------------------------------
-    // Output case implementations
-	//----------------------------------
-
-	// Switch cases must be able to report if all paths have return too
-	// If the switch case has no default case, then it doesn't return
-	// If a case has a break without first return then the switch has no return
-	// If a case doesn't have a return, but falls through to a case that does return then the case can be said to have a return too
-	*hasReturn = true;
-
-	// Compile case implementations, each one with the label before it
-	cnode = snode->firstChild->next;
-	while( cnode )
-	{
-		// Each case should have a constant expression
-		if( cnode->firstChild && cnode->firstChild->nodeType == snExpression )
-		{
-			expr.bc.Label((short)firstCaseLabel++);
-
-			bool caseHasReturn, caseHasBreak;
-			CompileCase(cnode->firstChild->next, &expr.bc, &caseHasReturn, &caseHasBreak);
-
-			// If the case does not return and have a break, then we know the switch doesn't return in all paths
-			if (!caseHasReturn && caseHasBreak)
-				*hasReturn = false;
-		}
-		else
-		{
-			expr.bc.Label((short)defaultLabel);
-
-			// Is default the last case?
-			if( cnode->next )
-			{
-				// We've already reported this error
-				break;
-			}
-
-			bool caseHasReturn, caseHasBreak;
-			CompileCase(cnode->firstChild, &expr.bc, &caseHasReturn, &caseHasBreak);
-
-			// If the default case does not return then we know the switch doesn't return in all paths
-			if (!caseHasReturn)
-				*hasReturn = false;
-		}
-
-		cnode = cnode->next;
-	}
-
-	// If there is no default case, then the switch cannot be said to return in all paths
-	if (defaultLabel == breakLabel)
-		*hasReturn = false;
-
-	//--------------------------------
-
-	bc->AddCode(&expr.bc);
-
-	// Add break label
-	bc->Label((short)breakLabel);
-
-	breakLabels.PopLast();
-	RemoveVariableScope();
+	bc->InstrINT(asBC_JMP, defaultLabel);
 }
 
 void asCCompiler::CompileCase(asCScriptNode *node, asCByteCode *bc, bool *hasReturn, bool *hasBreak)
@@ -6455,6 +6708,46 @@ int asCCompiler::GetVariableOffset(int varIndex)
 }
 
 
+void asCCompiler::ReleaseMovedVariables()
+{
+	const asCArray<int> &moved = byteCode.movedVariables;
+	asUINT n, m;
+
+	// Update the debug information for the variables that were moved
+	for( n = 0; n < outFunc->scriptData->variables.GetLength(); n++ )
+	{
+		asSScriptVariable *var = outFunc->scriptData->variables[n];
+		for( m = 0; m < moved.GetLength(); m += 2 )
+		{
+			if( moved[m] == var->stackOffset )
+			{
+				var->stackOffset = moved[m+1];
+				break;
+			}
+		}
+	}
+
+	// The positions that were left by the moved variables without being taken by
+	// other variables are no longer used. Those at the top of the stack can be released.
+	int varSize = 0;
+	for( n = 0; n < variableAllocations.GetLength(); n++ )
+	{
+		int offset = GetVariableOffset(n);
+		bool isLeft = false, isTaken = false;
+		for( m = 0; m < moved.GetLength(); m += 2 )
+		{
+			if( moved[m] == offset )   isLeft = true;
+			if( moved[m+1] == offset ) isTaken = true;
+		}
+
+		if( (!isLeft || isTaken) && offset > varSize )
+			varSize = offset;
+	}
+
+	if( varSize < (int)outFunc->scriptData->variableSpace )
+		outFunc->scriptData->variableSpace = varSize;
+}
+
 int asCCompiler::GetVariableSlot(int offset)
 {
 	int varOffset = 1;
@@ -11370,6 +11663,15 @@ int asCCompiler::CompileVariableAccess(const asCString &name, const asCString &s
 			asCGlobalProperty *prop = builder->GetGlobalProperty(name.AddressOf(), ns, &isCompiled, &isPureConstant, &constantValue, &isAppProp);
 			asASSERT(prop);
 
+			// A constexpr function can only use the global constants that the compiler knows the value of
+			if (outFunc->IsConstExpr() && isCompiled && !isPureConstant)
+			{
+				asCString str;
+				str.Format(TXT_CONSTEXPR_CANNOT_ACCESS_s, prop->name.AddressOf());
+				Error(str, errNode);
+				return -1;
+			}
+
 			// Verify that the global property has been compiled already
 			if (!isCompiled)
 			{
@@ -15333,13 +15635,691 @@ int asCCompiler::CompileOverloadedDualOperator2(asCScriptNode *node, const char
 	return 0;
 }
 
-int asCCompiler::MakeFunctionCall(asCExprContext *ctx, int funcId, asCObjectType *objectType, asCArray<asCExprContext*> &args, asCScriptNode *node, bool useVariable, int stackOffset, int funcPtrVar)
+// Returns the property if the method is a trivial get accessor, i.e. its body is
+// only 'return prop;' or 'return this.prop;' for a property of primitive type
+asCObjectProperty *asCCompiler::FindInlineGetterProperty(asCScriptFunction *func)
 {
-	if( objectType )
+	if( engine->ep.optimizeByteCode < 2 || func == 0 || func->funcType != asFUNC_SCRIPT || func->objectType == 0 )
+		return 0;
+
+	if( func->parameterTypes.GetLength() || func->returnType.IsReference() || !func->returnType.IsPrimitive() )
+		return 0;
+
+	// The function must be declared in the module being built so the source is available
+	sFunctionDescription *desc = 0;
+	for( asUINT n = 0; n < builder->functions.GetLength(); n++ )
+	{
+		if( builder->functions[n] && builder->functions[n]->funcId == func->id )
+		{
+			desc = builder->functions[n];
+			break;
+		}
+	}
+	if( desc == 0 || desc->isExistingShared || desc->node == 0 || desc->script == 0 )
+		return 0;
+
+	// The statement block isn't parsed until the function is compiled, so look at the tokens directly
+	asCScriptNode *block = desc->node->nodeType == snStatementBlock ? desc->node : desc->node->lastChild;
+	if( block == 0 || block->nodeType != snStatementBlock )
+		return 0;
+
+	const eTokenType pattern[] = { ttStartStatementBlock, ttReturn, ttIdentifier, ttEndStatement, ttEndStatementBlock };
+	const eTokenType patternThis[] = { ttStartStatementBlock, ttReturn, ttIdentifier, ttDot, ttIdentifier, ttEndStatement, ttEndStatementBlock };
+	const asUINT maxTokens = sizeof(patternThis)/sizeof(patternThis[0]);
+
+	eTokenType tokens[maxTokens];
+	size_t tokenPos[maxTokens];
+	size_t tokenLen[maxTokens];
+	asUINT numTokens = 0;
+	size_t pos = block->tokenPos;
+	size_t end = block->tokenPos + block->tokenLength;
+	while( pos < end )
+	{
+		size_t len = 0;
+		eTokenType t = engine->tok.GetToken(&desc->script->code[pos], end - pos, &len);
+		if( t != ttWhiteSpace && t != ttOnelineComment && t != ttMultilineComment )
+		{
+			if( numTokens == maxTokens )
+				return 0;
+			tokens[numTokens] = t;
+			tokenPos[numTokens] = pos;
+			tokenLen[numTokens] = len;
+			numTokens++;
+		}
+		pos += len;
+	}
+
+	const eTokenType *expect = numTokens == maxTokens ? patternThis : pattern;
+	if( numTokens != maxTokens && numTokens != sizeof(pattern)/sizeof(pattern[0]) )
+		return 0;
+	for( asUINT n = 0; n < numTokens; n++ )
+		if( tokens[n] != expect[n] )
+			return 0;
+
+	asCString name(&desc->script->code[tokenPos[2]], tokenLen[2]);
+	if( numTokens == maxTokens )
+	{
+		if( name != THIS_TOKEN )
+			return 0;
+		name.Assign(&desc->script->code[tokenPos[4]], tokenLen[4]);
+	}
+
+	// As the method has no parameters or local variables the name can only refer to the
+	// class member, unless the class doesn't have such a property. Virtual properties
+	// aren't found here so those are not inlined
+	asCDataType dt = asCDataType::CreateType(func->objectType, false);
+	asCObjectProperty *prop = builder->GetObjectProperty(dt, name.AddressOf());
+	if( prop == 0 || prop->type.IsReference() || !prop->type.IsPrimitive() ||
+		prop->compositeOffset || prop->isCompositeIndirect ||
+		!prop->type.IsEqualExceptRefAndConst(func->returnType) )
+		return 0;
+
+	return prop;
+}
+
+// internal
+// Returns true if the bytecode only works on the values in local variables and calls other
+// constexpr functions. If visited is given the called functions must also be compiled already
+bool asCCompiler::IsConstExprByteCode(asCScriptFunction *func, asCArray<asCScriptFunction*> *visited)
+{
+	if( visited )
+	{
+		if( visited->IndexOf(func) >= 0 )
+			return true;
+		visited->PushLast(func);
+
+		if( func->funcType != asFUNC_SCRIPT || !func->IsConstExpr() || func->scriptData == 0 || func->scriptData->byteCode.GetLength() == 0 )
+			return false;
+	}
+
+	asCArray<asDWORD> &bc = func->scriptData->byteCode;
+	for( asUINT n = 0; n < bc.GetLength(); n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		switch( *(asBYTE*)&bc[n] )
+		{
+		case asBC_CALL:
+			{
+				asCScriptFunction *callee = engine->scriptFunctions[asBC_INTARG(&bc[n])];
+				if( callee == 0 || !callee->IsConstExpr() )
+					return false;
+				if( visited && !IsConstExprByteCode(callee, visited) )
+					return false;
+			}
+			break;
+
+		// Instructions that only access the local variables, the stack and the registers
+		case asBC_PopPtr:    case asBC_PshC4:     case asBC_PshV4:     case asBC_PSF:       case asBC_SwapPtr:
+		case asBC_NOT:       case asBC_RET:       case asBC_JMP:       case asBC_JZ:        case asBC_JNZ:
+		case asBC_JS:        case asBC_JNS:       case asBC_JP:        case asBC_JNP:       case asBC_TZ:
+		case asBC_TNZ:       case asBC_TS:        case asBC_TNS:       case asBC_TP:        case asBC_TNP:
+		case asBC_NEGi:      case asBC_NEGf:      case asBC_NEGd:      case asBC_INCi16:    case asBC_INCi8:
+		case asBC_DECi16:    case asBC_DECi8:     case asBC_INCi:      case asBC_DECi:      case asBC_INCf:
+		case asBC_DECf:      case asBC_INCd:      case asBC_DECd:      case asBC_IncVi:     case asBC_DecVi:
+		case asBC_BNOT:      case asBC_BAND:      case asBC_BOR:       case asBC_BXOR:      case asBC_BSLL:
+		case asBC_BSRL:      case asBC_BSRA:      case asBC_PshC8:     case asBC_CMPd:      case asBC_CMPu:
+		case asBC_CMPf:      case asBC_CMPi:      case asBC_CMPIi:     case asBC_CMPIf:     case asBC_CMPIu:
+		case asBC_JMPP:      case asBC_PopRPtr:   case asBC_SUSPEND:   case asBC_SetV4:     case asBC_SetV8:
+		case asBC_CpyVtoV4:  case asBC_CpyVtoV8:  case asBC_CpyVtoR4:  case asBC_CpyVtoR8:  case asBC_CpyRtoV4:
+		case asBC_CpyRtoV8:  case asBC_WRTV1:     case asBC_WRTV2:     case asBC_WRTV4:     case asBC_WRTV8:
+		case asBC_RDR1:      case asBC_RDR2:      case asBC_RDR4:      case asBC_RDR8:      case asBC_LDV:
+		case asBC_iTOf:      case asBC_fTOi:      case asBC_uTOf:      case asBC_fTOu:      case asBC_sbTOi:
+		case asBC_swTOi:     case asBC_ubTOi:     case asBC_uwTOi:     case asBC_dTOi:      case asBC_dTOu:
+		case asBC_dTOf:      case asBC_iTOd:      case asBC_uTOd:      case asBC_fTOd:      case asBC_ADDi:
+		case asBC_SUBi:      case asBC_MULi:      case asBC_DIVi:      case asBC_MODi:      case asBC_ADDf:
+		case asBC_SUBf:      case asBC_MULf:      case asBC_DIVf:      case asBC_MODf:      case asBC_ADDd:
+		case asBC_SUBd:      case asBC_MULd:      case asBC_DIVd:      case asBC_MODd:      case asBC_ADDIi:
+		case asBC_SUBIi:     case asBC_MULIi:     case asBC_ADDIf:     case asBC_SUBIf:     case asBC_MULIf:
+		case asBC_iTOb:      case asBC_iTOw:      case asBC_SetV1:     case asBC_SetV2:     case asBC_i64TOi:
+		case asBC_uTOi64:    case asBC_iTOi64:    case asBC_fTOi64:    case asBC_dTOi64:    case asBC_fTOu64:
+		case asBC_dTOu64:    case asBC_i64TOf:    case asBC_u64TOf:    case asBC_i64TOd:    case asBC_u64TOd:
+		case asBC_NEGi64:    case asBC_INCi64:    case asBC_DECi64:    case asBC_BNOT64:    case asBC_ADDi64:
+		case asBC_SUBi64:    case asBC_MULi64:    case asBC_DIVi64:    case asBC_MODi64:    case asBC_BAND64:
+		case asBC_BOR64:     case asBC_BXOR64:    case asBC_BSLL64:    case asBC_BSRL64:    case asBC_BSRA64:
+		case asBC_CMPi64:    case asBC_CMPu64:    case asBC_ClrHi:     case asBC_JitEntry:  case asBC_PshV8:
+		case asBC_DIVu:      case asBC_MODu:      case asBC_DIVu64:    case asBC_MODu64:    case asBC_JLowZ:
+		case asBC_JLowNZ:    case asBC_POWi:      case asBC_POWu:      case asBC_POWf:      case asBC_POWd:
+		case asBC_POWdi:     case asBC_POWi64:    case asBC_POWu64:    case asBC_ADDIi64:   case asBC_SUBIi64:
+		case asBC_MULIi64:   case asBC_CMPIi64:   case asBC_CMPIu64:   case asBC_ADDId:     case asBC_SUBId:
+		case asBC_MULId:     case asBC_CMPId:
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// internal
+void asCCompiler::ConstExprLineCallback(asIScriptContext *ctx, asUINT *count)
+{
+	// Give up on evaluations that don't seem to finish, or that recurse too deeply
+	if( ++(*count) > 1000000 || ctx->GetCallstackSize() > 1000 )
+		ctx->Abort();
+}
+
+// internal
+// Executes the constexpr function with the constant arguments and replaces the call with the returned
+// value. Returns 1 if the call was evaluated, 0 if the call must be compiled normally, or negative on error
+int asCCompiler::EvaluateConstExprCall(asCExprContext *ctx, asCScriptFunction *func, asCArray<asCExprContext*> &args, asCScriptNode *node)
+{
+	if( args.GetLength() != func->parameterTypes.GetLength() || ctx->bc.GetLastInstr() != -1 )
+		return 0;
+
+	asUINT n;
+	for( n = 0; n < args.GetLength(); n++ )
+		if( !args[n]->type.isConstant || args[n]->bc.GetLastInstr() != -1 )
+			return 0;
+
+	asCArray<asCScriptFunction*> visited;
+	if( !IsConstExprByteCode(func, &visited) )
+	{
+		// The global variables are compiled in several passes, so a variable that calls a
+		// constexpr function that hasn't been compiled yet is compiled again in the next pass
+		if( builder->isCompilingGlobalVars && !outFunc->IsConstExpr() )
+		{
+			asCString str;
+			str.Format(TXT_CONSTEXPR_s_NOT_COMPILED, func->GetDeclaration());
+			Error(str, node);
+			return -1;
+		}
+
+		return 0;
+	}
+
+	// The arguments are converted on copies, so they are left untouched if the call must be compiled
+	// normally. Any warnings are reported by the conversion that is done for the call that is kept
+	asCArray<asCExprValue> values;
+	bool silent = builder->silent;
+	int numWarnings = builder->numWarnings;
+	builder->silent = true;
+	for( n = 0; n < args.GetLength(); n++ )
+	{
+		asCExprContext conv(engine);
+		conv.Copy(args[n]);
+		ImplicitConversion(&conv, func->parameterTypes[n], node, asIC_IMPLICIT_CONV);
+		if( !conv.type.isConstant || conv.bc.GetLastInstr() != -1 || !conv.type.dataType.IsEqualExceptRefAndConst(func->parameterTypes[n]) )
+			break;
+		values.PushLast(conv.type);
+	}
+	builder->silent = silent;
+	builder->numWarnings = numWarnings;
+	if( values.GetLength() != args.GetLength() )
+		return 0;
+
+	asIScriptContext *evalCtx = 0;
+	if( engine->CreateContext(&evalCtx, true) < 0 )
+		return 0;
+
+	asUINT count = 0;
+	evalCtx->SetLineCallback(asFUNCTION(ConstExprLineCallback), &count, asCALL_CDECL);
+
+	int r = evalCtx->Prepare(func);
+	for( n = 0; r >= 0 && n < args.GetLength(); n++ )
+	{
+		asCExprValue &value = values[n];
+		switch( value.dataType.GetSizeInMemoryBytes() )
+		{
+		case 1:  r = evalCtx->SetArgByte(n, value.GetConstantB()); break;
+		case 2:  r = evalCtx->SetArgWord(n, value.GetConstantW()); break;
+		case 4:  r = evalCtx->SetArgDWord(n, value.GetConstantDW()); break;
+		default: r = evalCtx->SetArgQWord(n, value.GetConstantQW()); break;
+		}
+	}
+
+	// If the function raises an exception or doesn't finish the call is made at runtime instead
+	if( r >= 0 )
+		r = evalCtx->Execute();
+
+	if( r == asEXECUTION_FINISHED )
+	{
+		asCDataType dt = func->returnType;
+		dt.MakeReadOnly(true);
+		switch( dt.GetSizeInMemoryBytes() )
+		{
+		case 1:  ctx->type.SetConstantB(dt, evalCtx->GetReturnByte()); break;
+		case 2:  ctx->type.SetConstantW(dt, evalCtx->GetReturnWord()); break;
+		case 4:  ctx->type.SetConstantDW(dt, evalCtx->GetReturnDWord()); break;
+		default: ctx->type.SetConstantQW(dt, evalCtx->GetReturnQWord()); break;
+		}
+	}
+
+	evalCtx->Release();
+
+	if( r != asEXECUTION_FINISHED )
+		return 0;
+
+	// Report the warnings from the conversions of the arguments that were evaluated
+	for( n = 0; n < args.GetLength(); n++ )
+		ImplicitConversion(args[n], func->parameterTypes[n], node, asIC_IMPLICIT_CONV);
+
+	ctx->exprNode = node;
+	return 1;
+}
+
+// internal
+// Returns true if the calls to the function can be replaced with a copy of its bytecode. This is
+// done for compiled functions that only work on primitive values, and that don't call other functions
+bool asCCompiler::CanInlineFunction(asCScriptFunction *func)
+{
+	// The largest bytecode, in dwords, that is inlined without the inline decorator
+	const asUINT maxAutoInlineSize = 32;
+
+	if( engine->ep.optimizeByteCode == 0 || func == 0 || func == outFunc || func->funcType != asFUNC_SCRIPT ||
+		func->IsNoInline() || func->IsVariadic() || func->module != outFunc->module ||
+		func->scriptData == 0 || func->scriptData->byteCode.GetLength() == 0 )
+		return false;
+
+	if( !func->IsInline() && engine->ep.optimizeByteCode < 2 )
+		return false;
+
+	if( func->returnType.IsReference() || !(func->returnType.IsPrimitive() || func->returnType.GetTokenType() == ttVoid) )
+		return false;
+
+	// The parameters are replaced with the caller's variables holding the arguments
+	asCArray<int> offsets;
+	int stackPos = 0;
+	if( func->objectType )
+	{
+		offsets.PushLast(0);
+		stackPos = -AS_PTR_SIZE;
+	}
+	asUINT n;
+	for( n = 0; n < func->parameterTypes.GetLength(); n++ )
+	{
+		const asCDataType &dt = func->parameterTypes[n];
+		if( dt.IsReference() || !dt.IsPrimitive() || dt.GetTokenType() == ttQuestion )
+			return false;
+		offsets.PushLast(stackPos);
+		stackPos -= dt.GetSizeOnStackDWords();
+	}
+
+	// Object variables would have to be cleaned up if an exception is raised
+	if( func->scriptData->tryCatchInfo.GetLength() )
+		return false;
+	for( n = 0; n < func->scriptData->variables.GetLength(); n++ )
+	{
+		asSScriptVariable *var = func->scriptData->variables[n];
+		if( var->type.IsReference() || !var->type.IsPrimitive() )
+			return false;
+		if( var->stackOffset > 0 && offsets.IndexOf(var->stackOffset) < 0 )
+			offsets.PushLast(var->stackOffset);
+	}
+
+	asUINT size = 0;
+	asCArray<asDWORD> &bc = func->scriptData->byteCode;
+	for( n = 0; n < bc.GetLength(); n += asBCTypeSize[asBCInfo[*(asBYTE*)&bc[n]].type] )
+	{
+		asDWORD *instr = &bc[n];
+		asEBCInstr op = asEBCInstr(*(asBYTE*)instr);
+		switch( op )
+		{
+		case asBC_SUSPEND:
+		case asBC_JitEntry:
+			// These are not copied
+			continue;
+
+		case asBC_LoadThisR:
+			if( func->objectType == 0 )
+				return false;
+			break;
+
+		// Instructions that only access the variables, the registers, the
+		// stack within the function, and the members of the object
+		case asBC_PopPtr:    case asBC_PshC4:     case asBC_PshV4:     case asBC_PSF:       case asBC_SwapPtr:
+		case asBC_NOT:       case asBC_RET:       case asBC_JMP:       case asBC_JZ:        case asBC_JNZ:
+		case asBC_JS:        case asBC_JNS:       case asBC_JP:        case asBC_JNP:       case asBC_TZ:
+		case asBC_TNZ:       case asBC_TS:        case asBC_TNS:       case asBC_TP:        case asBC_TNP:
+		case asBC_NEGi:      case asBC_NEGf:      case asBC_NEGd:      case asBC_INCi16:    case asBC_INCi8:
+		case asBC_DECi16:    case asBC_DECi8:     case asBC_INCi:      case asBC_DECi:      case asBC_INCf:
+		case asBC_DECf:      case asBC_INCd:      case asBC_DECd:      case asBC_IncVi:     case asBC_DecVi:
+		case asBC_BNOT:      case asBC_BAND:      case asBC_BOR:       case asBC_BXOR:      case asBC_BSLL:
+		case asBC_BSRL:      case asBC_BSRA:      case asBC_PshC8:     case asBC_CMPd:      case asBC_CMPu:
+		case asBC_CMPf:      case asBC_CMPi:      case asBC_CMPIi:     case asBC_CMPIf:     case asBC_CMPIu:
+		case asBC_PopRPtr:   case asBC_SetV4:     case asBC_SetV8:     case asBC_CpyVtoV4:  case asBC_CpyVtoV8:
+		case asBC_CpyVtoR4:  case asBC_CpyVtoR8:  case asBC_CpyRtoV4:  case asBC_CpyRtoV8:  case asBC_WRTV1:
+		case asBC_WRTV2:     case asBC_WRTV4:     case asBC_WRTV8:     case asBC_RDR1:      case asBC_RDR2:
+		case asBC_RDR4:      case asBC_RDR8:      case asBC_LDV:       case asBC_iTOf:      case asBC_fTOi:
+		case asBC_uTOf:      case asBC_fTOu:      case asBC_sbTOi:     case asBC_swTOi:     case asBC_ubTOi:
+		case asBC_uwTOi:     case asBC_dTOi:      case asBC_dTOu:      case asBC_dTOf:      case asBC_iTOd:
+		case asBC_uTOd:      case asBC_fTOd:      case asBC_ADDi:      case asBC_SUBi:      case asBC_MULi:
+		case asBC_DIVi:      case asBC_MODi:      case asBC_ADDf:      case asBC_SUBf:      case asBC_MULf:
+		case asBC_DIVf:      case asBC_MODf:      case asBC_ADDd:      case asBC_SUBd:      case asBC_MULd:
+		case asBC_DIVd:      case asBC_MODd:      case asBC_ADDIi:     case asBC_SUBIi:     case asBC_MULIi:
+		case asBC_ADDIf:     case asBC_SUBIf:     case asBC_MULIf:     case asBC_iTOb:      case asBC_iTOw:
+		case asBC_SetV1:     case asBC_SetV2:     case asBC_i64TOi:    case asBC_uTOi64:    case asBC_iTOi64:
+		case asBC_fTOi64:    case asBC_dTOi64:    case asBC_fTOu64:    case asBC_dTOu64:    case asBC_i64TOf:
+		case asBC_u64TOf:    case asBC_i64TOd:    case asBC_u64TOd:    case asBC_NEGi64:    case asBC_INCi64:
+		case asBC_DECi64:    case asBC_BNOT64:    case asBC_ADDi64:    case asBC_SUBi64:    case asBC_MULi64:
+		case asBC_DIVi64:    case asBC_MODi64:    case asBC_BAND64:    case asBC_BOR64:     case asBC_BXOR64:
+		case asBC_BSLL64:    case asBC_BSRL64:    case asBC_BSRA64:    case asBC_CMPi64:    case asBC_CMPu64:
+		case asBC_ClrHi:     case asBC_PshV8:     case asBC_DIVu:      case asBC_MODu:      case asBC_DIVu64:
+		case asBC_MODu64:    case asBC_JLowZ:     case asBC_JLowNZ:    case asBC_POWi:      case asBC_POWu:
+		case asBC_POWf:      case asBC_POWd:      case asBC_POWdi:     case asBC_POWi64:    case asBC_POWu64:
+		case asBC_ADDIi64:   case asBC_SUBIi64:   case asBC_MULIi64:   case asBC_CMPIi64:   case asBC_CMPIu64:
+		case asBC_ADDId:     case asBC_SUBId:     case asBC_MULId:     case asBC_CMPId:     case asBC_LoadRObjR:
+		case asBC_LoadVObjR: case asBC_PshVPtr:   case asBC_ADDSi:     case asBC_RDSPtr:    case asBC_PshRPtr:
+		case asBC_ChkNullV:  case asBC_PshNull:   case asBC_PGA:       case asBC_LDG:       case asBC_PshG4:
+		case asBC_CpyGtoV4:  case asBC_CpyVtoG4:  case asBC_LdGRdR4:
+			break;
+
+		default:
+			return false;
+		}
+
+		// Without the suspend instructions a loop cannot be interrupted by
+		// the line callback, so loops are only inlined when asked to
+		if( ((op >= asBC_JMP && op <= asBC_JNP) || op == asBC_JLowZ || op == asBC_JLowNZ) && asBC_INTARG(instr) < 0 && !func->IsInline() )
+			return false;
+
+		size += asBCTypeSize[asBCInfo[op].type];
+
+		// All the variables must be parameters or local variables so they can be mapped to the caller's variables
+		int count = 0;
+		switch( asBCInfo[op].type )
+		{
+		case asBCTYPE_wW_rW_rW_ARG:
+			count = 3;
+			break;
+		case asBCTYPE_wW_rW_ARG:
+		case asBCTYPE_rW_rW_ARG:
+		case asBCTYPE_wW_rW_DW_ARG:
+		case asBCTYPE_wW_rW_QW_ARG:
+			count = 2;
+			break;
+		case asBCTYPE_rW_ARG:
+		case asBCTYPE_wW_ARG:
+		case asBCTYPE_wW_W_ARG:
+		case asBCTYPE_rW_DW_ARG:
+		case asBCTYPE_wW_DW_ARG:
+		case asBCTYPE_wW_QW_ARG:
+		case asBCTYPE_rW_QW_ARG:
+		case asBCTYPE_rW_W_DW_ARG:
+		case asBCTYPE_rW_DW_DW_ARG:
+			count = 1;
+			break;
+		default:
+			break;
+		}
+		for( int v = 0; v < count; v++ )
+			if( offsets.IndexOf(((short*)instr)[v+1]) < 0 )
+				return false;
+	}
+
+	return func->IsInline() || size <= maxAutoInlineSize;
+}
+
+// internal
+// Replaces the call with a copy of the function's bytecode. Returns 1 if the call
+// was inlined, 0 if the call must be compiled normally, or negative on error
+int asCCompiler::InlineFunctionCall(asCExprContext *ctx, asCScriptFunction *func, asCArray<asCExprContext*> &args, asCScriptNode *node)
+{
+	if( args.GetLength() != func->parameterTypes.GetLength() || !CanInlineFunction(func) )
+		return 0;
+
+	// The calls that aren't allowed are compiled normally so the errors are reported
+	if( (outFunc->IsShared() && !func->IsShared()) ||
+		(func->IsPrivate() && func->objectType != outFunc->objectType) ||
+		(func->IsProtected() && !(func->objectType == outFunc->objectType || (outFunc->objectType && outFunc->objectType->DerivesFrom(func->objectType)))) )
+		return 0;
+
+	if( func->objectType )
+	{
+		if( CastToObjectType(ctx->type.dataType.GetTypeInfo()) == 0 )
+			return 0;
+
+		if( ctx->type.dataType.IsObjectHandle() )
+		{
+			// Convert the handle to a normal object
+			asCDataType dt = ctx->type.dataType;
+			dt.MakeHandle(false);
+			ImplicitConversion(ctx, dt, node, asIC_IMPLICIT_CONV);
+		}
+	}
+
+	// Store the expression node for error reporting
+	if( ctx->exprNode == 0 )
+		ctx->exprNode = node;
+
+	asCByteCode objBC(engine);
+	objBC.AddCode(&ctx->bc);
+
+	// The arguments are copied to temporary variables that take the place of the parameters
+	asCExprContext e(engine);
+	int n;
+	for( n = (int)args.GetLength()-1; n >= 0; n-- )
+	{
+		int l = int(reservedVariables.GetLength());
+		for( int m = n; m >= 0; m-- )
+			args[m]->bc.GetVarsUsed(reservedVariables);
+
+		asCExprContext *arg = args[n];
+		int r = ProcessPropertyGetAccessor(arg, arg->exprNode);
+		if( r >= 0 )
+		{
+			IsVariableInitialized(&arg->type, arg->exprNode);
+			ImplicitConversion(arg, func->parameterTypes[n], arg->exprNode, asIC_IMPLICIT_CONV);
+			if( !arg->type.dataType.IsEqualExceptRefAndConst(func->parameterTypes[n]) )
+			{
+				asCString str;
+				str.Format(TXT_CANT_IMPLICITLY_CONVERT_s_TO_s, arg->type.dataType.Format(outFunc->nameSpace).AddressOf(), func->parameterTypes[n].Format(outFunc->nameSpace).AddressOf());
+				Error(str, arg->exprNode);
+				r = -1;
+			}
+			else
+				ConvertToTempVariable(arg);
+		}
+		reservedVariables.SetLength(l);
+		if( r < 0 )
+			return r;
+
+		e.bc.AddCode(&arg->bc);
+	}
+	ctx->bc.AddCode(&e.bc);
+
+	// Verify if any of the args variable offsets are used in the other code.
+	// If they are exchange the offset for a new one
+	for( n = 0; n < (int)args.GetLength(); n++ )
+	{
+		if( objBC.IsVarUsed(args[n]->type.stackOffset) )
+		{
+			ReleaseTemporaryVariable(args[n]->type, 0);
+
+			asCDataType dt = args[n]->type.dataType;
+			dt.MakeReference(false);
+
+			int l = int(reservedVariables.GetLength());
+			objBC.GetVarsUsed(reservedVariables);
+			ctx->bc.GetVarsUsed(reservedVariables);
+			int newOffset = AllocateVariable(dt, true);
+			reservedVariables.SetLength(l);
+
+			ctx->bc.ExchangeVar(args[n]->type.stackOffset, newOffset);
+			args[n]->type.stackOffset = (short)newOffset;
+			args[n]->type.isTemporary = true;
+			args[n]->type.isVariable  = true;
+		}
+	}
+
+	ctx->bc.AddCode(&objBC);
+
+	// Pairs of the variable offsets in the function and in the caller
+	asCArray<int> varMap;
+	asCArray<int> temps;
+	if( func->objectType )
+	{
+		// The object pointer is kept in a variable, as it is no longer at offset 0
+		asCDataType dt = asCDataType::CreatePrimitive(AS_PTR_SIZE == 1 ? ttUInt : ttUInt64, false);
+		int thisVar = AllocateVariable(dt, true);
+		temps.PushLast(thisVar);
+		ctx->bc.Instr(asBC_PopRPtr);
+		ctx->bc.InstrSHORT(AS_PTR_SIZE == 1 ? asBC_CpyRtoV4 : asBC_CpyRtoV8, (short)thisVar);
+		ctx->bc.InstrSHORT(asBC_ChkNullV, (short)thisVar);
+		varMap.PushLast(0);
+		varMap.PushLast(thisVar);
+	}
+
+	int stackPos = func->objectType ? -AS_PTR_SIZE : 0;
+	for( n = 0; n < (int)args.GetLength(); n++ )
+	{
+		varMap.PushLast(stackPos);
+		varMap.PushLast(args[n]->type.stackOffset);
+		stackPos -= func->parameterTypes[n].GetSizeOnStackDWords();
+	}
+
+	// Variables that share the same position in the function share the same variable in the caller too
+	asUINT m;
+	for( m = 0; m < func->scriptData->variables.GetLength(); m++ )
+	{
+		asSScriptVariable *var = func->scriptData->variables[m];
+		if( var->stackOffset <= 0 )
+			continue;
+
+		asUINT v;
+		for( v = 0; v < varMap.GetLength(); v += 2 )
+			if( varMap[v] == var->stackOffset )
+				break;
+		if( v < varMap.GetLength() )
+			continue;
+
+		int offset = AllocateVariable(var->type, true);
+		temps.PushLast(offset);
+		varMap.PushLast(var->stackOffset);
+		varMap.PushLast(offset);
+	}
+
+	ctx->bc.InlineFunction(func, varMap, nextLabel);
+
+	asCExprValue tmpExpr = ctx->type;
+	if( func->returnType.GetSizeInMemoryBytes() )
+	{
+		int offset = AllocateVariable(func->returnType, true);
+		ctx->type.SetVariable(func->returnType, offset, true);
+
+		// Move the value from the return register to the variable
+		if( func->returnType.GetSizeOnStackDWords() == 1 )
+			ctx->bc.InstrSHORT(asBC_CpyRtoV4, (short)offset);
+		else
+			ctx->bc.InstrSHORT(asBC_CpyRtoV8, (short)offset);
+	}
+	else
+		ctx->type.Set(func->returnType);
+
+	for( m = 0; m < temps.GetLength(); m++ )
+		ReleaseTemporaryVariable(temps[m], 0);
+
+	// If the context holds a variable that needs cleanup and the application uses unsafe
+	// references then store it as a deferred parameter so it will be cleaned up afterwards.
+	if( tmpExpr.isTemporary && engine->ep.allowUnsafeReferences )
+	{
+		asSDeferredParam defer;
+		defer.argNode = 0;
+		defer.argType = tmpExpr;
+		defer.argInOutFlags = asTM_INOUTREF;
+		defer.origExpr = 0;
+		ctx->deferredParams.PushLast(defer);
+	}
+	else
+		ReleaseTemporaryVariable(tmpExpr, &ctx->bc);
+
+	ctx->type.isLValue = false;
+
+	AfterFunctionCall(func->id, args, ctx, engine->ep.allowUnsafeReferences ? true : false);
+	ProcessDeferredParams(ctx, engine->ep.allowUnsafeReferences);
+
+	// Remember the inlined function, so BuildIncremental doesn't recompile it without also recompiling the callers
+	if( builder->module && builder->module->m_inlinedFunctions.IndexOf(func->id) < 0 )
+		builder->module->m_inlinedFunctions.PushLast(func->id);
+
+	return 1;
+}
+
+int asCCompiler::MakeFunctionCall(asCExprContext *ctx, int funcId, asCObjectType *objectType, asCArray<asCExprContext*> &args, asCScriptNode *node, bool useVariable, int stackOffset, int funcPtrVar)
+{
+	if( objectType )
 		Dereference(ctx, true);
 
 	asCScriptFunction* descr = builder->GetFunctionDescription(funcId);
 
+	// Trivial get accessors that cannot be overridden are inlined by reading the property directly.
+	// The null pointer check is done by asBC_ADDSi so the exception is the same as for the call
+	if( objectType && args.GetLength() == 0 && !useVariable && funcPtrVar == 0 &&
+		(descr->funcType == asFUNC_SCRIPT || descr->funcType == asFUNC_VIRTUAL) &&
+		CastToObjectType(ctx->type.dataType.GetTypeInfo()) )
+	{
+		asCScriptFunction *realFunc = descr->funcType == asFUNC_VIRTUAL ? FindNonVirtualMethod(descr, objectType) : descr;
+		asCObjectProperty *prop = FindInlineGetterProperty(realFunc);
+		if( prop )
+		{
+			if( ctx->type.dataType.IsObjectHandle() )
+			{
+				// Convert the handle to a normal object
+				asCDataType dt = ctx->type.dataType;
+				dt.MakeHandle(false);
+				ImplicitConversion(ctx, dt, node, asIC_IMPLICIT_CONV);
+			}
+
+			// This must always be done even if the offset is 0 so the type info is stored
+			ctx->bc.InstrSHORT_DW(asBC_ADDSi, (short)prop->byteOffset, engine->GetTypeIdFromDataType(asCDataType::CreateType(ctx->type.dataType.GetTypeInfo(), false)));
+			ctx->bc.Instr(asBC_PopRPtr);
+
+			// A temporary object must be released after the value has been read
+			if( ctx->type.isTemporary )
+			{
+				asSDeferredParam deferred;
+				deferred.origExpr = 0;
+				deferred.argInOutFlags = asTM_INREF;
+				deferred.argNode = 0;
+				deferred.argType.SetVariable(ctx->type.dataType, ctx->type.stackOffset, true);
+
+				ctx->deferredParams.PushLast(deferred);
+			}
+
+			// The value is copied to a temporary variable just like the returned value would be
+			asCDataType dt = prop->type;
+			dt.MakeReadOnly(false);
+			int offset = AllocateVariable(dt, true);
+			if( dt.GetSizeInMemoryBytes() == 1 )
+				ctx->bc.InstrSHORT(asBC_RDR1, (short)offset);
+			else if( dt.GetSizeInMemoryBytes() == 2 )
+				ctx->bc.InstrSHORT(asBC_RDR2, (short)offset);
+			else if( dt.GetSizeInMemoryDWords() == 1 )
+				ctx->bc.InstrSHORT(asBC_RDR4, (short)offset);
+			else
+				ctx->bc.InstrSHORT(asBC_RDR8, (short)offset);
+			ctx->type.SetVariable(dt, offset, true);
+
+			ProcessDeferredParams(ctx);
+
+			// Remember the inlined function, so BuildIncremental doesn't recompile it without also recompiling the callers
+			if( builder->module && builder->module->m_inlinedFunctions.IndexOf(realFunc->id) < 0 )
+				builder->module->m_inlinedFunctions.PushLast(realFunc->id);
+
+			return 0;
+		}
+	}
+
+	// Calls to constexpr functions with constant arguments are evaluated by the compiler
+	if( objectType == 0 && !useVariable && funcPtrVar == 0 && descr->funcType == asFUNC_SCRIPT && descr->IsConstExpr() )
+	{
+		int r = EvaluateConstExprCall(ctx, descr, args, node);
+		if( r != 0 )
+			return r < 0 ? r : 0;
+	}
+
+	// Calls to small functions, and functions declared as inline, are replaced with a copy of the function
+	if( !useVariable && funcPtrVar == 0 && (descr->funcType == asFUNC_SCRIPT || descr->funcType == asFUNC_VIRTUAL) )
+	{
+		asCScriptFunction *realFunc = descr->funcType == asFUNC_VIRTUAL ? FindNonVirtualMethod(descr, objectType) : descr;
+		if( realFunc )
+		{
+			int r = InlineFunctionCall(ctx, realFunc, args, node);
+			if( r != 0 )
+				return r < 0 ? r : 0;
+		}
+	}
+
 	// Store the expression node for error reporting
 	if( ctx->exprNode == 0 )
 		ctx->exprNode = node;
@@ -15401,7 +16381,7 @@ int asCCompiler::MakeFunctionCall(asCExprContext *ctx, int funcId, asCObjectType
 
 	MoveArgsToStack(funcId, &ctx->bc, args, objectType ? true : false);
 
-	PerformFunctionCall(funcId, ctx, false, &args, 0, useVariable, stackOffset, funcPtrVar);
+	PerformFunctionCall(funcId, ctx, false, &args, objectType, useVariable, stackOffset, funcPtrVar);
 	
 	return 0;
 }
@@ -17247,6 +18227,77 @@ void asCCompiler::CompileOperatorOnHandles(asCScriptNode *node, asCExprContext *
 }
 
 
+// Returns true if the value returned by the system function can be received through asBC_Thiscall1,
+// which stores the returned pointer in the value register. Integer values returned in the same
+// register as a pointer will then be in the lower bytes, where the compiler expects them
+bool asCCompiler::IsThiscall1ReturnType(asCScriptFunction *func)
+{
+	if( func->returnType.IsReference() )
+		return true;
+
+#ifndef AS_BIG_ENDIAN
+	asSSystemFunctionInterface *intf = func->sysFuncIntf;
+	if( intf == 0 || intf->auxiliary ||
+		(intf->callConv != ICC_THISCALL && intf->callConv != ICC_VIRTUAL_THISCALL &&
+		 intf->callConv != ICC_CDECL_OBJLAST && intf->callConv != ICC_CDECL_OBJFIRST &&
+		 intf->callConv != ICC_GENERIC_METHOD) )
+		return false;
+
+	// Floats are returned in another register, and 64bit values may not fit in the pointer
+	const asCDataType &dt = func->returnType;
+	if( !dt.IsPrimitive() )
+		return false;
+	if( dt.IsBooleanType() )
+		return true;
+	return (dt.IsIntegerType() || dt.IsUnsignedType()) && dt.GetSizeInMemoryBytes() == 4;
+#else
+	return false;
+#endif
+}
+
+// Returns the implementation of the virtual method if it is known at compile time that no
+// object of the type the method is called on will resolve it to another function, else null
+asCScriptFunction *asCCompiler::FindNonVirtualMethod(asCScriptFunction *func, asCObjectType *objType)
+{
+	if( !engine->ep.optimizeByteCode )
+		return 0;
+
+	// The type of the object expression may be more specific than the type that declared the method
+	if( objType == 0 || !objType->DerivesFrom(func->objectType) )
+		objType = CastToObjectType(func->objectType);
+	if( objType == 0 || func->vfTableIdx < 0 || func->vfTableIdx >= (int)objType->virtualFunctionTable.GetLength() )
+		return 0;
+
+	asCScriptFunction *realFunc = objType->virtualFunctionTable[func->vfTableIdx];
+	if( realFunc == 0 || realFunc->funcType != asFUNC_SCRIPT )
+		return 0;
+
+	// Finalled methods and methods of finalled classes cannot be overridden
+	if( func->IsFinal() || realFunc->IsFinal() || (objType->flags & asOBJ_NOINHERIT) )
+		return realFunc;
+
+	// With the data-flow optimizations the class hierarchy is also checked. A class that
+	// isn't shared can only be derived from in the same module, and all of the
+	// classes in the module have already been declared when the functions are compiled
+	if( engine->ep.optimizeByteCode < 2 || builder == 0 || builder->module == 0 ||
+		objType->IsShared() || objType->module != builder->module )
+		return 0;
+
+	const asCArray<asCObjectType*> &classes = builder->module->m_classTypes;
+	for( asUINT n = 0; n < classes.GetLength(); n++ )
+	{
+		asCObjectType *ot = classes[n];
+		if( ot == objType || !ot->DerivesFrom(objType) )
+			continue;
+
+		if( func->vfTableIdx >= (int)ot->virtualFunctionTable.GetLength() ||
+			ot->virtualFunctionTable[func->vfTableIdx] != realFunc )
+			return 0;
+	}
+
+	return realFunc;
+}
+
 void asCCompiler::PerformFunctionCall(int funcId, asCExprContext *ctx, bool isConstructor, asCArray<asCExprContext*> *args, asCObjectType *objType, bool useVariable, int varOffset, int funcPtrVar)
 {
 	asCScriptFunction *descr = builder->GetFunctionDescription(funcId);
@@ -17414,15 +18465,16 @@ void asCCompiler::PerformFunctionCall(int funcId, asCExprContext *ctx, bool isCo
 		if( descr->DoesReturnOnStack() )
 			argSize += AS_PTR_SIZE;
 
-		// TODO: runtime optimize: If it is known that a class method cannot be overridden the call
-		//                         should be made with asBC_CALL as it is faster. Examples where this
-		//                         is known is for example finalled methods where the class doesn't derive
-		//                         from any other, or even non-finalled methods but where it is known
-		//                         at compile time the true type of the object. The first should be
-		//                         quite easy to determine, but the latter will be quite complex and possibly
-		//                         not worth it.
+		// If it is known that the class method cannot be overridden the call is made with
+		// asBC_CALL directly to the implementation as it is faster than resolving it at runtime
+		asCScriptFunction *realFunc = 0;
+		if( descr->funcType == asFUNC_VIRTUAL )
+			realFunc = FindNonVirtualMethod(descr, objType);
+
 		if( descr->funcType == asFUNC_IMPORTED )
 			ctx->bc.Call(asBC_CALLBND , descr->id, argSize);
+		else if( realFunc )
+			ctx->bc.Call(asBC_CALL    , realFunc->id, argSize);
 		// TODO: Maybe we need two different byte codes
 		else if( descr->funcType == asFUNC_INTERFACE || descr->funcType == asFUNC_VIRTUAL )
 			ctx->bc.Call(asBC_CALLINTF, descr->id, argSize);
@@ -17433,8 +18485,9 @@ void asCCompiler::PerformFunctionCall(int funcId, asCExprContext *ctx, bool isCo
 			// Check if we can use the faster asBC_Thiscall1 instruction, i.e. one of
 			//    type &obj::func(int)
 			//    type &obj::func(uint)
-			if( descr->GetObjectType() && descr->returnType.IsReference() &&
-				descr->parameterTypes.GetLength() == 1 &&
+			//    int   obj::func(uint), and the same with uint or bool as return type
+			if( descr->GetObjectType() && IsThiscall1ReturnType(descr) &&
+				descr->parameterTypes.GetLength() == 1 && !descr->IsVariadic() &&
 				(descr->parameterTypes[0].IsIntegerType() || descr->parameterTypes[0].IsUnsignedType()) &&
 				descr->parameterTypes[0].GetSizeInMemoryBytes() == 4 &&
 				!descr->parameterTypes[0].IsReference() )
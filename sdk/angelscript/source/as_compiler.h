@@ -249,6 +249,8 @@ protected:
 	void CompileIfStatement(asCScriptNode *node, bool *hasReturn, asCByteCode *bc);
 	void CompileSwitchStatement(asCScriptNode *node, bool *hasReturn, asCByteCode *bc);
 	void CompileCase(asCScriptNode *node, asCByteCode *bc, bool *hasReturn, bool *hasBreak);
+	void CompileSwitchJumps(asCByteCode *bc, int offset, asCArray<int> &caseValues, asCArray<int> &caseLabels, int defaultLabel);
+	void CompileSwitchRanges(asCByteCode *bc, int offset, const asCArray<int> &caseValues, const asCArray<int> &caseLabels, const asCArray<int> &ranges, int first, int last, int defaultLabel);
 	void CompileForStatement(asCScriptNode *node, asCByteCode *bc);
 	void CompileForEachStatement(asCScriptNode* node, asCByteCode* bc);
 	void CompileWhileStatement(asCScriptNode *node, asCByteCode *bc);
@@ -284,6 +286,7 @@ protected:
 	int  CompileInitListElement(asSListPatternNode *&patternNode, asCScriptNode *&valueNode, int bufferTypeId, short bufferVar, asUINT &bufferSize, asCByteCode &byteCode, int &elementsInSubList);
 	int  CompileAnonymousInitList(asCScriptNode *listNode, asCExprContext *ctx, const asCDataType &dt);
 
+	void ClearStructMembers(asCObjectType *ot, int offset, bool derefDest, int zeroVar, asCArray<asCObjectProperty*> &path, asCByteCode *bc);
 	int  CallDefaultConstructor(const asCDataType &type, int offset, bool isObjectOnHeap, asCByteCode *bc, asCScriptNode *node, EVarGlobOrMem isVarGlobOrMem = asVGM_VARIABLE, bool derefDest = false);
 	int  CallCopyConstructor(asCDataType &type, int offset, bool isObjectOnHeap, asCExprContext *ctx, asCExprContext *arg, asCScriptNode *node, EVarGlobOrMem isVarGlobOrMem = asVGM_VARIABLE, bool derefDestination = false);
 	void CallDestructor(asCDataType &type, int offset, bool isObjectOnHeap, asCByteCode *bc);
@@ -314,7 +317,15 @@ protected:
 	asUINT MatchFunctions(asCArray<int>& funcs, asCArray<asCExprContext*>& args, asCScriptNode* node, const char* name, asCArray<asSNamedArgument>* namedArgs = NULL, asCObjectType* objectType = NULL, bool isConstMethod = false, bool silent = false, bool allowObjectConstruct = true, const asCString& scope = "");
 	asUINT MatchArgument(asCArray<int> &funcs, asCArray<asSOverloadCandidate> &matches, const asCExprContext *argExpr, int paramNum, bool allowObjectConstruct = true);
 	int  MatchArgument(asCScriptFunction *desc, const asCExprContext *argExpr, int paramNum, bool allowObjectConstruct = true);
-	void PerformFunctionCall(int funcId, asCExprContext *out, bool isConstructor = false, asCArray<asCExprContext*> *args = 0, asCObjectType *objTypeForConstruct = 0, bool useVariable = false, int varOffset = 0, int funcPtrVar = 0);
+	asCObjectProperty *FindInlineGetterProperty(asCScriptFunction *func);
+	bool IsThiscall1ReturnType(asCScriptFunction *func);
+	asCScriptFunction *FindNonVirtualMethod(asCScriptFunction *func, asCObjectType *objType);
+	bool IsConstExprByteCode(asCScriptFunction *func, asCArray<asCScriptFunction*> *visited);
+	int  EvaluateConstExprCall(asCExprContext *ctx, asCScriptFunction *func, asCArray<asCExprContext*> &args, asCScriptNode *node);
+	static void ConstExprLineCallback(asIScriptContext *ctx, asUINT *count);
+	bool CanInlineFunction(asCScriptFunction *func);
+	int  InlineFunctionCall(asCExprContext *ctx, asCScriptFunction *func, asCArray<asCExprContext*> &args, asCScriptNode *node);
+	void PerformFunctionCall(int funcId, asCExprContext *out, bool isConstructor = false, asCArray<asCExprContext*> *args = 0, asCObjectType *objType = 0, bool useVariable = false, int varOffset = 0, int funcPtrVar = 0);
 	void MoveArgsToStack(int funcId, asCByteCode *bc, asCArray<asCExprContext *> &args, bool addOneToOffset);
 	int  MakeFunctionCall(asCExprContext *ctx, int funcId, asCObjectType *objectType, asCArray<asCExprContext*> &args, asCScriptNode *node, bool useVariable = false, int stackOffset = 0, int funcPtrVar = 0);
 	int  PrepareFunctionCall(int funcId, asCByteCode *bc, asCArray<asCExprContext *> &args);
@@ -419,6 +430,7 @@ protected:
 	int AllocateVariableNotIn(const asCDataType &type, bool isTemporary, bool forceOnHeap, asCExprContext *ctx);
 	int GetVariableOffset(int varIndex);
 	int GetVariableSlot(int varOffset);
+	void ReleaseMovedVariables();
 	void DeallocateVariable(int pos);
 	void ReleaseTemporaryVariable(asCExprValue &t, asCByteCode *bc);
 	void ReleaseTemporaryVariable(int offset, asCByteCode *bc);
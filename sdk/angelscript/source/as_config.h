@@ -108,6 +108,11 @@
 // 1 = Uses computed gotos in the VM
 // 0 = Do not use computed gotos
 
+// AS_NO_SIMD
+// Turns off the use of SSE2 instructions in the tokenizer. When the target
+// supports SSE2 the tokenizer scans runs of white space, identifier characters,
+// and string constants 16 bytes at a time, else a scalar loop is used.
+
 
 //
 // Library usage
@@ -1400,6 +1405,13 @@
 	#define AS_NO_THREADS
 #endif
 
+// SSE2 is always available on x86-64, and on 32bit x86 when enabled in the compiler
+#if !defined(AS_NO_SIMD) && !defined(AS_USE_SSE2)
+	#if defined(__SSE2__) || (defined(_M_X64) && !defined(_M_ARM64EC)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define AS_USE_SSE2
+	#endif
+#endif
+
 
 // The assert macro
 #if defined(ANDROID) || defined(__ANDROID__)
@@ -228,6 +228,7 @@ void asCConfigGroup::RemoveConfiguration(asCScriptEngine *engine, bool notUsed)
 				{
 					engine->templateInstanceTypes.RemoveIndexUnordered(idx);
 					asCObjectType *ot = CastToObjectType(t);
+					engine->RemoveTemplateInstanceTypeFromIndex(ot);
 					ot->DestroyInternal();
 					ot->ReleaseInternal();
 				}
@@ -738,6 +738,20 @@ int asCContext::Prepare(asIScriptFunction *func)
 			return asINVALID_ARG;
 		}
 
+		// Functions whose compilation was deferred are compiled when they are first prepared
+		asCScriptFunction *scriptFunc = reinterpret_cast<asCScriptFunction*>(func);
+		if( scriptFunc->funcType == asFUNC_SCRIPT && scriptFunc->scriptData->byteCode.GetLength() == 0 && scriptFunc->module )
+		{
+			int r = scriptFunc->module->CompileDeferredFunction(scriptFunc);
+			if( r < 0 )
+			{
+				asCString str;
+				str.Format(TXT_FAILED_IN_FUNC_s_WITH_s_s_d, "Prepare", func->GetDeclaration(true, true), errorNames[-r], r);
+				m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, str.AddressOf());
+				return r;
+			}
+		}
+
 		if( m_initialFunction )
 			m_initialFunction->Release();
 
@@ -746,8 +760,7 @@ int asCContext::Prepare(asIScriptFunction *func)
 		m_initialFunction->AddRef();
 		m_currentFunction = m_initialFunction;
 
-		// TODO: runtime optimize: GetSpaceNeededForArguments() should be precomputed
-		m_argumentsSize = m_currentFunction->GetSpaceNeededForArguments() + (m_currentFunction->objectType ? AS_PTR_SIZE : 0);
+		m_argumentsSize = m_currentFunction->GetArgumentsSize() + (m_currentFunction->objectType ? AS_PTR_SIZE : 0);
 
 		// Reserve space for the arguments and return value
 		if( m_currentFunction->DoesReturnOnStack() )
@@ -2055,7 +2068,7 @@ bool asCContext::ReserveStackSpace(asUINT size)
 		// Leave enough room above the stackpointer to copy the arguments from the previous stackblock
 		m_regs.stackPointer = m_stackBlocks[m_stackIndex] +
 			                  (m_stackBlockSize<<m_stackIndex) -
-			                  m_currentFunction->GetSpaceNeededForArguments() -
+			                  m_currentFunction->GetArgumentsSize() -
 			                  (m_currentFunction->objectType ? AS_PTR_SIZE : 0) -
 			                  (m_currentFunction->DoesReturnOnStack() ? AS_PTR_SIZE : 0);
 
@@ -2091,6 +2104,18 @@ void asCContext::PrepareScriptFunction()
 {
 	asASSERT( m_currentFunction->scriptData );
 
+	// Functions whose compilation was deferred are compiled on the first call
+	if( m_currentFunction->scriptData->byteCode.GetLength() == 0 )
+	{
+		if( m_currentFunction->module == 0 || m_currentFunction->module->CompileDeferredFunction(m_currentFunction) < 0 )
+		{
+			SetInternalException(TXT_FUNCTION_FAILED_TO_COMPILE);
+			return;
+		}
+
+		m_regs.programPointer = m_currentFunction->scriptData->byteCode.AddressOf();
+	}
+
 	// Make sure there is space on the stack to execute the function
 	asDWORD *oldStackPointer = m_regs.stackPointer;
 	asUINT needSize = m_currentFunction->scriptData->stackNeeded;
@@ -2104,7 +2129,7 @@ void asCContext::PrepareScriptFunction()
 
 		if( m_regs.stackPointer != oldStackPointer )
 		{
-			int numDwords = m_currentFunction->GetSpaceNeededForArguments() +
+			int numDwords = m_currentFunction->GetArgumentsSize() +
 			                (m_currentFunction->objectType ? AS_PTR_SIZE : 0) +
 			                (m_currentFunction->DoesReturnOnStack() ? AS_PTR_SIZE : 0);
 			memcpy(m_regs.stackPointer, oldStackPointer, sizeof(asDWORD)*numDwords);
@@ -2269,11 +2294,9 @@ static const void *const dispatch_table[256] = {
 &&INSTRUCTION(asBC_JLowNZ),		&&INSTRUCTION(asBC_AllocMem),	&&INSTRUCTION(asBC_SetListSize),&&INSTRUCTION(asBC_PshListElmnt),
 &&INSTRUCTION(asBC_SetListType),&&INSTRUCTION(asBC_POWi),		&&INSTRUCTION(asBC_POWu),		&&INSTRUCTION(asBC_POWf),
 &&INSTRUCTION(asBC_POWd),		&&INSTRUCTION(asBC_POWdi),		&&INSTRUCTION(asBC_POWi64),		&&INSTRUCTION(asBC_POWu64),
-&&INSTRUCTION(asBC_Thiscall1),
-
-								&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
-&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
-&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
+&&INSTRUCTION(asBC_Thiscall1),	&&INSTRUCTION(asBC_StrHash),	&&INSTRUCTION(asBC_ADDIi64),	&&INSTRUCTION(asBC_SUBIi64),
+&&INSTRUCTION(asBC_MULIi64),	&&INSTRUCTION(asBC_CMPIi64),	&&INSTRUCTION(asBC_CMPIu64),	&&INSTRUCTION(asBC_ADDId),
+&&INSTRUCTION(asBC_SUBId),		&&INSTRUCTION(asBC_MULId),		&&INSTRUCTION(asBC_CMPId),		&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
 &&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),			&&INSTRUCTION(FAULT),
@@ -2412,7 +2435,18 @@ static const void *const dispatch_table[256] = {
 			m_regs.stackPointer = l_sp;
 			m_regs.stackFramePointer = l_fp;
 
-			CallScriptFunction(m_engine->scriptFunctions[i]);
+			// Methods that the compiler has resolved at compile time are also called
+			// with this instruction so the object pointer must be verified here
+			asCScriptFunction *func = m_engine->scriptFunctions[i];
+			if( func->objectType && *(asPWORD*)l_sp == 0 )
+			{
+				// Tell the exception handler to clean up the arguments to this method
+				m_needToCleanupArgs = true;
+				SetInternalException(TXT_NULL_POINTER_ACCESS);
+				return;
+			}
+
+			CallScriptFunction(func);
 
 			// Extract the values from the context again
 			l_bc = m_regs.programPointer;
@@ -3127,7 +3161,7 @@ static const void *const dispatch_table[256] = {
 				// Call the constructor to initalize the memory
 				asCScriptFunction *f = m_engine->scriptFunctions[func];
 
-				asDWORD **a = (asDWORD**)*(asPWORD*)(m_regs.stackPointer + f->GetSpaceNeededForArguments());
+				asDWORD **a = (asDWORD**)*(asPWORD*)(m_regs.stackPointer + f->GetArgumentsSize());
 				if( a ) *a = mem;
 
 				// Push the object pointer on the stack
@@ -3166,6 +3200,11 @@ static const void *const dispatch_table[256] = {
 
 					l_sp += CallSystemFunction(func, this);
 				}
+				else if( objType->flags & asOBJ_SCRIPT_STRUCT )
+				{
+					// Script structs have no constructor so the members are just cleared
+					memset(mem, 0, objType->size);
+				}
 
 				// Pop the variable address from the stack
 				asDWORD **a = (asDWORD**)*(asPWORD*)l_sp;
@@ -4807,6 +4846,10 @@ static const void *const dispatch_table[256] = {
 		//  type &obj::func(uint)
 		//  void  obj::func(int)
 		//  void  obj::func(uint)
+		//  int   obj::func(uint), and the same with uint or bool as return type
+		//
+		// The value is returned in the pointer register, so the latter is only
+		// used on little endian platforms where the low bytes hold the value.
 		{
 			// Get function ID from the argument
 			int i = asBC_INTARG(l_bc);
@@ -4882,19 +4925,93 @@ static const void *const dispatch_table[256] = {
 		}
 		NEXT_INSTRUCTION();
 
+	INSTRUCTION(asBC_StrHash):
+		// Compute the hash of the string pointed to by the value on the stack. This
+		// is used by the switch statement on strings to find the case to execute
+		{
+			// The string factory is implemented by the application, so
+			// move the values back to the context in case it inspects them
+			m_regs.programPointer    = l_bc;
+			m_regs.stackPointer      = l_sp;
+			m_regs.stackFramePointer = l_fp;
+
+			void *str = *(void**)l_sp;
+			*(asDWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = m_engine->HashStringObject(str);
+			l_sp += AS_PTR_SIZE;
+		}
+		l_bc++;
+		NEXT_INSTRUCTION();
+
+	//------------------------------
+	// 64bit math operations and comparisons with constant value
+	INSTRUCTION(asBC_ADDIi64):
+		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) + asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_SUBIi64):
+		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) - asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_MULIi64):
+		*(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc)) = *(asQWORD*)(l_fp - asBC_SWORDARG1(l_bc)) * asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_CMPIi64):
+		{
+			asINT64 i1 = *(asINT64*)(l_fp - asBC_SWORDARG0(l_bc));
+			asINT64 i2 = (asINT64)asBC_QWORDARG(l_bc);
+			if( i1 == i2 )     *(int*)&m_regs.valueRegister =  0;
+			else if( i1 < i2 ) *(int*)&m_regs.valueRegister = -1;
+			else               *(int*)&m_regs.valueRegister =  1;
+			l_bc += 3;
+		}
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_CMPIu64):
+		{
+			asQWORD d1 = *(asQWORD*)(l_fp - asBC_SWORDARG0(l_bc));
+			asQWORD d2 = asBC_QWORDARG(l_bc);
+			if( d1 == d2 )     *(int*)&m_regs.valueRegister =  0;
+			else if( d1 < d2 ) *(int*)&m_regs.valueRegister = -1;
+			else               *(int*)&m_regs.valueRegister =  1;
+			l_bc += 3;
+		}
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_ADDId):
+		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) + *(double*)&asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_SUBId):
+		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) - *(double*)&asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_MULId):
+		*(double*)(l_fp - asBC_SWORDARG0(l_bc)) = *(double*)(l_fp - asBC_SWORDARG1(l_bc)) * *(double*)&asBC_QWORDARG(l_bc+1);
+		l_bc += 4;
+		NEXT_INSTRUCTION();
+
+	INSTRUCTION(asBC_CMPId):
+		{
+			// Do a comparison of the values, rather than a subtraction
+			// in order to get proper behaviour for infinity values.
+			double dbl1 = *(double*)(l_fp - asBC_SWORDARG0(l_bc));
+			double dbl2 = *(double*)&asBC_QWORDARG(l_bc);
+			if( dbl1 == dbl2 )     *(int*)&m_regs.valueRegister =  0;
+			else if( dbl1 < dbl2 ) *(int*)&m_regs.valueRegister = -1;
+			else                   *(int*)&m_regs.valueRegister =  1;
+			l_bc += 3;
+		}
+		NEXT_INSTRUCTION();
+
 	// Don't let the optimizer optimize for size,
 	// since it requires extra conditions and jumps
 #if AS_USE_COMPUTED_GOTOS == 0
-	INSTRUCTION(201): l_bc = (asDWORD*)201; goto case_FAULT;
-	INSTRUCTION(202): l_bc = (asDWORD*)202; goto case_FAULT;
-	INSTRUCTION(203): l_bc = (asDWORD*)203; goto case_FAULT;
-	INSTRUCTION(204): l_bc = (asDWORD*)204; goto case_FAULT;
-	INSTRUCTION(205): l_bc = (asDWORD*)205; goto case_FAULT;
-	INSTRUCTION(206): l_bc = (asDWORD*)206; goto case_FAULT;
-	INSTRUCTION(207): l_bc = (asDWORD*)207; goto case_FAULT;
-	INSTRUCTION(208): l_bc = (asDWORD*)208; goto case_FAULT;
-	INSTRUCTION(209): l_bc = (asDWORD*)209; goto case_FAULT;
-	INSTRUCTION(210): l_bc = (asDWORD*)210; goto case_FAULT;
 	INSTRUCTION(211): l_bc = (asDWORD*)211; goto case_FAULT;
 	INSTRUCTION(212): l_bc = (asDWORD*)212; goto case_FAULT;
 	INSTRUCTION(213): l_bc = (asDWORD*)213; goto case_FAULT;
@@ -6331,7 +6448,7 @@ int asCContext::GetArgsOnStackCount(asUINT stackLevel)
 		calledFunc = (asCScriptFunction*)s[1];
 	}
 	if( calledFunc )
-		stackPos -= calledFunc->GetSpaceNeededForArguments() + (calledFunc->DoesReturnOnStack() ? AS_PTR_SIZE : 0) + (calledFunc->GetObjectType() ? AS_PTR_SIZE : 0);
+		stackPos -= calledFunc->GetArgumentsSize() + (calledFunc->DoesReturnOnStack() ? AS_PTR_SIZE : 0) + (calledFunc->GetObjectType() ? AS_PTR_SIZE : 0);
 
 	// Cache the list of arg types by func pointer and program position
 	m_argsOnStackCacheFunc = func;
@@ -6435,7 +6552,7 @@ int asCContext::GetArgOnStack(asUINT stackLevel, asUINT arg, int* outTypeId, asU
 		calledFunc = (asCScriptFunction*)s[1];
 	}
 	if (calledFunc)
-		sp += calledFunc->GetSpaceNeededForArguments() + (calledFunc->DoesReturnOnStack() ? AS_PTR_SIZE : 0) + (calledFunc->GetObjectType() ? AS_PTR_SIZE : 0);
+		sp += calledFunc->GetArgumentsSize() + (calledFunc->DoesReturnOnStack() ? AS_PTR_SIZE : 0) + (calledFunc->GetObjectType() ? AS_PTR_SIZE : 0);
 
 	// Check that the cache for GetArgsOnStack is up-to-date
 	if (m_argsOnStackCacheFunc != func || m_argsOnStackCacheProgPos != asUINT(progPointer - &func->scriptData->byteCode[0]))
@@ -183,6 +183,8 @@ void asFreeMem(void *mem)
 
 asCMemoryMgr::asCMemoryMgr()
 {
+	numScriptNodeAllocs      = 0;
+	numByteInstructionAllocs = 0;
 }
 
 asCMemoryMgr::~asCMemoryMgr()
@@ -192,61 +194,21 @@ asCMemoryMgr::~asCMemoryMgr()
 
 void asCMemoryMgr::FreeUnusedMemory()
 {
-	// It's necessary to protect the scriptNodePool from multiple 
-	// simultaneous accesses, as the parser is used by several methods
-	// that can be executed simultaneously.
-	ENTERCRITICALSECTION(cs);
-
-	int n;
-	for( n = 0; n < (signed)scriptNodePool.GetLength(); n++ )
-		userFree(scriptNodePool[n]);
-	scriptNodePool.Allocate(0, false);
-
-	LEAVECRITICALSECTION(cs);
-
 	// The engine already protects against multiple threads 
 	// compiling scripts simultaneously so this pool doesn't have 
 	// to be protected again.
-	for( n = 0; n < (signed)byteInstructionPool.GetLength(); n++ )
+	for( int n = 0; n < (signed)byteInstructionPool.GetLength(); n++ )
 		userFree(byteInstructionPool[n]);
 	byteInstructionPool.Allocate(0, false);
 }
 
-void *asCMemoryMgr::AllocScriptNode()
+void asCMemoryMgr::AddScriptNodeAllocs(asUINT count)
 {
+	// The script nodes are allocated from the arena of each builder, which
+	// only reports the count when it is released. Builders used by the
+	// registration methods may run in parallel with a build so this is protected
 	ENTERCRITICALSECTION(cs);
-
-	if( scriptNodePool.GetLength() )
-	{
-		void *tRet = scriptNodePool.PopLast();
-		LEAVECRITICALSECTION(cs);
-		return tRet;
-	}
-
-	LEAVECRITICALSECTION(cs);
-
-#if defined(AS_DEBUG) 
-	return ((asALLOCFUNCDEBUG_t)(userAlloc))(sizeof(asCScriptNode), __FILE__, __LINE__);
-#else
-	return userAlloc(sizeof(asCScriptNode));
-#endif
-}
-
-void asCMemoryMgr::FreeScriptNode(void *ptr)
-{
-	ENTERCRITICALSECTION(cs);
-
-	// Pre allocate memory for the array to avoid slow growth
-	if( scriptNodePool.GetLength() == 0 )
-		scriptNodePool.Allocate(100, 0);
-
-	scriptNodePool.PushLast(ptr);
-	
-#ifdef AS_DEBUG
-	// clear the memory to facilitate identification of use after free
-	memset(ptr, 0xCDCDCDCD, sizeof(asCScriptNode));
-#endif
-
+	numScriptNodeAllocs += count;
 	LEAVECRITICALSECTION(cs);
 }
 
@@ -255,7 +217,9 @@ void asCMemoryMgr::FreeScriptNode(void *ptr)
 void *asCMemoryMgr::AllocByteInstruction()
 {
 	// This doesn't need a critical section because, only one compilation is allowed at a time
-	
+
+	numByteInstructionAllocs++;
+
 	if( byteInstructionPool.GetLength() )
 		return byteInstructionPool.PopLast();
 
@@ -116,17 +116,19 @@ public:
 
 	void FreeUnusedMemory();
 
-	void *AllocScriptNode();
-	void FreeScriptNode(void *ptr);
+	void AddScriptNodeAllocs(asUINT count);
 
 #ifndef AS_NO_COMPILER
 	void *AllocByteInstruction();
 	void FreeByteInstruction(void *ptr);
 #endif
 
+	// Number of allocation requests, used for the build statistics
+	asUINT numScriptNodeAllocs;
+	asUINT numByteInstructionAllocs;
+
 protected:
 	DECLARECRITICALSECTION(cs)
-	asCArray<void *> scriptNodePool;
 	asCArray<void *> byteInstructionPool;
 };
 
@@ -43,6 +43,7 @@
 #include "as_texts.h"
 #include "as_debug.h"
 #include "as_restore.h"
+#include "as_thread.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -55,6 +56,12 @@ asCModule::asCModule(const char *name, asCScriptEngine *engine)
 
 	m_builder = 0;
 	m_isGlobalVarInitialized = false;
+	m_isDiscarded = false;
+
+	memset(&m_buildStats, 0, sizeof(m_buildStats));
+	m_buildStartTime        = 0;
+	m_buildStartNodeAllocs  = 0;
+	m_buildStartInstrAllocs = 0;
 
 	m_accessMask = 1;
 
@@ -117,6 +124,7 @@ void asCModule::Discard()
 		engine->lastModule = 0;
 	engine->scriptModules.RemoveValue(this);
 	engine->discardedModules.PushLast(this);
+	m_isDiscarded = true;
 	RELEASEEXCLUSIVE(engine->engineRWLock);
 
 	// Allow the engine to go over the list of discarded modules to see what can be cleaned up at this moment.
@@ -295,6 +303,8 @@ int asCModule::Build()
 		return asSUCCESS;
 	}
 
+	BeginBuildStatistics();
+
 	// Compile the script
 	r = m_builder->Build();
 	asDELETE(m_builder,asCBuilder);
@@ -305,12 +315,15 @@ int asCModule::Build()
 		// Reset module again
 		InternalReset();
 
+		EndBuildStatistics();
 		m_engine->BuildCompleted();
 		return r;
 	}
 
 	JITCompile();
 
+	EndBuildStatistics();
+
 	m_engine->PrepareEngine();
 
 #ifdef AS_DEBUG
@@ -333,6 +346,132 @@ int asCModule::Build()
 #endif
 }
 
+// interface
+int asCModule::BuildIncremental()
+{
+#ifdef AS_NO_COMPILER
+	return asNOT_SUPPORTED;
+#else
+	TimeIt("asCModule::BuildIncremental");
+
+	if( !m_builder )
+		return asSUCCESS;
+
+	// The bytecode of the recompiled functions is replaced, so as with Build this
+	// isn't allowed while there are external references that may still need it
+	if( HasExternalReferences(false) )
+	{
+		m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_MODULE_IS_IN_USE);
+		return asMODULE_IS_IN_USE;
+	}
+
+	// Only one thread may build at one time
+	int r = m_engine->RequestBuild();
+	if( r < 0 )
+		return r;
+
+	m_engine->PrepareEngine();
+	if( m_engine->configFailed )
+	{
+		m_engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, TXT_INVALID_CONFIGURATION);
+		m_engine->BuildCompleted();
+		return asINVALID_CONFIGURATION;
+	}
+
+	BeginBuildStatistics();
+
+	// Recompile the modified functions. The existing global variables and
+	// types are kept, so there is no need to reset the module first
+	r = m_builder->BuildIncremental();
+	asDELETE(m_builder,asCBuilder);
+	m_builder = 0;
+
+	EndBuildStatistics();
+	m_engine->BuildCompleted();
+
+	return r;
+#endif
+}
+
+// interface
+int asCModule::CompileAll()
+{
+#ifdef AS_NO_COMPILER
+	return asNOT_SUPPORTED;
+#else
+	if( m_deferredFunctions.GetCount() == 0 )
+		return asSUCCESS;
+
+	int r = m_engine->RequestBuild();
+	if( r < 0 )
+		return r;
+
+	// The map is ordered by function id, so the functions are compiled in the order they were declared
+	asCArray<asCScriptFunction*> funcs;
+	asSMapNode<int, sDeferredFunction> *cursor = 0;
+	m_deferredFunctions.MoveFirst(&cursor);
+	while( cursor )
+	{
+		funcs.PushLast(m_engine->scriptFunctions[m_deferredFunctions.GetKey(cursor)]);
+		m_deferredFunctions.MoveNext(&cursor, cursor);
+	}
+
+	asCBuilder builder(m_engine, this);
+	r = builder.CompileDeferredFunctions(funcs);
+
+	m_engine->BuildCompleted();
+
+	return r;
+#endif
+}
+
+// interface
+int asCModule::GetBuildStatistics(asSBuildStatistics *stats) const
+{
+	if( stats == 0 )
+		return asINVALID_ARG;
+
+	*stats = m_buildStats;
+
+	// The content of the module may have changed since the build, e.g. with deferred
+	// compilations, so the function and bytecode counts are determined now
+	stats->numFunctions        = 0;
+	stats->totalByteCodeSize   = 0;
+	stats->largestByteCodeSize = 0;
+	for( asUINT n = 0; n < m_scriptFunctions.GetLength(); n++ )
+	{
+		asCScriptFunction *func = m_scriptFunctions[n];
+		if( func->module != this || func->scriptData == 0 || func->scriptData->byteCode.GetLength() == 0 )
+			continue;
+
+		asUINT size = (asUINT)func->scriptData->byteCode.GetLength();
+		stats->numFunctions++;
+		stats->totalByteCodeSize += size;
+		if( size > stats->largestByteCodeSize )
+			stats->largestByteCodeSize = size;
+	}
+	stats->numTypes = (asUINT)(m_classTypes.GetLength() + m_enumTypes.GetLength() + m_typeDefs.GetLength() + m_funcDefs.GetLength());
+
+	return asSUCCESS;
+}
+
+// internal
+void asCModule::BeginBuildStatistics()
+{
+	memset(&m_buildStats, 0, sizeof(m_buildStats));
+	m_buildStartTime        = asGetSystemTime();
+	m_buildStartNodeAllocs  = m_engine->memoryMgr.numScriptNodeAllocs;
+	m_buildStartInstrAllocs = m_engine->memoryMgr.numByteInstructionAllocs;
+}
+
+// internal
+void asCModule::EndBuildStatistics()
+{
+	m_buildStats.totalTime                = asGetSystemTime() - m_buildStartTime;
+	m_buildStats.numScriptNodeAllocs      = m_engine->memoryMgr.numScriptNodeAllocs - m_buildStartNodeAllocs;
+	m_buildStats.numByteInstructionAllocs = m_engine->memoryMgr.numByteInstructionAllocs - m_buildStartInstrAllocs;
+}
+
 // interface
 int asCModule::ResetGlobalVars(asIScriptContext *ctx)
 {
@@ -691,6 +830,7 @@ void asCModule::InternalReset()
 	for( n = 0; n < m_templateInstances.GetLength(); n++ )
 	{
 		asCObjectType *type = m_templateInstances[n];
+		m_engine->RemoveEntityOwner(type, this);
 		if( m_engine->FindNewOwnerForSharedType(type, this) != this )
 		{
 			// The type is owned by another module, just release our reference
@@ -709,6 +849,7 @@ void asCModule::InternalReset()
 	for( n = 0; n < m_classTypes.GetLength(); n++ )
 	{
 		asCObjectType *type = m_classTypes[n];
+		m_engine->RemoveEntityOwner(type, this);
 		if( type->IsShared() )
 		{
 			// The type is shared, so transfer ownership to another module that also uses it
@@ -738,6 +879,7 @@ void asCModule::InternalReset()
 	for( n = 0; n < m_enumTypes.GetLength(); n++ )
 	{
 		asCEnumType *type = m_enumTypes[n];
+		m_engine->RemoveEntityOwner(type, this);
 		if( type->IsShared() )
 		{
 			// The type is shared, so transfer ownership to another module that also uses it
@@ -764,6 +906,7 @@ void asCModule::InternalReset()
 	for( n = 0; n < m_typeDefs.GetLength(); n++ )
 	{
 		asCTypedefType *type = m_typeDefs[n];
+		m_engine->RemoveEntityOwner(type, this);
 
 		// The type should be destroyed now
 		type->DestroyInternal();
@@ -779,6 +922,7 @@ void asCModule::InternalReset()
 	{
 		asCFuncdefType *func = m_funcDefs[n];
 		asASSERT(func);
+		m_engine->RemoveEntityOwner(func, this);
 		if( func->funcdef && func->funcdef->IsShared() )
 		{
 			// The funcdef is shared, so transfer ownership to another module that also uses it
@@ -801,6 +945,7 @@ void asCModule::InternalReset()
 	for( n = 0; n < m_scriptFunctions.GetLength(); n++ )
 	{
 		asCScriptFunction *func = m_scriptFunctions[n];
+		m_engine->RemoveEntityOwner(func, this);
 		if( func->IsShared() )
 		{
 			// The func is shared, so transfer ownership to another module that also uses it
@@ -833,9 +978,64 @@ void asCModule::InternalReset()
 	// The references were already released as the types were removed from the respective arrays
 	m_typeLookup.EraseAll();
 
+	ClearSectionInfos();
+	ClearDeferredFunctions();
+
 	asASSERT( IsEmpty() );
 }
 
+// internal
+void asCModule::ClearSectionInfos()
+{
+	for( asUINT n = 0; n < m_sectionInfos.GetLength(); n++ )
+		asDELETE(m_sectionInfos[n], sScriptSectionInfo);
+	m_sectionInfos.SetLength(0);
+
+	m_namespaceVisibility.EraseAll();
+	m_pureConstants.EraseAll();
+	m_inlinedFunctions.SetLength(0);
+}
+
+// internal
+void asCModule::ClearDeferredFunctions()
+{
+	m_deferredFunctions.EraseAll();
+
+	for( asUINT n = 0; n < m_deferredScripts.GetLength(); n++ )
+		asDELETE(m_deferredScripts[n], asCScriptCode);
+	m_deferredScripts.SetLength(0);
+}
+
+// internal
+// Called by the context when a function whose compilation was deferred is first used
+int asCModule::CompileDeferredFunction(asCScriptFunction *func)
+{
+#ifdef AS_NO_COMPILER
+	UNUSED_VAR(func);
+	return asNOT_SUPPORTED;
+#else
+	// The function is being called, so instead of failing wait for another thread that is building
+	int r = m_engine->RequestBuild(true);
+	if( r < 0 )
+		return r;
+
+	// If the function has already been compiled, e.g. by another thread, the builder will just skip it
+	asCArray<asCScriptFunction*> funcs;
+	funcs.PushLast(func);
+
+	asCBuilder builder(m_engine, this);
+	r = builder.CompileDeferredFunctions(funcs);
+
+	m_engine->BuildCompleted();
+
+	// A function without bytecode that wasn't deferred cannot be executed
+	if( r >= 0 && func->scriptData->byteCode.GetLength() == 0 )
+		r = asERROR;
+
+	return r;
+#endif
+}
+
 // interface
 asIScriptFunction *asCModule::GetFunctionByName(const char *in_name) const
 {
@@ -1269,6 +1469,7 @@ int asCModule::AddScriptFunction(int sectionIdx, int declaredAt, int id, const a
 	func->parameterNames   = paramNames;
 	func->inOutFlags       = inOutFlags;
 	func->defaultArgs      = defaultArgs;
+	func->argumentsSize    = func->GetSpaceNeededForArguments();
 	func->objectType       = objType;
 	if( objType )
 		objType->AddRefInternal();
@@ -1282,6 +1483,8 @@ int asCModule::AddScriptFunction(int sectionIdx, int declaredAt, int id, const a
 
 	// The internal ref count was already set by the constructor
 	m_scriptFunctions.PushLast(func);
+	if( func->IsShared() )
+		m_engine->AddEntityOwner(func, this);
 	m_engine->AddScriptFunction(func);
 
 	// Compute the signature id
@@ -1300,6 +1503,8 @@ int asCModule::AddScriptFunction(asCScriptFunction *func)
 {
 	m_scriptFunctions.PushLast(func);
 	func->AddRefInternal();
+	if( func->IsShared() )
+		m_engine->AddEntityOwner(func, this);
 	m_engine->AddScriptFunction(func);
 
 	// If the function that is being added is an already compiled shared function
@@ -1514,6 +1719,7 @@ int asCModule::UnbindAllImportedFunctions()
 void asCModule::AddClassType(asCObjectType* type)
 {
 	m_classTypes.PushLast(type);
+	m_engine->AddEntityOwner(type, this);
 	m_typeLookup.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
 }
 
@@ -1521,6 +1727,7 @@ void asCModule::AddClassType(asCObjectType* type)
 void asCModule::AddEnumType(asCEnumType* type)
 {
 	m_enumTypes.PushLast(type);
+	m_engine->AddEntityOwner(type, this);
 	m_typeLookup.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
 }
 
@@ -1528,6 +1735,7 @@ void asCModule::AddEnumType(asCEnumType* type)
 void asCModule::AddTypeDef(asCTypedefType* type)
 {
 	m_typeDefs.PushLast(type);
+	m_engine->AddEntityOwner(type, this);
 	m_typeLookup.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
 }
 
@@ -1535,6 +1743,7 @@ void asCModule::AddTypeDef(asCTypedefType* type)
 void asCModule::AddFuncDef(asCFuncdefType* type)
 {
 	m_funcDefs.PushLast(type);
+	m_engine->AddEntityOwner(type, this);
 	m_typeLookup.Insert(asSNameSpaceNamePair(type->nameSpace, type->name), type);
 }
 
@@ -1545,6 +1754,8 @@ void asCModule::ReplaceFuncDef(asCFuncdefType* type, asCFuncdefType* newType)
 	if( i >= 0 )
 	{
 		m_funcDefs[i] = newType;
+		m_engine->RemoveEntityOwner(type, this);
+		m_engine->AddEntityOwner(newType, this);
 		
 		// Replace it in the lookup map too
 		asSMapNode<asSNameSpaceNamePair, asCTypeInfo*>* result = 0;
@@ -1629,6 +1840,12 @@ int asCModule::SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const
 	if( IsEmpty() )
 		return asERROR;
 
+	// The functions whose compilation was deferred must be compiled before they can be saved. Compiling
+	// them doesn't change the observable content of the module, so this is permitted in the const method
+	int r = const_cast<asCModule*>(this)->CompileAll();
+	if( r < 0 )
+		return r;
+
 	asCWriter write(const_cast<asCModule*>(this), out, m_engine, stripDebugInfo);
 	return write.Write();
 #endif
@@ -1639,6 +1856,22 @@ int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 {
 	if( in == 0 ) return asINVALID_ARG;
 
+	asCReader read(this, in, m_engine);
+	return LoadByteCode(read, wasDebugInfoStripped);
+}
+
+// interface
+int asCModule::LoadByteCode(const void *data, size_t size, bool *wasDebugInfoStripped)
+{
+	if( data == 0 ) return asINVALID_ARG;
+
+	asCReader read(this, data, size, m_engine);
+	return LoadByteCode(read, wasDebugInfoStripped);
+}
+
+// internal
+int asCModule::LoadByteCode(asCReader &read, bool *wasDebugInfoStripped)
+{
 	// Don't allow the module to be rebuilt if there are still
 	// external references that will need the previous code
 	if( HasExternalReferences(false) )
@@ -1647,25 +1880,42 @@ int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 		return asMODULE_IS_IN_USE;
 	}
 
-	// Only permit loading bytecode if no other thread is currently compiling
-	// TODO: It should be possible to have multiple threads perform compilations
-	int r = m_engine->RequestBuild();
+	// Read and unpack the bytecode container before taking the engine's lock, so
+	// threads loading different modules can do this part in parallel. Entities are
+	// only resolved and registered in the engine by Read below
+	double prepareStart = asGetSystemTime();
+	read.Prepare();
+	double prepareTime = asGetSystemTime() - prepareStart;
+
+	// Only permit loading bytecode if no other thread is currently compiling. Other
+	// threads may be loading bytecode, as long as they are not resolving entities
+	// at the same time. The lock isn't held while translating the bytecode
+	int r = m_engine->RequestLoad();
 	if( r < 0 )
 		return r;
 
-	asCReader read(this, in, m_engine);
-	r = read.Read(wasDebugInfoStripped);
-	if (r < 0)
-	{
-		m_engine->BuildCompleted();
-		return r;
-	}
+	ENTERCRITICALSECTION(m_engine->loadByteCodeLock);
+	BeginBuildStatistics();
+	m_buildStartTime -= prepareTime;
 
-	JITCompile();
+	r = read.Read();
+	LEAVECRITICALSECTION(m_engine->loadByteCodeLock);
+
+	if( r >= 0 )
+		r = read.Translate();
+
+	ENTERCRITICALSECTION(m_engine->loadByteCodeLock);
+	r = read.Finish(r, wasDebugInfoStripped);
+	m_buildStats.loadTime = asGetSystemTime() - m_buildStartTime;
+
+	if( r >= 0 )
+		JITCompile();
+
+	EndBuildStatistics();
 
 #ifdef AS_DEBUG
 	// Verify that there are no unwanted gaps in the scriptFunctions array.
-	for( asUINT n = 1; n < m_engine->scriptFunctions.GetLength(); n++ )
+	for( asUINT n = 1; r >= 0 && n < m_engine->scriptFunctions.GetLength(); n++ )
 	{
 		int id = n;
 		if( m_engine->scriptFunctions[n] == 0 && !m_engine->freeScriptFunctionIds.Exists(id) )
@@ -1673,7 +1923,13 @@ int asCModule::LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped)
 	}
 #endif
 
-	m_engine->BuildCompleted();
+	m_engine->LoadCompleted();
+	LEAVECRITICALSECTION(m_engine->loadByteCodeLock);
+
+	// Initialize the global variables (unless requested not to). As with Build this is
+	// done after the load is completed, so the initializers may load other modules
+	if( r >= 0 && m_engine->ep.initGlobalVarsAfterBuild )
+		r = ResetGlobalVars(0);
 
 	return r;
 }
@@ -1811,6 +2067,7 @@ int asCModule::RemoveFunction(asIScriptFunction *func)
 	{
 		m_globalFunctions.Erase(idx);
 		m_scriptFunctions.RemoveValue(f);
+		m_engine->RemoveEntityOwner(f, this);
 		f->ReleaseInternal();
 		return 0;
 	}
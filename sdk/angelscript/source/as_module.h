@@ -61,6 +61,8 @@ class asCConfigGroup;
 class asCTypedefType;
 class asCFuncdefType;
 struct asSNameSpace;
+class asCScriptCode;
+class asCReader;
 
 struct sBindInfo
 {
@@ -75,6 +77,31 @@ struct sObjectTypePair
 	asCObjectType *b;
 };
 
+// Information kept from the last build for each script section so that
+// BuildIncremental can recompile only the function bodies that changed
+struct sFunctionBodyInfo
+{
+	asUINT        tokenIdx; // Number of declaration tokens in the section before the body
+	asQWORD       hash;     // Hash of the source code of the body
+	int           row;      // Line where the body starts, used to adjust the debug information
+	asCArray<int> funcIds;  // Functions compiled from the body. Mixin methods may be included in multiple classes
+};
+
+struct sScriptSectionInfo
+{
+	asCString                   name;
+	asQWORD                     declarationHash; // Hash of all tokens outside the function bodies
+	asCArray<sFunctionBodyInfo> bodies;
+};
+
+// Location of the body of a function whose compilation has been deferred until it is first used
+struct sDeferredFunction
+{
+	asCScriptCode *script;
+	size_t         pos;
+	size_t         length;
+};
+
 
 // TODO: import: Remove function imports. When I have implemented function
 //               pointers the function imports should be deprecated.
@@ -86,12 +113,6 @@ struct sObjectTypePair
 //       With this separation it will be possible to compile the library without
 //       the compiler, thus giving a much smaller binary executable.
 
-// TODO: There should be a special compile option that will let the application
-//       recompile an already compiled script. The compiler should check if no
-//       destructive changes have been made (changing function signatures, etc)
-//       then it should simply replace the bytecode within the functions without
-//       changing the values of existing global properties, etc.
-
 class asCModule : public asIScriptModule
 {
 //-------------------------------------------
@@ -106,6 +127,9 @@ public:
 	// Compilation
 	virtual int         AddScriptSection(const char *name, const char *code, size_t codeLength, int lineOffset);
 	virtual int         Build();
+	virtual int         BuildIncremental();
+	virtual int         CompileAll();
+	virtual int         GetBuildStatistics(asSBuildStatistics *stats) const;
 	virtual int         CompileFunction(const char *sectionName, const char *code, int lineOffset, asDWORD reserved, asIScriptFunction **outFunc);
 	virtual int         CompileGlobalVar(const char *sectionName, const char *code, int lineOffset);
 	virtual asDWORD     SetAccessMask(asDWORD accessMask);
@@ -158,6 +182,7 @@ public:
 	// Bytecode Saving/Loading
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo) const;
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped);
+	virtual int LoadByteCode(const void *data, size_t size, bool *wasDebugInfoStripped);
 
 	// User data
 	virtual void *SetUserData(void *data, asPWORD type);
@@ -177,8 +202,14 @@ public:
 	friend class asCRestore;
 
 	void InternalReset();
+	void ClearSectionInfos();
+	void ClearDeferredFunctions();
+	int  CompileDeferredFunction(asCScriptFunction *func);
 	bool IsEmpty() const;
 	bool HasExternalReferences(bool shuttingDown);
+	void BeginBuildStatistics();
+	void EndBuildStatistics();
+	int  LoadByteCode(asCReader &read, bool *wasDebugInfoStripped);
 
 	int  CallInit(asIScriptContext *ctx);
 	void CallExit();
@@ -217,6 +248,7 @@ public:
 	asCArray<asPWORD> m_userData;
 	asDWORD           m_accessMask;
 	asSNameSpace     *m_defaultNamespace;
+	bool              m_isDiscarded;
 
 	// This array holds all functions, class members, factories, etc that were compiled with the module.
 	// These references hold an internal reference to the function object.
@@ -250,6 +282,22 @@ public:
 	asCArray<asCTypeInfo*>       m_externalTypes; // doesn't increase ref count
 	// This array holds functions that have been explicitly declared with 'external'
 	asCArray<asCScriptFunction*> m_externalFunctions; // doesn't increase ref count
+
+	// Information on the script sections from the last build, used by BuildIncremental
+	asCArray<sScriptSectionInfo*>                     m_sectionInfos;
+	asCMap<asSNameSpace*, asCArray<asSNameSpace*> >   m_namespaceVisibility;
+	asCMap<asCGlobalProperty*, asQWORD>               m_pureConstants;
+	asCArray<int>                                     m_inlinedFunctions; // Functions inlined in the callers
+
+	// Functions whose compilation has been deferred with asEP_DEFER_FUNCTION_COMPILATION
+	asCMap<int, sDeferredFunction>                    m_deferredFunctions; // key is the function id
+	asCArray<asCScriptCode*>                          m_deferredScripts;
+
+	// Statistics from the last build or load
+	asSBuildStatistics m_buildStats;
+	double             m_buildStartTime;
+	asUINT             m_buildStartNodeAllocs;
+	asUINT             m_buildStartInstrAllocs;
 };
 
 END_AS_NAMESPACE
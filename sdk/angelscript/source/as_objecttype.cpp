@@ -510,7 +510,7 @@ asIScriptFunction *asCObjectType::GetBehaviourByIndex(asUINT index, asEBehaviour
 // internal
 asCObjectProperty *asCObjectType::AddPropertyToClass(const asCString &propName, const asCDataType &dt, bool isPrivate, bool isProtected, bool isInherited)
 {
-	asASSERT( flags & asOBJ_SCRIPT_OBJECT );
+	asASSERT( flags & (asOBJ_SCRIPT_OBJECT | asOBJ_SCRIPT_STRUCT) );
 	asASSERT( dt.CanBeInstantiated() );
 	asASSERT( !IsInterface() );
 
@@ -592,7 +592,7 @@ void asCObjectType::ReleaseAllProperties()
 	{
 		if( properties[n] ) 
 		{
-			if( flags & asOBJ_SCRIPT_OBJECT )
+			if( flags & (asOBJ_SCRIPT_OBJECT | asOBJ_SCRIPT_STRUCT) )
 			{
 				// Release the config group for script classes that are being destroyed
 				asCConfigGroup *group = engine->FindConfigGroupForTypeInfo(properties[n]->type.GetTypeInfo());
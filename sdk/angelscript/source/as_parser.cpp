@@ -138,15 +138,16 @@ int asCParser::ParseFunctionDefinition(asCScriptCode *in_script, bool in_expectL
 
 asCScriptNode *asCParser::CreateNode(eScriptNode type)
 {
-	void *ptr = engine->memoryMgr.AllocScriptNode();
-	if( ptr == 0 )
+	// The nodes are allocated from the builder's arena
+	asCScriptNode *node = builder->nodeArena.CreateNode(type);
+	if( node == 0 )
 	{
 		// Out of memory
 		errorWhileParsing = true;
 		return 0;
 	}
 
-	return new(ptr) asCScriptNode(type);
+	return node;
 }
 
 int asCParser::ParseDataType(asCScriptCode *in_script, bool in_isReturnType)
@@ -1302,7 +1303,7 @@ bool asCParser::IdentifierIs(const sToken &t, const char *str)
 	return script->TokenEquals(t.pos, t.length, str);
 }
 
-// BNF:6: FUNCATTR      ::= ('override' | 'final' | 'explicit' | 'property' | 'delete')*
+// BNF:6: FUNCATTR      ::= ('override' | 'final' | 'explicit' | 'property' | 'delete' | 'constexpr' | 'inline' | 'noinline')*
 void asCParser::ParseMethodAttributes(asCScriptNode *funcNode)
 {
 	sToken t1;
@@ -1316,7 +1317,10 @@ void asCParser::ParseMethodAttributes(asCScriptNode *funcNode)
 			IdentifierIs(t1, OVERRIDE_TOKEN) || 
 			IdentifierIs(t1, EXPLICIT_TOKEN) ||
 			IdentifierIs(t1, PROPERTY_TOKEN) ||
-			IdentifierIs(t1, DELETE_TOKEN) )
+			IdentifierIs(t1, DELETE_TOKEN) ||
+			IdentifierIs(t1, CONSTEXPR_TOKEN) ||
+			IdentifierIs(t1, INLINE_TOKEN) ||
+			IdentifierIs(t1, NOINLINE_TOKEN) )
 			funcNode->AddChildLast(ParseIdentifier());
 		else
 			break;
@@ -1509,7 +1513,7 @@ bool asCParser::IsTemplateTypeList(sToken start, sToken *after)
 
 	// Accept >> and >>> tokens too. But then force the tokenizer to move
 	// only 1 character ahead (thus splitting the token in two).
-	if (script->code[t1.pos] != '>')
+	if (t1.pos >= script->codeLength || script->code[t1.pos] != '>')
 		isTemplateTypeList = false;
 
 	if (after)
@@ -2615,7 +2619,9 @@ asCScriptNode *asCParser::ParseScript(bool inBlock)
 			else if( t1.type == ttTypedef )
 				node->AddChildLast(ParseTypedef());		// Handle primitive typedefs
 			else if( t1.type == ttClass )
-				node->AddChildLast(ParseClass());
+				node->AddChildLast(ParseClass(true));
+			else if( IdentifierIs(t1, STRUCT_TOKEN) && IsStructDecl() )
+				node->AddChildLast(ParseClass(true));
 			else if( t1.type == ttMixin )
 				node->AddChildLast(ParseMixin());
 			else if( t1.type == ttInterface )
@@ -3169,7 +3175,10 @@ bool asCParser::IsFuncDecl(bool isMethod)
 					!IdentifierIs(t1, OVERRIDE_TOKEN) &&
 					!IdentifierIs(t1, EXPLICIT_TOKEN) &&
 					!IdentifierIs(t1, PROPERTY_TOKEN) &&
-					!IdentifierIs(t1, DELETE_TOKEN) )
+					!IdentifierIs(t1, DELETE_TOKEN) &&
+					!IdentifierIs(t1, CONSTEXPR_TOKEN) &&
+					!IdentifierIs(t1, INLINE_TOKEN) &&
+					!IdentifierIs(t1, NOINLINE_TOKEN) )
 				{
 					RewindTo(&t1);
 					break;
@@ -3618,13 +3627,45 @@ asCScriptNode *asCParser::ParseMixin()
 	node->SetToken(&t);
 
 	// A mixin token must be followed by a class declaration
-	node->AddChildLast(ParseClass());
+	node->AddChildLast(ParseClass(false));
 
 	return node;
 }
 
-// BNF:1: CLASS         ::= ('shared' | 'abstract' | 'final' | 'external')* 'class' IDENTIFIER (';' | ((':' IDENTIFIER (',' IDENTIFIER)*)? '{' (VIRTPROP | FUNC | VAR | FUNCDEF)* '}'))
-asCScriptNode *asCParser::ParseClass()
+// The contextual keyword 'struct' is only treated as such when followed by the name and the body of the struct
+bool asCParser::IsStructDecl()
+{
+	// Set start point so that we can rewind
+	sToken t;
+	GetToken(&t);
+	RewindTo(&t);
+
+	// Skip the modifiers, these are not allowed for structs but are reported by the builder
+	sToken t1;
+	GetToken(&t1);
+	while( IdentifierIs(t1, SHARED_TOKEN) ||
+		   IdentifierIs(t1, ABSTRACT_TOKEN) ||
+		   IdentifierIs(t1, FINAL_TOKEN) ||
+		   IdentifierIs(t1, EXTERNAL_TOKEN) )
+		GetToken(&t1);
+
+	bool isStruct = false;
+	if( IdentifierIs(t1, STRUCT_TOKEN) )
+	{
+		GetToken(&t1);
+		if( t1.type == ttIdentifier )
+		{
+			GetToken(&t1);
+			isStruct = t1.type == ttStartStatementBlock || t1.type == ttColon;
+		}
+	}
+
+	RewindTo(&t);
+	return isStruct;
+}
+
+// BNF:1: CLASS         ::= ('shared' | 'abstract' | 'final' | 'external')* ('class' | 'struct') IDENTIFIER (';' | ((':' IDENTIFIER (',' IDENTIFIER)*)? '{' (VIRTPROP | FUNC | VAR | FUNCDEF)* '}'))
+asCScriptNode *asCParser::ParseClass(bool allowStruct)
 {
 	asCScriptNode *node = CreateNode(snClass);
 	if( node == 0 ) return 0;
@@ -3643,7 +3684,9 @@ asCScriptNode *asCParser::ParseClass()
 		GetToken(&t);
 	}
 
-	if( t.type != ttClass )
+	// A struct is declared like a class, but with the contextual keyword 'struct'. The
+	// node will then hold the identifier token instead of the 'class' token
+	if( t.type != ttClass && !(allowStruct && IdentifierIs(t, STRUCT_TOKEN)) )
 	{
 		Error(ExpectedToken("class"), &t);
 		Error(InsteadFound(t), &t);
@@ -3652,7 +3695,7 @@ asCScriptNode *asCParser::ParseClass()
 
 	node->SetToken(&t);
 
-	if( engine->ep.allowImplicitHandleTypes )
+	if( engine->ep.allowImplicitHandleTypes && t.type == ttClass )
 	{
 		// Parse 'implicit handle class' construct
 		GetToken(&t);
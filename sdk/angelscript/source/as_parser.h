@@ -127,7 +127,7 @@ protected:
 	asCScriptNode *ParseUsing();
 	asCScriptNode *ParseFunction(bool isMethod = false);
 	asCScriptNode *ParseFuncDef();
-	asCScriptNode *ParseClass();
+	asCScriptNode *ParseClass(bool allowStruct);
 	asCScriptNode *ParseMixin();
 	asCScriptNode *ParseInitList();
 	asCScriptNode *ParseInterface();
@@ -137,6 +137,7 @@ protected:
 	asCScriptNode *ParseTypedef();
 	bool IsVarDecl();
 	bool IsVirtualPropertyDecl();
+	bool IsStructDecl();
 	bool IsFuncDecl(bool isMethod);
 	bool IsLambda();
 	bool IsFunctionCall(bool isTemplate);
@@ -48,29 +48,697 @@ BEGIN_AS_NAMESPACE
 #define SAVE_TO_BIT(dst, val, bit) ((dst) |= ((val) << (bit)))
 #define LOAD_FROM_BIT(dst, val, bit) ((dst) = ((val) >> (bit)) & 1)
 
+// The sectioned bytecode container (asEP_BYTECODE_FORMAT 1 and 2) has the following layout:
+//
+//  'A' 'S' 'B' 'C' version flags sectionCount
+//  sectionCount * { kind flags rawSize storedSize crc32 }
+//  sectionCount * storedData
+//
+// All multi-byte values are stored as 4 byte big-endian integers. The raw data of the
+// sections concatenated gives the same sequence that is written without the container,
+// except for the debug info. Unless it has been stripped the debug info of all functions
+// is stored in the last section, in the order the functions appear in the other sections
+// and with its own string table, so the reader can read it after everything else or skip
+// it. The legacy format always starts with the byte 0 or 1 so the two are easily told apart.
+const asBYTE BC_CONTAINER_VERSION      = 1;
+const asBYTE BC_CONTAINER_DEBUG_STRIPPED = 1;
+const asBYTE BC_SECTION_COMPRESSED     = 1;
+const asUINT BC_SECTION_HEADER_SIZE    = 14;
+
+enum asEBCSection
+{
+	asBCS_TYPES = 1,
+	asBCS_GLOBALS,
+	asBCS_FUNCTIONS,
+	asBCS_IMPORTS,
+	asBCS_USED_TYPES,
+	asBCS_USED_FUNCTIONS,
+	asBCS_USED_GLOBAL_PROPS,
+	asBCS_STRING_CONSTANTS,
+	asBCS_USED_OBJECT_PROPS,
+	asBCS_DEBUG_INFO
+};
+
+static void StoreBigEndianDWord(asBYTE *dst, asDWORD val)
+{
+	dst[0] = asBYTE(val >> 24);
+	dst[1] = asBYTE(val >> 16);
+	dst[2] = asBYTE(val >> 8);
+	dst[3] = asBYTE(val);
+}
+
+static asDWORD LoadBigEndianDWord(const asBYTE *src)
+{
+	return (asDWORD(src[0]) << 24) | (asDWORD(src[1]) << 16) | (asDWORD(src[2]) << 8) | asDWORD(src[3]);
+}
+
+// Standard CRC-32 (same as zlib), using a 16 entry table to keep the footprint small
+static asDWORD CalculateCRC32(const asBYTE *data, asUINT length)
+{
+	static const asDWORD table[16] =
+	{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+	};
+
+	asDWORD crc = 0xFFFFFFFF;
+	for( asUINT n = 0; n < length; n++ )
+	{
+		crc ^= data[n];
+		crc = (crc >> 4) ^ table[crc & 0xF];
+		crc = (crc >> 4) ^ table[crc & 0xF];
+	}
+	return ~crc;
+}
+
+// The sections are compressed with a simple LZ77 variant. Each sequence starts with a token
+// byte where the high nibble is the number of literals and the low nibble is the match length
+// minus 4. A nibble value of 15 means that more bytes follow, each adding to the length until
+// a byte less than 255 is found. After the literals comes the 2 byte match offset. The last
+// sequence holds only literals and is identified by the output being complete.
+const asUINT BC_MIN_MATCH   = 4;
+const asUINT BC_MAX_OFFSET  = 0xFFFF;
+const asUINT BC_HASH_BITS   = 12;
+
+static void WriteLZLength(asCArray<asBYTE> &dst, asUINT length)
+{
+	while( length >= 255 )
+	{
+		dst.PushLast(255);
+		length -= 255;
+	}
+	dst.PushLast(asBYTE(length));
+}
+
+static void WriteLZSequence(asCArray<asBYTE> &dst, const asBYTE *literals, asUINT numLiterals, asUINT offset, asUINT matchLength)
+{
+	asUINT matchCode = matchLength ? matchLength - BC_MIN_MATCH : 0;
+	dst.PushLast(asBYTE(((numLiterals < 15 ? numLiterals : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+	if( numLiterals >= 15 )
+		WriteLZLength(dst, numLiterals - 15);
+	for( asUINT n = 0; n < numLiterals; n++ )
+		dst.PushLast(literals[n]);
+
+	if( matchLength )
+	{
+		dst.PushLast(asBYTE(offset));
+		dst.PushLast(asBYTE(offset >> 8));
+		if( matchCode >= 15 )
+			WriteLZLength(dst, matchCode - 15);
+	}
+}
+
+static asDWORD LoadLZWord(const asBYTE *src)
+{
+	asDWORD val;
+	memcpy(&val, src, 4);
+	return val;
+}
+
+static void CompressSection(const asBYTE *src, asUINT length, asCArray<asBYTE> &dst)
+{
+	const asUINT noPos = 0xFFFFFFFF;
+	asCArray<asUINT> hashTable;
+	hashTable.SetLength(1 << BC_HASH_BITS);
+	for( asUINT n = 0; n < hashTable.GetLength(); n++ )
+		hashTable[n] = noPos;
+
+	dst.SetLength(0);
+	dst.Allocate(length/2 + 16, false);
+
+	asUINT anchor = 0;
+	asUINT pos = 0;
+	while( pos + BC_MIN_MATCH <= length )
+	{
+		asDWORD word = LoadLZWord(src + pos);
+		asUINT hash = (word * 2654435761u) >> (32 - BC_HASH_BITS);
+		asUINT candidate = hashTable[hash];
+		hashTable[hash] = pos;
+
+		if( candidate != noPos && pos - candidate <= BC_MAX_OFFSET && LoadLZWord(src + candidate) == word )
+		{
+			asUINT matchLength = BC_MIN_MATCH;
+			while( pos + matchLength < length && src[candidate + matchLength] == src[pos + matchLength] )
+				matchLength++;
+
+			WriteLZSequence(dst, src + anchor, pos - anchor, pos - candidate, matchLength);
+			pos += matchLength;
+			anchor = pos;
+		}
+		else
+			pos++;
+	}
+
+	// The remaining bytes are stored as literals
+	if( anchor < length )
+		WriteLZSequence(dst, src + anchor, length - anchor, 0, 0);
+}
+
+static bool ReadLZLength(const asBYTE *src, asUINT srcLength, asUINT &pos, asUINT &length)
+{
+	asBYTE b;
+	do
+	{
+		if( pos >= srcLength )
+			return false;
+		b = src[pos++];
+		length += b;
+	} while( b == 255 );
+	return true;
+}
+
+static bool DecompressSection(const asBYTE *src, asUINT srcLength, asBYTE *dst, asUINT dstLength)
+{
+	asUINT ip = 0, op = 0;
+	while( op < dstLength )
+	{
+		if( ip >= srcLength )
+			return false;
+		asBYTE token = src[ip++];
+
+		asUINT numLiterals = token >> 4;
+		if( numLiterals == 15 && !ReadLZLength(src, srcLength, ip, numLiterals) )
+			return false;
+		if( numLiterals > srcLength - ip || numLiterals > dstLength - op )
+			return false;
+		memcpy(dst + op, src + ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		if( op == dstLength )
+			break;
+
+		if( srcLength - ip < 2 )
+			return false;
+		asUINT offset = asUINT(src[ip]) | (asUINT(src[ip+1]) << 8);
+		ip += 2;
+		if( offset == 0 || offset > op )
+			return false;
+
+		asUINT matchLength = token & 0xF;
+		if( matchLength == 15 && !ReadLZLength(src, srcLength, ip, matchLength) )
+			return false;
+		matchLength += BC_MIN_MATCH;
+		if( matchLength > dstLength - op )
+			return false;
+
+		// The match may overlap the output so it must be copied byte by byte
+		for( asUINT n = 0; n < matchLength; n++, op++ )
+			dst[op] = dst[op - offset];
+	}
+
+	return ip == srcLength;
+}
+
+// Returns true for the instructions that asCReader::TranslateFunction must visit to
+// update indices, jump offsets, or stack offsets after loading. The writer stores the
+// instruction numbers of these in a relocation table for each function, so the reader
+// doesn't have to decode every instruction to find them.
+static bool IsRelocatedInstruction(asBYTE c)
+{
+	switch( c )
+	{
+	case asBC_REFCPY:
+	case asBC_RefCpyV:
+	case asBC_OBJTYPE:
+	case asBC_TYPEID:
+	case asBC_Cast:
+	case asBC_ADDSi:
+	case asBC_LoadThisR:
+	case asBC_LoadRObjR:
+	case asBC_LoadVObjR:
+	case asBC_COPY:
+	case asBC_RET:
+	case asBC_CALL:
+	case asBC_CALLINTF:
+	case asBC_CALLSYS:
+	case asBC_Thiscall1:
+	case asBC_FuncPtr:
+	case asBC_ALLOC:
+	case asBC_STR:
+	case asBC_CALLBND:
+	case asBC_PGA:
+	case asBC_PshGPtr:
+	case asBC_LDG:
+	case asBC_PshG4:
+	case asBC_LdGRdR4:
+	case asBC_CpyGtoV4:
+	case asBC_CpyVtoG4:
+	case asBC_SetG4:
+	case asBC_JMP:
+	case asBC_JZ:
+	case asBC_JNZ:
+	case asBC_JLowZ:
+	case asBC_JLowNZ:
+	case asBC_JS:
+	case asBC_JNS:
+	case asBC_JP:
+	case asBC_JNP:
+	case asBC_AllocMem:
+	case asBC_FREE:
+	case asBC_SetListSize:
+	case asBC_PshListElmnt:
+	case asBC_SetListType:
+	case asBC_GETREF:
+	case asBC_GETOBJ:
+	case asBC_GETOBJREF:
+	case asBC_ChkNullS:
+		return true;
+	default:
+		return false;
+	}
+}
+
 asCReader::asCReader(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine)
-	: module(_module), stream(_stream), engine(_engine), error(false), bytesRead(0), lastCompositeProp(0)
+	: module(_module), stream(_stream), buffer(0), bufferSize(0), bufferPos(0), engine(_engine), error(false), bytesRead(0), currentSection(0), containerFlags(0), hasPeekedByte(false), peekedByte(0), readDebugSection(false), isPrepared(false), deferErrors(false), prepareResult(0), lastCompositeProp(0)
+{
+}
+
+asCReader::asCReader(asCModule* _module, const void* _buffer, size_t _bufferSize, asCScriptEngine* _engine)
+	: module(_module), stream(0), buffer((const asBYTE*)_buffer), bufferSize(_bufferSize), bufferPos(0), engine(_engine), error(false), bytesRead(0), currentSection(0), containerFlags(0), hasPeekedByte(false), peekedByte(0), readDebugSection(false), isPrepared(false), deferErrors(false), prepareResult(0), lastCompositeProp(0)
 {
 }
 
+asCReader::~asCReader()
+{
+	asSMapNode<asCScriptFunction*, STranslationInfo*> *cursor = 0;
+	translationInfo.MoveFirst(&cursor);
+	while( cursor )
+	{
+		asDELETE(translationInfo.GetValue(cursor), STranslationInfo);
+		translationInfo.MoveNext(&cursor, cursor);
+	}
+}
+
+int asCReader::ReadRawData(void *data, asUINT size)
+{
+	if( buffer )
+	{
+		if( !IsInBuffer(size) )
+			return asERROR;
+		memcpy(data, buffer + bufferPos, size);
+		bufferPos += size;
+		return 0;
+	}
+
+	return stream->Read(data, size);
+}
+
+// Returns true if the memory buffer has the requested number of bytes left. A value is never
+// split between two sections of a container, so when the current section has been read to the
+// end the reading continues with the next one
+bool asCReader::IsInBuffer(size_t size)
+{
+	while( size > bufferSize - bufferPos )
+	{
+		if( bufferPos != bufferSize || currentSection + 1 >= sectionData.GetLength() )
+			return false;
+
+		currentSection++;
+		buffer     = sectionData[currentSection];
+		bufferSize = sectionSizes[currentSection];
+		bufferPos  = 0;
+	}
+
+	return true;
+}
+
+int asCReader::ReadContainer()
+{
+	// Determine if the bytecode is stored in a container by looking at the first byte
+	asBYTE first = 0xFF; // set to 0xFF to better catch if the stream doesn't update the value
+	if( buffer )
+	{
+		if( bufferSize == 0 || buffer[0] != 'A' )
+			return 0;
+	}
+	else
+	{
+		if( stream->Read(&first, 1) < 0 )
+			return Error(TXT_UNEXPECTED_END_OF_FILE);
+		if( first != 'A' )
+		{
+			// Keep the byte so the sequential read will get it
+			hasPeekedByte = true;
+			peekedByte = first;
+			return 0;
+		}
+	}
+
+	asBYTE header[7];
+	int r = ReadRawData(header, buffer ? 7 : 6);
+	if( r < 0 )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+	const asBYTE *h = buffer ? header + 1 : header;
+	if( h[0] != 'S' || h[1] != 'B' || h[2] != 'C' )
+		return Error(TXT_INVALID_BYTECODE_d);
+	if( h[3] != BC_CONTAINER_VERSION )
+	{
+		asCString str;
+		str.Format(TXT_BYTECODE_CONTAINER_VERSION_d, h[3]);
+		return WriteError(str);
+	}
+	// The flags are verified against the stream when it is read
+	containerFlags = h[4];
+	if( containerFlags & ~BC_CONTAINER_DEBUG_STRIPPED )
+		return Error(TXT_INVALID_BYTECODE_d);
+	asUINT numSections = h[5];
+	bytesRead += 7;
+
+	asCArray<asBYTE> table;
+	table.SetLength(numSections * BC_SECTION_HEADER_SIZE);
+	if( numSections && ReadRawData(table.AddressOf(), table.GetLength()) < 0 )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+	bytesRead += table.GetLength();
+
+	// Unless the debug info was stripped it is always in the last section, and
+	// there must be at least one other section with the rest of the bytecode
+	bool hasDebugSection = (containerFlags & BC_CONTAINER_DEBUG_STRIPPED) ? false : true;
+	asUINT numMainSections = numSections - (hasDebugSection ? 1 : 0);
+	if( numSections == 0 || numMainSections == 0 )
+		return Error(TXT_INVALID_BYTECODE_d);
+	for( asUINT n = 0; n < numSections; n++ )
+	{
+		bool isDebugSection = table[n*BC_SECTION_HEADER_SIZE] == asBCS_DEBUG_INFO;
+		if( isDebugSection != (n == numMainSections) )
+			return Error(TXT_INVALID_BYTECODE_d);
+	}
+
+	// The debug info is only read if the application wants it
+	readDebugSection = hasDebugSection && !engine->ep.skipDebugInfoOnLoad;
+	asUINT numUsedSections = readDebugSection ? numSections : numMainSections;
+
+	// When reading from memory the uncompressed sections are parsed in place, so only
+	// the compressed sections need to be unpacked. From a stream all sections are read
+	// into memory, with the uncompressed sections going straight to their final place
+	asQWORD totalSize = 0;
+	for( asUINT n = 0; n < numUsedSections; n++ )
+	{
+		const asBYTE *entry = &table[n*BC_SECTION_HEADER_SIZE];
+		if( !buffer || (entry[1] & BC_SECTION_COMPRESSED) )
+			totalSize += LoadBigEndianDWord(entry + 2);
+	}
+	if( totalSize > 0x7FFFFFFF )
+		return Error(TXT_INVALID_BYTECODE_d);
+	containerData.SetLength(asUINT(totalSize));
+	if( containerData.GetLength() != totalSize )
+	{
+		error = true;
+		return asOUT_OF_MEMORY;
+	}
+
+	sectionData.Allocate(numMainSections, false);
+	sectionSizes.Allocate(numMainSections, false);
+
+	asCArray<asBYTE> stored;
+	asUINT offset = 0;
+	for( asUINT n = 0; n < numSections; n++ )
+	{
+		const asBYTE *entry  = &table[n*BC_SECTION_HEADER_SIZE];
+		asUINT rawSize       = LoadBigEndianDWord(entry + 2);
+		asUINT storedSize    = LoadBigEndianDWord(entry + 6);
+		asDWORD crc          = LoadBigEndianDWord(entry + 10);
+		bool compressed      = (entry[1] & BC_SECTION_COMPRESSED) ? true : false;
+
+		if( !compressed && storedSize != rawSize )
+			return Error(TXT_INVALID_BYTECODE_d);
+
+		if( n >= numUsedSections )
+		{
+			// Skip the debug info without verifying or unpacking it
+			if( buffer )
+			{
+				if( storedSize > bufferSize - bufferPos )
+					return Error(TXT_UNEXPECTED_END_OF_FILE);
+				bufferPos += storedSize;
+			}
+			else
+			{
+				// The stream is still read to the end so it is left after the bytecode
+				stored.SetLength(storedSize < 65536 ? storedSize : 65536);
+				for( asUINT left = storedSize; left > 0; )
+				{
+					asUINT chunk = left < stored.GetLength() ? left : stored.GetLength();
+					if( stream->Read(stored.AddressOf(), chunk) < 0 )
+						return Error(TXT_UNEXPECTED_END_OF_FILE);
+					left -= chunk;
+				}
+			}
+			bytesRead += storedSize;
+			continue;
+		}
+
+		// The compressed debug info read from a stream is kept until it is unpacked
+		bool isDebugSection = n == numMainSections;
+		const asBYTE *data;
+		if( buffer )
+		{
+			if( storedSize > bufferSize - bufferPos )
+				return Error(TXT_UNEXPECTED_END_OF_FILE);
+			data = buffer + bufferPos;
+			bufferPos += storedSize;
+		}
+		else
+		{
+			asBYTE *dst = containerData.AddressOf() + offset;
+			if( compressed )
+			{
+				asCArray<asBYTE> &packed = isDebugSection ? debugSectionStored : stored;
+				packed.SetLength(storedSize);
+				dst = packed.AddressOf();
+			}
+			if( storedSize && stream->Read(dst, storedSize) < 0 )
+				return Error(TXT_UNEXPECTED_END_OF_FILE);
+			data = dst;
+		}
+		bytesRead += storedSize;
+
+		asBYTE *unpacked = (!buffer || compressed) ? containerData.AddressOf() + offset : 0;
+		if( !buffer || compressed )
+			offset += rawSize;
+
+		if( isDebugSection )
+		{
+			// The debug info is verified and unpacked by ReadDebugInfo
+			debugSection.index      = n;
+			debugSection.stored     = data;
+			debugSection.storedSize = storedSize;
+			debugSection.rawSize    = rawSize;
+			debugSection.crc        = crc;
+			debugSection.compressed = compressed;
+			debugSection.unpacked   = unpacked;
+			continue;
+		}
+
+		bool ok = CalculateCRC32(data, storedSize) == crc;
+		if( ok && compressed )
+		{
+			ok = DecompressSection(data, storedSize, unpacked, rawSize);
+			data = unpacked;
+		}
+		if( !ok )
+		{
+			asCString str;
+			str.Format(TXT_BYTECODE_SECTION_d_CORRUPT, n);
+			return WriteError(str);
+		}
+
+		sectionData.PushLast(data);
+		sectionSizes.PushLast(rawSize);
+	}
+
+	// The rest of the load reads the sections in sequence. Offsets reported
+	// in error messages from here on refer to the unpacked data
+	currentSection = 0;
+	buffer         = sectionData[0];
+	bufferSize     = sectionSizes[0];
+	bufferPos      = 0;
+	bytesRead      = 0;
+
+	return 0;
+}
+
+int asCReader::ReadDebugInfo()
+{
+	TimeIt("asCReader::ReadDebugInfo");
+
+	// Verify and unpack the section now that it is needed
+	const asBYTE *data = debugSection.stored;
+	bool ok = CalculateCRC32(data, debugSection.storedSize) == debugSection.crc;
+	if( ok && debugSection.compressed )
+	{
+		ok = DecompressSection(data, debugSection.storedSize, debugSection.unpacked, debugSection.rawSize);
+		data = debugSection.unpacked;
+	}
+	if( !ok )
+	{
+		asCString str;
+		str.Format(TXT_BYTECODE_SECTION_d_CORRUPT, debugSection.index);
+		return WriteError(str);
+	}
+
+	// Continue reading from the debug info section only. It has its own string
+	// table as it is written in parallel with the other sections
+	currentSection = sectionData.GetLength();
+	buffer         = data;
+	bufferSize     = debugSection.rawSize;
+	bufferPos      = 0;
+	bytesRead      = 0;
+	savedStrings.SetLength(0);
+
+	for( asUINT n = 0; n < debugInfoFuncs.GetLength() && !error; n++ )
+	{
+		// The function may have been discarded in favour of an already existing
+		// shared function, in which case the reader holds the only reference or none
+		asCScriptFunction *func = debugInfoFuncs[n];
+		ReadFunctionDebugInfo((func && func->internalRefCount.get() > 1) ? func : 0);
+	}
+
+	// All of the debug info must have been used
+	if( !error && bufferPos != bufferSize )
+		Error(TXT_INVALID_BYTECODE_d);
+
+	if( error )
+		return asERROR;
+
+	noDebugInfo = false;
+	return asSUCCESS;
+}
+
+void asCReader::ReadFunctionDebugInfo(asCScriptFunction *func)
+{
+	// The debug info of discarded functions is read into temporary storage
+	asCArray<int>    tmpLineNumbers, tmpSectionIdxs;
+	asCArray<int>   &lineNumbers = func ? func->scriptData->lineNumbers : tmpLineNumbers;
+	asCArray<int>   &sectionIdxs = func ? func->scriptData->sectionIdxs : tmpSectionIdxs;
+	asCString        str;
+	asUINT           i;
+
+	asUINT length = SanityCheck(ReadEncodedUInt(), 1000000);
+	lineNumbers.SetLength(length);
+	if( lineNumbers.GetLength() != length )
+	{
+		// Out of memory
+		error = true;
+		return;
+	}
+	for( i = 0; i < length; ++i )
+		lineNumbers[i] = ReadEncodedUInt();
+
+	// Read the array of script sections
+	length = SanityCheck(ReadEncodedUInt(), 1000000);
+	sectionIdxs.SetLength(length);
+	if( sectionIdxs.GetLength() != length )
+	{
+		// Out of memory
+		error = true;
+		return;
+	}
+	for( i = 0; i < length; ++i )
+	{
+		if( (i & 1) == 0 )
+			sectionIdxs[i] = ReadEncodedUInt();
+		else
+		{
+			ReadString(&str);
+			sectionIdxs[i] = engine->GetScriptSectionNameIndex(str.AddressOf());
+		}
+	}
+
+	// Read the names of the variables, which have already been loaded
+	length = SanityCheck(ReadEncodedUInt(), 1000000);
+	if( func && length != func->scriptData->variables.GetLength() )
+	{
+		Error(TXT_INVALID_BYTECODE_d);
+		return;
+	}
+	for( i = 0; i < length && !error; i++ )
+	{
+		asUINT declaredAt = ReadEncodedUInt();
+		ReadString(&str);
+		if( func )
+		{
+			func->scriptData->variables[i]->declaredAtProgramPos = declaredAt;
+			func->scriptData->variables[i]->name = str;
+		}
+	}
+
+	// Read script section name
+	ReadString(&str);
+	asUINT declaredAt = ReadEncodedUInt();
+	if( func )
+	{
+		func->scriptData->scriptSectionIdx = engine->GetScriptSectionNameIndex(str.AddressOf());
+		func->scriptData->declaredAt = declaredAt;
+	}
+
+	// Read parameter names
+	asUINT countParam = asUINT(ReadEncodedUInt64());
+	if( func && countParam > func->parameterTypes.GetLength() )
+	{
+		Error(TXT_INVALID_BYTECODE_d);
+		return;
+	}
+	if( func )
+		func->parameterNames.SetLength(countParam);
+	for( i = 0; i < countParam && !error; i++ )
+	{
+		ReadString(&str);
+		if( func )
+			func->parameterNames[i] = str;
+	}
+}
+
 int asCReader::ReadData(void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
 	int ret = 0;
+	if( buffer )
+	{
+		// Read directly from the memory buffer without going through the stream
+		if( !IsInBuffer(size) )
+		{
+			// Don't leave the destination uninitialized
+			memset(data, 0, size);
+			bufferPos = bufferSize;
+			ret = asERROR;
+		}
+		else
+		{
+			const asBYTE *src = buffer + bufferPos;
+			bufferPos += size;
 #if defined(AS_BIG_ENDIAN)
-	for( asUINT n = 0; ret >= 0 && n < size; n++ )
-		ret = stream->Read(((asBYTE*)data)+n, 1);
+			memcpy(data, src, size);
 #else
-	for( int n = size-1; ret >= 0 && n >= 0; n-- )
-		ret = stream->Read(((asBYTE*)data)+n, 1);
+			for( asUINT n = 0; n < size; n++ )
+				((asBYTE*)data)[size-1-n] = src[n];
+#endif
+		}
+	}
+	else if( hasPeekedByte )
+	{
+		// The first byte was already read when checking for the container
+		asASSERT(size == 1);
+		*(asBYTE*)data = peekedByte;
+		hasPeekedByte = false;
+	}
+	else
+	{
+#if defined(AS_BIG_ENDIAN)
+		for( asUINT n = 0; ret >= 0 && n < size; n++ )
+			ret = stream->Read(((asBYTE*)data)+n, 1);
+#else
+		for( int n = size-1; ret >= 0 && n >= 0; n-- )
+			ret = stream->Read(((asBYTE*)data)+n, 1);
 #endif
+	}
 	if (ret < 0)
 		Error(TXT_UNEXPECTED_END_OF_FILE);
 	bytesRead += size;
 	return ret;
 }
 
-int asCReader::Read(bool *wasDebugInfoStripped)
+int asCReader::Read()
 {
 	TimeIt("asCReader::Read");
 
@@ -80,7 +748,72 @@ int asCReader::Read(bool *wasDebugInfoStripped)
 
 	// Call the inner method to do the actual loading
 	int r = ReadInner();
-	if( r < 0 )
+
+	// Release the functions that were held for the debug info
+	for( asUINT n = 0; n < debugInfoFuncs.GetLength(); n++ )
+		if( debugInfoFuncs[n] )
+			debugInfoFuncs[n]->ReleaseInternal();
+	debugInfoFuncs.SetLength(0);
+
+	return r;
+}
+
+int asCReader::Translate()
+{
+	TimeIt("asCReader::Translate");
+
+	// The translation only modifies the loaded functions and looks up entities that
+	// were already resolved by Read, so it can run in parallel with other threads
+	// that are loading bytecode. Errors are reported by Finish
+	deferErrors = true;
+
+	// Update the loaded bytecode to point to the correct types, property offsets,
+	// function ids, etc. This is basically a linking stage.
+	for( asUINT i = 0; i < module->m_scriptFunctions.GetLength() && !error; i++ )
+		if( module->m_scriptFunctions[i]->funcType == asFUNC_SCRIPT )
+			TranslateFunction(module->m_scriptFunctions[i]);
+
+	asCSymbolTable<asCGlobalProperty>::iterator globIt = module->m_scriptGlobals.List();
+	while( globIt && !error )
+	{
+		asCScriptFunction *initFunc = (*globIt)->GetInitFunc();
+		if( initFunc )
+			TranslateFunction(initFunc);
+		globIt++;
+	}
+
+	deferErrors = false;
+
+	return error ? asERROR : asSUCCESS;
+}
+
+int asCReader::Finish(int r, bool *wasDebugInfoStripped)
+{
+	TimeIt("asCReader::Finish");
+
+	if( deferredError.GetLength() )
+	{
+		engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, deferredError.AddressOf());
+		deferredError = "";
+	}
+
+	if( r >= 0 )
+	{
+		// Add references for all functions (except for the pre-existing shared code)
+		for( asUINT i = 0; i < module->m_scriptFunctions.GetLength(); i++ )
+			if( !dontTranslate.MoveTo(0, module->m_scriptFunctions[i]) )
+				module->m_scriptFunctions[i]->AddReferences();
+
+		asCSymbolTable<asCGlobalProperty>::iterator globIt = module->m_scriptGlobals.List();
+		while( globIt )
+		{
+			asCScriptFunction *initFunc = (*globIt)->GetInitFunc();
+			if( initFunc )
+				initFunc->AddReferences();
+			globIt++;
+		}
+	}
+	else
 	{
 		// Something went wrong while loading the bytecode, so we need
 		// to clean-up whatever has been created during the process.
@@ -99,17 +832,24 @@ int asCReader::Read(bool *wasDebugInfoStripped)
 				if( (*it)->GetInitFunc()->scriptData )
 					(*it)->GetInitFunc()->scriptData->byteCode.SetLength(0);
 
+		// Without the references the loaded functions may still point to the
+		// class types after these have been released by the module, so hold
+		// on to the types until all the functions have been cleaned up too
+		asCArray<asCObjectType*> types = module->m_classTypes;
+		for( i = 0; i < types.GetLength(); i++ )
+			types[i]->AddRefInternal();
+
 		module->InternalReset();
+
+		for( i = 0; i < types.GetLength(); i++ )
+			types[i]->ReleaseInternal();
 	}
-	else
+
+	if( r >= 0 )
 	{
 		// Init system functions properly
 		engine->PrepareEngine();
 
-		// Initialize the global variables (unless requested not to)
-		if( engine->ep.initGlobalVarsAfterBuild )
-			r = module->ResetGlobalVars(0);
-
 		if( wasDebugInfoStripped )
 			*wasDebugInfoStripped = noDebugInfo;
 	}
@@ -123,19 +863,41 @@ int asCReader::Read(bool *wasDebugInfoStripped)
 }
 
 int asCReader::Error(const char *msg)
+{
+	asCString str;
+	str.Format(msg, bytesRead);
+	return WriteError(str);
+}
+
+int asCReader::WriteError(const asCString &msg)
 {
 	// Don't write if it has already been reported an error earlier
 	if( !error )
 	{
-		asCString str;
-		str.Format(msg, bytesRead);
-		engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, str.AddressOf());
+		// Prepare and Translate may run in parallel with other threads so
+		// the message is held back until the engine's lock is held again
+		if( deferErrors )
+			deferredError = msg;
+		else
+			engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, msg.AddressOf());
 		error = true;
 	}
 
 	return asERROR;
 }
 
+int asCReader::Prepare()
+{
+	// Unpack the bytecode container, if any, into memory. This doesn't
+	// touch the engine so it doesn't have to hold the engine's build lock
+	deferErrors   = true;
+	prepareResult = ReadContainer();
+	deferErrors   = false;
+	isPrepared    = true;
+
+	return prepareResult;
+}
+
 int asCReader::ReadInner()
 {
 	TimeIt("asCReader::ReadInner");
@@ -144,14 +906,32 @@ int asCReader::ReadInner()
 	// If any error occurs, it will return to the caller who is
 	// responsible for cleaning up the partially loaded entities.
 
-	engine->deferValidationOfTemplateTypes = true;
-
 	unsigned long i, count;
 	asCScriptFunction* func;
 
+	// Unpack the sections if the bytecode is stored in a container
+	if( !isPrepared )
+		Prepare();
+	if( prepareResult < 0 )
+	{
+		if( deferredError.GetLength() )
+			engine->WriteMessage("", 0, 0, asMSGTYPE_ERROR, deferredError.AddressOf());
+		deferredError = "";
+		return prepareResult;
+	}
+
 	// Read the flag as 1 byte even on platforms with 4byte booleans
 	noDebugInfo = ReadEncodedUInt() ? VALUE_OF_BOOLEAN_TRUE : 0;
 
+	// In a container the debug info is never stored with the functions
+	if( sectionData.GetLength() && !noDebugInfo )
+	{
+		Error(TXT_INVALID_BYTECODE_d);
+		return asERROR;
+	}
+
+	engine->deferValidationOfTemplateTypes = true;
+
 	// Read enums
 	count = SanityCheck(ReadEncodedUInt(), 1000000);
 	module->m_enumTypes.Allocate(count, false);
@@ -167,6 +947,13 @@ int asCReader::ReadInner()
 		bool isExternal = false;
 		ReadTypeDeclaration(et, 1, &isExternal);
 
+		// Don't continue with an enum that wasn't properly loaded
+		if( error )
+		{
+			asDELETE(et, asCEnumType);
+			return asERROR;
+		}
+
 		// If the type is shared then we should use the original if it exists
 		bool sharedExists = false;
 		if( et->IsShared() )
@@ -412,6 +1199,14 @@ int asCReader::ReadInner()
 
 		bool isExternal = false;
 		ReadTypeDeclaration(td, 1, &isExternal);
+
+		// Don't continue with a typedef that wasn't properly loaded
+		if( error )
+		{
+			asDELETE(td, asCTypedefType);
+			return asERROR;
+		}
+
 		td->module = module;
 		module->AddTypeDef(td);
 		ReadTypeDeclaration(td, 2);
@@ -529,6 +1324,7 @@ int asCReader::ReadInner()
 		info->importedFunctionSignature = ReadFunction(isNew, false, false);
 		if( info->importedFunctionSignature == 0 )
 		{
+			asDELETE(info, sBindInfo);
 			Error(TXT_INVALID_BYTECODE_d);
 			break;
 		}
@@ -608,8 +1404,9 @@ int asCReader::ReadInner()
 			}
 			else
 			{
-				// If the callback said this template instance won't be garbage collected then remove the flag
-				if( dontGarbageCollect )
+				// If the callback said this template instance won't be garbage collected then remove the flag.
+				// Only write it once, since other threads loading bytecode may be reading the flags
+				if( dontGarbageCollect && (ot->flags & asOBJ_GC) )
 					ot->flags &= ~asOBJ_GC;
 			}
 		}
@@ -618,36 +1415,13 @@ int asCReader::ReadInner()
 
 	if( error ) return asERROR;
 
-	// Update the loaded bytecode to point to the correct types, property offsets,
-	// function ids, etc. This is basically a linking stage.
-	for( i = 0; i < module->m_scriptFunctions.GetLength() && !error; i++ )
-		if( module->m_scriptFunctions[i]->funcType == asFUNC_SCRIPT )
-			TranslateFunction(module->m_scriptFunctions[i]);
-
-	asCSymbolTable<asCGlobalProperty>::iterator globIt = module->m_scriptGlobals.List();
-	while( globIt && !error )
-	{
-		asCScriptFunction *initFunc = (*globIt)->GetInitFunc();
-		if( initFunc )
-			TranslateFunction(initFunc);
-		globIt++;
-	}
-
-	if( error ) return asERROR;
+	// The debug info is read last as it is stored in its own section
+	if( readDebugSection && ReadDebugInfo() < 0 )
+		return asERROR;
 
-	// Add references for all functions (except for the pre-existing shared code)
-	for( i = 0; i < module->m_scriptFunctions.GetLength(); i++ )
-		if( !dontTranslate.MoveTo(0, module->m_scriptFunctions[i]) )
-			module->m_scriptFunctions[i]->AddReferences();
+	// The bytecode is translated by Translate, which may run without holding the lock
+	CollectFunctionsById();
 
-	globIt = module->m_scriptGlobals.List();
-	while( globIt )
-	{
-		asCScriptFunction *initFunc = (*globIt)->GetInitFunc();
-		if( initFunc )
-			initFunc->AddReferences();
-		globIt++;
-	}
 	return error ? asERROR : asSUCCESS;
 }
 
@@ -1195,8 +1969,14 @@ void asCReader::ReadFunctionSignature(asCScriptFunction *func, asCObjectType **p
 
 	if (isTemplateFunc)
 	{
-		count = ReadEncodedUInt();
+		count = SanityCheck(ReadEncodedUInt(), 100);
 		func->templateSubTypes.SetLength(count);
+		if (func->templateSubTypes.GetLength() != count)
+		{
+			// Out of memory
+			error = true;
+			return;
+		}
 		for (asUINT n = 0; n < count; n++)
 			ReadDataType(&func->templateSubTypes[n]);
 	}
@@ -1253,6 +2033,8 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 		return 0;
 	}
 
+	func->argumentsSize = func->GetSpaceNeededForArguments();
+
 	if( func->funcType == asFUNC_SCRIPT )
 	{
 		// Skip this for external shared entities
@@ -1312,6 +2094,49 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 
 				func->scriptData->variableSpace = SanityCheck(ReadEncodedUInt(), 1000000);
 
+				if (bits & 64)
+				{
+					// Read the relocation table and the stack size that were stored by the writer
+					STranslationInfo *info = asNEW(STranslationInfo);
+					if (info == 0)
+					{
+						// Out of memory
+						error = true;
+						func->DestroyHalfCreated();
+						return 0;
+					}
+					translationInfo.Insert(func, info);
+
+					info->ptrSize = ReadEncodedUInt();
+					info->variableSpace = SanityCheck(ReadEncodedUInt(), 1000000);
+					info->stackNeeded = SanityCheck(ReadEncodedUInt(), 1000000);
+
+					int length = SanityCheck(ReadEncodedUInt(), 1000000);
+					info->relocations.SetLength(length);
+					if (int(info->relocations.GetLength()) != length)
+					{
+						// Out of memory
+						error = true;
+						func->DestroyHalfCreated();
+						return 0;
+					}
+
+					// The instruction numbers are stored as the delta from the previous one
+					asUINT instrNbr = 0;
+					for (i = 0; i < length; ++i)
+					{
+						asUINT delta = ReadEncodedUInt();
+						if (i > 0 && delta == 0)
+						{
+							Error(TXT_INVALID_BYTECODE_d);
+							func->DestroyHalfCreated();
+							return 0;
+						}
+						instrNbr += delta;
+						info->relocations[i] = instrNbr;
+					}
+				}
+
 				if (bits & 8)
 				{
 					int length = SanityCheck(ReadEncodedUInt(), 1000000);
@@ -1447,6 +2272,14 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 					for (asUINT n = 0; n < countParam; n++)
 						ReadString(&func->parameterNames[n]);
 				}
+
+				// The debug info in the container is read once all functions have been loaded.
+				// Hold on to the function in case it is discarded before that
+				if (readDebugSection)
+				{
+					func->AddRefInternal();
+					debugInfoFuncs.PushLast(func);
+				}
 			}
 		}
 	}
@@ -1546,7 +2379,8 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 				// Virtual methods must be added to the module's script functions array, 
 				// even if they are not owned by the module
 				module->m_scriptFunctions.PushLast(realFunc);
-				realFunc->AddRefInternal();		
+				realFunc->AddRefInternal();
+				engine->AddEntityOwner(realFunc, module);		
 			}				
 		}
 		else
@@ -1562,6 +2396,12 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 
 		// Destroy the newly created function instance since it has been replaced by an existing function
 		isNew = false;
+		if( debugInfoFuncs.GetLength() && debugInfoFuncs[debugInfoFuncs.GetLength() - 1] == func )
+		{
+			// The debug info still has to be read, but not into this function
+			debugInfoFuncs[debugInfoFuncs.GetLength() - 1] = 0;
+			func->ReleaseInternal();
+		}
 		func->DestroyHalfCreated();
 		
 		// As it is an existing function it shouldn't be added to the module or the engine
@@ -1573,6 +2413,8 @@ asCScriptFunction *asCReader::ReadFunction(bool &isNew, bool addToModule, bool a
 		// The refCount is already 1
 		module->m_scriptFunctions.PushLast(func);
 		func->module = module;
+		if( func->IsShared() )
+			engine->AddEntityOwner(func, module);
 	}
 	if( addToEngine )
 	{
@@ -1613,9 +2455,11 @@ void asCReader::ReadTypeDeclaration(asCTypeInfo *type, int phase, bool *isExtern
 		// Reset the size of script classes, since it will be recalculated as properties are added
 		if( (type->flags & asOBJ_SCRIPT_OBJECT) && type->size != 0 )
 			type->size = sizeof(asCScriptObject);
+		else if( type->flags & asOBJ_SCRIPT_STRUCT )
+			type->size = 0;
 
 		asCObjectType *ot = CastToObjectType(type);
-		if (ot)
+		if (ot && !(type->flags & asOBJ_SCRIPT_STRUCT))
 		{
 			// Use the default script class behaviours
 			ot->beh = engine->scriptTypeBehaviours.beh;
@@ -2057,8 +2901,12 @@ void asCReader::ReadTypeDeclaration(asCTypeInfo *type, int phase, bool *isExtern
 
 		// properties[]
 		asUINT size = SanityCheck(ReadEncodedUInt(), 1000000);
-		for( asUINT n = 0; n < size; n++ )
+		for( asUINT n = 0; n < size && !error; n++ )
 			ReadObjectProperty(ot);
+
+		// Script structs are padded to whole dwords, the same way the builder lays them out
+		if( type->flags & asOBJ_SCRIPT_STRUCT )
+			type->size = type->size ? (type->size + 3) & ~3 : 4;
 	}
 }
 
@@ -2204,7 +3052,19 @@ void asCReader::ReadString(asCString* str)
 	{
 		len /= 2;
 		str->SetLength(len);
-		int r = stream->Read(str->AddressOf(), len);
+		int r = 0;
+		if( buffer )
+		{
+			if( !IsInBuffer(len) )
+				r = asERROR;
+			else
+			{
+				memcpy(str->AddressOf(), buffer + bufferPos, len);
+				bufferPos += len;
+			}
+		}
+		else
+			r = stream->Read(str->AddressOf(), len);
 		if (r < 0)
 			Error(TXT_UNEXPECTED_END_OF_FILE);
 
@@ -2255,6 +3115,13 @@ void asCReader::ReadObjectProperty(asCObjectType *ot)
 	bool isProtected = (flags & 2) ? true : false;
 	bool isInherited = (flags & 4) ? true : false;
 
+	// A property of a type that cannot be instantiated is never valid
+	if( error || !dt.CanBeInstantiated() )
+	{
+		Error(TXT_INVALID_BYTECODE_d);
+		return;
+	}
+
 	// TODO: shared: If the type is shared and pre-existing, we should just
 	//               validate that the loaded methods match the original
 	if( !existingShared.MoveTo(0, ot) )
@@ -2280,6 +3147,12 @@ void asCReader::ReadDataType(asCDataType *dt)
 
 	// Read the type definition
 	eTokenType tokenType = (eTokenType)ReadEncodedUInt();
+	if( tokenType != ttIdentifier && tokenType != ttUnrecognizedToken && tokenType != ttQuestion &&
+		tokenType != ttVoid && tokenType != ttBool && !asCDataType::CreatePrimitive(tokenType, false).IsMathType() )
+	{
+		Error(TXT_INVALID_BYTECODE_d);
+		return;
+	}
 
 	// Reserve a spot in the savedDataTypes
 	asUINT saveSlot = savedDataTypes.GetLength();
@@ -2365,6 +3238,13 @@ asCTypeInfo* asCReader::ReadTypeInfo()
 			}
 		}
 
+		// The template must be instantiated with the same number of subtypes as it was declared with
+		if( error || subTypes.GetLength() != tmpl->templateSubTypes.GetLength() )
+		{
+			Error(TXT_INVALID_BYTECODE_d);
+			return 0;
+		}
+
 		// Return the actual template if the subtypes are the template's dummy types
 		if( tmpl->templateSubTypes == subTypes )
 			ot = tmpl;
@@ -2432,6 +3312,8 @@ asCTypeInfo* asCReader::ReadTypeInfo()
 		asCString typeName, ns;
 		ReadString(&typeName);
 		ReadString(&ns);
+		if( error )
+			return 0;
 		asSNameSpace *nameSpace = engine->AddNameSpace(ns.AddressOf());
 
 		if( typeName.GetLength() && typeName != "$obj" && typeName != "$func" )
@@ -2459,7 +3341,11 @@ asCTypeInfo* asCReader::ReadTypeInfo()
 			ot = &engine->functionBehaviours;
 		}
 		else
-			asASSERT( false );
+		{
+			// The name of the type is never empty in valid bytecode
+			Error(TXT_INVALID_BYTECODE_d);
+			return 0;
+		}
 	}
 	else if (ch == 'c')
 	{
@@ -2494,7 +3380,8 @@ asCTypeInfo* asCReader::ReadTypeInfo()
 	else
 	{
 		// No object type
-		asASSERT( ch == '\0' || error );
+		if( ch != '\0' )
+			Error(TXT_INVALID_BYTECODE_d);
 		ot = 0;
 	}
 
@@ -2518,6 +3405,13 @@ void asCReader::ReadByteCode(asCScriptFunction *func)
 		asBYTE b;
 		ReadData(&b, 1);
 
+		// Stop at the end of the stream or an instruction that doesn't exist
+		if( error || b >= asBC_MAXBYTECODE )
+		{
+			Error(TXT_INVALID_BYTECODE_d);
+			break;
+		}
+
 		// Allocate the space for the instruction
 		asUINT len = asBCTypeSize[asBCInfo[b].type];
 		asUINT newSize = asUINT(func->scriptData->byteCode.GetLength()) + len;
@@ -2694,6 +3588,26 @@ void asCReader::ReadByteCode(asCScriptFunction *func)
 				bc += 2;
 			}
 			break;
+		case asBCTYPE_wW_rW_QW_ARG:
+			{
+				*(asBYTE*)(bc) = b;
+
+				// Read the first argument
+				asWORD w = ReadEncodedUInt16();
+				*(((asWORD*)bc)+1) = w;
+				bc++;
+
+				// Read the second argument
+				w = ReadEncodedUInt16();
+				*(asWORD*)bc = w;
+				bc++;
+
+				// Read the third argument
+				asQWORD qw = ReadEncodedUInt64();
+				*(asQWORD*)bc = qw;
+				bc += 2;
+			}
+			break;
 		case asBCTYPE_rW_DW_DW_ARG:
 			{
 				*(asBYTE*)(bc) = b;
@@ -2751,10 +3665,12 @@ void asCReader::ReadUsedTypeIds()
 
 	asUINT count = SanityCheck(ReadEncodedUInt(), 1000000);
 	usedTypeIds.Allocate(count, false);
-	for( asUINT n = 0; n < count; n++ )
+	for( asUINT n = 0; n < count && !error; n++ )
 	{
 		asCDataType dt;
 		ReadDataType(&dt);
+		if( error )
+			break;
 		usedTypeIds.PushLast(engine->GetTypeIdFromDataType(dt));
 	}
 }
@@ -2880,6 +3796,67 @@ asCScriptFunction *asCReader::FindFunction(int idx)
 	}
 }
 
+void asCReader::CollectFunctionsById()
+{
+	// The translated call instructions refer to the used functions and imported functions
+	for( asUINT n = 0; n < usedFunctions.GetLength(); n++ )
+		if( usedFunctions[n] && !functionsById.MoveTo(0, usedFunctions[n]->id) )
+			functionsById.Insert(usedFunctions[n]->id, usedFunctions[n]);
+	for( asUINT n = 0; n < module->m_bindInformations.GetLength(); n++ )
+	{
+		asCScriptFunction *func = module->m_bindInformations[n] ? module->m_bindInformations[n]->importedFunctionSignature : 0;
+		if( func && !functionsById.MoveTo(0, func->id) )
+			functionsById.Insert(func->id, func);
+	}
+
+	// The initialization lists are adjusted based on the list factory of the pattern type
+	for( asUINT n = 0; n < module->m_scriptFunctions.GetLength(); n++ )
+	{
+		asCScriptFunction *func = module->m_scriptFunctions[n];
+		if( func->scriptData == 0 || dontTranslate.MoveTo(0, func) )
+			continue;
+
+		for( asUINT v = 0; v < func->scriptData->variables.GetLength(); v++ )
+		{
+			asCObjectType *ot = CastToObjectType(func->scriptData->variables[v]->type.GetTypeInfo());
+			if( ot && (ot->flags & asOBJ_LIST_PATTERN) )
+			{
+				int factoryId = ot->templateSubTypes[0].GetBehaviour()->listFactory;
+				if( factoryId > 0 && factoryId < (int)engine->scriptFunctions.GetLength() && !functionsById.MoveTo(0, factoryId) )
+					functionsById.Insert(factoryId, engine->scriptFunctions[factoryId]);
+			}
+		}
+	}
+}
+
+asCScriptFunction *asCReader::FindFunctionById(int id)
+{
+	asSMapNode<int, asCScriptFunction*> *cursor = 0;
+	if( functionsById.MoveTo(&cursor, id) )
+		return functionsById.GetValue(cursor);
+	return 0;
+}
+
+asCScriptFunction *asCReader::GetCalledFunction(asCScriptFunction *func, asDWORD programPos)
+{
+	// Same as asCScriptFunction::GetCalledFunction, but without looking in the engine
+	asDWORD *bc = &func->scriptData->byteCode[programPos];
+	switch( *(asBYTE*)bc )
+	{
+	case asBC_CALL:
+	case asBC_CALLSYS:
+	case asBC_Thiscall1:
+	case asBC_CALLINTF:
+	case asBC_CALLBND:
+		return FindFunctionById(asBC_INTARG(bc));
+	case asBC_ALLOC:
+		return FindFunctionById(asBC_INTARG(bc + AS_PTR_SIZE));
+	default:
+		// asBC_CallPtr only looks at the variables of the function itself
+		return func->GetCalledFunction(programPos);
+	}
+}
+
 void asCReader::TranslateFunction(asCScriptFunction *func)
 {
 	// Skip this if the function is part of an pre-existing shared object
@@ -2907,10 +3884,31 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 		n += size;
 	}
 
-	asUINT bcNum = 0;
-	for( n = 0; n < bcLength; bcNum++ )
+	// If the writer stored a relocation table only the instructions listed
+	// in it need to be visited, else all instructions must be checked
+	STranslationInfo *info = 0;
+	asSMapNode<asCScriptFunction*, STranslationInfo*> *cursor = 0;
+	if( translationInfo.MoveTo(&cursor, func) )
+		info = translationInfo.GetValue(cursor);
+
+	asUINT numInstrToVisit = info ? info->relocations.GetLength() : instructionNbrToPos.GetLength();
+	for( asUINT r = 0; r < numInstrToVisit; r++ )
 	{
+		asUINT bcNum = info ? info->relocations[r] : r;
+		if( bcNum >= instructionNbrToPos.GetLength() )
+		{
+			Error(TXT_INVALID_BYTECODE_d);
+			return;
+		}
+		n = instructionNbrToPos[bcNum];
+
 		int c = *(asBYTE*)&bc[n];
+		if( info && !IsRelocatedInstruction(asBYTE(c)) )
+		{
+			Error(TXT_INVALID_BYTECODE_d);
+			return;
+		}
+
 		if( c == asBC_REFCPY ||
 			c == asBC_RefCpyV ||
 			c == asBC_OBJTYPE )
@@ -3183,16 +4181,19 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 			// Inform the list adjuster the type id of the next element
 			listAdj->SetNextType(bc[n+2]);
 		}
-
-		n += asBCTypeSize[asBCInfo[c].type];
 	}
 
 	// Calculate the stack adjustments
 	CalculateAdjustmentByPos(func);
 
+	// The adjustments are accumulated so it is enough to look at the last
+	// entries to know if any variable position needs to be adjusted at all
+	bool adjustStack = (adjustByPos.GetLength() && adjustByPos[adjustByPos.GetLength()-1]) ||
+	                   (adjustNegativeStackByPos.GetLength() && adjustNegativeStackByPos[adjustNegativeStackByPos.GetLength()-1]);
+
 	// Adjust all variable positions in the bytecode
 	bc = func->scriptData->byteCode.AddressOf();
-	for( n = 0; n < bcLength; )
+	for( n = 0; adjustStack && n < bcLength; )
 	{
 		int c = *(asBYTE*)&bc[n];
 		switch( asBCInfo[c].type )
@@ -3213,6 +4214,7 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 
 		case asBCTYPE_wW_rW_ARG:
 		case asBCTYPE_wW_rW_DW_ARG:
+		case asBCTYPE_wW_rW_QW_ARG:
 		case asBCTYPE_rW_rW_ARG:
 			{
 				asBC_SWORDARG0(&bc[n]) = (short)AdjustStackPosition(asBC_SWORDARG0(&bc[n]));
@@ -3254,8 +4256,9 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 	//                 This will also make the AdjustGetOffset() function quicker as it can
 	//                 receive the called function directly instead of having to search for it.
 	bc = func->scriptData->byteCode.AddressOf();
-	for( n = 0; n < bcLength; )
+	for( asUINT r = 0; r < numInstrToVisit; r++ )
 	{
+		n = instructionNbrToPos[info ? info->relocations[r] : r];
 		int c = *(asBYTE*)&bc[n];
 
 		if( c == asBC_GETREF ||
@@ -3265,8 +4268,6 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 		{
 			asBC_WORDARG0(&bc[n]) = (asWORD)AdjustGetOffset(asBC_WORDARG0(&bc[n]), func, n);
 		}
-
-		n += asBCTypeSize[asBCInfo[c].type];
 	}
 
 	for( n = 0; n < func->scriptData->objVariableInfo.GetLength(); n++ )
@@ -3290,7 +4291,12 @@ void asCReader::TranslateFunction(asCScriptFunction *func)
 	for( n = 0; n < func->scriptData->sectionIdxs.GetLength(); n += 2 )
 		func->scriptData->sectionIdxs[n] = instructionNbrToPos[func->scriptData->sectionIdxs[n]];
 
-	CalculateStackNeeded(func);
+	// The stack size stored by the writer can be used as is if the
+	// variables take up the same space as on the platform that saved it
+	if( info && info->ptrSize == AS_PTR_SIZE && info->variableSpace == (asUINT)func->scriptData->variableSpace )
+		func->scriptData->stackNeeded = info->stackNeeded;
+	else
+		CalculateStackNeeded(func);
 }
 
 asCReader::SListAdjuster::SListAdjuster(asCReader* rd, asDWORD* bc, asCObjectType* listType) :
@@ -3301,9 +4307,13 @@ asCReader::SListAdjuster::SListAdjuster(asCReader* rd, asDWORD* bc, asCObjectTyp
 	// Find the first expected value in the list
 	if (patternType && (patternType->flags & asOBJ_LIST_PATTERN) )
 	{
-		asSListPatternNode* node = patternType->engine->scriptFunctions[patternType->templateSubTypes[0].GetBehaviour()->listFactory]->listPattern;
+		asCScriptFunction *factory = reader->FindFunctionById(patternType->templateSubTypes[0].GetBehaviour()->listFactory);
+		asSListPatternNode *node = factory ? factory->listPattern : 0;
 		asASSERT(node && node->type == asLPT_START);
-		patternNode = node->next;
+		if( node )
+			patternNode = node->next;
+		else
+			reader->Error(TXT_INVALID_BYTECODE_d);
 	}
 	else
 		reader->Error(TXT_INVALID_BYTECODE_d);
@@ -3524,7 +4534,7 @@ void asCReader::CalculateStackNeeded(asCScriptFunction *func)
 				bc == asBC_CALLINTF ||
 				bc == asBC_CallPtr )
 			{
-				asCScriptFunction *called = func->GetCalledFunction(pos);
+				asCScriptFunction *called = GetCalledFunction(func, pos);
 				if( called )
 				{
 					stackInc = -called->GetSpaceNeededForArguments();
@@ -3779,7 +4789,7 @@ int asCReader::AdjustGetOffset(int offset, asCScriptFunction *func, asDWORD prog
 			if (bc == asBC_ALLOC)
 				bcAlloc = true;
 
-			calledFunc = func->GetCalledFunction(n);
+			calledFunc = GetCalledFunction(func, n);
 			break;
 		}
 		else if( bc == asBC_REFCPY ||
@@ -3922,8 +4932,91 @@ asCTypeInfo *asCReader::FindType(int idx)
 #ifndef AS_NO_COMPILER
 
 asCWriter::asCWriter(asCModule* _module, asIBinaryStream* _stream, asCScriptEngine* _engine, bool _stripDebug)
-	: module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug), error(false), bytesWritten(0), lastWasComposite(false)
+	: module(_module), stream(_stream), engine(_engine), stripDebugInfo(_stripDebug), error(false), bytesWritten(0), useContainer(_engine->ep.bytecodeFormat > 0), writingDebugInfo(false), lastWasComposite(false)
+{
+}
+
+void asCWriter::EndSection(asBYTE kind)
+{
+	if( !useContainer )
+		return;
+
+	sectionKinds.PushLast(kind);
+	sectionEnds.PushLast(containerData.GetLength());
+}
+
+int asCWriter::WriteContainer()
 {
+	TimeIt("asCWriter::WriteContainer");
+
+	asUINT numSections = sectionKinds.GetLength();
+	asASSERT( numSections < 256 );
+
+	asCArray<asBYTE> header;
+	header.SetLength(7 + numSections * BC_SECTION_HEADER_SIZE);
+	header[0] = 'A';
+	header[1] = 'S';
+	header[2] = 'B';
+	header[3] = 'C';
+	header[4] = BC_CONTAINER_VERSION;
+	header[5] = stripDebugInfo ? BC_CONTAINER_DEBUG_STRIPPED : 0;
+	header[6] = asBYTE(numSections);
+
+	// Compress the sections first so the final sizes are known when writing the header
+	asCArray< asCArray<asBYTE> > compressed;
+	compressed.SetLength(numSections);
+	asUINT start = 0;
+	for( asUINT n = 0; n < numSections; n++ )
+	{
+		asUINT rawSize = sectionEnds[n] - start;
+		const asBYTE *raw = containerData.AddressOf() + start;
+
+		// Only keep the compressed data if it is actually smaller
+		if( engine->ep.bytecodeFormat >= 2 && rawSize > 0 )
+		{
+			CompressSection(raw, rawSize, compressed[n]);
+			if( compressed[n].GetLength() >= rawSize )
+				compressed[n].SetLength(0);
+		}
+
+		bool isCompressed = compressed[n].GetLength() > 0;
+		asUINT storedSize = isCompressed ? compressed[n].GetLength() : rawSize;
+		const asBYTE *stored = isCompressed ? compressed[n].AddressOf() : raw;
+
+		asBYTE *entry = &header[7 + n*BC_SECTION_HEADER_SIZE];
+		entry[0] = sectionKinds[n];
+		entry[1] = isCompressed ? BC_SECTION_COMPRESSED : 0;
+		StoreBigEndianDWord(entry + 2, rawSize);
+		StoreBigEndianDWord(entry + 6, storedSize);
+		StoreBigEndianDWord(entry + 10, CalculateCRC32(stored, storedSize));
+
+		start = sectionEnds[n];
+	}
+
+	int r = stream->Write(header.AddressOf(), header.GetLength());
+	bytesWritten = header.GetLength();
+
+	start = 0;
+	for( asUINT n = 0; r >= 0 && n < numSections; n++ )
+	{
+		asUINT rawSize = sectionEnds[n] - start;
+		if( compressed[n].GetLength() )
+		{
+			r = stream->Write(compressed[n].AddressOf(), compressed[n].GetLength());
+			bytesWritten += compressed[n].GetLength();
+		}
+		else if( rawSize )
+		{
+			r = stream->Write(containerData.AddressOf() + start, rawSize);
+			bytesWritten += rawSize;
+		}
+		start = sectionEnds[n];
+	}
+
+	if( r < 0 )
+		return Error(TXT_UNEXPECTED_END_OF_FILE);
+
+	return asSUCCESS;
 }
 
 int asCWriter::Error(const char *msg)
@@ -3944,6 +5037,20 @@ int asCWriter::WriteData(const void *data, asUINT size)
 {
 	asASSERT(size == 1 || size == 2 || size == 4 || size == 8);
 	int ret = 0;
+	if( useContainer )
+	{
+		// Buffer the data until the whole container can be written
+		asCArray<asBYTE> &dst = writingDebugInfo ? debugData : containerData;
+#if defined(AS_BIG_ENDIAN)
+		for( asUINT n = 0; n < size; n++ )
+			dst.PushLast(((const asBYTE*)data)[n]);
+#else
+		for( int n = size-1; n >= 0; n-- )
+			dst.PushLast(((const asBYTE*)data)[n]);
+#endif
+		bytesWritten += size;
+		return ret;
+	}
 #if defined(AS_BIG_ENDIAN)
 	for( asUINT n = 0; ret >= 0 && n < size; n++ )
 		ret = stream->Write(((asBYTE*)data)+n, 1);
@@ -3969,8 +5076,9 @@ int asCWriter::Write()
 	// TODO: Should be possible to skip saving the typedefs. They are usually not needed after the script is compiled anyway
 	// TODO: Should be possible to skip saving constants. They are usually not needed after the script is compiled anyway
 
-	// Write the flag as 1byte even on platforms with 4byte booleans
-	WriteEncodedInt64(stripDebugInfo ? 1 : 0);
+	// Write the flag as 1byte even on platforms with 4byte booleans. In a container
+	// the functions never hold the debug info as it is kept in a separate section
+	WriteEncodedInt64((stripDebugInfo || useContainer) ? 1 : 0);
 
 	// Store enums
 	{
@@ -4054,6 +5162,7 @@ int asCWriter::Write()
 			WriteTypeDeclaration(module->m_typeDefs[i], 2);
 		}
 	}
+	EndSection(asBCS_TYPES);
 
 	// scriptGlobals[]
 	{
@@ -4065,6 +5174,7 @@ int asCWriter::Write()
 		for( ; it; it++ )
 			WriteGlobalProperty(*it);
 	}
+	EndSection(asBCS_GLOBALS);
 
 	// scriptFunctions[]
 	{
@@ -4093,6 +5203,7 @@ int asCWriter::Write()
 			funcIt++;
 		}
 	}
+	EndSection(asBCS_FUNCTIONS);
 
 	// bindInformations[]
 	{
@@ -4106,6 +5217,7 @@ int asCWriter::Write()
 			WriteString(&module->m_bindInformations[i]->importFromModule);
 		}
 	}
+	EndSection(asBCS_IMPORTS);
 
 	// usedTypes[]
 	{
@@ -4119,18 +5231,32 @@ int asCWriter::Write()
 
 	// usedTypeIds[]
 	WriteUsedTypeIds();
+	EndSection(asBCS_USED_TYPES);
 
 	// usedFunctions[]
 	WriteUsedFunctions();
+	EndSection(asBCS_USED_FUNCTIONS);
 
 	// usedGlobalProperties[]
 	WriteUsedGlobalProps();
+	EndSection(asBCS_USED_GLOBAL_PROPS);
 
 	// usedStringConstants[]
 	WriteUsedStringConstants();
+	EndSection(asBCS_STRING_CONSTANTS);
 
 	// usedObjectProperties[]
 	WriteUsedObjectProps();
+	EndSection(asBCS_USED_OBJECT_PROPS);
+
+	if( useContainer && !stripDebugInfo )
+	{
+		containerData.Concatenate(debugData);
+		EndSection(asBCS_DEBUG_INFO);
+	}
+
+	if( useContainer && !error )
+		return WriteContainer();
 
 	return error ? asERROR : asSUCCESS;
 }
@@ -4351,6 +5477,9 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 		if (func->scriptData->tryCatchInfo.GetLength())
 			bits += 16;
 		bits += func->IsExplicit() ? 32 : 0;
+		// The default format is kept identical on all platforms, so the
+		// platform specific translation info is only stored in the container
+		bits += useContainer ? 64 : 0;
 		WriteData(&bits, 1);
 
 		// For external shared functions the rest is not needed
@@ -4365,6 +5494,33 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 		asDWORD varSpace = AdjustStackPosition(func->scriptData->variableSpace);
 		WriteEncodedInt64(varSpace);
 
+		if (bits & 64)
+		{
+			// Store the stack size as it is on this platform. The reader can use
+			// it directly if the pointer size and variable space is the same
+			WriteEncodedInt64(AS_PTR_SIZE);
+			WriteEncodedInt64(func->scriptData->variableSpace);
+			WriteEncodedInt64(func->scriptData->stackNeeded);
+
+			// Store the instruction numbers that the reader must translate
+			// so it doesn't have to decode all instructions to find them
+			asCArray<asUINT> relocations;
+			asDWORD *bc = func->scriptData->byteCode.AddressOf();
+			asUINT bcLength = (asUINT)func->scriptData->byteCode.GetLength();
+			asUINT instrNbr = 0;
+			for (asUINT n = 0; n < bcLength; instrNbr++)
+			{
+				asBYTE c = *(asBYTE*)&bc[n];
+				if (IsRelocatedInstruction(c))
+					relocations.PushLast(instrNbr);
+				n += asBCTypeSize[asBCInfo[c].type];
+			}
+
+			WriteEncodedInt64((asUINT)relocations.GetLength());
+			for (i = 0; i < relocations.GetLength(); ++i)
+				WriteEncodedInt64(relocations[i] - (i ? relocations[i-1] : 0));
+		}
+
 		if (bits & 8)
 		{
 			WriteEncodedInt64((asUINT)func->scriptData->objVariableInfo.GetLength());
@@ -4395,6 +5551,8 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 		// to be in number of instructions instead of DWORD offset
 		if( !stripDebugInfo )
 		{
+			writingDebugInfo = useContainer;
+
 			asUINT length = (asUINT)func->scriptData->lineNumbers.GetLength();
 			WriteEncodedInt64(length);
 			for( i = 0; i < length; ++i )
@@ -4423,6 +5581,8 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 					}
 				}
 			}
+
+			writingDebugInfo = false;
 		}
 
 		// Write the variable information
@@ -4433,7 +5593,7 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 		WriteEncodedInt64((asUINT)func->scriptData->variables.GetLength());
 		for( i = 0; i < func->scriptData->variables.GetLength(); i++ )
 		{
-			if (!stripDebugInfo)
+			if (!stripDebugInfo && !useContainer)
 			{
 				// The program position must be adjusted to be in number of instructions
 				WriteEncodedInt64(bytecodeNbrByPos[func->scriptData->variables[i]->declaredAtProgramPos]);
@@ -4448,9 +5608,22 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 			WriteDataType(&func->scriptData->variables[i]->type);
 		}
 
-		// Store script section name
 		if( !stripDebugInfo )
 		{
+			writingDebugInfo = useContainer;
+
+			// In the container the names of the variables are stored with the rest of the debug info
+			if( useContainer )
+			{
+				WriteEncodedInt64((asUINT)func->scriptData->variables.GetLength());
+				for( i = 0; i < func->scriptData->variables.GetLength(); i++ )
+				{
+					WriteEncodedInt64(bytecodeNbrByPos[func->scriptData->variables[i]->declaredAtProgramPos]);
+					WriteString(&func->scriptData->variables[i]->name);
+				}
+			}
+
+			// Store script section name
 			if( func->scriptData->scriptSectionIdx >= 0 )
 				WriteString(engine->scriptSectionNames[func->scriptData->scriptSectionIdx]);
 			else
@@ -4459,15 +5632,14 @@ void asCWriter::WriteFunction(asCScriptFunction* func)
 				WriteData(&c, 1);
 			}
 			WriteEncodedInt64(func->scriptData->declaredAt);
-		}
 
-		// Store the parameter names
-		if( !stripDebugInfo )
-		{
+			// Store the parameter names
 			count = asUINT(func->parameterNames.GetLength());
 			WriteEncodedInt64(count);
 			for( asUINT n = 0; n < count; n++ )
 				WriteString(&func->parameterNames[n]);
+
+			writingDebugInfo = false;
 		}
 	}
 	else if( func->funcType == asFUNC_VIRTUAL || func->funcType == asFUNC_INTERFACE )
@@ -4692,9 +5864,12 @@ void asCWriter::WriteEncodedInt64(asINT64 i)
 
 void asCWriter::WriteString(asCString* str)
 {
+	// The debug info section has its own string table
+	asCMap<asCString, int> &idMap = writingDebugInfo ? debugStringToIdMap : stringToIdMap;
+
 	// First check if the string hasn't been saved already
 	asSMapNode<asCString, int> *cursor = 0;
-	if (stringToIdMap.MoveTo(&cursor, *str))
+	if (idMap.MoveTo(&cursor, *str))
 	{
 		// Save a reference to the existing string
 		// The lowest bit is set to 1 to indicate a reference
@@ -4709,11 +5884,23 @@ void asCWriter::WriteString(asCString* str)
 
 	if( len > 0 )
 	{
-		stream->Write(str->AddressOf(), (asUINT)len);
+		if( useContainer )
+		{
+			asCArray<asBYTE> &dst = writingDebugInfo ? debugData : containerData;
+			for( asUINT n = 0; n < len; n++ )
+				dst.PushLast(asBYTE((*str)[n]));
+		}
+		else
+			stream->Write(str->AddressOf(), (asUINT)len);
 		bytesWritten += len;
 
-		savedStrings.PushLast(*str);
-		stringToIdMap.Insert(*str, int(savedStrings.GetLength()) - 1);
+		if( writingDebugInfo )
+			debugStringToIdMap.Insert(*str, debugStringToIdMap.GetCount());
+		else
+		{
+			savedStrings.PushLast(*str);
+			stringToIdMap.Insert(*str, int(savedStrings.GetLength()) - 1);
+		}
 	}
 }
 
@@ -5394,6 +6581,7 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 
 		case asBCTYPE_wW_rW_ARG:
 		case asBCTYPE_wW_rW_DW_ARG:
+		case asBCTYPE_wW_rW_QW_ARG:
 		case asBCTYPE_rW_rW_ARG:
 			{
 				asBC_SWORDARG0(tmpBC) = (short)AdjustStackPosition(asBC_SWORDARG0(tmpBC));
@@ -5577,6 +6765,25 @@ void asCWriter::WriteByteCode(asCScriptFunction *func)
 				WriteEncodedInt64(qw);
 			}
 			break;
+		case asBCTYPE_wW_rW_QW_ARG:
+			{
+				// Write the instruction code
+				asBYTE b = (asBYTE)c;
+				WriteData(&b, 1);
+
+				// Write the first argument
+				short w = *(((short*)tmpBC)+1);
+				WriteEncodedInt64(w);
+
+				// Write the second argument
+				w = *(((short*)tmpBC)+2);
+				WriteEncodedInt64(w);
+
+				// Write the third argument
+				asQWORD qw = *(asQWORD*)&tmpBC[2];
+				WriteEncodedInt64(qw);
+			}
+			break;
 		case asBCTYPE_rW_DW_DW_ARG:
 			{
 				// Write the instruction code
@@ -49,21 +49,71 @@ class asCReader
 {
 public:
 	asCReader(asCModule *module, asIBinaryStream *stream, asCScriptEngine *engine);
+	asCReader(asCModule *module, const void *buffer, size_t bufferSize, asCScriptEngine *engine);
+	~asCReader();
 
-	int Read(bool *wasDebugInfoStripped);
+	// The load is done in phases so that only the resolution of the entities in
+	// the engine has to be serialized with other threads loading bytecode. Prepare
+	// and Translate don't touch the engine's shared state, Read and Finish do
+	int Prepare();
+	int Read();
+	int Translate();
+	int Finish(int r, bool *wasDebugInfoStripped);
 
 protected:
 	asCModule       *module;
 	asIBinaryStream *stream;
+	const asBYTE    *buffer;     // used instead of the stream when loading from memory
+	size_t           bufferSize;
+	size_t           bufferPos;
 	asCScriptEngine *engine;
 	bool             noDebugInfo;
 	bool             error;
 	asUINT           bytesRead;
 
+	// Used when the bytecode is stored in a sectioned container. The sections are read
+	// one after the other, either in place from the memory buffer or from containerData
+	asCArray<asBYTE>        containerData;
+	asCArray<const asBYTE*> sectionData;
+	asCArray<asUINT>        sectionSizes;
+	asUINT                  currentSection;
+	asBYTE                  containerFlags;
+	bool                    hasPeekedByte;
+	asBYTE                  peekedByte;
+
+	// The debug info in a container is kept in the last section. It is only verified and
+	// unpacked when it is read after all the other entities, and not at all when skipped
+	struct SDebugSection
+	{
+		asUINT        index;
+		const asBYTE *stored;
+		asUINT        storedSize;
+		asUINT        rawSize;
+		asDWORD       crc;
+		bool          compressed;
+		asBYTE       *unpacked;
+	};
+	bool                         readDebugSection;
+	SDebugSection                debugSection;
+	asCArray<asBYTE>             debugSectionStored;
+	asCArray<asCScriptFunction*> debugInfoFuncs;
+
+	// Errors found by Prepare and Translate are reported by Read and Finish
+	bool             isPrepared;
+	bool             deferErrors;
+	int              prepareResult;
+	asCString        deferredError;
+
 	int                Error(const char *msg);
+	int                WriteError(const asCString &msg);
 
 	int                ReadInner();
+	int                ReadContainer();
+	bool               IsInBuffer(size_t size);
+	int                ReadDebugInfo();
+	void               ReadFunctionDebugInfo(asCScriptFunction *func);
 
+	int                ReadRawData(void *data, asUINT size);
 	int                ReadData(void *data, asUINT size);
 	void               ReadString(asCString *str);
 	asCScriptFunction *ReadFunction(bool &isNew, bool addToModule = true, bool addToEngine = true, bool addToGC = true, bool *isExternal = 0);
@@ -91,6 +141,8 @@ protected:
 	int                FindTypeId(int idx);
 	short              FindObjectPropOffset(asWORD index);
 	asCScriptFunction *FindFunction(int idx);
+	asCScriptFunction *FindFunctionById(int id);
+	asCScriptFunction *GetCalledFunction(asCScriptFunction *func, asDWORD programPos);
 
 	// After loading, each function needs to be translated to update pointers, function ids, etc
 	void TranslateFunction(asCScriptFunction *func);
@@ -106,6 +158,11 @@ protected:
 	asCArray<void*>              usedGlobalProperties;
 	asCArray<void*>              usedStringConstants;
 
+	// The functions that the translation looks up by id, so it doesn't have to
+	// access the engine's function table that other threads may be modifying
+	asCMap<int, asCScriptFunction*> functionsById;
+	void CollectFunctionsById();
+
 	asCArray<asCScriptFunction*>  savedFunctions;
 	asCArray<asCDataType>         savedDataTypes;
 	asCArray<asCString>           savedStrings;
@@ -123,6 +180,16 @@ protected:
 	asCMap<void*,bool>              existingShared;
 	asCMap<asCScriptFunction*,bool> dontTranslate;
 
+	// Information stored by the writer to speed up the translation of the functions
+	struct STranslationInfo
+	{
+		asUINT           ptrSize;       // The pointer size on the platform that saved the bytecode
+		asUINT           variableSpace; // The variable space on that platform
+		asUINT           stackNeeded;   // The stack size on that platform
+		asCArray<asUINT> relocations;   // Instruction numbers that must be translated
+	};
+	asCMap<asCScriptFunction*,STranslationInfo*> translationInfo;
+
 	// Helper class for adjusting offsets within initialization list buffers
 	struct SListAdjuster
 	{
@@ -173,8 +240,22 @@ protected:
 	bool             error;
 	asUINT           bytesWritten;
 
+	// When writing a sectioned container the data is buffered in memory until the end
+	bool             useContainer;
+	asCArray<asBYTE> containerData;
+	asCArray<asBYTE> sectionKinds;
+	asCArray<asUINT> sectionEnds;
+
+	// In a container the debug info of the functions is collected in a separate
+	// section with its own string table, so the reader can skip it as a whole
+	bool                   writingDebugInfo;
+	asCArray<asBYTE>       debugData;
+	asCMap<asCString, int> debugStringToIdMap;
+
 	int              Error(const char *msg);
 
+	void EndSection(asBYTE kind);
+	int  WriteContainer();
 	int  WriteData(const void *data, asUINT size);
 
 	void WriteString(asCString *str);
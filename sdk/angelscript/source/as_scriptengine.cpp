@@ -285,7 +285,11 @@ int asCScriptEngine::SetEngineProperty(asEEngineProp property, asPWORD value)
 		break;
 
 	case asEP_OPTIMIZE_BYTECODE:
-		ep.optimizeByteCode = value ? true : false;
+		// 0 = no optimization, 1 = peephole optimizations, 2 = also data-flow optimizations
+		if( value <= 2 )
+			ep.optimizeByteCode = (asUINT)value;
+		else
+			return asINVALID_ARG;
 		break;
 
 	case asEP_COPY_SCRIPT_SECTIONS:
@@ -498,6 +502,20 @@ int asCScriptEngine::SetEngineProperty(asEEngineProp property, asPWORD value)
 		tok.InitJumpTable();
 		break;
 
+	case asEP_DEFER_FUNCTION_COMPILATION:
+		ep.deferFunctionCompilation = value ? true : false;
+		break;
+
+	case asEP_BYTECODE_FORMAT:
+		if( value > 2 )
+			return asINVALID_ARG;
+		ep.bytecodeFormat = (asUINT)value;
+		break;
+
+	case asEP_SKIP_DEBUG_INFO_ON_LOAD:
+		ep.skipDebugInfoOnLoad = value ? true : false;
+		break;
+
 	default:
 		return asINVALID_ARG;
 	}
@@ -630,6 +648,15 @@ asPWORD asCScriptEngine::GetEngineProperty(asEEngineProp property) const
 	case asEP_FOREACH_SUPPORT:
 		return ep.foreachSupport;
 
+	case asEP_DEFER_FUNCTION_COMPILATION:
+		return ep.deferFunctionCompilation;
+
+	case asEP_BYTECODE_FORMAT:
+		return ep.bytecodeFormat;
+
+	case asEP_SKIP_DEBUG_INFO_ON_LOAD:
+		return ep.skipDebugInfoOnLoad;
+
 	default:
 		return 0;
 	}
@@ -666,7 +693,7 @@ asCScriptEngine::asCScriptEngine()
 	// Engine properties
 	{
 		ep.allowUnsafeReferences         = false;
-		ep.optimizeByteCode              = true;
+		ep.optimizeByteCode              = 1;
 		ep.copyScriptSections            = true;
 		ep.maximumContextStackSize       = 0;         // no limit
 		ep.initContextStackSize          = 1024;      // 4KB default init stack size
@@ -708,6 +735,9 @@ asCScriptEngine::asCScriptEngine()
 		ep.memberInitMode                = 1;         // 0 = pre 2.38.0, members with init expr in declaration are initialized after super(), 1 = all members initialized in beginning, except if explicitly initialized in body
 		ep.boolConversionMode            = 0;         // 0 = only do use opImplConv for registered value type, 1 = use also opConv in contextual conversion even for reference types
 		ep.foreachSupport                = true;
+		ep.deferFunctionCompilation      = false;
+		ep.bytecodeFormat                = 0;         // 0 = sequential stream, 1 = container with sections, 2 = container with compressed sections
+		ep.skipDebugInfoOnLoad           = false;
 	}
 
 	gc.engine = this;
@@ -718,6 +748,8 @@ asCScriptEngine::asCScriptEngine()
 	configFailed = false;
 	isPrepared = false;
 	isBuilding = false;
+	buildThread = 0;
+	numLoadsInProgress = 0;
 	deferValidationOfTemplateTypes = false;
 	lastModule = 0;
 
@@ -879,6 +911,7 @@ asCScriptEngine::~asCScriptEngine()
 			templateType->ReleaseInternal();
 	}
 	templateInstanceTypes.SetLength(0);
+	templateInstanceIndex.EraseAll();
 
 	asCSymbolTable<asCGlobalProperty>::iterator it = registeredGlobalProps.List();
 	for( ; it; it++ )
@@ -1004,6 +1037,49 @@ asIScriptContext *asCScriptEngine::RequestContext()
 	return CreateContext();
 }
 
+// internal
+void asCScriptEngine::AddEntityOwner(const void *entity, asCModule *mod)
+{
+	asSMapNode<const void*, asCArray<asCModule*> > *cursor;
+	if( entityOwners.MoveTo(&cursor, entity) )
+		entityOwners.GetValue(cursor).PushLast(mod);
+	else
+	{
+		asCArray<asCModule*> owners;
+		owners.PushLast(mod);
+		entityOwners.Insert(entity, owners);
+	}
+}
+
+// internal
+void asCScriptEngine::RemoveEntityOwner(const void *entity, asCModule *mod)
+{
+	asSMapNode<const void*, asCArray<asCModule*> > *cursor;
+	if( !entityOwners.MoveTo(&cursor, entity) )
+		return;
+
+	asCArray<asCModule*> &owners = entityOwners.GetValue(cursor);
+	owners.RemoveValue(mod);
+	if( owners.GetLength() == 0 )
+		entityOwners.Erase(cursor);
+}
+
+// internal
+asCModule *asCScriptEngine::FindOtherOwner(const void *entity, asCModule *mod) const
+{
+	asSMapNode<const void*, asCArray<asCModule*> > *cursor;
+	if( !entityOwners.MoveTo(&cursor, entity) )
+		return 0;
+
+	// Discarded modules are not eligible as they are about to be destroyed
+	const asCArray<asCModule*> &owners = entityOwners.GetValue(cursor);
+	for( asUINT n = 0; n < owners.GetLength(); n++ )
+		if( owners[n] != mod && !owners[n]->m_isDiscarded )
+			return owners[n];
+
+	return 0;
+}
+
 // internal
 asCModule *asCScriptEngine::FindNewOwnerForSharedType(asCTypeInfo *in_type, asCModule *in_mod)
 {
@@ -1012,29 +1088,9 @@ asCModule *asCScriptEngine::FindNewOwnerForSharedType(asCTypeInfo *in_type, asCM
 	if( in_type->module != in_mod)
 		return in_type->module;
 
-	for( asUINT n = 0; n < scriptModules.GetLength(); n++ )
-	{
-		// TODO: optimize: If the modules already stored the shared types separately, this would be quicker
-		int foundIdx = -1;
-		asCModule *mod = scriptModules[n];
-		if( mod == in_type->module ) continue;
-		if( in_type->flags & asOBJ_ENUM )
-			foundIdx = mod->m_enumTypes.IndexOf(CastToEnumType(in_type));
-		else if (in_type->flags & asOBJ_TYPEDEF)
-			foundIdx = mod->m_typeDefs.IndexOf(CastToTypedefType(in_type));
-		else if (in_type->flags & asOBJ_FUNCDEF)
-			foundIdx = mod->m_funcDefs.IndexOf(CastToFuncdefType(in_type));
-		else if (in_type->flags & asOBJ_TEMPLATE)
-			foundIdx = mod->m_templateInstances.IndexOf(CastToObjectType(in_type));
-		else
-			foundIdx = mod->m_classTypes.IndexOf(CastToObjectType(in_type));
-
-		if( foundIdx >= 0 )
-		{
-			in_type->module = mod;
-			break;
-		}
-	}
+	asCModule *mod = FindOtherOwner(in_type, in_type->module);
+	if( mod )
+		in_type->module = mod;
 
 	return in_type->module;
 }
@@ -1066,23 +1122,13 @@ asCModule *asCScriptEngine::FindNewOwnerForSharedFunc(asCScriptFunction *in_func
 		{
 			in_func->module->m_scriptFunctions.PushLast(in_func);
 			in_func->AddRefInternal();
+			AddEntityOwner(in_func, in_func->module);
 		}
 	}
 
-	for( asUINT n = 0; n < scriptModules.GetLength(); n++ )
-	{
-		// TODO: optimize: If the modules already stored the shared types separately, this would be quicker
-		int foundIdx = -1;
-		asCModule *mod = scriptModules[n];
-		if( mod == in_func->module ) continue;
-		foundIdx = mod->m_scriptFunctions.IndexOf(in_func);
-
-		if( foundIdx >= 0 )
-		{
-			in_func->module = mod;
-			break;
-		}
-	}
+	asCModule *mod = FindOtherOwner(in_func, in_func->module);
+	if( mod )
+		in_func->module = mod;
 
 	return in_func->module;
 }
@@ -2077,7 +2123,7 @@ int asCScriptEngine::RegisterObjectType(const char *name, int byteSize, asQWORD
 			type->flags      = flags;
 			type->accessMask = defaultAccessMask;
 
-			templateInstanceTypes.PushLast(type);
+			AddTemplateInstanceType(type);
 
 			currentGroup->types.PushLast(type);
 
@@ -3606,17 +3652,38 @@ asCModule *asCScriptEngine::GetModuleFromFuncId(int id)
 }
 
 // internal
-int asCScriptEngine::RequestBuild()
+int asCScriptEngine::RequestBuild(bool wait)
 {
-	ACQUIREEXCLUSIVE(engineRWLock);
-	if( isBuilding )
+#ifdef AS_NO_THREADS
+	// There are no other threads to wait for
+	wait = false;
+#endif
+
+	for(;;)
 	{
+		ACQUIREEXCLUSIVE(engineRWLock);
+		if( !isBuilding && !numLoadsInProgress )
+			break;
+
+		// The thread that is building cannot wait for itself, e.g. if a
+		// script executed by the compiler calls a deferred function
+		bool isSameThread = isBuilding && buildThread == asCThreadManager::GetLocalData();
 		RELEASEEXCLUSIVE(engineRWLock);
-		return asBUILD_IN_PROGRESS;
+
+		if( !wait || isSameThread )
+			return asBUILD_IN_PROGRESS;
+
+		// Block until the build or the loads in progress have completed and then try again
+		ACQUIREEXCLUSIVE(buildRWLock);
+		RELEASEEXCLUSIVE(buildRWLock);
 	}
 	isBuilding = true;
+	buildThread = asCThreadManager::GetLocalData();
 	RELEASEEXCLUSIVE(engineRWLock);
 
+	// Hold the lock until the build is completed so other threads can wait for it
+	ACQUIREEXCLUSIVE(buildRWLock);
+
 	return 0;
 }
 
@@ -3626,7 +3693,46 @@ void asCScriptEngine::BuildCompleted()
 	// Always free up pooled memory after a completed build
 	memoryMgr.FreeUnusedMemory();
 
+	ACQUIREEXCLUSIVE(engineRWLock);
 	isBuilding = false;
+	buildThread = 0;
+	RELEASEEXCLUSIVE(engineRWLock);
+
+	// The flag is cleared first so the threads that are woken up don't have to wait again
+	RELEASEEXCLUSIVE(buildRWLock);
+}
+
+// internal
+int asCScriptEngine::RequestLoad()
+{
+	// Multiple threads may load bytecode at the same time, as
+	// long as no other thread is building a module from script
+	ACQUIREEXCLUSIVE(engineRWLock);
+	if( isBuilding )
+	{
+		RELEASEEXCLUSIVE(engineRWLock);
+		return asBUILD_IN_PROGRESS;
+	}
+	numLoadsInProgress++;
+	RELEASEEXCLUSIVE(engineRWLock);
+
+	// Hold the lock until the load is completed so builds can wait for it
+	ACQUIRESHARED(buildRWLock);
+
+	return 0;
+}
+
+// internal
+void asCScriptEngine::LoadCompleted()
+{
+	ACQUIREEXCLUSIVE(engineRWLock);
+	bool isLast = --numLoadsInProgress == 0;
+	RELEASEEXCLUSIVE(engineRWLock);
+	RELEASESHARED(buildRWLock);
+
+	// Free up pooled memory after the last concurrent load completes
+	if( isLast )
+		memoryMgr.FreeUnusedMemory();
 }
 
 void asCScriptEngine::RemoveTemplateInstanceType(asCObjectType *t)
@@ -3646,45 +3752,145 @@ void asCScriptEngine::RemoveTemplateInstanceType(asCObjectType *t)
 		if( configGroups[n]->generatedTemplateInstances.Exists(t) )
 			return;
 
+	// The index is keyed by the subtypes, so it must be updated before they are released
+	RemoveTemplateInstanceTypeFromIndex(t);
 	t->DestroyInternal();
 	templateInstanceTypes.RemoveValue(t);
 	generatedTemplateTypes.RemoveValue(t);
 	t->ReleaseInternal();
 }
 
+// internal
+asQWORD asCScriptEngine::HashTemplateInstance(const asSNameSpace *ns, const asCString &name, const asCArray<asCDataType> &subTypes) const
+{
+	// Only the properties that are always compared by asCDataType::operator== are
+	// included, so equal subtypes are guaranteed to produce the same hash
+	asQWORD hash = asStringHash(name.AddressOf(), name.GetLength());
+	asPWORD nsPtr = (asPWORD)ns;
+	hash = asStringHash((const char*)&nsPtr, sizeof(nsPtr), hash);
+	for( asUINT n = 0; n < subTypes.GetLength(); n++ )
+	{
+		const asCDataType &dt = subTypes[n];
+		asPWORD typePtr = (asPWORD)dt.GetTypeInfo();
+		asDWORD props = (asDWORD(dt.GetTokenType()) << 4) |
+		                (dt.IsObjectHandle() ? 1 : 0) |
+		                (dt.IsReference()    ? 2 : 0) |
+		                (dt.IsHandleToConst() ? 4 : 0) |
+		                (dt.IsReadOnly()     ? 8 : 0);
+		hash = asStringHash((const char*)&typePtr, sizeof(typePtr), hash);
+		hash = asStringHash((const char*)&props, sizeof(props), hash);
+	}
+	return hash;
+}
+
+// internal
+// Returns the hash of the raw data of a string object created by the string factory.
+// This is used by the switch statement on strings, so the compiler and the context
+// must compute the same hash for strings with the same content
+asDWORD asCScriptEngine::HashStringObject(const void *str) const
+{
+	asUINT length = 0;
+	if( stringFactory == 0 || stringFactory->GetRawStringData(str, 0, &length) < 0 )
+		return 0;
+
+	// Most strings will fit in the local buffer so no memory needs to be allocated
+	char buffer[256];
+	char *data = buffer;
+	if( length > sizeof(buffer) )
+	{
+		data = asNEWARRAY(char, length);
+		if( data == 0 )
+			return 0;
+	}
+
+	asQWORD hash = 0;
+	if( stringFactory->GetRawStringData(str, data, &length) >= 0 )
+		hash = asStringHash(data, length);
+
+	if( data != buffer )
+		asDELETEARRAY(data);
+
+	// Fold the hash to 32bit so it can be used as the value of a switch case
+	return asDWORD(hash ^ (hash >> 32));
+}
+
+// internal
+void asCScriptEngine::AddTemplateInstanceType(asCObjectType *t)
+{
+	templateInstanceTypes.PushLast(t);
+
+	asQWORD hash = HashTemplateInstance(t->nameSpace, t->name, t->templateSubTypes);
+	asSMapNode<asQWORD, asCArray<asCObjectType*> > *cursor;
+	if( templateInstanceIndex.MoveTo(&cursor, hash) )
+		templateInstanceIndex.GetValue(cursor).PushLast(t);
+	else
+	{
+		asCArray<asCObjectType*> bucket;
+		bucket.PushLast(t);
+		templateInstanceIndex.Insert(hash, bucket);
+	}
+}
+
+// internal
+void asCScriptEngine::RemoveTemplateInstanceTypeFromIndex(asCObjectType *t)
+{
+	asSMapNode<asQWORD, asCArray<asCObjectType*> > *cursor;
+	if( !templateInstanceIndex.MoveTo(&cursor, HashTemplateInstance(t->nameSpace, t->name, t->templateSubTypes)) ||
+		!templateInstanceIndex.GetValue(cursor).Exists(t) )
+	{
+		// The subtypes have been modified since the type was added, so search all buckets
+		templateInstanceIndex.MoveFirst(&cursor);
+		while( cursor && !templateInstanceIndex.GetValue(cursor).Exists(t) )
+			templateInstanceIndex.MoveNext(&cursor, cursor);
+		if( cursor == 0 )
+			return;
+	}
+
+	asCArray<asCObjectType*> &bucket = templateInstanceIndex.GetValue(cursor);
+	bucket.RemoveValue(t);
+	if( bucket.GetLength() == 0 )
+		templateInstanceIndex.Erase(cursor);
+}
+
 // internal
 asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateType, asCArray<asCDataType> &subTypes, asCModule *requestingModule)
 {
 	asUINT n;
 
 	// Is there any template instance type or template specialization already with this subtype?
-	for( n = 0; n < templateInstanceTypes.GetLength(); n++ )
-	{
-		asCObjectType *type = templateInstanceTypes[n];
-		if( type &&
-			type->name == templateType->name &&
-			type->nameSpace == templateType->nameSpace &&
-			type->templateSubTypes == subTypes )
-		{
-			// If the template instance is generated, then the module should hold a reference
-			// to it so the config group can determine see that the template type is in use.
-			// Template specializations will be treated as normal types
-			if( requestingModule && generatedTemplateTypes.Exists(type) )
+	asSMapNode<asQWORD, asCArray<asCObjectType*> > *cursor;
+	if( templateInstanceIndex.MoveTo(&cursor, HashTemplateInstance(templateType->nameSpace, templateType->name, subTypes)) )
+	{
+		asCArray<asCObjectType*> &bucket = templateInstanceIndex.GetValue(cursor);
+		for( n = 0; n < bucket.GetLength(); n++ )
+		{
+			asCObjectType *type = bucket[n];
+			if( type &&
+				type->name == templateType->name &&
+				type->nameSpace == templateType->nameSpace &&
+				type->templateSubTypes == subTypes )
 			{
-				if( type->module == 0 )
-				{
-					// Set the ownership of this template type
-					// It may be without ownership if it was previously created from application with for example GetTypeInfoByDecl
-					type->module = requestingModule;
-				}
-				if( !requestingModule->m_templateInstances.Exists(type) )
+				// If the template instance is generated, then the module should hold a reference
+				// to it so the config group can determine see that the template type is in use.
+				// Template specializations will be treated as normal types
+				if( requestingModule && generatedTemplateTypes.Exists(type) )
 				{
-					requestingModule->m_templateInstances.PushLast(type);
-					type->AddRefInternal();
+					if( type->module == 0 )
+					{
+						// Set the ownership of this template type
+						// It may be without ownership if it was previously created from application with for example GetTypeInfoByDecl
+						type->module = requestingModule;
+					}
+					if( !requestingModule->m_templateInstances.Exists(type) )
+					{
+						requestingModule->m_templateInstances.PushLast(type);
+						type->AddRefInternal();
+						AddEntityOwner(type, requestingModule);
+					}
 				}
-			}
 
-			return templateInstanceTypes[n];
+				return type;
+			}
 		}
 	}
 
@@ -3721,6 +3927,7 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 		ot->module = requestingModule;
 		requestingModule->m_templateInstances.PushLast(ot);
 		ot->AddRefInternal();
+		AddEntityOwner(ot, requestingModule);
 	}
 	else
 	{
@@ -3737,6 +3944,7 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 				{
 					ot->module->m_templateInstances.PushLast(ot);
 					ot->AddRefInternal();
+					AddEntityOwner(ot, ot->module);
 					break;
 				}
 			}
@@ -3760,6 +3968,7 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 				if( ot->module )
 				{
 					ot->module->m_templateInstances.RemoveValue(ot);
+					RemoveEntityOwner(ot, ot->module);
 					ot->ReleaseInternal();
 				}
 				ot->ReleaseInternal();
@@ -3799,7 +4008,7 @@ asCObjectType *asCScriptEngine::GetTemplateInstanceType(asCObjectType *templateT
 	// to include the new template instance type in the list of known types, otherwise it is possible that we get
 	// a infinite recursive loop as the template instance type is requested again during the generation of the
 	// template functions.
-	templateInstanceTypes.PushLast(ot);
+	AddTemplateInstanceType(ot);
 
 	// Store the template instance types that have been created automatically by the engine from a template type
 	// The object types in templateInstanceTypes that are not also in generatedTemplateTypes are registered template specializations
@@ -5433,7 +5642,12 @@ void *asCScriptEngine::CreateScriptObject(const asITypeInfo *type)
 		// Manually allocate the memory, then call the default constructor
 		ptr = CallAlloc(objType);
 		int funcIndex = objType->beh.construct;
-		if (funcIndex)
+		if( objType->flags & asOBJ_SCRIPT_STRUCT )
+		{
+			// Script structs have no constructor so the members are just cleared
+			memset(ptr, 0, objType->size);
+		}
+		else if (funcIndex)
 		{
 			if (objType->flags & asOBJ_TEMPLATE)
 			{
@@ -254,14 +254,20 @@ public:
 	void DeleteDiscardedModules();
 
 	void RemoveTemplateInstanceType(asCObjectType *t);
+	void AddTemplateInstanceType(asCObjectType *t);
+	void RemoveTemplateInstanceTypeFromIndex(asCObjectType *t);
+	asQWORD HashTemplateInstance(const asSNameSpace *ns, const asCString &name, const asCArray<asCDataType> &subTypes) const;
+	asDWORD HashStringObject(const void *str) const;
 
 	asCConfigGroup *FindConfigGroupForFunction(int funcId) const;
 	asCConfigGroup *FindConfigGroupForGlobalVar(int gvarId) const;
 	asCConfigGroup *FindConfigGroupForTypeInfo(const asCTypeInfo *type) const;
 	asCConfigGroup *FindConfigGroupForFuncDef(const asCFuncdefType *funcDef) const;
 
-	int  RequestBuild();
+	int  RequestBuild(bool wait = false);
 	void BuildCompleted();
+	int  RequestLoad();
+	void LoadCompleted();
 
 	void PrepareEngine();
 	bool isPrepared;
@@ -311,6 +317,9 @@ public:
 
 	asCModule         *FindNewOwnerForSharedType(asCTypeInfo *type, asCModule *mod);
 	asCModule         *FindNewOwnerForSharedFunc(asCScriptFunction *func, asCModule *mod);
+	void               AddEntityOwner(const void *entity, asCModule *mod);
+	void               RemoveEntityOwner(const void *entity, asCModule *mod);
+	asCModule         *FindOtherOwner(const void *entity, asCModule *mod) const;
 
 	asCFuncdefType    *FindMatchingFuncdef(asCScriptFunction *func, asCModule *mod);
 
@@ -364,6 +373,8 @@ public:
 	// This list will contain all instances of templates, both registered specialized
 	// types and those automacially instantiated from scripts
 	asCArray<asCObjectType *>      templateInstanceTypes; // increases ref count
+	// Lookup index for templateInstanceTypes, keyed by the hash of name, namespace and subtypes
+	asCMap<asQWORD, asCArray<asCObjectType *> > templateInstanceIndex;
 
 	// Store information about list patterns
 	asCArray<asCObjectType *>      listPatternTypes; // increases ref count
@@ -400,6 +411,13 @@ public:
 	// threads from requesting builds at the same time (without blocking)
 	bool                   isBuilding;
 	// Synchronized with engineRWLock
+	// The thread that is currently building, so it doesn't wait for itself in RequestBuild
+	asCThreadLocalData    *buildThread;
+	// Synchronized with engineRWLock
+	// The number of threads currently loading pre-compiled bytecode. Loads may overlap with
+	// each other, but not with builds, so RequestBuild fails while this is not zero
+	asUINT                 numLoadsInProgress;
+	// Synchronized with engineRWLock
 	// This array holds modules that have been discard (thus are no longer visible to the application)
 	// but cannot yet be deleted due to having external references to some of the entities in them
 	asCArray<asCModule *>  discardedModules;
@@ -412,6 +430,10 @@ public:
 
 	// Stores shared script declared types (classes, interfaces, enums)
 	asCArray<asCTypeInfo *> sharedScriptTypes; // increases ref count
+	// Stores the modules that hold each script declared type, template instance, and shared function.
+	// A module is listed once for each time the entity is added to it. Used to find a new owner
+	// for shared entities when a module is discarded without searching all the other modules
+	asCMap<const void *, asCArray<asCModule *> > entityOwners; // doesn't increase ref count
 	// This array stores the template instances types that have been automatically generated from template types
 	asCArray<asCObjectType *> generatedTemplateTypes;
 	// Stores the funcdefs
@@ -483,12 +505,14 @@ public:
 
 	// Synchronization for threads
 	DECLAREREADWRITELOCK(mutable engineRWLock)
+	DECLARECRITICALSECTION(loadByteCodeLock) // Serializes the resolution of entities by LoadByteCode calls from multiple threads
+	DECLAREREADWRITELOCK(buildRWLock)        // Held exclusively by builds and shared by loads, so RequestBuild can wait for them to complete
 
 	// Engine properties
 	struct
 	{
 		bool   allowUnsafeReferences;
-		bool   optimizeByteCode;
+		asUINT optimizeByteCode;
 		bool   copyScriptSections;
 		asUINT maximumContextStackSize;
 		asUINT initContextStackSize;
@@ -529,6 +553,9 @@ public:
 		asUINT memberInitMode;
 		asUINT boolConversionMode;
 		bool   foreachSupport;
+		bool   deferFunctionCompilation;
+		asUINT bytecodeFormat;
+		bool   skipDebugInfoOnLoad;
 	} ep;
 
 	// Callbacks
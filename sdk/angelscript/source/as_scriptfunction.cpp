@@ -201,6 +201,7 @@ void asCScriptFunction::MakeDelegate(asCScriptFunction *func, void *obj)
 	parameterTypes = func->parameterTypes;
 	returnType     = func->returnType;
 	inOutFlags     = func->inOutFlags;
+	argumentsSize  = func->argumentsSize;
 
 	// The delegate doesn't own the parameters as it will only forward them to the real method
 	// so the exception handler must not clean up the parameters for the delegate
@@ -366,6 +367,7 @@ asCScriptFunction::asCScriptFunction(asCScriptEngine *engine, asCModule *mod, as
 	sysFuncIntf            = 0;
 	signatureId            = 0;
 	dontCleanUpOnException = false;
+	argumentsSize          = -1;
 	vfTableIdx             = -1;
 	gcFlag                 = false;
 	id                     = 0;
@@ -662,6 +664,18 @@ int asCScriptFunction::GetSpaceNeededForArguments()
 	return s;
 }
 
+// internal
+int asCScriptFunction::GetArgumentsSize()
+{
+	// The size is stored when the function is declared, loaded, or prepared by the engine, as
+	// the parameters cannot change after that. It isn't stored here, since the function may
+	// be called from multiple threads at the same time
+	if( argumentsSize >= 0 )
+		return argumentsSize;
+
+	return GetSpaceNeededForArguments();
+}
+
 // internal
 int asCScriptFunction::GetSpaceNeededForReturnValue()
 {
@@ -1596,6 +1610,10 @@ void asCScriptFunction::JITCompile()
 	if( !engine->jitCompiler )
 		return;
 
+	// Functions whose compilation was deferred will be JIT compiled once they have been compiled
+	if( scriptData->byteCode.GetLength() == 0 )
+		return;
+
 	// Make sure the function has been compiled with JitEntry instructions
 	// For functions that has JitEntry this will be a quick test
 	asUINT length;
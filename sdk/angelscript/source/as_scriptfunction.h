@@ -113,7 +113,10 @@ enum asEFuncTrait
 	asTRAIT_EXPLICIT    = 1<<9,  // method
 	asTRAIT_PROPERTY    = 1<<10, // method/function
 	asTRAIT_DELETED     = 1<<11, // method
-	asTRAIT_VARIADIC    = 1<<12  // method/function
+	asTRAIT_VARIADIC    = 1<<12, // method/function
+	asTRAIT_CONSTEXPR   = 1<<13, // function
+	asTRAIT_INLINE      = 1<<14, // method/function
+	asTRAIT_NOINLINE    = 1<<15  // method/function
 };
 
 struct asSFunctionTraits
@@ -232,6 +235,9 @@ public:
 	void SetPrivate(bool set) { traits.SetTrait(asTRAIT_PRIVATE, set); }
 	void SetProperty(bool set) { traits.SetTrait(asTRAIT_PROPERTY, set); }
 	void SetVariadic(bool set) { traits.SetTrait(asTRAIT_VARIADIC, set); }
+	bool IsConstExpr() const { return traits.GetTrait(asTRAIT_CONSTEXPR); }
+	bool IsInline() const { return traits.GetTrait(asTRAIT_INLINE); }
+	bool IsNoInline() const { return traits.GetTrait(asTRAIT_NOINLINE); }
 	bool IsFactory() const;
 
 	asCScriptFunction(asCScriptEngine *engine, asCModule *mod, asEFuncType funcType);
@@ -257,6 +263,7 @@ public:
 	void      AddVariable(const asCString &name, const asCDataType &type, int stackOffset, bool onHeap);
 
 	int       GetSpaceNeededForArguments();
+	int       GetArgumentsSize();
 	int       GetSpaceNeededForReturnValue();
 	asCString GetDeclarationStr(bool includeObjectName = true, bool includeNamespace = false, bool includeParamNames = false) const;
 	int       GetLineNumber(int programPosition, int *sectionIdx);
@@ -382,6 +389,9 @@ public:
 	// Stub functions and delegates don't own the object and parameters
 	bool                         dontCleanUpOnException;
 
+	// Space needed for the arguments, or -1 if it hasn't been stored yet. See GetArgumentsSize
+	int                          argumentsSize;
+
 	// Used by asFUNC_VIRTUAL
 	int                          vfTableIdx;
 
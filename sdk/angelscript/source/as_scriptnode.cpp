@@ -42,8 +42,76 @@
 
 BEGIN_AS_NAMESPACE
 
-asCScriptNode::asCScriptNode(eScriptNode type)
+// Number of nodes allocated in each block of the arena
+const asUINT NODES_PER_BLOCK = 256;
+
+asCScriptNodeArena::asCScriptNodeArena(asCScriptEngine *_engine)
+{
+	engine    = _engine;
+	blockPos  = NODES_PER_BLOCK;
+	freeNodes = 0;
+	numAllocs = 0;
+}
+
+asCScriptNodeArena::~asCScriptNodeArena()
+{
+	// The nodes don't have anything to clean up so the memory can be released without visiting them
+	for( asUINT n = 0; n < blocks.GetLength(); n++ )
+		userFree(blocks[n]);
+
+	// Report the number of allocations for the build statistics
+	if( numAllocs )
+		engine->memoryMgr.AddScriptNodeAllocs(numAllocs);
+}
+
+asCScriptNode *asCScriptNodeArena::CreateNode(eScriptNode type)
+{
+	void *ptr;
+	if( freeNodes )
+	{
+		// Reuse a node that has been destroyed
+		ptr = freeNodes;
+		freeNodes = freeNodes->next;
+	}
+	else
+	{
+		if( blockPos == NODES_PER_BLOCK )
+		{
+#if defined(AS_DEBUG)
+			void *block = ((asALLOCFUNCDEBUG_t)(userAlloc))(sizeof(asCScriptNode)*NODES_PER_BLOCK, __FILE__, __LINE__);
+#else
+			void *block = userAlloc(sizeof(asCScriptNode)*NODES_PER_BLOCK);
+#endif
+			if( block == 0 )
+			{
+				// Out of memory
+				return 0;
+			}
+			blocks.PushLast(block);
+			blockPos = 0;
+		}
+
+		ptr = reinterpret_cast<asCScriptNode*>(blocks[blocks.GetLength()-1]) + blockPos++;
+	}
+
+	numAllocs++;
+	return new(ptr) asCScriptNode(type, this);
+}
+
+void asCScriptNodeArena::FreeNode(asCScriptNode *node)
+{
+#ifdef AS_DEBUG
+	// clear the memory to facilitate identification of use after free
+	memset(node, 0xCDCDCDCD, sizeof(asCScriptNode));
+#endif
+
+	node->next = freeNodes;
+	freeNodes = node;
+}
+
+asCScriptNode::asCScriptNode(eScriptNode type, asCScriptNodeArena *_arena)
 {
+	arena       = _arena;
 	nodeType    = type;
 	tokenType   = ttUnrecognizedToken;
 	tokenPos    = 0;
@@ -69,22 +137,19 @@ void asCScriptNode::Destroy(asCScriptEngine *engine)
 		node = nxt;
 	}
 
-	// Return the memory to the memory manager
-	engine->memoryMgr.FreeScriptNode(this);
+	// Return the memory to the arena
+	arena->FreeNode(this);
 }
 
 asCScriptNode *asCScriptNode::CreateCopy(asCScriptEngine *engine)
 {
-	void *ptr = engine->memoryMgr.AllocScriptNode();
-	if( ptr == 0 )
+	asCScriptNode *node = arena->CreateNode(nodeType);
+	if( node == 0 )
 	{
 		// Out of memory
 		return 0;
 	}
 
-	new(ptr) asCScriptNode(nodeType);
-	
-	asCScriptNode *node = reinterpret_cast<asCScriptNode*>(ptr);
 	node->tokenLength = tokenLength;
 	node->tokenPos    = tokenPos;
 	node->tokenType   = tokenType;
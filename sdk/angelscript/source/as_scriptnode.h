@@ -41,6 +41,7 @@
 
 #include "as_config.h"
 #include "as_tokendef.h"
+#include "as_array.h"
 
 BEGIN_AS_NAMESPACE
 
@@ -105,11 +106,12 @@ struct sToken
 };
 
 class asCScriptEngine;
+class asCScriptNodeArena;
 
 class asCScriptNode
 {
 public:
-	asCScriptNode(eScriptNode nodeType);
+	asCScriptNode(eScriptNode nodeType, asCScriptNodeArena *arena);
 
 	void Destroy(asCScriptEngine *engine);
 	asCScriptNode *CreateCopy(asCScriptEngine *engine);
@@ -131,11 +133,35 @@ public:
 	asCScriptNode *firstChild;
 	asCScriptNode *lastChild;
 
+	// The arena that the node was allocated from
+	asCScriptNodeArena *arena;
+
 protected:
 	// Must call Destroy instead
 	~asCScriptNode() {}
 };
 
+// Each builder allocates its script nodes from its own arena. The nodes are
+// allocated linearly from large blocks, and destroyed nodes are kept in a free
+// list for reuse. All memory is released at once when the arena is destroyed.
+// The arena is not thread safe, but as each builder has its own no lock is needed.
+class asCScriptNodeArena
+{
+public:
+	asCScriptNodeArena(asCScriptEngine *engine);
+	~asCScriptNodeArena();
+
+	asCScriptNode *CreateNode(eScriptNode type);
+	void           FreeNode(asCScriptNode *node);
+
+protected:
+	asCScriptEngine  *engine;
+	asCArray<void*>   blocks;
+	asUINT            blockPos;
+	asCScriptNode    *freeNodes;
+	asUINT            numAllocs;
+};
+
 END_AS_NAMESPACE
 
 #endif
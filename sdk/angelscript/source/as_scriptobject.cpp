@@ -444,6 +444,11 @@ asCScriptObject::~asCScriptObject()
 	for( int n = (int)objType->properties.GetLength()-1; n >= 0; n-- )
 	{
 		asCObjectProperty *prop = objType->properties[n];
+
+		// Members of primitive types don't need to be cleaned up
+		if( prop->type.GetTypeInfo() == 0 )
+			continue;
+
 		if( prop->type.IsObject() )
 		{
 			// Destroy the object
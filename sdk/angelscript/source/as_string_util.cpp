@@ -379,5 +379,19 @@ int asStringEncodeUTF16(unsigned int value, char *outEncodedBuffer)
 	}
 }
 
+asQWORD asStringHash(const char *buffer, size_t length, asQWORD seed)
+{
+	const asQWORD prime = (asQWORD(0x00000100) << 32) | 0x000001B3;
+
+	asQWORD hash = seed;
+	for( size_t n = 0; n < length; n++ )
+	{
+		hash ^= (asBYTE)buffer[n];
+		hash *= prime;
+	}
+
+	return hash;
+}
+
 
 END_AS_NAMESPACE
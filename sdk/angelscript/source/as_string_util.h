@@ -36,6 +36,8 @@
 
 BEGIN_AS_NAMESPACE
 
+const asQWORD asSTRING_HASH_SEED = (asQWORD(0xCBF29CE4) << 32) | 0x84222325;
+
 int     asCompareStrings(const char *str1, size_t len1, const char *str2, size_t len2);
 
 double  asStringScanDouble(const char *string, size_t *numScanned);
@@ -46,6 +48,9 @@ int     asStringDecodeUTF8(const char *encodedBuffer, unsigned int *outLength);
 
 int     asStringEncodeUTF16(unsigned int value, char *outEncodedBuffer);
 
+// 64bit FNV-1a hash. Pass the result of a previous call as the seed to hash non-contiguous data
+asQWORD asStringHash(const char *buffer, size_t length, asQWORD seed = asSTRING_HASH_SEED);
+
 END_AS_NAMESPACE
 
 #endif
@@ -66,6 +66,7 @@
 #define TXT_CANNOT_FORM_ARRAY_OF_s                 "Can't form arrays of subtype '%s'"
 #define TXT_CANNOT_IMPLEMENT_SELF                  "Can't implement itself, or another interface that implements this interface"
 #define TXT_CANNOT_IMPLICITLY_CALL_EXPLICIT_COPY_CONSTR   "Can't implicitly call explicit copy constructor"
+#define TXT_CANNOT_IMPORT_CONSTEXPR                "Imported function cannot be declared as constexpr"
 #define TXT_CANNOT_INHERIT_FROM_s_FINAL            "Can't inherit from class '%s' marked as final"
 #define TXT_CANNOT_INHERIT_FROM_MULTIPLE_CLASSES   "Can't inherit from multiple classes"
 #define TXT_CANNOT_INHERIT_FROM_SELF               "Can't inherit from itself, or another class that inherits from this class"
@@ -85,6 +86,10 @@
 #define TXT_COMPOUND_ASGN_ON_VALUE_TYPE            "Compound assignments with property accessors on value types are not supported"
 #define TXT_COMPOUND_ASGN_WITH_IDX_PROP            "Compound assignments with indexed property accessors are not supported"
 #define TXT_COMPOUND_ASGN_REQUIRE_GET_SET          "Compound assignments with property accessors require both get and set accessors"
+#define TXT_CONSTEXPR_CANNOT_ACCESS_s              "Function declared as constexpr cannot access the global variable '%s'"
+#define TXT_CONSTEXPR_MUST_BE_PRIMITIVE            "Function declared as constexpr can only take and return primitive types by value"
+#define TXT_CONSTEXPR_NOT_PURE                     "Function declared as constexpr can only work on primitive values and call other constexpr functions"
+#define TXT_CONSTEXPR_s_NOT_COMPILED               "Function '%s' declared as constexpr must be compiled before it can be evaluated"
 #define TXT_PROP_ACCESS_s_DOES_NOT_EXPECT_INDEX    "Implemented property accessor '%s' does not expect index argument"
 #define TXT_PROP_ACCESS_s_EXPECTS_INDEX            "Implemented property accessor '%s' expects index argument"
 
@@ -130,6 +135,7 @@
 #define TXT_FOUND_MULTIPLE_ENUM_VALUES            "Found multiple matching enum values"
 #define TXT_FUNCTION_ALREADY_EXIST                "A function with the same name and parameters already exists"
 #define TXT_FUNCTION_s_NOT_FOUND                  "Function '%s' not found"
+#define TXT_FUNCTION_s_REQUIRES_FULL_BUILD        "The function '%s' cannot be recompiled incrementally. A full build is required"
 
 #define TXT_GET_SET_ACCESSOR_TYPE_MISMATCH_FOR_s "The property '%s' has mismatching types for the get and set accessors"
 #define TXT_GLOBAL_VARS_NOT_ALLOWED              "Global variables have been disabled by the application"
@@ -279,9 +285,18 @@
 #define TXT_SHARED_CANNOT_USE_NON_SHARED_TYPE_s        "Shared code cannot use non-shared type '%s'"
 #define TXT_SHARED_s_DOESNT_MATCH_ORIGINAL             "Shared type '%s' doesn't match the original declaration in other module"
 #define TXT_SECTION_IS_EMPTY                           "The script section is empty"
+#define TXT_SECTION_DECLARATIONS_CHANGED               "The script section has changes outside the function bodies. A full build is required"
+#define TXT_SECTION_NOT_IN_PREVIOUS_BUILD              "The script section was not part of the previous build. A full build is required"
 #define TXT_SIGNED_UNSIGNED_MISMATCH                   "Signed/Unsigned mismatch"
 #define TXT_STRINGS_NOT_RECOGNIZED                     "Strings are not recognized by the application"
+#define TXT_STRUCT_CANNOT_BE_DECLARED_AS_s             "Struct cannot be declared as '%s'"
+#define TXT_STRUCT_CANNOT_HAVE_CONSTRUCTOR             "Structs cannot have constructors, destructors, or opAssign"
+#define TXT_STRUCT_CANNOT_INHERIT                      "Struct cannot inherit from classes or implement interfaces"
+#define TXT_STRUCT_MEMBER_CANNOT_BE_s                  "Struct member cannot be of type '%s'. Only primitives, enums, and other structs are allowed"
+#define TXT_STRUCT_MEMBER_CANNOT_HAVE_INIT             "Struct members cannot have initialization expressions"
+#define TXT_STRUCT_s_CANNOT_CONTAIN_ITSELF             "Struct '%s' cannot contain itself"
 #define TXT_SWITCH_CASE_MUST_BE_CONSTANT               "Case expressions must be literal constants"
+#define TXT_SWITCH_CASE_MUST_BE_STRING                 "Case expressions must be string literals when switching on a string"
 #define TXT_SWITCH_MUST_BE_INTEGRAL                    "Switch expressions must be integral numbers"
 
 #define TXT_TMPL_s_EXPECTS_d_SUBTYPES          "Template '%s' expects %d sub type(s)"
@@ -355,6 +370,8 @@
 #define TXT_PREV_FUNC_IS_NAMED_s_TYPE_IS_d               "The function in previous message is named '%s'. The func type is %d"
 #define TXT_RESURRECTING_SCRIPTOBJECT_s                  "The script object of type '%s' is being resurrected illegally during destruction"
 #define TXT_INVALID_BYTECODE_d                           "LoadByteCode failed. The bytecode is invalid. Number of bytes read from stream: %d"
+#define TXT_BYTECODE_CONTAINER_VERSION_d                 "LoadByteCode failed. The bytecode container version %d is not supported"
+#define TXT_BYTECODE_SECTION_d_CORRUPT                   "LoadByteCode failed. Section %d of the bytecode container is corrupt"
 #define TXT_NO_JIT_IN_FUNC_s                             "Function '%s' appears to have been compiled without JIT entry points"
 #define TXT_ENGINE_REF_COUNT_ERROR_DURING_SHUTDOWN       "Uh oh! The engine's reference count is increasing while it is being destroyed. Make sure references needed for clean-up are immediately released"
 #define TXT_MODULE_IS_IN_USE                             "The module is still in use and cannot be rebuilt. Discard it and request another module"
@@ -381,6 +398,7 @@
 #define TXT_EXCEPTION_CAUGHT              "Caught an exception from the application"
 #define TXT_MISMATCH_IN_VALUE_ASSIGN      "Mismatching types in value assignment"
 #define TXT_TOO_MANY_NESTED_CALLS         "Too many nested calls"
+#define TXT_FUNCTION_FAILED_TO_COMPILE    "Failed to compile the function"
 
 // Error codes
 #define ERROR_NAME(x) #x
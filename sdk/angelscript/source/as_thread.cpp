@@ -36,6 +36,8 @@
 // Functions for multi threading support
 //
 
+#include <time.h>
+
 #include "as_config.h"
 #include "as_thread.h"
 #include "as_atomic.h"
@@ -464,5 +466,23 @@ void asCThreadReadWriteLock::ReleaseShared()
 
 //========================================================================
 
+double asGetSystemTime()
+{
+#if !defined(AS_NO_THREADS) && defined(AS_WINDOWS_THREADS)
+	LARGE_INTEGER freq, count;
+	if( QueryPerformanceFrequency(&freq) && QueryPerformanceCounter(&count) )
+		return double(count.QuadPart) / double(freq.QuadPart);
+#elif !defined(AS_NO_THREADS) && defined(AS_POSIX_THREADS) && defined(CLOCK_MONOTONIC)
+	timespec ts;
+	if( clock_gettime(CLOCK_MONOTONIC, &ts) == 0 )
+		return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#endif
+
+	// Fall back to the processor time when no monotonic clock is available
+	return double(clock()) / CLOCKS_PER_SEC;
+}
+
+//========================================================================
+
 END_AS_NAMESPACE
 
@@ -47,6 +47,9 @@
 
 BEGIN_AS_NAMESPACE
 
+// Returns a time stamp in seconds from a monotonic clock when available
+double asGetSystemTime();
+
 class asCThreadLocalData;
 
 class asCThreadManager : public asIThreadManager
@@ -327,6 +327,10 @@ const char * const EXTERNAL_TOKEN  = "external";
 const char * const EXPLICIT_TOKEN  = "explicit";
 const char * const PROPERTY_TOKEN  = "property";
 const char * const DELETE_TOKEN    = "delete";
+const char * const STRUCT_TOKEN    = "struct";
+const char * const CONSTEXPR_TOKEN = "constexpr";
+const char * const INLINE_TOKEN    = "inline";
+const char * const NOINLINE_TOKEN  = "noinline";
 
 END_AS_NAMESPACE
 
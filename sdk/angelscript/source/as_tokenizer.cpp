@@ -45,11 +45,164 @@
 #endif
 #include <string.h> // strcmp()
 
+#ifdef AS_USE_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h> // _BitScanForward()
+#endif
+#endif
+
 BEGIN_AS_NAMESPACE
 
+// Character classes for the ASCII characters. Characters above 127 are
+// only valid in identifiers if the engine allows unicode identifiers
+const asBYTE CC_WHITESPACE  = 1;
+const asBYTE CC_IDENTIFIER  = 2;
+const asBYTE CC_IDENT_START = 4;
+
+static const asBYTE charClass[128] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, // \t \n \r
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // space
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, // 0-9
+	0, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, // A-O
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 0, 0, 0, 0, 6, // P-Z _
+	0, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, // a-o
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 0, 0, 0, 0, 0  // p-z
+};
+
+static inline bool IsCharOfClass(char ch, asBYTE cls)
+{
+	return asBYTE(ch) < 128 && (charClass[asBYTE(ch)] & cls);
+}
+
+#ifdef AS_USE_SSE2
+static inline asUINT CountTrailingZeros(asUINT mask)
+{
+#if defined(_MSC_VER)
+	unsigned long idx;
+	_BitScanForward(&idx, mask);
+	return asUINT(idx);
+#else
+	return asUINT(__builtin_ctz(mask));
+#endif
+}
+
+// Returns the number of white space characters at the start of the source
+static size_t ScanWhiteSpace(const char *source, size_t length)
+{
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab   = _mm_set1_epi8('\t');
+	const __m128i lf    = _mm_set1_epi8('\n');
+	const __m128i cr    = _mm_set1_epi8('\r');
+
+	size_t n = 0;
+	for( ; n + 16 <= length; n += 16 )
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(source + n));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+		                         _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+		asUINT mask = asUINT(_mm_movemask_epi8(m)) ^ 0xFFFF;
+		if( mask )
+			return n + CountTrailingZeros(mask);
+	}
+
+	while( n < length && IsCharOfClass(source[n], CC_WHITESPACE) )
+		n++;
+	return n;
+}
+
+// Returns the number of identifier characters at the start of the source
+static size_t ScanIdentifier(const char *source, size_t length, bool allowUnicode)
+{
+	// The comparisons are signed so characters above 127 are below all the ranges
+	const __m128i lowerBit = _mm_set1_epi8(0x20);
+	const __m128i beforeA  = _mm_set1_epi8('a'-1);
+	const __m128i afterZ   = _mm_set1_epi8('z'+1);
+	const __m128i before0  = _mm_set1_epi8('0'-1);
+	const __m128i after9   = _mm_set1_epi8('9'+1);
+	const __m128i under    = _mm_set1_epi8('_');
+	const __m128i zero     = _mm_setzero_si128();
+
+	size_t n = 0;
+	for( ; n + 16 <= length; n += 16 )
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(source + n));
+		__m128i l = _mm_or_si128(v, lowerBit);
+		__m128i m = _mm_and_si128(_mm_cmpgt_epi8(l, beforeA), _mm_cmplt_epi8(l, afterZ));
+		m = _mm_or_si128(m, _mm_and_si128(_mm_cmpgt_epi8(v, before0), _mm_cmplt_epi8(v, after9)));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, under));
+		if( allowUnicode )
+			m = _mm_or_si128(m, _mm_cmplt_epi8(v, zero));
+		asUINT mask = asUINT(_mm_movemask_epi8(m)) ^ 0xFFFF;
+		if( mask )
+			return n + CountTrailingZeros(mask);
+	}
+
+	for( ; n < length; n++ )
+	{
+		if( !IsCharOfClass(source[n], CC_IDENTIFIER) && !(allowUnicode && asBYTE(source[n]) >= 128) )
+			break;
+	}
+	return n;
+}
+
+// Returns the number of characters before the first quote, back slash, or line break
+static size_t ScanStringConstant(const char *source, size_t length, char quote)
+{
+	const __m128i q  = _mm_set1_epi8(quote);
+	const __m128i bs = _mm_set1_epi8('\\');
+	const __m128i lf = _mm_set1_epi8('\n');
+
+	size_t n = 0;
+	for( ; n + 16 <= length; n += 16 )
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(source + n));
+		__m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_or_si128(_mm_cmpeq_epi8(v, bs), _mm_cmpeq_epi8(v, lf)));
+		asUINT mask = asUINT(_mm_movemask_epi8(m));
+		if( mask )
+			return n + CountTrailingZeros(mask);
+	}
+
+	while( n < length && source[n] != quote && source[n] != '\\' && source[n] != '\n' )
+		n++;
+	return n;
+}
+#else
+static size_t ScanWhiteSpace(const char *source, size_t length)
+{
+	size_t n = 0;
+	while( n < length && IsCharOfClass(source[n], CC_WHITESPACE) )
+		n++;
+	return n;
+}
+
+static size_t ScanIdentifier(const char *source, size_t length, bool allowUnicode)
+{
+	size_t n = 0;
+	for( ; n < length; n++ )
+	{
+		if( !IsCharOfClass(source[n], CC_IDENTIFIER) && !(allowUnicode && asBYTE(source[n]) >= 128) )
+			break;
+	}
+	return n;
+}
+
+static size_t ScanStringConstant(const char *source, size_t length, char quote)
+{
+	size_t n = 0;
+	while( n < length && source[n] != quote && source[n] != '\\' && source[n] != '\n' )
+		n++;
+	return n;
+}
+#endif
+
 asCTokenizer::asCTokenizer()
 {
 	engine = 0;
+	keywordHashSeed = 0;
+	maxKeywordLength = 0;
 	memset(keywordTable, 0, sizeof(keywordTable));
 
 	InitJumpTable();
@@ -114,6 +267,86 @@ void asCTokenizer::InitJumpTable()
 
 		tok[insert] = &current;
 	}
+
+	InitKeywordHash();
+}
+
+// static
+asUINT asCTokenizer::HashKeyWord(const char *word, size_t length, asUINT seed)
+{
+	// FNV-1a
+	asUINT hash = 2166136261u ^ seed;
+	for( size_t n = 0; n < length; n++ )
+	{
+		hash ^= asBYTE(word[n]);
+		hash *= 16777619u;
+	}
+	return hash ^ (hash >> 16);
+}
+
+void asCTokenizer::InitKeywordHash()
+{
+	// Gather the keywords that would otherwise be parsed as identifiers
+	asCArray<const sTokenWord*> words;
+	maxKeywordLength = 0;
+	for( asUINT n = 0; n < numTokenWords; n++ )
+	{
+		const sTokenWord &current = tokenWords[n];
+		if( current.tokenType == ttForEach && engine && !engine->ep.foreachSupport )
+			continue;
+		if( !IsCharOfClass(current.word[0], CC_IDENT_START) )
+			continue;
+
+		words.PushLast(&current);
+		if( current.wordLength > maxKeywordLength )
+			maxKeywordLength = current.wordLength;
+	}
+
+	// Search for a seed that gives each keyword its own slot. With the table
+	// 8 times larger than the number of keywords a seed is found in a few tries
+	asUINT size = 16;
+	while( size < words.GetLength()*8 )
+		size <<= 1;
+	for( asUINT seed = 0; ; seed++ )
+	{
+		// Double the size of the table if it is taking too long to find a seed
+		if( seed && (seed % 1000) == 0 )
+			size <<= 1;
+
+		keywordHash.SetLength(size);
+		memset(keywordHash.AddressOf(), 0, size*sizeof(sTokenWord*));
+
+		asUINT n;
+		for( n = 0; n < words.GetLength(); n++ )
+		{
+			asUINT slot = HashKeyWord(words[n]->word, words[n]->wordLength, seed) & (size-1);
+			if( keywordHash[slot] )
+				break;
+			keywordHash[slot] = words[n];
+		}
+
+		if( n == words.GetLength() )
+		{
+			keywordHashSeed = seed;
+			break;
+		}
+	}
+}
+
+bool asCTokenizer::IsReservedWord(const char *source, size_t length, eTokenType &tokenType) const
+{
+	if( length > maxKeywordLength )
+		return false;
+
+	asUINT slot = HashKeyWord(source, length, keywordHashSeed) & (asUINT(keywordHash.GetLength())-1);
+	const sTokenWord *word = keywordHash[slot];
+	if( word && word->wordLength == length && memcmp(source, word->word, length) == 0 )
+	{
+		tokenType = word->tokenType;
+		return true;
+	}
+
+	return false;
 }
 
 // static
@@ -168,7 +401,9 @@ asETokenClass asCTokenizer::ParseToken(const char *source, size_t sourceLength,
 	if( IsWhiteSpace(source, sourceLength, tokenLength, tokenType) ) return asTC_WHITESPACE;
 	if( IsComment(source, sourceLength, tokenLength, tokenType)    ) return asTC_COMMENT;
 	if( IsConstant(source, sourceLength, tokenLength, tokenType)   ) return asTC_VALUE;
-	if( IsIdentifier(source, sourceLength, tokenLength, tokenType) ) return asTC_IDENTIFIER;
+
+	// Identifiers that are reserved words are returned with the type of the keyword
+	if( IsIdentifier(source, sourceLength, tokenLength, tokenType) ) return tokenType == ttIdentifier ? asTC_IDENTIFIER : asTC_KEYWORD;
 	if( IsKeyWord(source, sourceLength, tokenLength, tokenType)    ) return asTC_KEYWORD;
 
 	// If none of the above this is an unrecognized token
@@ -194,21 +429,7 @@ bool asCTokenizer::IsWhiteSpace(const char *source, size_t sourceLength, size_t
 	}
 
 	// Group all other white space characters into one
-	size_t n;
-	int numWsChars = (int)strlen(whiteSpace);
-	for( n = 0; n < sourceLength; n++ )
-	{
-		bool isWhiteSpace = false;
-		for( int w = 0; w < numWsChars; w++ )
-		{
-			if( source[n] == whiteSpace[w] )
-			{
-				isWhiteSpace = true;
-				break;
-			}
-		}
-		if( !isWhiteSpace )	break;
-	}
+	size_t n = ScanWhiteSpace(source, sourceLength);
 
 	if( n > 0 )
 	{
@@ -233,15 +454,10 @@ bool asCTokenizer::IsComment(const char *source, size_t sourceLength, size_t &to
 		// One-line comment
 
 		// Find the length
-		size_t n;
-		for( n = 2; n < sourceLength; n++ )
-		{
-			if( source[n] == '\n' )
-				break;
-		}
+		const char *end = (const char*)memchr(source + 2, '\n', sourceLength - 2);
 
 		tokenType   = ttOnelineComment;
-		tokenLength = n < sourceLength ? n+1 : n;
+		tokenLength = end ? size_t(end - source) + 1 : sourceLength;
 
 		return true;
 	}
@@ -251,15 +467,27 @@ bool asCTokenizer::IsComment(const char *source, size_t sourceLength, size_t &to
 		// Multi-line comment
 
 		// Find the length
-		size_t n;
-		for( n = 2; n < sourceLength-1; )
+		size_t n = 2;
+		for(;;)
 		{
-			if( source[n++] == '*' && source[n] == '/' )
+			const char *star = n + 1 < sourceLength ? (const char*)memchr(source + n, '*', sourceLength - 1 - n) : 0;
+			if( star == 0 )
+			{
+				// The comment is not terminated
+				n = sourceLength;
 				break;
+			}
+
+			n = size_t(star - source) + 1;
+			if( source[n] == '/' )
+			{
+				n++;
+				break;
+			}
 		}
 
 		tokenType   = ttMultilineComment;
-		tokenLength = n+1;
+		tokenLength = n;
 
 		return true;
 	}
@@ -361,19 +589,22 @@ bool asCTokenizer::IsConstant(const char *source, size_t sourceLength, size_t &t
 			// Heredoc string constant (spans multiple lines, no escape sequences)
 
 			// Find the length
-			size_t n;
-			for( n = 3; n < sourceLength-2; n++ )
+			size_t n = 3;
+			const char *quote;
+			while( n < sourceLength-2 && (quote = (const char*)memchr(source + n, '"', sourceLength - 2 - n)) != 0 )
 			{
-				if (source[n] == '"' && source[n + 1] == '"' && source[n + 2] == '"')
+				n = size_t(quote - source);
+				if (source[n + 1] == '"' && source[n + 2] == '"')
 				{
 					tokenType = ttHeredocStringConstant;
 					tokenLength = n + 3;
 					return true;
 				}
+				n++;
 			}
 
 			tokenType   = ttNonTerminatedStringConstant;
-			tokenLength = n+2;
+			tokenLength = sourceLength;
 		}
 		else
 		{
@@ -393,6 +624,16 @@ bool asCTokenizer::IsConstant(const char *source, size_t sourceLength, size_t &t
 					n++;
 					continue;
 				}
+#else
+				// Skip ahead to the next character that needs to be looked at
+				size_t skip = ScanStringConstant(source + n, sourceLength - n, quote);
+				if( skip )
+				{
+					evenSlashes = true;
+					n += skip;
+					if( n == sourceLength )
+						break;
+				}
 #endif
 
 				if( source[n] == '\n' ) 
@@ -428,24 +669,11 @@ bool asCTokenizer::IsIdentifier(const char *source, size_t sourceLength, size_t
 		(c < 0 && engine->ep.allowUnicodeIdentifiers) )
 	{
 		tokenType   = ttIdentifier;
-		tokenLength = 1;
-
-		for( size_t n = 1; n < sourceLength; n++ )
-		{
-			c = source[n];
-			if( (c >= 'a' && c <= 'z') ||
-				(c >= 'A' && c <= 'Z') ||
-				(c >= '0' && c <= '9') ||
-				c == '_' ||
-				(c < 0 && engine->ep.allowUnicodeIdentifiers) )
-				tokenLength++;
-			else
-				break;
-		}
+		tokenLength = 1 + ScanIdentifier(source + 1, sourceLength - 1, engine->ep.allowUnicodeIdentifiers);
 
-		// Make sure the identifier isn't a reserved keyword
-		if( IsKeyWord(source, tokenLength, tokenLength, tokenType) )
-			return false;
+		// Check if the identifier is a reserved keyword. In this case the
+		// token type is set to that of the keyword, e.g. ttInt or ttClass
+		IsReservedWord(source, tokenLength, tokenType);
 
 		return true;
 	}
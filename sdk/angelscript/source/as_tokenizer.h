@@ -43,6 +43,7 @@
 #include "as_config.h"
 #include "as_tokendef.h"
 #include "as_map.h"
+#include "as_array.h"
 #include "as_string.h"
 
 BEGIN_AS_NAMESPACE
@@ -67,13 +68,23 @@ protected:
 	bool IsKeyWord(const char *source, size_t sourceLength, size_t &tokenLength, eTokenType &tokenType) const;
 	bool IsIdentifier(const char *source, size_t sourceLength, size_t &tokenLength, eTokenType &tokenType) const;
 	bool IsDigitInRadix(char ch, int radix) const;
+	bool IsReservedWord(const char *source, size_t length, eTokenType &tokenType) const;
 
 	void InitJumpTable();
 	void FreeJumpTable();
+	void InitKeywordHash();
+
+	static asUINT HashKeyWord(const char *word, size_t length, asUINT seed);
 
 	const asCScriptEngine *engine;
 
 	const sTokenWord **keywordTable[256];
+
+	// Perfect hash of the keywords that are made up of identifier characters.
+	// The seed is searched for when the table is built so no two keywords share a slot
+	asCArray<const sTokenWord*> keywordHash;
+	asUINT                      keywordHashSeed;
+	size_t                      maxKeywordLength;
 };
 
 END_AS_NAMESPACE
@@ -336,7 +336,7 @@ void asCTypeInfo::CleanUserData()
 bool asCTypeInfo::IsShared() const
 {
 	// Types that can be declared by scripts need to have the explicit flag asOBJ_SHARED
-	if (flags & (asOBJ_SCRIPT_OBJECT | asOBJ_ENUM)) return flags & asOBJ_SHARED ? true : false;
+	if (flags & (asOBJ_SCRIPT_OBJECT | asOBJ_SCRIPT_STRUCT | asOBJ_ENUM)) return flags & asOBJ_SHARED ? true : false;
 
 	// Otherwise we assume the type to be shared
 	return true;
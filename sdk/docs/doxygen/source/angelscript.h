@@ -221,7 +221,7 @@ enum asEEngineProp
 {
 	//! Allow unsafe references. Default: false.
 	asEP_ALLOW_UNSAFE_REFERENCES            = 1,
-	//! Optimize byte code. Default: true.
+	//! Optimize byte code. 0 = no optimizations, 1 = peephole optimizations, 2 = also data-flow optimizations. Default: 1.
 	asEP_OPTIMIZE_BYTECODE                  = 2,
 	//! Copy script section memory. Default: true.
 	asEP_COPY_SCRIPT_SECTIONS               = 3,
@@ -299,6 +299,12 @@ enum asEEngineProp
 	asEP_BOOL_CONVERSION_MODE               = 39,
 	//! Enable foreach support. Default: true
 	asEP_FOREACH_SUPPORT                    = 40,
+	//! Defer the compilation of function bodies until the functions are first used. Default: false
+	asEP_DEFER_FUNCTION_COMPILATION         = 41,
+	//! Select the format for saved bytecode. 0 - sequential stream, 1 - container with checksummed sections, 2 - container with compressed sections. Default: 0
+	asEP_BYTECODE_FORMAT                    = 42,
+	//! Skip the debug information when loading bytecode saved in a container. Default: false
+	asEP_SKIP_DEBUG_INFO_ON_LOAD            = 43,
 
 	asEP_LAST_PROPERTY
 };
@@ -429,7 +435,9 @@ enum asEObjTypeFlags : asQWORD
 	//! The class is abstract, i.e. cannot be instantiated
 	asOBJ_ABSTRACT                    = (1<<29),
 	//! Reserved for future use.
-	asOBJ_APP_ALIGN16                 = (1<<30)
+	asOBJ_APP_ALIGN16                 = (1<<30),
+	//! The type is a struct declared in the script
+	asOBJ_SCRIPT_STRUCT               = (asQWORD(1)<<33)
 };
 
 // Behaviours
@@ -821,6 +829,39 @@ struct asSMessageInfo
 	const char *message;
 };
 
+//! \brief Statistics from the last build or load of a module
+struct asSBuildStatistics
+{
+	//! Seconds spent parsing the script sections
+	double parseTime;
+	//! Seconds spent compiling the declarations of the script classes and interfaces
+	double typeCompileTime;
+	//! Seconds spent compiling the global variables
+	double globalVarCompileTime;
+	//! Seconds spent compiling the function bodies, including the deferred compilations
+	double functionCompileTime;
+	//! Seconds spent finalizing and optimizing the bytecode. This is part of the compile times above
+	double finalizeTime;
+	//! Seconds spent loading pre-compiled bytecode
+	double loadTime;
+	//! Total seconds for the build or load, including the JIT compilation
+	double totalTime;
+	//! The number of functions compiled since the build, including the deferred compilations
+	asUINT numFunctionsCompiled;
+	//! The number of script functions in the module that have bytecode
+	asUINT numFunctions;
+	//! The number of types declared in the module
+	asUINT numTypes;
+	//! The total size of the bytecode of the functions in the module, in dwords
+	asUINT totalByteCodeSize;
+	//! The size of the largest function in the module, in dwords
+	asUINT largestByteCodeSize;
+	//! The number of script nodes allocated by the parser
+	asUINT numScriptNodeAllocs;
+	//! The number of bytecode instructions allocated by the compiler
+	asUINT numByteInstructionAllocs;
+};
+
 
 // API functions
 
@@ -2366,6 +2407,58 @@ public:
 	//!
 	//! \see \ref doc_compile_script
 	virtual int         Build() = 0;
+	//! \brief Recompile only the functions whose bodies were modified in the previously added script sections.
+	//! \return A negative value on error
+	//! \retval asINVALID_CONFIGURATION The engine configuration is invalid.
+	//! \retval asERROR The modified functions failed to compile. The module is left unchanged.
+	//! \retval asBUILD_IN_PROGRESS Another thread is currently building.
+	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and cannot be replaced.
+	//! \retval asNOT_SUPPORTED The changes require a full build, or compiler support is disabled in the engine.
+	//!
+	//! Only the script sections that have been modified since the last \ref Build need to be added 
+	//! again with \ref AddScriptSection, using the same section names as before. The sections are compared 
+	//! with the information kept from the last build, and only the functions whose bodies have changed 
+	//! are recompiled. The functions keep their ids, and the types and global variables in the module, 
+	//! including their current values, are not touched.
+	//!
+	//! If anything outside the function bodies has changed, e.g. a declaration or the initialization of 
+	//! a global variable, the method returns \ref asNOT_SUPPORTED without changing the module, and the 
+	//! application should then do a full \ref Build instead. The same is true for changes in constructors 
+	//! of script classes, in shared and constexpr functions, and in functions that were inlined in 
+	//! the callers.
+	//!
+	//! As with \ref Build, the method returns \ref asMODULE_IS_IN_USE while there are external references 
+	//! to the module, e.g. from a context that is still executing or suspended in one of its functions, 
+	//! since the old bytecode is released once the new has been compiled. The modified sections are kept, 
+	//! so the method can be called again once the references have been released.
+	//!
+	//! \see \ref doc_compile_script
+	virtual int         BuildIncremental() = 0;
+	//! \brief Compile the functions whose compilation was deferred.
+	//! \return A negative value on error
+	//! \retval asERROR At least one of the functions failed to compile.
+	//! \retval asBUILD_IN_PROGRESS Another thread is currently building.
+	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
+	//!
+	//! When the engine property \ref asEP_DEFER_FUNCTION_COMPILATION is set the \ref Build only registers 
+	//! the declarations and the function bodies are compiled when the functions are first prepared or called.
+	//! Use this method to compile all the remaining function bodies at once, e.g. to report any errors in 
+	//! the script before it is executed, or before executing the script from multiple threads.
+	//!
+	//! If any function fails to compile none of the functions are compiled, and they will be compiled 
+	//! again when they are used.
+	virtual int         CompileAll() = 0;
+	//! \brief Returns statistics on the last build or load of the module.
+	//! \param[out] stats The structure that will receive the statistics.
+	//! \return A negative value on error
+	//! \retval asINVALID_ARG The stats pointer is null.
+	//!
+	//! The statistics are collected each time the module is built with \ref Build, \ref BuildIncremental,
+	//! or loaded with \ref LoadByteCode. The timings and allocation counts cover the last of these operations,
+	//! while the function and bytecode counts reflect the current content of the module. Use this to
+	//! report slow builds in telemetry. The bytecode size of the individual functions can be obtained 
+	//! with \ref asIScriptFunction::GetByteCode.
+	virtual int         GetBuildStatistics(asSBuildStatistics *stats) const = 0;
 	//! \brief Compile a single function.
 	//! \param[in] sectionName The name of the script section
 	//! \param[in] code The script code buffer
@@ -2713,12 +2806,18 @@ public:
 	//! \return A negative value on error.
 	//! \retval asINVALID_ARG The stream object wasn't specified.
 	//! \retval asNOT_SUPPORTED Compiler support is disabled in the engine.
-	//! \retval asERROR Nothing has been compiled in the module.
+	//! \retval asERROR Nothing has been compiled in the module, or a deferred function failed to compile.
+	//! \retval asBUILD_IN_PROGRESS Another thread is currently building, so the deferred functions couldn't be compiled.
 	//!
 	//! This method is used to save pre-compiled byte code to disk or memory, for a later restoral.
 	//! The application must implement an object that inherits from \ref asIBinaryStream to provide
 	//! the necessary stream operations.
 	//!
+	//! Observe that even though the method is const it will first call \ref CompileAll if the compilation of
+	//! any functions was deferred with \ref asEP_DEFER_FUNCTION_COMPILATION, since only compiled functions can 
+	//! be saved. This modifies the module in the same way as if the functions had been called, and requires 
+	//! the same lock as a build.
+	//!
 	//! \see \ref doc_adv_precompile
 	virtual int SaveByteCode(asIBinaryStream *out, bool stripDebugInfo = false) const = 0;
 	//! \brief Load pre-compiled byte code from a binary stream.
@@ -2727,7 +2826,7 @@ public:
 	//! \param[out] wasDebugInfoStripped Set to true if the byte code was saved without debug information.
 	//! \return A negative value on error.
 	//! \retval asINVALID_ARG The stream object wasn't specified.
-	//! \retval asBUILD_IN_PROGRESS Another thread is currently building.
+	//! \retval asBUILD_IN_PROGRESS Another thread is currently building a module from script.
 	//! \retval asOUT_OF_MEMORY The engine ran out of memory while loading the byte code.
 	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and and cannot be removed. 
 	//! \retval asERROR It was not possible to load the byte code.
@@ -2745,8 +2844,32 @@ public:
 	//! provides information about the type of error that caused the failure while loading the byte code to the
 	//! \ref asIScriptEngine::SetMessageCallback "message stream". 
 	//!
+	//! Multiple threads may load byte code into different modules at the same time. The reading and
+	//! unpacking of byte code saved in a \ref asEP_BYTECODE_FORMAT "container" is done in parallel, while 
+	//! the resolving of the entities in the engine is done by one thread at a time. The method will only 
+	//! return asBUILD_IN_PROGRESS if another thread is building a module from script.
+	//!
 	//! \see \ref doc_adv_precompile
 	virtual int LoadByteCode(asIBinaryStream *in, bool *wasDebugInfoStripped = 0) = 0;
+	//! \brief Load pre-compiled byte code from a memory buffer.
+	//!
+	//! \param[in] data The buffer with the byte code.
+	//! \param[in] size The size of the buffer in bytes.
+	//! \param[out] wasDebugInfoStripped Set to true if the byte code was saved without debug information.
+	//! \return A negative value on error.
+	//! \retval asINVALID_ARG The buffer wasn't specified.
+	//! \retval asBUILD_IN_PROGRESS Another thread is currently building a module from script.
+	//! \retval asOUT_OF_MEMORY The engine ran out of memory while loading the byte code.
+	//! \retval asMODULE_IS_IN_USE The code in the module is still being used and and cannot be removed. 
+	//! \retval asERROR It was not possible to load the byte code.
+	//!
+	//! This works like the \ref LoadByteCode(asIBinaryStream*,bool*) "stream version", but reads the byte code 
+	//! directly from a contiguous buffer, e.g. a file mapped into memory, which avoids the calls to 
+	//! \ref asIBinaryStream::Read for each value. The buffer must contain the byte code exactly as it 
+	//! was written by \ref SaveByteCode, and it only needs to stay valid until the method returns.
+	//!
+	//! \see \ref doc_adv_precompile
+	virtual int LoadByteCode(const void *data, size_t size, bool *wasDebugInfoStripped = 0) = 0;
 	//! \}
 
 	// User data
@@ -4712,7 +4835,7 @@ enum asEBCInstr
 	asBC_PshG4			= 7,
 	//! \brief Perform the actions of \ref asBC_LDG followed by \ref asBC_RDR4
 	asBC_LdGRdR4		= 8,
-	//! \brief Jump to a script function, indexed by the argument
+	//! \brief Jump to a script function, indexed by the argument. For class methods the object pointer on the stack is checked for null
 	asBC_CALL			= 9,
 	//! \brief Return to the instruction after the last executed call
 	asBC_RET			= 10,
@@ -5096,8 +5219,28 @@ enum asEBCInstr
 	asBC_POWu64			= 199,
 	//! \brief Call registered function with single 32bit integer argument. Suspend further execution if requested.
 	asBC_Thiscall1		= 200,
-
-	asBC_MAXBYTECODE	= 201,
+	//! \brief Pop string pointer from the stack and store the hash of its content in the variable
+	asBC_StrHash		= 201,
+	//! \brief Add a 64bit integer variable with a constant value and store the result in another variable
+	asBC_ADDIi64		= 202,
+	//! \brief Subtract a 64bit integer variable with a constant value and store the result in another variable
+	asBC_SUBIi64		= 203,
+	//! \brief Multiply a 64bit integer variable with a constant value and store the result in another variable
+	asBC_MULIi64		= 204,
+	//! \brief Compare 64bit integer variable with constant and store the result in value register
+	asBC_CMPIi64		= 205,
+	//! \brief Compare 64bit unsigned integer variable with constant and store the result in value register
+	asBC_CMPIu64		= 206,
+	//! \brief Add a double variable with a constant value and store the result in another variable
+	asBC_ADDId			= 207,
+	//! \brief Subtract a double variable with a constant value and store the result in another variable
+	asBC_SUBId			= 208,
+	//! \brief Multiply a double variable with a constant value and store the result in another variable
+	asBC_MULId			= 209,
+	//! \brief Compare double variable with constant and store the result in value register
+	asBC_CMPId			= 210,
+
+	asBC_MAXBYTECODE	= 211,
 
 	// Temporary tokens. Can't be output to the final program
 	asBC_TryBlock		= 250,
@@ -5152,12 +5295,14 @@ enum asEBCType
 	//! \brief Instruction + WORD arg(source var) + WORD arg + DWORD arg
 	asBCTYPE_rW_W_DW_ARG  = 19,
 	//! \brief Instruction + WORD arg(source var) + DWORD arg + DWORD arg
-	asBCTYPE_rW_DW_DW_ARG = 20
+	asBCTYPE_rW_DW_DW_ARG = 20,
+	//! \brief Instruction + WORD arg (dest var) + WORD arg (source var) + QWORD arg
+	asBCTYPE_wW_rW_QW_ARG = 21
 };
 
 // Instruction type sizes
 //! \brief Lookup table for determining the size of each \ref asEBCType "type" of bytecode instruction.
-const int asBCTypeSize[21] =
+const int asBCTypeSize[22] =
 {
 	0, // asBCTYPE_INFO
 	1, // asBCTYPE_NO_ARG
@@ -5179,7 +5324,8 @@ const int asBCTypeSize[21] =
 	3, // asBCTYPE_rW_QW_ARG
 	2, // asBCTYPE_W_DW_ARG
 	3, // asBCTYPE_rW_W_DW_ARG
-	3  // asBCTYPE_rW_DW_DW_ARG
+	3, // asBCTYPE_rW_DW_DW_ARG
+	4  // asBCTYPE_wW_rW_QW_ARG
 };
 
 // Instruction info
@@ -5429,17 +5575,17 @@ const asSBCInfo asBCInfo[256] =
 	asBCINFO(POWi64,	wW_rW_rW_ARG,	0),
 	asBCINFO(POWu64,	wW_rW_rW_ARG,	0),
 	asBCINFO(Thiscall1, DW_ARG,			-AS_PTR_SIZE-1),
+	asBCINFO(StrHash,	wW_ARG,			-AS_PTR_SIZE),
+	asBCINFO(ADDIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(SUBIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(MULIi64,	wW_rW_QW_ARG,	0),
+	asBCINFO(CMPIi64,	rW_QW_ARG,		0),
+	asBCINFO(CMPIu64,	rW_QW_ARG,		0),
+	asBCINFO(ADDId,		wW_rW_QW_ARG,	0),
+	asBCINFO(SUBId,		wW_rW_QW_ARG,	0),
+	asBCINFO(MULId,		wW_rW_QW_ARG,	0),
+	asBCINFO(CMPId,		rW_QW_ARG,		0),
 
-	asBCINFO_DUMMY(201),
-	asBCINFO_DUMMY(202),
-	asBCINFO_DUMMY(203),
-	asBCINFO_DUMMY(204),
-	asBCINFO_DUMMY(205),
-	asBCINFO_DUMMY(206),
-	asBCINFO_DUMMY(207),
-	asBCINFO_DUMMY(208),
-	asBCINFO_DUMMY(209),
-	asBCINFO_DUMMY(210),
 	asBCINFO_DUMMY(211),
 	asBCINFO_DUMMY(212),
 	asBCINFO_DUMMY(213),
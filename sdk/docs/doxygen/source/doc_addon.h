@@ -1662,6 +1662,24 @@ public:
   // Add a pre-processor define for conditional compilation
   void DefineWord(const char *word);
 
+  // Enable a cache of the compiled bytecode in the given directory. When set the
+  // BuildModule will look for bytecode compiled from the same pre-processed script
+  // sections with the same engine configuration and load that instead of compiling.
+  // On a miss the compiled bytecode is saved to the cache for the next time.
+  // Must be set before adding the script sections. Pass an empty string to disable.
+  void   SetByteCodeCacheDir(const char *dir);
+
+  // Set the access mask of the current module. When the bytecode cache is used
+  // the mask must be set through the builder, rather than directly on the module,
+  // so it becomes part of the cache key. Must be called after StartNewModule.
+  void   SetAccessMask(asDWORD mask);
+
+  // Returns true if the last BuildModule loaded the module from the cache
+  bool   WasLoadedFromCache() const;
+
+  // Returns the name of the cache file used by the last BuildModule
+  string GetByteCodeCacheFile() const;
+
   // Enumerate included script sections
   unsigned int GetSectionCount() const;
   string       GetSectionName(unsigned int idx) const;
@@ -1757,6 +1775,34 @@ Example script with conditional compilation:
 </pre>
 
 
+\section doc_addon_build_cache Bytecode cache
+
+To avoid compiling the same scripts every time the application starts, the builder can keep a cache of
+the compiled bytecode on disk. Enable it by calling SetByteCodeCacheDir() with a directory where the
+application has write access. The key of each cache entry is a hash of the pre-processed script sections,
+i.e. after the include directives, conditional programming and metadata have been processed, together with
+a fingerprint of the engine configuration, which includes the engine properties and the declarations and
+access masks of the registered application interface. The module's access mask and default namespace are
+also part of the key. Any change to the scripts, the application interface or these module settings will
+thus automatically give a new cache entry. Set the access mask with the builder's SetAccessMask() and the
+default namespace on the module returned by GetModule(), after calling StartNewModule() and before BuildModule(),
+so they are taken into account.
+
+On a hit the bytecode is loaded with \ref asIScriptModule::LoadByteCode "LoadByteCode" instead of compiling
+the scripts, and the metadata is still available as usual. If the cache file cannot be loaded the scripts are
+compiled as normal and the cache file is replaced. Old cache entries are never removed by the builder.
+
+\code
+CScriptBuilder builder;
+builder.SetByteCodeCacheDir("cache");
+builder.StartNewModule(engine, "game");
+builder.AddSectionFromFile("game.as");
+int r = builder.BuildModule();
+\endcode
+
+\note The bytecode cache relies on the registered application interface being declared in the same way
+on each run. Application functions and properties are bound by their declarations when the bytecode is
+loaded, so changing the implementation of a registered function doesn't invalidate the cache.
 
 
 
@@ -200,7 +200,21 @@ By default the engine will accept 100 nested calls.
 \ref asEP_OPTIMIZE_BYTECODE
 
 Normally this option is only used for testing the library, but should you find that the compilation time takes too long, then
-it may be of interest to turn off the bytecode optimization pass by setting this option to false. 
+it may be of interest to turn off the bytecode optimization pass by setting this option to 0. 
+
+By setting this option to 2 the compiler will in addition to the default peephole optimizations also analyse how the values flow 
+through each function, and based on that propagate constants and copies of variables and remove assignments to variables that 
+are never read afterwards. Computations that give the same result in each iteration of a loop are moved to before the loop, and 
+multiplications of the loop counter are replaced with additions. Local variables that are never alive at the same time are 
+also made to share the same position on the stack, which reduces the size of the stack frames. Calls to class methods that 
+no derived class in the module overrides are made directly instead of looking up the method in the virtual function table, and 
+get accessors that only return a property of primitive type are replaced with a direct read of the property. Calls to small 
+script functions that only work with primitive values are replaced with a copy of the function body. Null checks of 
+handles that have already been verified, and that cannot have been modified since, are also removed, and handles that are 
+copied only to be read or moved to another variable borrow the reference instead of incrementing and decrementing the 
+reference counter. This gives faster bytecode in exchange for a longer compilation time. As with any optimizing compiler 
+the values of local variables inspected by a debugger may not be up to date when this level is used, and it will not be 
+possible to step into inlined accessors and functions.
  
 \ref asEP_COPY_SCRIPT_SECTIONS
  
@@ -279,6 +293,36 @@ If the behaviour used before 2.33.0 is desired for backwards compatibility, then
 generic calling convention will always release references for handles received in arguments, and never increment references 
 for returned handles. 
 
+\ref asEP_DEFER_FUNCTION_COMPILATION
+
+When this property is set the \ref asIScriptModule::Build "Build" will only register the declarations and compile the 
+types, global variables and class constructors. The function bodies are compiled when the functions are first prepared
+or called, which reduces the build time and memory use for scripts with many functions that are rarely used. Errors in the
+function bodies are reported to the message callback when the function is compiled. A function that fails to compile 
+will make \ref asIScriptContext::Prepare "Prepare" return an error, or raise a script exception if called from a script.
+
+Use \ref asIScriptModule::CompileAll "CompileAll" to compile all the remaining functions at once. Observe that the
+functions are compiled under the same lock as a build. If another thread is building or loading bytecode when a function 
+is first used, the thread calling the function will wait for the other thread to complete before compiling it, while 
+CompileAll will return \ref asBUILD_IN_PROGRESS. Shared functions are always compiled immediately.
+
+\ref asEP_BYTECODE_FORMAT
+
+Selects the format used by \ref asIScriptModule::SaveByteCode "SaveByteCode". With the default 0 the bytecode is 
+written as a sequential stream. With 1 the same data is stored in a container split into sections, where each section
+has a checksum that is verified on load so truncated or damaged files are detected before any entity is created. With 
+2 the sections are also compressed, which typically gives considerably smaller files at a small cost in load time. 
+Both container formats also store relocation tables that speed up the linking of the functions on load, but unlike 
+the default format the content then depends on the pointer size of the platform that saved it.
+\ref asIScriptModule::LoadByteCode "LoadByteCode" recognizes all formats regardless of this property.
+
+\ref asEP_SKIP_DEBUG_INFO_ON_LOAD
+
+When this property is set \ref asIScriptModule::LoadByteCode "LoadByteCode" will skip the debug information stored in 
+a bytecode container without verifying or unpacking it, as if the bytecode had been saved with the debug information 
+stripped. This reduces the load time and memory use when line numbers and variable names aren't needed. The property 
+has no effect on bytecode saved in the sequential format.
+
 \ref asEP_NO_DEBUG_OUTPUT
 
 When the library is built with AS_DEBUG it will write debug output to the folder AS_DEBUG by default. By turning on this engine property this debug output is disabled.
@@ -296,6 +296,14 @@ Perform the operation with a constant value and the value of the variable. The o
  - \ref asBC_SUBIf
  - \ref asBC_MULIf
 
+ - \ref asBC_ADDIi64
+ - \ref asBC_SUBIi64
+ - \ref asBC_MULIi64
+
+ - \ref asBC_ADDId
+ - \ref asBC_SUBId
+ - \ref asBC_MULId
+
 
 
 
@@ -348,6 +356,9 @@ Compare the value of a variable with a constant and store the result in the valu
  - \ref asBC_CMPIi
  - \ref asBC_CMPIu
  - \ref asBC_CMPIf
+ - \ref asBC_CMPIi64
+ - \ref asBC_CMPIu64
+ - \ref asBC_CMPId
 
 Test the value in the value register. Update the value register according to the result.
 
@@ -436,6 +447,13 @@ Setup the VM to begin execution of the other script function
  - \ref asBC_CALLBND
  - \ref asBC_CallPtr
  
+\ref asBC_CALL is also used to call class methods that the compiler has resolved without the virtual function
+table, e.g. finalled methods and methods of final classes. If the called function is a class method the JIT 
+compiler must verify that the object pointer on the top of the stack isn't null before making the call, and 
+otherwise raise a null pointer exception and set the context to clean up the arguments, just like for 
+\ref asBC_CALLINTF. Prior to version 2.38.0 the compiler never used asBC_CALL for class methods, so the 
+instruction could be implemented without this check.
+ 
 Setup the VM to return to the calling function 
  
  - \ref asBC_RET
@@ -461,6 +479,10 @@ Call an application registered function
  - \ref asBC_CALLSYS
  - \ref asBC_Thiscall1
 
+Compute the hash of a string object through the application's string factory
+
+ - \ref asBC_StrHash
+
 Save the state and suspend execution, then return control to the application
 
  - \ref asBC_SUSPEND
@@ -31,6 +31,11 @@ Even if you don't want or can't use multithreading, you can still write applicat
 
  - The engine will only allow one thread to build scripts at any one time, since this is something that 
    changes the internal state of the engine and cannot safely be done in multiple threads simultaneously.
+   Multiple threads can \ref asIScriptModule::LoadByteCode "load pre-compiled bytecode" into different modules 
+   at the same time. The threads will do the reading, unpacking and translation of the bytecode in parallel,
+   and only wait for each other while the loaded entities are resolved and registered in the engine. As with 
+   a build, the global variables are initialized after the load has completed, so the initializers may in 
+   turn load other modules.
    
  - Reference counters for objects that will be referred to by scripts in different threads must be thread safe
    in order to avoid race conditions as multiple threads attempt to update the same reference counter.
@@ -41,6 +41,25 @@ protected:
 };
 \endcode
 
+If the pre-compiled bytecode is already in memory, e.g. if the file has been mapped into memory or is 
+embedded in the application, it is faster to pass the buffer directly to the overload 
+\ref asIScriptModule::LoadByteCode(const void*,size_t,bool*) "LoadByteCode(data, size)". The module will then
+read the data directly from the buffer instead of calling the binary stream for each value.
+
+The engine property \ref asEP_BYTECODE_FORMAT can be used to store the bytecode in a container with checksummed 
+and optionally compressed sections. This reduces the size of the files and the number of calls to the binary stream, 
+as each section is written and read in a single call. The container also holds a relocation table for each function
+that lets the loader link the bytecode without decoding every instruction. When the bytecode is loaded on a platform 
+with the same pointer size as the one that saved it, the stack size stored with each function is used as is.
+Sections that are not compressed are read directly from the memory buffer when the overload taking a buffer is used,
+so the buffer must remain valid until LoadByteCode returns.
+
+In the container the debug information of all functions is kept in a separate section with its own string table.
+This section is only verified and unpacked after all the other entities have been loaded, and it is not read at all 
+if the engine property \ref asEP_SKIP_DEBUG_INFO_ON_LOAD is set, so a single file can serve both for debugging and 
+for fast loading. The other sections are unpacked up front, before the engine's lock is taken. Use the stripDebugInfo 
+argument of \ref asIScriptModule::SaveByteCode "SaveByteCode" to leave out the debug information completely.
+
 
 \see \ref doc_samples_asbuild
 
@@ -214,6 +214,7 @@ for classes is similar to C++ and Java.
  - \subpage doc_script_class_private
  - \subpage doc_script_class_ops
  - \subpage doc_script_class_prop
+ - \subpage doc_script_class_struct
 
 
 
@@ -20,7 +20,7 @@ FUNC          ::= ('shared' | 'external')* ('private' | 'protected')? (((TYPE '&
 VIRTPROP      ::= ('private' | 'protected')? TYPE '&'? IDENTIFIER '{' (('get' | 'set') 'const'? FUNCATTR (STATBLOCK | ';'))* '}'
 INTERFACE     ::= ('external' | 'shared')* 'interface' IDENTIFIER (';' | ((':' IDENTIFIER (',' IDENTIFIER)*)? '{' (VIRTPROP | INTFMTHD)* '}'))
 MIXIN         ::= 'mixin' CLASS
-CLASS         ::= ('shared' | 'abstract' | 'final' | 'external')* 'class' IDENTIFIER (';' | ((':' IDENTIFIER (',' IDENTIFIER)*)? '{' (VIRTPROP | FUNC | VAR | FUNCDEF)* '}'))
+CLASS         ::= ('shared' | 'abstract' | 'final' | 'external')* ('class' | 'struct') IDENTIFIER (';' | ((':' IDENTIFIER (',' IDENTIFIER)*)? '{' (VIRTPROP | FUNC | VAR | FUNCDEF)* '}'))
 VAR           ::= ('private'|'protected')? TYPE IDENTIFIER (( '=' (INITLIST | EXPR)) | ARGLIST)? (',' IDENTIFIER (( '=' (INITLIST | EXPR)) | ARGLIST)?)* ';'
 TYPEDEF       ::= 'typedef' PRIMTYPE IDENTIFIER ';'
 INTFMTHD      ::= TYPE '&'? IDENTIFIER PARAMLIST 'const'? ';'
@@ -33,7 +33,7 @@ INITLIST      ::= '{' (ASSIGN | INITLIST)? (',' (ASSIGN | INITLIST)?)* '}'
 SCOPE         ::= '::'? (IDENTIFIER '::')* (IDENTIFIER TEMPLTYPELIST? '::')?
 DATATYPE      ::= (IDENTIFIER | PRIMTYPE | '?' | 'auto')
 PRIMTYPE      ::= 'void' | 'int' | 'int8' | 'int16' | 'int32' | 'int64' | 'uint' | 'uint8' | 'uint16' | 'uint32' | 'uint64' | 'float' | 'double' | 'bool'
-FUNCATTR      ::= ('override' | 'final' | 'explicit' | 'property' | 'delete')*
+FUNCATTR      ::= ('override' | 'final' | 'explicit' | 'property' | 'delete' | 'constexpr' | 'inline' | 'noinline')*
 STATEMENT     ::= (IF | FOR | FOREACH | WHILE | RETURN | STATBLOCK | BREAK | CONTINUE | DOWHILE | SWITCH | EXPRSTAT | TRY)
 EXPRSTAT      ::= ASSIGN? ';'
 SWITCH        ::= 'switch' '(' ASSIGN ')' '{' CASE* '}'
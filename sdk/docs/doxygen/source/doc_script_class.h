@@ -298,6 +298,9 @@ control the correct use of all classes. It is also possible to mark individual c
 class as 'final', in which case it is still possible to inherit from the class, but the finalled
 method cannot be overridden.
 
+As finalled methods and methods of final classes cannot be overridden the compiler is able to call them
+directly, without looking up the method in the virtual function table, which is slightly faster.
+
 Another keyword that can be used to mark a class is 'abstract'. Abstract classes cannot be 
 instantiated, but they can be derived from. Abstract classes are most frequently used when you
 want to create a family of classes by deriving from a common base class, but do not want the
@@ -542,4 +545,48 @@ class before it has been initialized.
 
 
 
+*/
+
+/**
+
+
+\page doc_script_class_struct Structs
+
+A struct is declared like a class but with the keyword 'struct'. Unlike classes, structs are value
+types, i.e. the members are stored directly in the variable, class member, or global variable that
+holds the struct, so declaring a local struct doesn't allocate any memory on the heap. The \ref doc_datatypes_arrays "array"
+add-on also stores the structs directly in its buffer instead of allocating each element separately. Assigning a struct
+to another copies the content, and each variable holds its own independent copy.
+
+<pre>
+  struct Vec2
+  {
+    float x;
+    float y;
+
+    float lengthSquared() const { return x*x + y*y; }
+  }
+
+  void main()
+  {
+    Vec2 a;        // All members are initialized to 0
+    a.x = 1;
+    Vec2 b = a;    // b is a copy of a
+    b.x = 2;       // a.x is still 1
+  }
+</pre>
+
+Structs are meant for plain data, so they are more restricted than classes:
+
+ - The members can only be primitives, enums, or other structs. Handles, strings, and other objects are not allowed.
+ - The members cannot be initialized in the declaration. Instead all members are set to 0 when the struct is created.
+ - A struct cannot have constructors, destructor, or opAssign. Other methods, including operator overloads, are allowed.
+ - A struct cannot inherit from classes or implement interfaces, and cannot be declared as shared or external.
+ - It is not possible to take a handle to a struct.
+
+The word 'struct' is only treated as a keyword when it starts a type declaration, so it can still be used as an 
+identifier elsewhere in the scripts.
+
+
+
 */
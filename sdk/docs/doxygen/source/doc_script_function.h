@@ -22,6 +22,49 @@ The type of the return value should be specified before the name of the function
 the type should be defined as 'void'. After the function name, the list of parameters is specified between parenthesis. 
 Each parameter is defined by its type and name.
 
+\section doc_script_func_constexpr Compile time evaluation
+
+A global function that only computes a value from its arguments can be declared with the decorator 'constexpr'. When such
+a function is called with constant arguments the compiler will execute it while building the script and use the returned 
+value as a constant, so the call costs nothing at runtime. The result can also be used to initialize global constants, which 
+in turn can be used as constants in other expressions.
+
+<pre>
+  const int TILE_SIZE = 16;
+  int Area(int tiles) constexpr { return tiles * TILE_SIZE * TILE_SIZE; }
+  
+  // This is initialized to 6400 by the compiler
+  const int MAP_AREA = Area(25);
+</pre>
+
+A constexpr function can only take and return primitive types by value. It cannot access global variables, except constants 
+whose value is known by the compiler, and it can only call other constexpr functions. If the evaluation raises an exception, or
+doesn't finish within a reasonable time, the call is made at runtime instead.
+
+\section doc_script_func_inline Inline functions
+
+When the highest optimization level is used the compiler will replace calls to small functions with a copy of the function 
+body, which avoids the overhead of the call. A function or class method can be declared with the decorator 'inline' to have it 
+inlined even if it is larger, or 'noinline' to have it always called normally.
+
+<pre>
+  // The calls to this function are replaced with the loop itself
+  int Sum(int n) inline
+  {
+    int s = 0;
+    for( int i = 1; i <= n; i++ )
+      s += i;
+    return s;
+  }
+  
+  // This function is never inlined
+  void Log(int value) noinline { ... }
+</pre>
+
+Only functions in the same module that take and return primitive types by value, and that don't call other functions, can be 
+inlined. For other functions the decorator is ignored. The inlined code is not seen by the line callback or in the call stack, 
+so a loop in a function declared as inline cannot be interrupted from the application until it finishes.
+
 
 
 
@@ -119,6 +119,25 @@ The case value can be a constant variable that was initialized with a constant
 expression. If the constant variable was initialized with an expression that 
 cannot be determined at compile time it cannot be used in the case values.
 
+The switch can also be done on a string, in which case the case values must be
+string literals. The string is hashed once and then only compared with the case 
+values that have the same hash, so it is faster than a series of ifs comparing 
+the string with each value.
+
+<pre>
+  switch( command )
+  {
+  case "start":
+    // This will be executed if command equals "start"
+    break;
+
+  case "stop":
+  case "quit":
+    // This will be executed if command equals "stop" or "quit"
+    break;
+  }
+</pre>
+
 
 
 
@@ -78,6 +78,122 @@ bool Test()
 
 	// TODO: Preprocessor directives should be alone on the line
 
+	// Test the bytecode cache
+	{
+		asIScriptEngine* engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		const char *cacheScript =
+			"[meta] int g = 42; \n"
+			"int func() { return g - 1; } \n"
+			"#if FAST \n"
+			"int fast() { return g + 1; } \n"
+			"#endif \n";
+
+		CScriptBuilder builder;
+		builder.SetByteCodeCacheDir(".");
+		vector<string> cacheFiles;
+
+		// The first build compiles the script and stores it in the cache
+		builder.StartNewModule(engine, "cache");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() )
+			TEST_FAILED;
+		cacheFiles.push_back(builder.GetByteCodeCacheFile());
+
+		// The second build with the same input loads from the cache
+		builder.StartNewModule(engine, "cache");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || !builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() != cacheFiles[0] )
+			TEST_FAILED;
+		asIScriptModule *mod = engine->GetModule("cache");
+		r = ExecuteString(engine, "assert( func() == 41 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+		vector<string> metadata = builder.GetMetadataForVar(mod->GetGlobalVarIndexByName("g"));
+		if( metadata.size() != 1 || metadata[0] != "meta" )
+			TEST_FAILED;
+
+		// A change in the pre-processed script gives a miss
+		builder.StartNewModule(engine, "cache");
+		builder.DefineWord("FAST");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() == cacheFiles[0] )
+			TEST_FAILED;
+		cacheFiles.push_back(builder.GetByteCodeCacheFile());
+		r = ExecuteString(engine, "assert( fast() == 43 );", engine->GetModule("cache"));
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// A change in the registered interface gives a miss
+		int appValue = 0;
+		engine->RegisterGlobalProperty("int appValue", &appValue);
+		builder.StartNewModule(engine, "cache");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() == cacheFiles[1] )
+			TEST_FAILED;
+		cacheFiles.push_back(builder.GetByteCodeCacheFile());
+
+		// A damaged cache file is silently replaced
+		FILE *f = fopen(cacheFiles[2].c_str(), "wb");
+		if( f )
+		{
+			fwrite("garbage", 7, 1, f);
+			fclose(f);
+		}
+		builder.StartNewModule(engine, "cache");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() )
+			TEST_FAILED;
+		builder.StartNewModule(engine, "cache");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || !builder.WasLoadedFromCache() )
+			TEST_FAILED;
+
+		// The module's access mask and default namespace are part of the key
+		builder.StartNewModule(engine, "cache");
+		builder.SetAccessMask(2);
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() == cacheFiles[2] )
+			TEST_FAILED;
+		cacheFiles.push_back(builder.GetByteCodeCacheFile());
+
+		builder.StartNewModule(engine, "cache");
+		builder.GetModule()->SetDefaultNamespace("ns");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() == cacheFiles[2] || builder.GetByteCodeCacheFile() == cacheFiles[3] )
+			TEST_FAILED;
+		cacheFiles.push_back(builder.GetByteCodeCacheFile());
+
+		builder.StartNewModule(engine, "cache");
+		builder.GetModule()->SetDefaultNamespace("ns");
+		builder.AddSectionFromMemory("cache", cacheScript);
+		r = builder.BuildModule();
+		if( r < 0 || !builder.WasLoadedFromCache() || builder.GetByteCodeCacheFile() != cacheFiles[4] )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+
+		for( size_t n = 0; n < cacheFiles.size(); n++ )
+			remove(cacheFiles[n].c_str());
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+	}
+
 	// Test reusing builder for different scripts with metadata
 	// https://www.gamedev.net/forums/topic/718144-potential-bug-in-cscriptbuilder/5469392/
 	{
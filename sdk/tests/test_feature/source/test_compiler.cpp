@@ -1459,6 +1459,11 @@ bool Test()
 		if (r < 0)
 			TEST_FAILED;
 
+		// An identifier that starts with a keyword must not be split at the unicode character
+		asUINT len = 0;
+		if( engine->ParseToken("is\xf6land", 0, &len) != asTC_IDENTIFIER || len != 7 )
+			TEST_FAILED;
+
 		engine->ShutDownAndRelease();
 	}
 
@@ -1897,6 +1902,41 @@ bool Test()
 		engine->Release();
 	}
 
+	// Test tokens that are longer than the blocks scanned at a time by the tokenizer
+	{
+		engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
+
+		asUINT len = 0;
+		if( engine->ParseToken("interface", 0, &len) != asTC_KEYWORD || len != 9 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("interface_with_a_very_long_name_0123456789 ", 0, &len) != asTC_IDENTIFIER || len != 42 )
+			TEST_FAILED;
+
+		if( engine->ParseToken(" \t\r\n                                   \tx", 0, &len) != asTC_WHITESPACE || len != 40 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("// a one line comment that is long enough\nx", 0, &len) != asTC_COMMENT || len != 42 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("/* a comment with * and ** that is long enough **/x", 0, &len) != asTC_COMMENT || len != 50 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("/* a comment that is never terminated", 0, &len) != asTC_COMMENT || len != 37 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("'a string with an escaped \\' quote and more text'x", 0, &len) != asTC_VALUE || len != 49 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("\"a string ending with an escaped slash \\\\\"x", 0, &len) != asTC_VALUE || len != 42 )
+			TEST_FAILED;
+
+		if( engine->ParseToken("\"\"\"a heredoc string \" with \"\" quotes\"\"\"x", 0, &len) != asTC_VALUE || len != 39 )
+			TEST_FAILED;
+
+		engine->Release();
+	}
+
 	// Test compiler warning with implicit conversion of enums
 	// http://www.gamedev.net/topic/652867-implicit-conversion-changed-sign-of-value/
 	{
@@ -79,6 +79,87 @@ bool Test()
 	asIScriptModule* mod;
 	int r;
 
+	// Test constructors and methods taking arguments of different sizes, both in the
+	// built module and after loading the bytecode, as the context relies on the space
+	// for the arguments that is stored when the functions are declared or loaded
+	{
+		engine = asCreateScriptEngine();
+
+		bout.buffer = "";
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+
+		RegisterStdString(engine);
+
+		mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class P { \n"
+			"  double d; int64 i; string s; int8 b; \n"
+			"  P(double d, int64 i, const string &in s, int8 b) { this.d = d; this.i = i; this.s = s; this.b = b; } \n"
+			"  double sum(int64 k, double f) { return d + i + s.length() + b + k + f; } \n"
+			"} \n"
+			"funcdef double CB(int64, double); \n"
+			"double main() { \n"
+			"  double r = 0; \n"
+			"  for( int n = 0; n < 100; n++ ) { P p(n, 2, 'abc', 1); r += p.sum(1, 0.5); } \n"
+			"  return r; \n"
+			"} \n"
+			"CB @getDelegate() { P p(1, 2, 'ab', 3); return CB(p.sum); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptModule *mod2 = engine->GetModule("loaded", asGM_ALWAYS_CREATE);
+		r = mod2->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptModule *mods[] = { mod, mod2 };
+		for( asUINT m = 0; m < 2; m++ )
+		{
+			asIScriptContext *ctx = engine->CreateContext();
+			r = ctx->Prepare(mods[m]->GetFunctionByName("main"));
+			if( r >= 0 ) r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDouble() != 5700 )
+				TEST_FAILED;
+
+			r = ctx->Prepare(mods[m]->GetFunctionByName("getDelegate"));
+			if( r >= 0 ) r = ctx->Execute();
+			asIScriptFunction *dlg = 0;
+			if( r == asEXECUTION_FINISHED )
+			{
+				dlg = *(asIScriptFunction**)ctx->GetAddressOfReturnValue();
+				dlg->AddRef();
+			}
+			else
+				TEST_FAILED;
+
+			if( dlg )
+			{
+				r = ctx->Prepare(dlg);
+				ctx->SetArgQWord(0, 10);
+				ctx->SetArgDouble(1, 0.25);
+				if( r >= 0 ) r = ctx->Execute();
+				if( r != asEXECUTION_FINISHED || ctx->GetReturnDouble() != 18.25 )
+					TEST_FAILED;
+				dlg->Release();
+			}
+			ctx->Release();
+		}
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Test accessing parent's properties before calling super
 	// Reported by Sam Tupy
 	{
@@ -1,3 +1,6 @@
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include "utils.h"
 #include "../../add_on/scriptbuilder/scriptbuilder.h"
 
@@ -6,6 +9,22 @@ using namespace std;
 namespace TestModule
 {
 
+static void SuspendContext(asIScriptGeneric *)
+{
+	asGetActiveContext()->Suspend();
+}
+
+static std::atomic<bool> g_isBuilding;
+static void BlockingBuildCallback(const asSMessageInfo *, void *)
+{
+	// Keep the build in progress for a while so the other thread has to wait for it
+	if( !g_isBuilding )
+	{
+		g_isBuilding = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
+
 bool Test()
 {
 	bool fail = false;
@@ -30,6 +49,399 @@ bool Test()
 		engine->ShutDownAndRelease();
 	}
 
+	// Test BuildIncremental
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		const char *scriptA =
+			"int g = 1; \n"
+			"const int K = 10; \n"
+			"funcdef int CB(); \n"
+			"class C { int v = 2; int get() { return v + K; } } \n"
+			"int f() { return 1; } \n"
+			"int l() { CB @cb = function() { return 3; }; return cb(); } \n";
+		const char *scriptB =
+			"int other() { return f() * 100; } \n";
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("a", scriptA);
+		mod->AddScriptSection("b", scriptB);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "g = 42; assert( other() == 100 ); assert( C().get() == 12 ); assert( l() == 3 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		int funcId = mod->GetFunctionByName("f")->GetId();
+		asUINT funcCount = mod->GetFunctionCount();
+
+		// Only the bodies have changed so the functions can be recompiled without a full build
+		mod->AddScriptSection("a",
+			"int g = 1; \n"
+			"const int K = 10; \n"
+			"funcdef int CB(); \n"
+			"class C { int v = 2; int get() { return v + K + 1; } } \n"
+			"int f() { /* changed */ return 2; } \n"
+			"int l() { CB @cb = function() { return 4; }; return cb(); } \n");
+		r = mod->BuildIncremental();
+		if( r != asSUCCESS )
+			TEST_FAILED;
+
+		if( mod->GetFunctionByName("f")->GetId() != funcId )
+			TEST_FAILED;
+		if( mod->GetFunctionCount() != funcCount )
+			TEST_FAILED;
+
+		// The value of the global variable is kept
+		r = ExecuteString(engine, "assert( g == 42 ); assert( other() == 200 ); assert( C().get() == 13 ); assert( l() == 4 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// Changes outside the function bodies require a full build
+		mod->AddScriptSection("a",
+			"int g = 2; \n"
+			"const int K = 10; \n"
+			"funcdef int CB(); \n"
+			"class C { int v = 2; int get() { return v + K; } } \n"
+			"int f() { return 3; } \n"
+			"int l() { CB @cb = function() { return 4; }; return cb(); } \n");
+		r = mod->BuildIncremental();
+		if( r != asNOT_SUPPORTED )
+			TEST_FAILED;
+
+		// Sections that were not part of the previous build also require a full build
+		mod->AddScriptSection("c", "int h() { return 0; } \n");
+		r = mod->BuildIncremental();
+		if( r != asNOT_SUPPORTED )
+			TEST_FAILED;
+
+		// If the new code fails to compile the module is left untouched
+		mod->AddScriptSection("b", "int other() { return f() * unknown; } \n");
+		r = mod->BuildIncremental();
+		if( r != asERROR )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( g == 42 ); assert( other() == 200 ); assert( C().get() == 13 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( bout.buffer != "a (0, 0) : Info    : The script section has changes outside the function bodies. A full build is required\n"
+						   "c (0, 0) : Info    : The script section was not part of the previous build. A full build is required\n"
+						   "b (1, 13) : Info    : Compiling int other()\n"
+						   "b (1, 28) : Error   : No matching symbol 'unknown'\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Get accessors that have been inlined by the data-flow optimizations cannot be recompiled
+	// without also recompiling the callers, so BuildIncremental must request a full build
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("a",
+			"class C { int v = 2; int get() { return v; } } \n"
+			"int main() { C c; return c.get(); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( main() == 2 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The callers of the accessor are unchanged, so they still have the inlined read
+		mod->AddScriptSection("a",
+			"class C { int v = 2; int get() { return v + 1; } } \n"
+			"int main() { C c; return c.get(); } \n");
+		r = mod->BuildIncremental();
+		if( r != asNOT_SUPPORTED )
+			TEST_FAILED;
+
+		// Declaring the accessor as noinline keeps it from being inlined again
+		mod->AddScriptSection("a",
+			"class C { int v = 2; int get() noinline { return v + 1; } } \n"
+			"int main() { C c; return c.get(); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( main() == 3 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The accessor is no longer inlined, so it can now be recompiled on its own
+		mod->AddScriptSection("a",
+			"class C { int v = 2; int get() noinline { return v + 2; } } \n"
+			"int main() { C c; return c.get(); } \n");
+		r = mod->BuildIncremental();
+		if( r != asSUCCESS )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( main() == 4 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( bout.buffer != "a (1, 32) : Info    : The function 'int C::get()' cannot be recompiled incrementally. A full build is required\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// BuildIncremental must not replace the bytecode while a context is still using it
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void suspend()", asFUNCTION(SuspendContext), asCALL_GENERIC);
+		bout.buffer = "";
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("a", "int f() { int a = 1; suspend(); return a + 1; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		ctx = engine->CreateContext();
+		ctx->Prepare(mod->GetFunctionByName("f"));
+		r = ctx->Execute();
+		if( r != asEXECUTION_SUSPENDED )
+			TEST_FAILED;
+
+		mod->AddScriptSection("a", "int f() { int a = 10; suspend(); return a + 10; } \n");
+		r = mod->BuildIncremental();
+		if( r != asMODULE_IS_IN_USE )
+			TEST_FAILED;
+
+		// The suspended context continues with the original bytecode
+		r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 2 )
+			TEST_FAILED;
+		ctx->Release();
+
+		// The pending changes are applied once the module is no longer in use
+		r = mod->BuildIncremental();
+		if( r != asSUCCESS )
+			TEST_FAILED;
+
+		ctx = engine->CreateContext();
+		ctx->Prepare(mod->GetFunctionByName("f"));
+		r = ctx->Execute();
+		if( r == asEXECUTION_SUSPENDED )
+			r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 20 )
+			TEST_FAILED;
+		ctx->Release();
+
+		if( bout.buffer != " (0, 0) : Error   : The module is still in use and cannot be rebuilt. Discard it and request another module\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Test build statistics
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		bout.buffer = "";
+
+		asSBuildStatistics stats;
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		if( mod->GetBuildStatistics(0) != asINVALID_ARG )
+			TEST_FAILED;
+
+		mod->AddScriptSection("test",
+			"enum E { A, B }\n"
+			"class C { int v; int Get() { return v; } }\n"
+			"int g = 42;\n"
+			"int Main() { C c; c.v = g; int s = 0; for( int n = 0; n < 10; n++ ) s += c.Get(); return s; }\n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = mod->GetBuildStatistics(&stats);
+		if( r < 0 )
+			TEST_FAILED;
+		if( stats.numTypes != 2 ||
+			stats.numFunctions < 3 ||
+			stats.numFunctionsCompiled < stats.numFunctions ||
+			stats.totalByteCodeSize == 0 ||
+			stats.largestByteCodeSize == 0 ||
+			stats.largestByteCodeSize > stats.totalByteCodeSize ||
+			stats.numScriptNodeAllocs == 0 ||
+			stats.numByteInstructionAllocs == 0 ||
+			stats.parseTime < 0 || stats.finalizeTime < 0 ||
+			stats.totalTime < stats.parseTime + stats.typeCompileTime + stats.globalVarCompileTime + stats.functionCompileTime - 0.001 ||
+			stats.loadTime != 0 )
+			TEST_FAILED;
+
+		// The largest function is Main
+		asUINT length = 0;
+		mod->GetFunctionByName("Main")->GetByteCode(&length);
+		if( length != stats.largestByteCodeSize )
+			TEST_FAILED;
+
+		// Loading the bytecode reports the load time instead of the compilation
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		asUINT totalSize = stats.totalByteCodeSize;
+
+		mod = engine->GetModule("test2", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		r = mod->GetBuildStatistics(&stats);
+		if( r < 0 )
+			TEST_FAILED;
+		if( stats.numFunctionsCompiled != 0 ||
+			stats.totalByteCodeSize != totalSize ||
+			stats.numTypes != 2 ||
+			stats.parseTime != 0 ||
+			stats.loadTime < 0 || stats.totalTime < stats.loadTime )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Test deferred compilation of function bodies
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_DEFER_FUNCTION_COMPILATION, true);
+		bout.buffer = "";
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int g = init(); \n"
+			"int init() { return 1; } \n"
+			"class C { int v = 2; int get() { return v; } } \n"
+			"funcdef int CB(); \n"
+			"int l() { CB @cb = function() { return 3; }; return cb(); } \n"
+			"int bad() { return unknown; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The function bodies are only compiled when used
+		asUINT length = 0;
+		mod->GetFunctionByName("l")->GetByteCode(&length);
+		if( length != 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( g == 1 ); assert( C().get() == 2 ); assert( l() == 3 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		mod->GetFunctionByName("l")->GetByteCode(&length);
+		if( length == 0 )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// Errors are reported when the function is first used
+		ctx = engine->CreateContext();
+		r = ctx->Prepare(mod->GetFunctionByName("bad"));
+		if( r != asERROR )
+			TEST_FAILED;
+		ctx->Release();
+
+		r = ExecuteString(engine, "bad();", mod);
+		if( r != asEXECUTION_EXCEPTION )
+			TEST_FAILED;
+
+		r = mod->CompileAll();
+		if( r != asERROR )
+			TEST_FAILED;
+
+		if( bout.buffer != "test (6, 11) : Info    : Compiling int bad()\n"
+						   "test (6, 20) : Error   : No matching symbol 'unknown'\n"
+						   " (0, 0) : Error   : Failed in call to function 'Prepare' with 'int bad()' (Code: asERROR, -1)\n"
+						   "test (6, 11) : Info    : Compiling int bad()\n"
+						   "test (6, 20) : Error   : No matching symbol 'unknown'\n"
+						   "test (6, 11) : Info    : Compiling int bad()\n"
+						   "test (6, 20) : Error   : No matching symbol 'unknown'\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// A function whose compilation was deferred is compiled when it is called even if another
+	// thread is building at the same time. The calling thread waits for the build to complete
+	{
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asFUNCTION(BlockingBuildCallback), 0, asCALL_CDECL);
+		engine->SetEngineProperty(asEP_DEFER_FUNCTION_COMPILATION, true);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", "int f() { return 42; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		g_isBuilding = false;
+		asIScriptFunction *func = mod->GetFunctionByName("f");
+		ctx = engine->CreateContext();
+		int result = 0;
+		std::thread caller([&]() {
+			for( int n = 0; n < 5000 && !g_isBuilding; n++ )
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			int rc = ctx->Prepare(func);
+			if( rc >= 0 )
+				rc = ctx->Execute();
+			result = rc == asEXECUTION_FINISHED ? (int)ctx->GetReturnDWord() : rc;
+			asThreadCleanup();
+		});
+
+		// The warning in the global variable invokes the message callback during the build
+		asIScriptModule *mod2 = engine->GetModule("other", asGM_ALWAYS_CREATE);
+		mod2->AddScriptSection("other", "int a = 1.5; \n");
+		r = mod2->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		caller.join();
+		ctx->Release();
+
+		if( !g_isBuilding || result != 42 )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Test GetTypeInfoByName with namespaces
 	{
 		asIScriptEngine *engine = asCreateScriptEngine();
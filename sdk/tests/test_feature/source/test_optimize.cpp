@@ -404,6 +404,27 @@ static double g_d[6];
 static asUINT g_b[6];
 static asQWORD g_b64[6];
 
+// Returns true if the bytecode of the function calls another script function
+static bool HasCall(asIScriptFunction *func)
+{
+	if( func == 0 ) return false;
+	asUINT len;
+	asDWORD *bc = func->GetByteCode(&len);
+	for( asUINT n = 0; n < len; )
+	{
+		asBYTE c = *(asBYTE*)(&bc[n]);
+		if( c == asBC_CALL || c == asBC_CALLINTF )
+			return true;
+		n += asBCTypeSize[asBCInfo[c].type];
+	}
+	return false;
+}
+
+static void Pause(asIScriptGeneric *)
+{
+	asGetActiveContext()->Suspend();
+}
+
 bool TestOptimize()
 {
 	bool fail = false;
@@ -1248,6 +1269,748 @@ bool TestOptimize()
 		engine->ShutDownAndRelease();
 	}
 
+	// Data-flow optimizations with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		r = engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 3);
+		if( r != asINVALID_ARG )
+			TEST_FAILED;
+		r = engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+		if( r < 0 || engine->GetEngineProperty(asEP_OPTIMIZE_BYTECODE) != 2 )
+			TEST_FAILED;
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int copies(int a, int b) { int c = a; int d = c; return d + b; } \n"
+			"int consts(int a) { int x = 5; int y = x; return a * y; } \n"
+			"int loop(int n) { int s = 0; for( int i = 0; i < n; i++ ) { int t = i; s += t * 3; if( s > 100 ) s -= 50; } return s; } \n"
+			"int branch(int a) { int x = 1; if( a > 0 ) x = 2; int y = x; switch( a ) { case 0: y += 10; break; case 1: y += 20; break; } return y; } \n"
+			"double dbl(double a, int b) { double r = a; while( b-- > 0 ) r = r * 2 + b; return r; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The local variables are replaced with the arguments they are copies of
+		asBYTE expectCopies[] = { asBC_SUSPEND, asBC_ADDi, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("copies"), expectCopies) )
+			TEST_FAILED;
+
+		// The constant is propagated through the copy and the variables become unused
+		asBYTE expectConsts[] = { asBC_SUSPEND, asBC_MULIi, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("consts"), expectConsts) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( copies(1, 2) == 3 ); \n"
+			"assert( consts(3) == 15 ); \n"
+			"assert( loop(50) == 1675 ); \n"
+			"assert( branch(-1) == 1 ); \n"
+			"assert( branch(0) == 11 ); \n"
+			"assert( branch(1) == 22 ); \n"
+			"assert( dbl(1, 3) == 18 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Loop optimizations with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int sum(int n, int k) { int s = 0; for( int i = 0; i < n; i++ ) { int a = k * 7; s += a + i * 4; } return s; } \n"
+			"int nested(int n) { int s = 0; for( int i = 0; i < n; i++ ) for( int j = 0; j < n; j++ ) s += i * 10 + j * 3 + n * 2; return s; } \n"
+			"int down(int n, int k) { int s = 0; int i = n; while( i > 0 ) { i -= 2; int t = i * 3 + k; if( t > 20 ) break; s += t; } return s + i; } \n"
+			"int early(int n, int k) { int t = 99; for( int i = 0; i < n; i++ ) { t = i * 2 + k; if( i == 3 ) break; } return t; } \n"
+			"int last(int n, int k) { int a = 5; for( int i = 0; i < n; i++ ) a = k * 2; return a; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The invariant multiplication is moved out of the loop, and the multiplication
+		// of the counter is replaced with an addition when the counter is incremented
+		asBYTE expectSum[] = { asBC_SUSPEND, asBC_SetV4, asBC_SUSPEND, asBC_SetV4, asBC_MULIi, asBC_ADDIi, asBC_JMP,
+		                       asBC_SUSPEND, asBC_SUSPEND, asBC_ADDi, asBC_SUSPEND, asBC_IncVi, asBC_ADDIi,
+		                       asBC_SUSPEND, asBC_CMPi, asBC_JS, asBC_SUSPEND, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("sum"), expectSum) )
+			TEST_FAILED;
+
+		// Loops that are never entered must give the same result
+		r = ExecuteString(engine,
+			"assert( sum(10, 3) == 390 ); \n"
+			"assert( sum(0, 3) == 0 ); \n"
+			"assert( nested(5) == 900 ); \n"
+			"assert( nested(0) == 0 ); \n"
+			"assert( down(11, 1) == 9 ); \n"
+			"assert( down(0, 1) == 0 ); \n"
+			"assert( early(10, 1) == 7 ); \n"
+			"assert( early(2, 1) == 3 ); \n"
+			"assert( early(0, 1) == 99 ); \n"
+			"assert( last(3, 4) == 8 ); \n"
+			"assert( last(0, 4) == 5 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Variables that are never alive at the same time share the stack position with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void pause()", asFUNCTION(Pause), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int share(int a) { int x = a * 2; int s = x + 1; int y = s * 3; pause(); return y; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptContext *ctx = engine->CreateContext();
+		ctx->Prepare(mod->GetFunctionByName("share"));
+		ctx->SetArgDWord(0, 5);
+		r = ctx->Execute();
+		if( r != asEXECUTION_SUSPENDED )
+			TEST_FAILED;
+		else
+		{
+			// The debug information must reflect the new positions
+			int offsets[3] = {0};
+			int value = 0;
+			for( int n = 0; n < ctx->GetVarCount(); n++ )
+			{
+				const char *name = 0;
+				int offset = 0;
+				ctx->GetVar(n, 0, &name, 0, 0, 0, &offset);
+				if( name && string(name) == "x" ) offsets[0] = offset;
+				if( name && string(name) == "s" ) offsets[1] = offset;
+				if( name && string(name) == "y" )
+				{
+					offsets[2] = offset;
+					value = *(int*)ctx->GetAddressOfVar(n);
+				}
+			}
+			if( offsets[0] <= 0 || offsets[0] != offsets[1] || offsets[0] != offsets[2] )
+				TEST_FAILED;
+			if( value != 33 )
+				TEST_FAILED;
+
+			r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 33 )
+				TEST_FAILED;
+		}
+		ctx->Release();
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Calls to methods that cannot be overridden are made without the virtual lookup. The
+	// methods are declared as noinline, as they would otherwise be inlined in the callers
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class Base { int value() noinline { return 1; } int over() { return 2; } int fin() final noinline { return 3; } } \n"
+			"final class Leaf : Base { int over() noinline { return 20; } } \n"
+			"class Mid : Base { int over() { return 30; } } \n"
+			"int callValue(Base @b) { return b.value(); } \n"
+			"int callOver(Base @b) { return b.over(); } \n"
+			"int callFin(Base @b) { return b.fin(); } \n"
+			"int callLeaf(Leaf @l) { return l.over(); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// Finalled methods, methods of finalled classes, and methods that no derived class
+		// overrides are called directly, while the overridden method still needs the lookup
+		asBYTE expectDirect[] = { asBC_SUSPEND, asBC_PshVPtr, asBC_CALL, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		asBYTE expectVirtual[] = { asBC_SUSPEND, asBC_PshVPtr, asBC_CALLINTF, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("callValue"), expectDirect) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("callFin"), expectDirect) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("callLeaf"), expectDirect) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("callOver"), expectVirtual) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"Leaf l; Mid m; \n"
+			"assert( callValue(l) == 1 ); \n"
+			"assert( callOver(l) == 20 ); \n"
+			"assert( callOver(m) == 30 ); \n"
+			"assert( callFin(m) == 3 ); \n"
+			"assert( callLeaf(l) == 20 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The direct call must still raise the exception for null handles
+		asIScriptContext *ctx = engine->CreateContext();
+		r = ExecuteString(engine, "callValue(null);", mod, ctx);
+		if( r != asEXECUTION_EXCEPTION || string(ctx->GetExceptionString()) != "Null pointer access" )
+			TEST_FAILED;
+		ctx->Release();
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Trivial get accessors are inlined with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class Vec { private float _x = 1.5f; float get_x() const property { return _x; } int id() { return this._id; } int _id = 4; } \n"
+			"class Acc { int _v = 5; int v { get { return _v; } } int calc() noinline { return _v + 1; } } \n"
+			"class Over { int value() { return 1; } } \n"
+			"class Derived : Over { int value() { return 2; } } \n"
+			"float getX(Vec @v) { return v.x; } \n"
+			"int getId(Vec @v) { return v.id(); } \n"
+			"int getV(Acc @a) { return a.v; } \n"
+			"int getCalc(Acc @a) { return a.calc(); } \n"
+			"int getValue(Over @o) { return o.value(); } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The accessors are replaced with a direct read of the property
+		asBYTE expectInline[] = { asBC_SUSPEND, asBC_LoadThisR, asBC_RDR4, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("getX"), expectInline) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("getId"), expectInline) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("getV"), expectInline) )
+			TEST_FAILED;
+
+		// Methods that do more than return a property are not replaced by this, so they are
+		// still called when declared as noinline, and overridden methods are never inlined
+		asBYTE expectCall[] = { asBC_SUSPEND, asBC_PshVPtr, asBC_CALL, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		asBYTE expectVirtual[] = { asBC_SUSPEND, asBC_PshVPtr, asBC_CALLINTF, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("getCalc"), expectCall) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("getValue"), expectVirtual) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"Vec v; Acc a; Derived d; \n"
+			"assert( getX(v) == 1.5f ); \n"
+			"assert( getId(v) == 4 ); \n"
+			"assert( getV(a) == 5 ); \n"
+			"assert( getCalc(a) == 6 ); \n"
+			"assert( getValue(d) == 2 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The inlined accessor must still raise the exception for null handles
+		asIScriptContext *ctx = engine->CreateContext();
+		r = ExecuteString(engine, "getV(null);", mod, ctx);
+		if( r != asEXECUTION_EXCEPTION || string(ctx->GetExceptionString()) != "Null pointer access" )
+			TEST_FAILED;
+		ctx->Release();
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Null checks of handles that have already been verified are removed with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class Obj { int v = 1; } \n"
+			"int f(const Obj &in o) { return o.v; } \n"
+			"int twice(Obj @h) { return f(h) + f(h); } \n"
+			"bool isNull(Obj @h) { return h is null; } \n"
+			"int loop(Obj @h, int n) { int s = f(h); for( int i = 0; i < n; i++ ) { s += f(h); if( i == 2 ) @h = null; } return s; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The handle cannot change between the calls so it is only checked once
+		asBYTE expectTwice[] = { asBC_SUSPEND, asBC_ChkNullV, asBC_PshVPtr, asBC_CALL, asBC_CpyRtoV4, asBC_PshVPtr, asBC_CALL,
+		                         asBC_CpyRtoV4, asBC_ADDi, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("twice"), expectTwice) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"Obj o; \n"
+			"assert( twice(o) == 2 ); \n"
+			"assert( loop(o, 3) == 4 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The check must remain when the handle is modified in the loop
+		asIScriptContext *ctx = engine->CreateContext();
+		r = ExecuteString(engine, "Obj o; loop(o, 5);", mod, ctx);
+		if( r != asEXECUTION_EXCEPTION || string(ctx->GetExceptionString()) != "Null pointer access" )
+			TEST_FAILED;
+		ctx->Release();
+
+		engine->ShutDownAndRelease();
+	}
+
+	// The foreach loop over an array calls the iteration methods through the
+	// faster asBC_Thiscall1 as they take a uint and return a bool or uint
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		RegisterScriptArray(engine, false);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"bool atEnd(const array<int> &in a, uint i) { return a.opForEnd(i); } \n"
+			"uint next(const array<int> &in a, uint i) { return a.opForNext(i); } \n"
+			"int sum(const array<int> &in a) { int s = 0; foreach( int v : a ) s += v; return s; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asBYTE expect[] = { asBC_SUSPEND, asBC_PshV4, asBC_PshVPtr, asBC_Thiscall1, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("atEnd"), expect) )
+			TEST_FAILED;
+		if( !ValidateByteCode(mod->GetFunctionByName("next"), expect) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"array<int> a = {1, 2, 3, 4}; \n"
+			"assert( atEnd(a, 4) ); \n"
+			"assert( !atEnd(a, 3) ); \n"
+			"assert( next(a, 1) == 2 ); \n"
+			"assert( sum(a) == 10 ); \n"
+			"array<int> e; \n"
+			"assert( sum(e) == 0 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Handles that are copied only to be read or moved don't update the
+	// reference counter with asEP_OPTIMIZE_BYTECODE = 2
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int destroyed = 0; \n"
+			"class Obj { int v = 1; ~Obj() { destroyed++; } } \n"
+			"class Node { int v = 1; Node @next; } \n"
+			"int f(Obj @o) { return o.v; } \n"
+			"int pass(Obj @h) { return f(h); } \n"
+			"int twice(Obj @h) { return f(h) + f(h); } \n"
+			"bool isNull(Obj @h) { return h is null; } \n"
+			"Obj @ret(Obj @h) { return h; } \n"
+			"int walk(Node @h) { int s = 0; while( h !is null ) { s += h.v; @h = h.next; } return s; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The handle is compared without making a copy of it
+		asBYTE expectIsNull[] = { asBC_SUSPEND, asBC_ClrVPtr, asBC_CmpPtr, asBC_TZ, asBC_CpyRtoV4, asBC_FREE, asBC_CpyVtoR4, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("isNull"), expectIsNull) )
+			TEST_FAILED;
+
+		// The parameter is returned without a new reference
+		asBYTE expectRet[] = { asBC_SUSPEND, asBC_LOADOBJ, asBC_FREE, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("ret"), expectRet) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"Obj a; \n"
+			"assert( pass(a) == 1 ); \n"
+			"assert( twice(a) == 2 ); \n"
+			"assert( ret(a) is a ); \n"
+			"assert( ret(null) is null ); \n"
+			"assert( !isNull(a) ); \n"
+			"assert( isNull(null) ); \n"
+			"assert( destroyed == 0 ); \n"
+			"assert( pass(Obj()) == 1 ); \n"
+			"assert( destroyed == 1 ); \n"
+			"ret(Obj()); \n"
+			"assert( destroyed == 2 ); \n"
+			"Node n; @n.next = Node(); \n"
+			"assert( walk(n) == 2 ); \n"
+			"assert( walk(null) == 0 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Calls to constexpr functions with constant arguments are evaluated by the compiler, and
+	// global constants initialized by them can be used as constants in other expressions
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"const int SIZE = scale(4); \n"
+			"int scale(int x) constexpr { return x * FACTOR; } \n"
+			"const int FACTOR = 3; \n"
+			"int fact(int n) constexpr { int r = 1; for( int i = 2; i <= n; i++ ) r *= i; return r; } \n"
+			"int fib(int n) constexpr { return n < 2 ? n : fib(n-1) + fib(n-2); } \n"
+			"double half(double v) constexpr { return v / 2; } \n"
+			"int div(int a, int b) constexpr { return a / b; } \n"
+			"int forever(int n) constexpr { while( true ) n++; return n; } \n"
+			"int k() { return fact(5) + SIZE; } \n"
+			"int zero = 0; \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The call is replaced with the returned value
+		asBYTE expectK[] = { asBC_SUSPEND, asBC_SetV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("k"), expectK) )
+			TEST_FAILED;
+
+		// Calls that raise exceptions or don't finish are made at runtime instead
+		r = ExecuteString(engine,
+			"assert( k() == 132 ); \n"
+			"assert( SIZE == 12 ); \n"
+			"assert( fib(20) == 6765 ); \n"
+			"assert( half(5) == 2.5 ); \n"
+			"int a = 5; \n"
+			"assert( fact(a) == 120 ); \n"
+			"if( zero == 1 ) forever(0); \n"
+			"div(1, 0); \n", mod);
+		if( r != asEXECUTION_EXCEPTION )
+			TEST_FAILED;
+
+		CBufferedOutStream bout;
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+
+		// The conversions of the arguments are reported once, both when the call
+		// is evaluated and when it has to be made at runtime instead
+		r = ExecuteString(engine,
+			"assert( fact(3.5) == 6 ); \n"
+			"if( zero == 1 ) div(7.5, 0); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+		if( bout.buffer != "ExecuteString (1, 9) : Warning : Implicit conversion of value is not exact\n"
+						   "ExecuteString (2, 21) : Warning : Implicit conversion of value is not exact\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+		bout.buffer = "";
+
+		mod->AddScriptSection("test",
+			"class Obj {} \n"
+			"Obj @obj(int x) constexpr { return null; } \n"
+			"int ref(int &in x) constexpr { return x; } \n"
+			"class C { int m() constexpr { return 1; } } \n"
+			"import int imp() constexpr from 'other'; \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		mod->AddScriptSection("test",
+			"int g = 1; \n"
+			"void func() {} \n"
+			"int glob(int x) constexpr { return x + g; } \n"
+			"int call(int x) constexpr { func(); return x; } \n"
+			"const int C = glob(1); \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer != "test (2, 1) : Error   : Function declared as constexpr can only take and return primitive types by value\n"
+						   "test (3, 1) : Error   : Function declared as constexpr can only take and return primitive types by value\n"
+						   "test (5, 1) : Error   : Imported function cannot be declared as constexpr\n"
+						   "test (4, 19) : Error   : Unexpected token 'constexpr'\n"
+						   "test (5, 11) : Info    : Compiling const int C\n"
+						   "test (5, 15) : Error   : Function 'int glob(int)' declared as constexpr must be compiled before it can be evaluated\n"
+						   "test (3, 1) : Info    : Compiling int glob(int)\n"
+						   "test (3, 40) : Error   : Function declared as constexpr cannot access the global variable 'g'\n"
+						   "test (4, 1) : Info    : Compiling int call(int)\n"
+						   "test (4, 1) : Error   : Function declared as constexpr can only work on primitive values and call other constexpr functions\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Calls to small script functions are inlined with asEP_OPTIMIZE_BYTECODE = 2, and calls to
+	// functions declared as inline also with the default level, while noinline is always called
+	for( asUINT level = 1; level <= 2; level++ )
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, level);
+
+		const char *script =
+			"int g = 3; \n"
+			"int add(int a, int b) { return a + b; } \n"
+			"double sq(double x) { return x * x; } \n"
+			"int glob(int x) { g += x; return x * g; } \n"
+			"class C { int v = 2; int mul(int a) { return v * a; } } \n"
+			"int sum(int n) inline { int s = 0; for( int i = 1; i <= n; i++ ) s += i; return s; } \n"
+			"int big(int a) noinline { return a + 1; } \n"
+			"int callAdd(int a) { return add(a, 1); } \n"
+			"double callSq(double x) { return sq(x); } \n"
+			"int callGlob(int x) { return glob(x); } \n"
+			"int callMul(C @c) { return c.mul(5); } \n"
+			"int callSum(int n) { return sum(n); } \n"
+			"int callBig(int a) { return big(a); } \n"
+			"int order() { int y = 1; return add(y++, y); } \n";
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", script);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// Functions declared as inline are inlined with both levels, even with loops
+		if( HasCall(mod->GetFunctionByName("callSum")) )
+			TEST_FAILED;
+		if( !HasCall(mod->GetFunctionByName("callBig")) )
+			TEST_FAILED;
+		const char *small[] = { "callAdd", "callSq", "callGlob", "callMul", "order" };
+		for( asUINT n = 0; n < 5; n++ )
+		{
+			if( HasCall(mod->GetFunctionByName(small[n])) != (level == 1) )
+				TEST_FAILED;
+		}
+
+		// The inlined code must also work after saving and loading the bytecode
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The arguments are evaluated from right to left, the same as for a normal call
+		r = ExecuteString(engine,
+			"assert( callAdd(4) == 5 ); \n"
+			"assert( callSq(1.5) == 2.25 ); \n"
+			"assert( callGlob(2) == 10 && g == 5 ); \n"
+			"assert( callMul(C()) == 10 ); \n"
+			"assert( callSum(4) == 10 ); \n"
+			"assert( callBig(1) == 2 ); \n"
+			"assert( order() == 2 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The object is still checked for null before the inlined method accesses the members
+		r = ExecuteString(engine, "C @c; callMul(c);", mod);
+		if( r != asEXECUTION_EXCEPTION )
+			TEST_FAILED;
+
+		// The callers still have the old code, so changing an inlined function requires a full build
+		CBufferedOutStream bout;
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test", script);
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+		string modified = script;
+		modified.replace(modified.find("s += i;"), 7, "s += 2*i;");
+		mod->AddScriptSection("test", modified.c_str());
+		r = mod->BuildIncremental();
+		if( r != asNOT_SUPPORTED )
+			TEST_FAILED;
+		if( bout.buffer != "test (6, 23) : Info    : The function 'int sum(int)' cannot be recompiled incrementally. A full build is required\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Arithmetic and comparisons of int64 and double variables with constants use the
+	// instructions that take the constant as argument instead of loading it in a variable
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int64 addI(int64 a) { return a + 1000000000000; } \n"
+			"int64 subI(int64 a) { return a - 3; } \n"
+			"int64 mulI(int64 a) { return -5 * a; } \n"
+			"double addD(double a) { return 0.5 + a; } \n"
+			"double subD(double a) { return a - 1.25; } \n"
+			"double mulD(double a) { return a * 3.0; } \n"
+			"bool lessI(int64 a) { return a < -4000000000; } \n"
+			"bool lessU(uint64 a) { return a < 0xFFFFFFFF00000000; } \n"
+			"bool lessD(double a) { return a < 2.5; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asBYTE expectAddI[] = { asBC_SUSPEND, asBC_ADDIi64, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("addI"), expectAddI) )
+			TEST_FAILED;
+		asBYTE expectSubI[] = { asBC_SUSPEND, asBC_SUBIi64, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("subI"), expectSubI) )
+			TEST_FAILED;
+		asBYTE expectMulI[] = { asBC_SUSPEND, asBC_MULIi64, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("mulI"), expectMulI) )
+			TEST_FAILED;
+		asBYTE expectAddD[] = { asBC_SUSPEND, asBC_ADDId, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("addD"), expectAddD) )
+			TEST_FAILED;
+		asBYTE expectSubD[] = { asBC_SUSPEND, asBC_SUBId, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("subD"), expectSubD) )
+			TEST_FAILED;
+		asBYTE expectMulD[] = { asBC_SUSPEND, asBC_MULId, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("mulD"), expectMulD) )
+			TEST_FAILED;
+		asBYTE expectLessI[] = { asBC_SUSPEND, asBC_CMPIi64, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("lessI"), expectLessI) )
+			TEST_FAILED;
+		asBYTE expectLessU[] = { asBC_SUSPEND, asBC_CMPIu64, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("lessU"), expectLessU) )
+			TEST_FAILED;
+		asBYTE expectLessD[] = { asBC_SUSPEND, asBC_CMPId, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("lessD"), expectLessD) )
+			TEST_FAILED;
+
+		// The instructions must also work after saving and loading the bytecode
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( addI(-1) == 999999999999 ); \n"
+			"assert( subI(1) == -2 ); \n"
+			"assert( mulI(3000000000) == -15000000000 ); \n"
+			"assert( addD(1) == 1.5 ); \n"
+			"assert( subD(1) == -0.25 ); \n"
+			"assert( mulD(-1.5) == -4.5 ); \n"
+			"assert( lessI(-4000000001) && !lessI(-4000000000) ); \n"
+			"assert( lessU(0xFFFFFFFE00000000) && !lessU(0xFFFFFFFF00000000) && !lessU(0xFFFFFFFFFFFFFFFF) ); \n"
+			"assert( lessD(2.25) && !lessD(2.5) && !lessD(1e300) ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// With asEP_OPTIMIZE_BYTECODE = 2 the data flow analysis knows the values of int64 and
+	// double variables, so the constants are used as arguments and the int64 math is folded
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, 2);
+
+		mod = engine->GetModule("mod", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int64 mulC(int64 a) { int64 x = 5000000000; int64 y = x; return a * y; } \n"
+			"int64 addC(int64 a) { int64 x = -7; int64 y = x; return y + a; } \n"
+			"double addCD(double a) { double x = 0.25; double y = x; return y + a; } \n"
+			"bool cmpC(int64 a) { int64 x = -3; int64 y = x; return a < y; } \n"
+			"bool cmpCU(uint64 a) { uint64 x = 0xFFFFFFFF00000000; uint64 y = x; return a < y; } \n"
+			"bool cmpCD(double a) { double x = 2.5; double y = x; return a < y; } \n"
+			"int64 fold(int64 a) { int64 x = 3000000000; int64 y = x * 4; int64 z = y - 7; int64 w = z & 0xFFFFFFFF; int64 v = w | 2; int64 u = v ^ x; return u + a; } \n"
+			"int64 foldVars(int64 a) { int64 x = 3000000000; int64 y = 5; int64 s = x + y; int64 p = s * y; int64 d = p - x; return a + d; } \n"
+			"int64 branch(int64 a) { int64 x = 5; if( a > 0 ) x = 6; int64 y = x * 2; return y + a; } \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		// The constants in the copied variables are used as arguments, also when the constant is the left operand
+		asBYTE expectMulC[] = { asBC_SUSPEND, asBC_MULIi64, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("mulC"), expectMulC) )
+			TEST_FAILED;
+		asBYTE expectAddC[] = { asBC_SUSPEND, asBC_ADDIi64, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("addC"), expectAddC) )
+			TEST_FAILED;
+		asBYTE expectAddCD[] = { asBC_SUSPEND, asBC_ADDId, asBC_CpyVtoR8, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("addCD"), expectAddCD) )
+			TEST_FAILED;
+		asBYTE expectCmpC[] = { asBC_SUSPEND, asBC_CMPIi64, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("cmpC"), expectCmpC) )
+			TEST_FAILED;
+		asBYTE expectCmpCU[] = { asBC_SUSPEND, asBC_CMPIu64, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("cmpCU"), expectCmpCU) )
+			TEST_FAILED;
+		asBYTE expectCmpCD[] = { asBC_SUSPEND, asBC_CMPId, asBC_TS, asBC_CpyRtoV4, asBC_CpyVtoR4, asBC_RET };
+		if( !ValidateByteCode(mod->GetFunctionByName("cmpCD"), expectCmpCD) )
+			TEST_FAILED;
+
+		// The chains of int64 operations on known values are folded into the argument of a single addition
+		const char *folded[] = { "fold", "foldVars" };
+		asQWORD expectFolded[] = { I64(2039556603), I64(12000000025) };
+		for( asUINT n = 0; n < 2; n++ )
+		{
+			asIScriptFunction *func = mod->GetFunctionByName(folded[n]);
+			if( !ValidateByteCode(func, expectAddC) )
+				TEST_FAILED;
+			else
+			{
+				// The argument of asBC_ADDIi64 follows the two variable operands
+				asUINT len;
+				asDWORD *bc = func->GetByteCode(&len);
+				asDWORD *instr = bc + asBCTypeSize[asBCInfo[asBC_SUSPEND].type];
+				if( *(asQWORD*)(instr + 2) != expectFolded[n] )
+					TEST_FAILED;
+			}
+		}
+
+		// The value isn't known after the branches join so it must not be folded
+		asBYTE expectBranch[] = { asBC_SUSPEND, asBC_ADDIi64, asBC_CpyVtoR8, asBC_RET };
+		if( ValidateByteCode(mod->GetFunctionByName("branch"), expectBranch) )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( mulC(-3) == -15000000000 ); \n"
+			"assert( addC(10) == 3 ); \n"
+			"assert( addCD(1) == 1.25 ); \n"
+			"assert( cmpC(-4) && !cmpC(-3) ); \n"
+			"assert( cmpCU(0xFFFFFFFE00000000) && !cmpCU(0xFFFFFFFF00000000) ); \n"
+			"assert( cmpCD(2.25) && !cmpCD(2.5) ); \n"
+			"assert( fold(1) == 2039556604 ); \n"
+			"assert( foldVars(-25) == 12000000000 ); \n"
+			"assert( branch(-1) == 9 ); \n"
+			"assert( branch(1) == 13 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Success
 	return fail;
 }
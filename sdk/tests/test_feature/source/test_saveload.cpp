@@ -6,6 +6,8 @@
 
 #include <memory>
 #include <vector>
+#include <thread>
+#include <atomic>
 #include "utils.h"
 #include "../../../add_on/scriptarray/scriptarray.h"
 #include "../../../add_on/scripthandle/scripthandle.h"
@@ -362,6 +364,7 @@ public:
 };
 
 bool TestAndrewPrice();
+bool TestConcurrentLoad();
 
 static asIScriptFunction *g_func = 0;
 
@@ -397,6 +400,314 @@ bool Test()
 	asIScriptEngine* engine;
 	asIScriptModule* mod;
 
+	// Test loading bytecode directly from a memory buffer
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		RegisterStdString(engine);
+
+		CBytecodeStream stream("");
+
+		const char* script =
+			"class Foo { string name; int64 big = 1234567890123; double d = 3.14; } \n"
+			"enum E { A = -1, B = 1000000 } \n"
+			"string g = 'global'; \n"
+			"int main() { \n"
+			"  Foo f; f.name = g + ' value'; \n"
+			"  assert( f.name == 'global value' ); \n"
+			"  assert( f.big == 1234567890123 && f.d == 3.14 ); \n"
+			"  return A + B; \n"
+			"} \n";
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->AddScriptSection("main", script); assert(r >= 0);
+		r = mod->Build(); assert(r >= 0);
+		r = mod->SaveByteCode(&stream); assert(r >= 0);
+		mod->Discard();
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		if( mod->LoadByteCode(0, 10) != asINVALID_ARG )
+			TEST_FAILED;
+
+		bool wasStripped = true;
+		r = mod->LoadByteCode(&stream.buffer[0], stream.buffer.size(), &wasStripped);
+		if( r < 0 || wasStripped )
+			TEST_FAILED;
+
+		r = ExecuteString(engine, "assert( main() == 999999 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// A truncated buffer must fail gracefully
+		bout.buffer = "";
+		mod = engine->GetModule("truncated", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream.buffer[0], stream.buffer.size() / 2);
+		if( r >= 0 )
+			TEST_FAILED;
+		if( bout.buffer.find("Unexpected end of file") == std::string::npos )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		r = engine->ShutDownAndRelease(); assert(r >= 0);
+	}
+
+	// Test saving / loading bytecode in the sectioned container format
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		RegisterStdString(engine);
+
+		const char* script =
+			"class Foo { string name; int64 big = 1234567890123; } \n"
+			"string g = 'global'; \n"
+			"int calc(int a) { int s = 0; for( int n = 0; n < a; n++ ) s += n; return s; } \n"
+			"int calc2(int a) { int s = 0; for( int n = 0; n < a; n++ ) s += n*2; return s; } \n"
+			"int calc3(int a) { int s = 0; for( int n = 0; n < a; n++ ) s += n*3; return s; } \n"
+			"int main() { \n"
+			"  Foo f; f.name = g + ' value'; \n"
+			"  assert( f.name == 'global value' ); \n"
+			"  assert( f.big == 1234567890123 ); \n"
+			"  return calc(10) + calc2(10) + calc3(10); \n"
+			"} \n";
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->AddScriptSection("main", script); assert(r >= 0);
+		r = mod->Build(); assert(r >= 0);
+
+		CBytecodeStream legacy(""), checked(""), uncompressed(""), compressed("");
+		r = mod->SaveByteCode(&legacy); assert(r >= 0);
+		r = engine->SetEngineProperty(asEP_BYTECODE_FORMAT, 3);
+		if( r != asINVALID_ARG )
+			TEST_FAILED;
+		engine->SetEngineProperty(asEP_BYTECODE_FORMAT, 1);
+		r = mod->SaveByteCode(&checked, true); assert(r >= 0);
+		r = mod->SaveByteCode(&uncompressed); assert(r >= 0);
+		engine->SetEngineProperty(asEP_BYTECODE_FORMAT, 2);
+		r = mod->SaveByteCode(&compressed); assert(r >= 0);
+		mod->Discard();
+
+		if( checked.buffer[0] != 'A' || compressed.buffer[0] != 'A' )
+			TEST_FAILED;
+		// The container also holds the relocation tables so compare with the uncompressed container
+		if( compressed.buffer.size() >= uncompressed.buffer.size() )
+			TEST_FAILED;
+
+		// All formats can be loaded regardless of the current engine property
+		CBytecodeStream *streams[] = { &legacy, &checked, &compressed };
+		for( asUINT n = 0; n < 3; n++ )
+		{
+			bool wasStripped = false;
+			mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+			r = mod->LoadByteCode(streams[n], &wasStripped);
+			if( r < 0 || wasStripped != (n == 1) )
+				TEST_FAILED;
+			r = ExecuteString(engine, "assert( main() == 270 );", mod);
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+
+			mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+			r = mod->LoadByteCode(&streams[n]->buffer[0], streams[n]->buffer.size());
+			if( r < 0 )
+				TEST_FAILED;
+			r = ExecuteString(engine, "assert( main() == 270 );", mod);
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+		}
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// A corrupted byte must be detected by the checksum
+		std::vector<asBYTE> corrupt = compressed.buffer;
+		corrupt[corrupt.size() - 3] ^= 0x20;
+		mod = engine->GetModule("corrupt", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&corrupt[0], corrupt.size());
+		if( r >= 0 )
+			TEST_FAILED;
+		if( bout.buffer.find("of the bytecode container is corrupt") == std::string::npos )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// An unknown container version must be rejected
+		bout.buffer = "";
+		corrupt = checked.buffer;
+		corrupt[4] = 99;
+		r = mod->LoadByteCode(&corrupt[0], corrupt.size());
+		if( r >= 0 )
+			TEST_FAILED;
+		if( bout.buffer != " (0, 0) : Error   : LoadByteCode failed. The bytecode container version 99 is not supported\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// The flags in the header must be known and agree with the content
+		for( asUINT n = 0; n < 2; n++ )
+		{
+			bout.buffer = "";
+			corrupt = checked.buffer;
+			corrupt[5] = n == 0 ? 0 : 0x81;
+			r = mod->LoadByteCode(&corrupt[0], corrupt.size());
+			if( r >= 0 )
+				TEST_FAILED;
+			if( bout.buffer.find("The bytecode is invalid") == std::string::npos )
+			{
+				PRINTF("%s", bout.buffer.c_str());
+				TEST_FAILED;
+			}
+		}
+
+		// A container without any sections must be rejected both from memory and from a stream
+		const asBYTE empty[] = { 'A', 'S', 'B', 'C', 1, 0, 0 };
+		for( asUINT n = 0; n < 2; n++ )
+		{
+			bout.buffer = "";
+			CBytecodeStream emptyStream("");
+			emptyStream.buffer.assign(empty, empty + sizeof(empty));
+			if( n == 0 )
+				r = mod->LoadByteCode(empty, sizeof(empty));
+			else
+				r = mod->LoadByteCode(&emptyStream);
+			if( r >= 0 )
+				TEST_FAILED;
+			if( bout.buffer.find("The bytecode is invalid") == std::string::npos )
+			{
+				PRINTF("%s", bout.buffer.c_str());
+				TEST_FAILED;
+			}
+		}
+
+		// The debug info is kept in the container unless stripped, and can be skipped on load
+		for( asUINT n = 0; n < 4; n++ )
+		{
+			bool skip = n >= 2;
+			engine->SetEngineProperty(asEP_SKIP_DEBUG_INFO_ON_LOAD, skip);
+			if( engine->GetEngineProperty(asEP_SKIP_DEBUG_INFO_ON_LOAD) != asPWORD(skip) )
+				TEST_FAILED;
+
+			bout.buffer = "";
+			bool wasStripped = !skip;
+			mod = engine->GetModule("debug", asGM_ALWAYS_CREATE);
+			CBytecodeStream *source = (n & 1) ? &uncompressed : &compressed;
+			source->Restart();
+			if( n < 2 )
+				r = mod->LoadByteCode(source, &wasStripped);
+			else
+				r = mod->LoadByteCode(&source->buffer[0], source->buffer.size(), &wasStripped);
+			if( r < 0 || wasStripped != skip )
+				TEST_FAILED;
+
+			asIScriptFunction *func = mod->GetFunctionByName("calc");
+			const char *section = 0;
+			int row = 0;
+			bool foundVar = false;
+			for( asUINT v = 0; func && v < func->GetVarCount(); v++ )
+			{
+				const char *name = 0;
+				func->GetVar(v, &name);
+				if( name && std::string(name) == "s" )
+					foundVar = true;
+			}
+			if( func == 0 || func->GetDeclaredAt(&section, &row, 0) < 0 )
+				TEST_FAILED;
+			else if( skip ? (foundVar || row != 0) : (!foundVar || row != 3 || section == 0 || std::string(section) != "main") )
+				TEST_FAILED;
+
+			r = ExecuteString(engine, "assert( main() == 270 );", mod);
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+			if( bout.buffer != "" )
+			{
+				PRINTF("%s", bout.buffer.c_str());
+				TEST_FAILED;
+			}
+		}
+
+		// A damaged debug info section is not noticed when it is skipped
+		corrupt = compressed.buffer;
+		corrupt[corrupt.size() - 3] ^= 0x20;
+		mod = engine->GetModule("corrupt", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&corrupt[0], corrupt.size());
+		if( r < 0 )
+			TEST_FAILED;
+		engine->SetEngineProperty(asEP_SKIP_DEBUG_INFO_ON_LOAD, false);
+
+		r = engine->ShutDownAndRelease(); assert(r >= 0);
+	}
+
+	// Test that the relocation tables stored in the container translate all the necessary instructions
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		bout.buffer = "";
+
+		RegisterStdString(engine);
+		RegisterScriptArray(engine, true);
+
+		const char* script =
+			"funcdef int CB(int); \n"
+			"interface I { int get(); } \n"
+			"class Base : I { int v = 1; int get() { return v; } } \n"
+			"class Derived : Base { string s; Derived(const string &in a) { s = a; v = 2; } int get() override { return v + s.length(); } } \n"
+			"int twice(int a) { return a*2; } \n"
+			"int sum(const array<int> &in a, string s, I@ i) { int t = 0; for( uint n = 0; n < a.length(); n++ ) t += a[n]; return t + s.length() + i.get(); } \n"
+			"array<array<int>> g = {{1,2},{3}}; \n"
+			"int main() { \n"
+			"  Derived d('abc'); \n"
+			"  I@ i = d; \n"
+			"  CB@ cb = twice; \n"
+			"  array<int> a = {1, 2, 3}; \n"
+			"  int r = sum(a, 'xy', i) + cb(g[0][1]); \n"
+			"  switch( r ) { case 0: return -1; case 17: return r + g[1][0]; } \n"
+			"  return r; \n"
+			"} \n";
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->AddScriptSection("main", script); assert(r >= 0);
+		r = mod->Build(); assert(r >= 0);
+
+		engine->SetEngineProperty(asEP_BYTECODE_FORMAT, 1);
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream); assert(r >= 0);
+		mod->Discard();
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+		r = ExecuteString(engine, "assert( main() == 20 );", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		r = engine->ShutDownAndRelease(); assert(r >= 0);
+	}
+
 	// Test saving / loading bytecode with class that cannot generate copy constructor containing other class that cannot generate copy constructor
 	// Problem reported by Sam Tupy
 	{
@@ -743,6 +1054,42 @@ bool Test()
 		r = engine->ShutDownAndRelease();
 	}
 
+	// Test loading bytecode that ends prematurely
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		bout.buffer = "";
+
+		mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+		r = mod->AddScriptSection("truncated",
+			"shared enum E { A = 1, B = 2, C = 3 } \n"
+			"shared class SC { int v; E e = C; } \n"
+			"typedef double real; \n"
+			"E g = B; \n"
+			"real h = 1.5; \n");
+		r = mod->Build(); assert(r >= 0);
+
+		CBytecodeStream stream("");
+		r = mod->SaveByteCode(&stream); assert(r >= 0);
+		mod->Discard();
+
+		// Every truncation must fail without crashing, no matter where it ends
+		for( size_t n = 1; n < stream.buffer.size(); n++ )
+		{
+			mod = engine->GetModule(0, asGM_ALWAYS_CREATE);
+			r = mod->LoadByteCode(&stream.buffer[0], n);
+			if( r >= 0 )
+				TEST_FAILED;
+		}
+		if( bout.buffer.find("Unexpected end of file") == std::string::npos )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		r = engine->ShutDownAndRelease();
+	}
+
 	// Test bytecode loading with value type and list constructor
 	// Reported by Phong Ba
 	{
@@ -1746,7 +2093,7 @@ bool Test()
 
 		engine->ShutDownAndRelease();
 
-		if( bout.buffer != "config (65, 0) : Warning : Cannot register template callback without the actual implementation\n" )
+		if( bout.buffer != "config (68, 0) : Warning : Cannot register template callback without the actual implementation\n" )
 		{
 			PRINTF("%s", bout.buffer.c_str());
 			TEST_FAILED;
@@ -1820,6 +2167,9 @@ bool Test()
 					"ep 38 1\n"
 					"ep 39 0\n"
 					"ep 40 1\n"
+					"ep 41 0\n"
+					"ep 42 0\n"
+					"ep 43 0\n"
 					"\n"
 					"// Enums\n"
 					"\n"
@@ -2294,6 +2644,7 @@ bool Test()
 
 	Test2();
 	TestAndrewPrice();
+	TestConcurrentLoad();
 
 
 	// Test saving/loading with array of function pointers
@@ -3692,5 +4043,125 @@ bool TestAndrewPrice()
 	return fail;
 }
 
-} // namespace
+// Loads the same bytecode into many modules from multiple threads at the same time.
+// Previously all but one of the threads would fail with asBUILD_IN_PROGRESS
+static asIScriptEngine *g_loadEngine = 0;
+static std::vector<asBYTE> g_loadBytecode;
+static std::atomic<int> g_loadFailures(0);
 
+static void LoadThread(int threadId, int numModules)
+{
+	for( int n = 0; n < numModules; n++ )
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "mod_%d_%d", threadId, n);
+		asIScriptModule *mod = g_loadEngine->GetModule(name, asGM_ALWAYS_CREATE);
+
+		// Load from memory in some threads and from a stream in the others
+		int r;
+		if( threadId & 1 )
+			r = mod->LoadByteCode(&g_loadBytecode[0], g_loadBytecode.size());
+		else
+		{
+			CBytecodeStream stream("");
+			stream.buffer = g_loadBytecode;
+			r = mod->LoadByteCode(&stream);
+		}
+		if( r < 0 )
+			g_loadFailures++;
+	}
+
+	// Give AngelScript a chance to cleanup some memory
+	asThreadCleanup();
+}
+
+// Loads a module from a global variable's initializer while the outer load is still in progress
+static void LoadNested(asIScriptGeneric *gen)
+{
+	asIScriptModule *mod = g_loadEngine->GetModule("nested", asGM_ALWAYS_CREATE);
+	gen->SetReturnDWord(mod->LoadByteCode(&g_loadBytecode[0], g_loadBytecode.size()));
+}
+
+bool TestConcurrentLoad()
+{
+	const int NUM_THREADS = 8;
+	const int NUM_MODULES = 50;
+
+	COutStream out;
+	g_loadEngine = asCreateScriptEngine();
+	g_loadEngine->SetMessageCallback(asMETHOD(COutStream,Callback), &out, asCALL_THISCALL);
+	g_loadEngine->RegisterGlobalFunction("int loadNested()", asFUNCTION(LoadNested), asCALL_GENERIC);
+	RegisterScriptArray(g_loadEngine, false);
+
+	// Compile the script once and store it in a compressed container
+	g_loadEngine->SetEngineProperty(asEP_BYTECODE_FORMAT, 2);
+	asIScriptModule *mod = g_loadEngine->GetModule("source", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("script",
+		"class Node { Node @next; int value; } \n"
+		"int func(int count) { \n"
+		"  Node @first = Node(); \n"
+		"  Node @n = first; \n"
+		"  for( int i = 1; i < count; i++ ) { @n.next = Node(); @n = n.next; n.value = i; } \n"
+		"  int sum = 0; \n"
+		"  for( @n = first; n !is null; @n = n.next ) sum += n.value; \n"
+		"  return sum; \n"
+		"} \n"
+		"array<int> list = {1, 2, 3}; \n");
+	CBytecodeStream compiled("");
+	if( mod->Build() < 0 || mod->SaveByteCode(&compiled) < 0 )
+		TEST_FAILED;
+	g_loadBytecode = compiled.buffer;
+	mod->Discard();
+
+	// Load the bytecode into many modules from multiple threads at the same time
+	g_loadFailures = 0;
+	std::vector<std::thread> threads;
+	for( int n = 0; n < NUM_THREADS; n++ )
+		threads.push_back(std::thread(LoadThread, n, NUM_MODULES));
+	for( int n = 0; n < NUM_THREADS; n++ )
+		threads[n].join();
+
+	if( g_loadFailures )
+	{
+		PRINTF("%d loads failed\n", (int)g_loadFailures);
+		TEST_FAILED;
+	}
+	if( g_loadEngine->GetModuleCount() != NUM_THREADS * NUM_MODULES )
+		TEST_FAILED;
+
+	// Verify that all the modules work
+	asIScriptContext *ctx = g_loadEngine->CreateContext();
+	for( asUINT n = 0; n < g_loadEngine->GetModuleCount(); n++ )
+	{
+		asIScriptFunction *func = g_loadEngine->GetModuleByIndex(n)->GetFunctionByName("func");
+		ctx->Prepare(func);
+		ctx->SetArgDWord(0, 100);
+		if( ctx->Execute() != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 4950 )
+			TEST_FAILED;
+	}
+	ctx->Release();
+
+	// A global variable initializer may load another module. This used to
+	// deadlock as the initializers were called while holding the engine's lock
+	mod = g_loadEngine->GetModule("source", asGM_ALWAYS_CREATE);
+	mod->AddScriptSection("script", "int nested = loadNested(); \n");
+	CBytecodeStream stream("");
+	if( mod->Build() < 0 || mod->SaveByteCode(&stream) < 0 )
+		TEST_FAILED;
+	mod = g_loadEngine->GetModule("outer", asGM_ALWAYS_CREATE);
+	if( mod->LoadByteCode(&stream) < 0 )
+		TEST_FAILED;
+	int idx = mod->GetGlobalVarIndexByName("nested");
+	if( idx < 0 || *(int*)mod->GetAddressOfGlobalVar(idx) < 0 )
+		TEST_FAILED;
+	if( g_loadEngine->GetModule("nested", asGM_ONLY_IF_EXISTS) == 0 ||
+		g_loadEngine->GetModule("nested")->GetFunctionByName("func") == 0 )
+		TEST_FAILED;
+
+	g_loadEngine->ShutDownAndRelease();
+	g_loadEngine = 0;
+
+	return fail;
+}
+
+} // namespace
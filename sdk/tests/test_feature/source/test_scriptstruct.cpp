@@ -156,6 +156,248 @@ bool Test()
 	COutStream out;
 	CBufferedOutStream bout;
 
+	// Structs are value types that are stored inline in variables, members and globals
+	// The members are cleared on declaration, and assignments copy the content
+	for( asUINT level = 0; level <= 2; level++ )
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->SetEngineProperty(asEP_OPTIMIZE_BYTECODE, level);
+		RegisterScriptArray(engine, true);
+		bout.buffer = "";
+
+		mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"enum Col { Red, Green = 5 } \n"
+			"struct Vec { float x; float y; float len2() const { return x*x + y*y; } } \n"
+			"namespace ns { struct Rect { Vec a; Vec b; int8 tag; double w; Col c; } } \n"
+			"ns::Rect g; \n"
+			"class Holder { ns::Rect r; int k = 3; } \n"
+			"Vec add(Vec a, const Vec &in b) { Vec r; r.x = a.x + b.x; r.y = a.y + b.y; return r; } \n"
+			"void fill(ns::Rect &out r) { r.a.x = 1; r.b.y = 2; r.tag = 7; r.w = 0.5; r.c = Green; } \n"
+			"double main() \n"
+			"{ \n"
+			"  Vec v; \n"
+			"  if( v.x != 0 || v.y != 0 ) return -1; \n"
+			"  v.x = 1.5; v.y = 2; \n"
+			"  Vec w = v; \n"
+			"  w.x += 1; \n"
+			"  if( v.x != 1.5 || w.x != 2.5 ) return -2; \n"
+			"  Vec s = add(v, w); \n"
+			"  if( s.x != 4 || s.y != 4 || s.len2() != 32 ) return -3; \n"
+			"  ns::Rect r; \n"
+			"  fill(r); \n"
+			"  if( r.tag != 7 || r.a.x != 1 || r.b.y != 2 || r.c != Green ) return -4; \n"
+			"  g = r; \n"
+			"  g.tag++; \n"
+			"  if( r.tag != 7 || g.tag != 8 ) return -5; \n"
+			"  Holder h; \n"
+			"  h.r = g; \n"
+			"  h.r.a = s; \n"
+			"  if( h.r.a.x != 4 || h.k != 3 || h.r.tag != 8 ) return -6; \n"
+			"  array<Vec> arr(3); \n"
+			"  arr[1].x = 5; \n"
+			"  arr.insertLast(s); \n"
+			"  if( arr[0].x != 0 || arr[1].x != 5 || arr[3].y != 4 ) return -7; \n"
+			"  double sum = 0; \n"
+			"  for( int i = 0; i < 100; i++ ) { Vec t; t.x += i; sum += t.x + t.y; } \n"
+			"  int struct = 1; \n" // struct is a contextual keyword
+			"  return sum + r.w + g.w + struct; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asITypeInfo *type = mod->GetTypeInfoByName("Vec");
+		if( type == 0 || (type->GetFlags() & (asOBJ_VALUE | asOBJ_POD)) != (asOBJ_VALUE | asOBJ_POD) || type->GetSize() != 8 || type->GetPropertyCount() != 2 )
+			TEST_FAILED;
+
+		// The saved bytecode must give the same result when loaded
+		CBytecodeStream stream("test");
+		r = mod->SaveByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		for( int n = 0; n < 2; n++ )
+		{
+			asIScriptContext *ctx = engine->CreateContext();
+			r = ctx->Prepare(mod->GetFunctionByName("main"));
+			if( r >= 0 )
+				r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED )
+				TEST_FAILED;
+			else if( ctx->GetReturnDouble() != 4952 )
+			{
+				PRINTF("struct test returned %g on level %d\n", ctx->GetReturnDouble(), level);
+				TEST_FAILED;
+			}
+			ctx->Release();
+
+			if( n == 0 )
+			{
+				mod = engine->GetModule("test2", asGM_ALWAYS_CREATE);
+				r = mod->LoadByteCode(&stream);
+				if( r < 0 )
+					TEST_FAILED;
+			}
+		}
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Arrays store the structs inline in the buffer instead of allocating each element
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		RegisterScriptArray(engine, true);
+		bout.buffer = "";
+
+		mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"struct Big \n"
+			"{ \n"
+			"  double a; double b; int8 c; int k; \n"
+			"  int opCmp(const Big &in o) const { return k - o.k; } \n"
+			"  bool opEquals(const Big &in o) const { return k == o.k; } \n"
+			"} \n"
+			"Big make(int k) { Big b; b.k = k; b.a = k * 0.5; b.c = int8(k); return b; } \n"
+			"int main() \n"
+			"{ \n"
+			"  array<Big> arr = {make(3), make(1), make(2)}; \n"
+			"  if( arr.length() != 3 || arr[0].k != 3 || arr[0].a != 1.5 || arr[2].c != 2 ) return -1; \n"
+			"  for( int n = 0; n < 20; n++ ) arr.insertLast(arr[0]); \n"
+			"  if( arr.length() != 23 || arr[22].k != 3 || arr[22].a != 1.5 ) return -2; \n"
+			"  arr.removeRange(3, 20); \n"
+			"  arr.insertAt(1, make(5)); \n"
+			"  arr.removeAt(0); \n"
+			"  if( arr.length() != 3 || arr[0].k != 5 || arr[1].k != 1 ) return -3; \n"
+			"  arr.sortAsc(); \n"
+			"  if( arr[0].k != 1 || arr[1].k != 2 || arr[2].k != 5 || arr[2].a != 2.5 ) return -4; \n"
+			"  arr.reverse(); \n"
+			"  if( arr[0].k != 5 || arr[0].c != 5 || arr[2].k != 1 || arr[2].a != 0.5 ) return -5; \n"
+			"  if( arr.find(make(2)) != 1 || arr.find(make(4)) != -1 ) return -6; \n"
+			"  array<Big> copy = arr; \n"
+			"  copy[0].k = 7; \n"
+			"  if( arr[0].k != 5 || copy[0].k != 7 || copy[1].a != 1 ) return -7; \n"
+			"  copy = arr; \n"
+			"  if( !(copy == arr) ) return -8; \n"
+			"  arr.resize(5); \n"
+			"  if( arr[4].k != 0 || arr[4].a != 0 ) return -9; \n"
+			"  array<Big> filled(2, make(9)); \n"
+			"  if( filled[1].k != 9 || filled[1].a != 4.5 ) return -10; \n"
+			"  return 1; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asIScriptContext *ctx = engine->CreateContext();
+		r = ctx->Prepare(mod->GetFunctionByName("main"));
+		if( r >= 0 )
+			r = ctx->Execute();
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+		else if( ctx->GetReturnDWord() != 1 )
+		{
+			PRINTF("struct array test returned %d\n", (int)ctx->GetReturnDWord());
+			TEST_FAILED;
+		}
+		ctx->Release();
+
+		// The elements are laid out contiguously in the buffer
+		asITypeInfo *bigType = mod->GetTypeInfoByName("Big");
+		CScriptArray *arr = CScriptArray::Create(mod->GetTypeInfoByDecl("array<Big>"), 3);
+		if( bigType == 0 || arr == 0 || arr->GetElementTypeId() != bigType->GetTypeId() )
+			TEST_FAILED;
+		else
+		{
+			if( (asBYTE*)arr->At(1) - (asBYTE*)arr->At(0) != (int)bigType->GetSize() ||
+				(asBYTE*)arr->At(2) - (asBYTE*)arr->GetBuffer() != 2*(int)bigType->GetSize() )
+				TEST_FAILED;
+			arr->Release();
+		}
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Structs only hold plain data and don't support constructors, inheritance, or handles
+	{
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		bout.buffer = "";
+
+		mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"interface I {} \n"
+			"struct A { A() {} int x; } \n"
+			"struct B : I { int y; } \n"
+			"shared struct C { int z; } \n"
+			"struct D { int v; void opAssign(const D &in) {} } \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer !=
+			"test (3, 12) : Error   : Struct cannot inherit from classes or implement interfaces\n"
+			"test (4, 1) : Error   : Struct cannot be declared as 'shared'\n"
+			"test (2, 12) : Error   : Structs cannot have constructors, destructors, or opAssign\n"
+			"test (5, 19) : Error   : Structs cannot have constructors, destructors, or opAssign\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		bout.buffer = "";
+		mod->AddScriptSection("test",
+			"class C {} \n"
+			"struct E { C c; E e; int k = 1; } \n"
+			"struct F { G g; } \n"
+			"struct G { F f; } \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer !=
+			"test (2, 12) : Error   : Struct member cannot be of type 'C'. Only primitives, enums, and other structs are allowed\n"
+			"test (2, 8) : Error   : Struct 'E' cannot contain itself\n"
+			"test (2, 28) : Error   : Struct members cannot have initialization expressions\n"
+			"test (3, 8) : Error   : Struct 'F' cannot contain itself\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		bout.buffer = "";
+		mod->AddScriptSection("test",
+			"struct S { int v; } \n"
+			"void main() { S @h; } \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer !=
+			"test (2, 1) : Info    : Compiling void main()\n"
+			"test (2, 17) : Error   : Object handle is not supported for this type\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Mixins do not support deleting methods
 	{
 		engine = asCreateScriptEngine(ANGELSCRIPT_VERSION);
@@ -259,6 +259,59 @@ bool Test()
 		r = engine->ShutDownAndRelease(); assert(r >= 0);
 	}
 
+	// Test ownership of shared entities moving through several modules as they are discarded one by one
+	{
+		engine = asCreateScriptEngine();
+		bout.buffer = "";
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+
+		const char *script =
+			"shared enum E { A = 1 }\n"
+			"shared funcdef int CB();\n"
+			"shared interface I { int Get(); }\n"
+			"shared class C : I { int Get() { return Helper(); } }\n"
+			"shared int Helper() { return A; }\n"
+			"int Main() { I@ i = C(); CB@ cb = Helper; return i.Get() + cb(); }\n";
+
+		const char *names[] = { "mod0", "mod1", "mod2", "mod3", "mod4" };
+		const int numModules = 5;
+		asIScriptModule *mods[numModules];
+		for( int n = 0; n < numModules; n++ )
+		{
+			mods[n] = engine->GetModule(names[n], asGM_ALWAYS_CREATE);
+			mods[n]->AddScriptSection("test", script);
+			r = mods[n]->Build();
+			if( r < 0 )
+				TEST_FAILED;
+		}
+
+		// Discard the modules in order so the ownership has to be transferred each time
+		for( int n = 0; n < numModules - 1; n++ )
+		{
+			mods[n]->Discard();
+			engine->GarbageCollect();
+
+			asIScriptContext *ctx = engine->CreateContext();
+			ctx->Prepare(mods[numModules-1]->GetFunctionByName("Main"));
+			r = ctx->Execute();
+			if( r != asEXECUTION_FINISHED || ctx->GetReturnDWord() != 2 )
+				TEST_FAILED;
+			ctx->Release();
+
+			// The next module in line should have become the owner
+			if( mods[numModules-1]->GetTypeInfoByName("C")->GetModule() != mods[n+1] )
+				TEST_FAILED;
+		}
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		r = engine->ShutDownAndRelease(); assert(r >= 0);
+	}
+
 	// Test anonymous functions within shared functions
 	// Reported by Phong Ba
 	{
@@ -52,6 +52,43 @@ bool TestCreateEngine()
 			TEST_FAILED;
 		}
 	}
+
+	// The builder temporarily replaces the message callback when compiling global
+	// variables and evaluating template instances. The original must be restored
+	{
+		CBufferedOutStream bout;
+		engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		RegisterScriptArray(engine, false);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"class C { array<int> a; } \n"
+			"int g = 42; \n");
+		int r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		asSFuncPtr msgCallback;
+		void* obj = 0;
+		asDWORD callConv = 0;
+		engine->GetMessageCallback(&msgCallback, &obj, &callConv);
+		if( obj != &bout || callConv != asCALL_THISCALL )
+			TEST_FAILED;
+
+		asIScriptEngine *engine2 = asCreateScriptEngine();
+		engine2->SetMessageCallback(msgCallback, obj, callConv);
+		engine2->WriteMessage("test", 0, 0, asMSGTYPE_INFORMATION, "Hello after build");
+		engine2->ShutDownAndRelease();
+
+		engine->ShutDownAndRelease();
+
+		if (bout.buffer != "test (0, 0) : Info    : Hello after build\n")
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+	}
 	
 	return fail;
 }
@@ -30,6 +30,170 @@ bool TestSwitch()
 	bool fail = false;
 	int r;
 
+	// Test switch with many sparse cases, which is dispatched with a binary search
+	{
+		COutStream out;
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(COutStream, Callback), &out, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int func(int v) { \n"
+			"  switch( v ) { \n"
+			"  case -7: return 1; \n"
+			"  case 1: return 2; \n"
+			"  case 100: return 3; \n"
+			"  case 1000: return 4; \n"
+			"  case 5000: return 5; \n"
+			"  case 20000: return 6; \n"
+			"  case 100000: return 7; \n"
+			"  case 100001: return 8; \n"
+			"  case 100003: return 9; \n"
+			"  case 300000: return 10; \n"
+			"  } \n"
+			"  return 0; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( func(-7) == 1 ); \n"
+			"assert( func(1) == 2 ); \n"
+			"assert( func(100) == 3 ); \n"
+			"assert( func(1000) == 4 ); \n"
+			"assert( func(5000) == 5 ); \n"
+			"assert( func(20000) == 6 ); \n"
+			"assert( func(100000) == 7 ); \n"
+			"assert( func(100001) == 8 ); \n"
+			"assert( func(100003) == 9 ); \n"
+			"assert( func(300000) == 10 ); \n"
+			"assert( func(-8) == 0 ); \n"
+			"assert( func(0) == 0 ); \n"
+			"assert( func(50000) == 0 ); \n"
+			"assert( func(100002) == 0 ); \n"
+			"assert( func(100004) == 0 ); \n"
+			"assert( func(300001) == 0 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		engine->ShutDownAndRelease();
+	}
+
+	// Test switch on strings
+	{
+		CBufferedOutStream bout;
+		asIScriptEngine *engine = asCreateScriptEngine();
+		engine->SetMessageCallback(asMETHOD(CBufferedOutStream, Callback), &bout, asCALL_THISCALL);
+		engine->RegisterGlobalFunction("void assert(bool)", asFUNCTION(Assert), asCALL_GENERIC);
+		RegisterStdString(engine);
+		RegisterScriptArray(engine, true);
+
+		asIScriptModule *mod = engine->GetModule("test", asGM_ALWAYS_CREATE);
+		mod->AddScriptSection("test",
+			"int func(const string &in s) { \n"
+			"  switch( s ) { \n"
+			"  case \"alpha\": return 1; \n"
+			"  case \"beta\": return 2; \n"
+			"  case \"\": return 3; \n"
+			"  case \"a long string that doesn't fit in the small buffer of the string\": return 4; \n"
+			"  case \"e\": case \"f\": case \"g\": case \"h\": return 5; \n"
+			"  default: return 0; \n"
+			"  } \n"
+			"} \n"
+			"int fallThrough(string s) { \n"
+			"  int r = 0; \n"
+			"  switch( s + '!' ) { \n"
+			"  case 'a!': r = 1; break; \n"
+			"  case 'b!': r = 2; \n"
+			"  case 'c!': r += 3; break; \n"
+			"  } \n"
+			"  return r; \n"
+			"} \n"
+			"int loop() { \n"
+			"  int r = 0; \n"
+			"  array<string> words = {'one', 'two', 'skip', 'three'}; \n"
+			"  for( uint n = 0; n < words.length(); n++ ) { \n"
+			"    switch( words[n] ) { \n"
+			"    case 'one': r += 1; break; \n"
+			"    case 'skip': continue; \n"
+			"    default: r += 10; \n"
+			"    } \n"
+			"    r += 100; \n"
+			"  } \n"
+			"  return r; \n"
+			"} \n");
+		r = mod->Build();
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( func('alpha') == 1 ); \n"
+			"assert( func('beta') == 2 ); \n"
+			"assert( func('') == 3 ); \n"
+			"assert( func(\"a long string that doesn't fit in the small buffer of the string\") == 4 ); \n"
+			"assert( func('g') == 5 ); \n"
+			"assert( func('gamma') == 0 ); \n"
+			"assert( func('Alpha') == 0 ); \n"
+			"assert( fallThrough('a') == 1 ); \n"
+			"assert( fallThrough('b') == 5 ); \n"
+			"assert( fallThrough('c') == 3 ); \n"
+			"assert( fallThrough('d') == 0 ); \n"
+			"assert( loop() == 321 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		// The hashes must still match the strings when the bytecode is loaded
+		CBytecodeStream stream("test");
+		mod->SaveByteCode(&stream);
+		mod = engine->GetModule("loaded", asGM_ALWAYS_CREATE);
+		r = mod->LoadByteCode(&stream);
+		if( r < 0 )
+			TEST_FAILED;
+
+		r = ExecuteString(engine,
+			"assert( func('beta') == 2 ); \n"
+			"assert( func('gamma') == 0 ); \n"
+			"assert( fallThrough('b') == 5 ); \n"
+			"assert( loop() == 321 ); \n", mod);
+		if( r != asEXECUTION_FINISHED )
+			TEST_FAILED;
+
+		if( bout.buffer != "" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		// The cases must be string literals and can't be repeated
+		bout.buffer = "";
+		mod->AddScriptSection("test",
+			"const string C = 'c'; \n"
+			"void func(const string &in s) { \n"
+			"  switch( s ) { \n"
+			"  case 'a': break; \n"
+			"  case 1: break; \n"
+			"  case C: break; \n"
+			"  case 'a': break; \n"
+			"  } \n"
+			"} \n");
+		r = mod->Build();
+		if( r >= 0 )
+			TEST_FAILED;
+
+		if( bout.buffer != "test (2, 1) : Info    : Compiling void func(const string&in)\n"
+		                   "test (5, 8) : Error   : Case expressions must be string literals when switching on a string\n"
+		                   "test (6, 8) : Error   : Case expressions must be string literals when switching on a string\n"
+		                   "test (7, 8) : Error   : Duplicate switch case\n" )
+		{
+			PRINTF("%s", bout.buffer.c_str());
+			TEST_FAILED;
+		}
+
+		engine->ShutDownAndRelease();
+	}
+
 	// Test switch with typedef and enums
 	// Reported by 1vanK from Urho3D
 	{